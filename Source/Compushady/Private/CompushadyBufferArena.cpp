@@ -0,0 +1,285 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#include "CompushadyBufferArena.h"
+#include "Compushady.h"
+#include "Algo/BinarySearch.h"
+
+bool UCompushadyBufferArena::InitializeArena(const FString& InName, const int64 Size, const int32 InStride, FString& ErrorMessages)
+{
+#if COMPUSHADY_UE_VERSION >= 53
+	if (Size <= 0 || InStride <= 0 || Size % InStride != 0 || Size / InStride > MAX_uint32)
+	{
+		ErrorMessages = "Invalid Size or Stride (Size must be a multiple of Stride)";
+		return false;
+	}
+
+	Name = InName;
+	Stride = InStride;
+	Capacity = Size / Stride;
+	UsedElements = 0;
+
+	BackingUAV = NewObject<UCompushadyUAV>(this);
+	BackingUAV->InitializeFromPendingStructuredBuffer(Name, Size, Stride);
+
+	FreeRanges.Empty();
+	FreeRanges.Add({ 0, Capacity });
+
+	return true;
+#else
+	ErrorMessages = "Buffer Arenas require Unreal Engine 5.3";
+	return false;
+#endif
+}
+
+UCompushadySRV* UCompushadyBufferArena::AllocateSRV(const int32 NumElements)
+{
+	int64 FirstElement = 0;
+	if (!AllocateRange(NumElements, FirstElement))
+	{
+		return nullptr;
+	}
+
+	UCompushadySRV* SRV = NewObject<UCompushadySRV>(this);
+	const FRange Range = { FirstElement, NumElements };
+	if (!InitializeView(SRV, Range))
+	{
+		FreeRange(Range);
+		return nullptr;
+	}
+
+	Allocations.Add(SRV, Range);
+	Views.Add(SRV);
+
+	return SRV;
+}
+
+UCompushadyUAV* UCompushadyBufferArena::AllocateUAV(const int32 NumElements)
+{
+	int64 FirstElement = 0;
+	if (!AllocateRange(NumElements, FirstElement))
+	{
+		return nullptr;
+	}
+
+	UCompushadyUAV* UAV = NewObject<UCompushadyUAV>(this);
+	const FRange Range = { FirstElement, NumElements };
+	if (!InitializeView(UAV, Range))
+	{
+		FreeRange(Range);
+		return nullptr;
+	}
+
+	Allocations.Add(UAV, Range);
+	Views.Add(UAV);
+
+	return UAV;
+}
+
+bool UCompushadyBufferArena::Free(UCompushadyResource* Resource)
+{
+	FRange Range;
+	if (!Allocations.RemoveAndCopyValue(Resource, Range))
+	{
+		UE_LOG(LogCompushady, Error, TEXT("Resource has not been allocated by this Buffer Arena"));
+		return false;
+	}
+
+	Views.RemoveSingleSwap(Resource);
+	FreeRange(Range);
+
+	return true;
+}
+
+bool UCompushadyBufferArena::Compact(const int64 NewSize)
+{
+	if (!BackingUAV)
+	{
+		return false;
+	}
+
+	const int64 NewCapacity = NewSize > 0 ? NewSize / Stride : Capacity;
+	if (NewSize < 0 || NewSize % Stride != 0 || NewCapacity < UsedElements || NewCapacity > MAX_uint32)
+	{
+		UE_LOG(LogCompushady, Error, TEXT("Invalid Buffer Arena size %lld"), NewSize);
+		return false;
+	}
+
+	// the views are recreated from the game thread, so nothing in flight must reference them
+	FlushRenderingCommands();
+
+	UCompushadyUAV* NewBackingUAV = NewObject<UCompushadyUAV>(this);
+	NewBackingUAV->InitializeFromPendingStructuredBuffer(Name, NewCapacity * Stride, Stride);
+
+	// the ranges keep their order, contiguous ranges are moved with a single copy
+	struct FMove
+	{
+		int64 SourceOffset;
+		int64 DestinationOffset;
+		int64 Size;
+	};
+
+	TArray<UCompushadyResource*> SortedViews = Views;
+	SortedViews.Sort([this](UCompushadyResource& A, UCompushadyResource& B)
+		{
+			return Allocations.FindChecked(&A).FirstElement < Allocations.FindChecked(&B).FirstElement;
+		});
+
+	TArray<FMove> Moves;
+	int64 NextElement = 0;
+	for (UCompushadyResource* View : SortedViews)
+	{
+		FRange& Range = Allocations.FindChecked(View);
+		if (Moves.Num() > 0 && Moves.Last().SourceOffset + Moves.Last().Size == Range.FirstElement * Stride)
+		{
+			Moves.Last().Size += Range.NumElements * Stride;
+		}
+		else
+		{
+			Moves.Add({ Range.FirstElement * Stride, NextElement * Stride, Range.NumElements * Stride });
+		}
+		Range.FirstElement = NextElement;
+		NextElement += Range.NumElements;
+	}
+
+	ENQUEUE_RENDER_COMMAND(DoCompushadyCompactBufferArena)(
+		[SourceBufferRHIRef = BackingUAV->GetBufferRHI(), NewBackingUAV, Moves = MoveTemp(Moves)](FRHICommandListImmediate& RHICmdList)
+		{
+			FBufferRHIRef DestinationBufferRHIRef = NewBackingUAV->GetBufferRHI();
+			RHICmdList.Transition(FRHITransitionInfo(SourceBufferRHIRef, ERHIAccess::Unknown, ERHIAccess::CopySrc));
+			RHICmdList.Transition(FRHITransitionInfo(DestinationBufferRHIRef, ERHIAccess::Unknown, ERHIAccess::CopyDest));
+			for (const FMove& Move : Moves)
+			{
+				RHICmdList.CopyBufferRegion(DestinationBufferRHIRef, Move.DestinationOffset, SourceBufferRHIRef, Move.SourceOffset, Move.Size);
+			}
+		});
+
+	BackingUAV = NewBackingUAV;
+	Capacity = NewCapacity;
+
+	FreeRanges.Empty();
+	if (NextElement < Capacity)
+	{
+		FreeRanges.Add({ NextElement, Capacity - NextElement });
+	}
+
+	for (UCompushadyResource* View : Views)
+	{
+		if (!InitializeView(View, Allocations.FindChecked(View)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int64 UCompushadyBufferArena::GetOffset(UCompushadyResource* Resource) const
+{
+	if (const FRange* Range = Allocations.Find(Resource))
+	{
+		return Range->FirstElement * Stride;
+	}
+	return -1;
+}
+
+int64 UCompushadyBufferArena::GetSize() const
+{
+	return Capacity * Stride;
+}
+
+int64 UCompushadyBufferArena::GetUsedBytes() const
+{
+	return UsedElements * Stride;
+}
+
+int64 UCompushadyBufferArena::GetLargestFreeBytes() const
+{
+	int64 LargestFreeElements = 0;
+	for (const FRange& Range : FreeRanges)
+	{
+		LargestFreeElements = FMath::Max(LargestFreeElements, Range.NumElements);
+	}
+	return LargestFreeElements * Stride;
+}
+
+int32 UCompushadyBufferArena::GetNumAllocations() const
+{
+	return Allocations.Num();
+}
+
+float UCompushadyBufferArena::GetFragmentation() const
+{
+	const int64 FreeBytes = GetSize() - GetUsedBytes();
+	if (FreeBytes <= 0)
+	{
+		return 0;
+	}
+	return 1.0f - static_cast<float>(static_cast<double>(GetLargestFreeBytes()) / FreeBytes);
+}
+
+UCompushadyUAV* UCompushadyBufferArena::GetBackingUAV() const
+{
+	return BackingUAV;
+}
+
+bool UCompushadyBufferArena::AllocateRange(const int64 NumElements, int64& FirstElement)
+{
+	if (!BackingUAV || NumElements <= 0)
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < FreeRanges.Num(); Index++)
+	{
+		FRange& Range = FreeRanges[Index];
+		if (Range.NumElements >= NumElements)
+		{
+			FirstElement = Range.FirstElement;
+			Range.FirstElement += NumElements;
+			Range.NumElements -= NumElements;
+			if (Range.NumElements == 0)
+			{
+				FreeRanges.RemoveAt(Index);
+			}
+			UsedElements += NumElements;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UCompushadyBufferArena::FreeRange(const FRange& Range)
+{
+	UsedElements -= Range.NumElements;
+
+	int32 Index = Algo::LowerBoundBy(FreeRanges, Range.FirstElement, &FRange::FirstElement);
+	FreeRanges.Insert(Range, Index);
+
+	if (Index + 1 < FreeRanges.Num() && FreeRanges[Index].FirstElement + FreeRanges[Index].NumElements == FreeRanges[Index + 1].FirstElement)
+	{
+		FreeRanges[Index].NumElements += FreeRanges[Index + 1].NumElements;
+		FreeRanges.RemoveAt(Index + 1);
+	}
+
+	if (Index > 0 && FreeRanges[Index - 1].FirstElement + FreeRanges[Index - 1].NumElements == FreeRanges[Index].FirstElement)
+	{
+		FreeRanges[Index - 1].NumElements += FreeRanges[Index].NumElements;
+		FreeRanges.RemoveAt(Index);
+	}
+}
+
+bool UCompushadyBufferArena::InitializeView(UCompushadyResource* Resource, const FRange& Range)
+{
+	if (UCompushadySRV* SRV = Cast<UCompushadySRV>(Resource))
+	{
+		return SRV->InitializeFromStructuredBuffer(BackingUAV->GetBufferRHI(), static_cast<uint32>(Range.FirstElement), static_cast<uint32>(Range.NumElements));
+	}
+
+	if (UCompushadyUAV* UAV = Cast<UCompushadyUAV>(Resource))
+	{
+		return UAV->InitializeFromStructuredBuffer(BackingUAV->GetBufferRHI(), static_cast<uint32>(Range.FirstElement), static_cast<uint32>(Range.NumElements));
+	}
+
+	return false;
+}
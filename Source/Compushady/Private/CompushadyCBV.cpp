@@ -2,6 +2,58 @@
 
 #include "CompushadyCBV.h"
 
+namespace Compushady
+{
+	namespace CBV
+	{
+		enum class EPropertyKind : uint8
+		{
+			Unsupported,
+			Plain,
+			Double
+		};
+
+		// structs are supported only when tightly packed and made of the same kind of properties (e.g. FVector or FLinearColor)
+		EPropertyKind GetPropertyKind(const FProperty* Property)
+		{
+			if (Property->IsA<FFloatProperty>() || Property->IsA<FIntProperty>() || Property->IsA<FUInt32Property>())
+			{
+				return EPropertyKind::Plain;
+			}
+
+			if (Property->IsA<FDoubleProperty>())
+			{
+				return EPropertyKind::Double;
+			}
+
+			if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+			{
+				EPropertyKind Kind = EPropertyKind::Unsupported;
+				int32 PropertiesSize = 0;
+				for (TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+				{
+					const EPropertyKind FieldKind = GetPropertyKind(*It);
+					if (FieldKind == EPropertyKind::Unsupported || (Kind != EPropertyKind::Unsupported && FieldKind != Kind))
+					{
+						return EPropertyKind::Unsupported;
+					}
+					Kind = FieldKind;
+					PropertiesSize += It->GetSize();
+				}
+
+				if (PropertiesSize != StructProperty->Struct->GetStructureSize())
+				{
+					return EPropertyKind::Unsupported;
+				}
+
+				return Kind;
+			}
+
+			return EPropertyKind::Unsupported;
+		}
+	}
+}
+
 bool UCompushadyCBV::Initialize(const FString& Name, const uint8* Data, const int64 Size)
 {
 	if (Size <= 0)
@@ -43,6 +95,38 @@ FUniformBufferRHIRef UCompushadyCBV::GetRHI()
 	return UniformBufferRHIRef;
 }
 
+void UCompushadyCBV::SetSnapshotMode(const bool bEnabled)
+{
+	bSnapshotMode = bEnabled;
+	LastSnapshot.Reset();
+}
+
+bool UCompushadyCBV::IsSnapshotMode() const
+{
+	return bSnapshotMode;
+}
+
+TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> UCompushadyCBV::Snapshot()
+{
+	if (!bSnapshotMode)
+	{
+		return nullptr;
+	}
+
+	// the dirty flag is owned by the non-snapshot path (the CBV could be used by a blendable too), so just compare the data
+	if (!LastSnapshot.IsValid() || LastSnapshot->Num() != BufferData.Num() || FMemory::Memcmp(LastSnapshot->GetData(), BufferData.GetData(), BufferData.Num()) != 0)
+	{
+		LastSnapshot = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(BufferData);
+	}
+
+	return LastSnapshot;
+}
+
+FUniformBufferRHIRef UCompushadyCBV::CreateSnapshotRHI(const TArray<uint8>& SnapshotData) const
+{
+	return RHICreateUniformBuffer(SnapshotData.GetData(), UniformBufferLayoutRHIRef, EUniformBufferUsage::UniformBuffer_SingleFrame, EUniformBufferValidation::None);
+}
+
 bool UCompushadyCBV::BufferDataIsDirty() const
 {
 	return bBufferDataDirty;
@@ -217,4 +301,206 @@ bool UCompushadyCBV::SetPerspectiveFromSceneCaptureComponent2D(const int64 Offse
 	FMinimalViewInfo MinimalViewInfo;
 	SceneCaptureComponent->GetCameraView(0, MinimalViewInfo);
 	return SetPerspectiveFromMinimalViewInfo(Offset, MinimalViewInfo, bTranspose);
-}
\ No newline at end of file
+}
+
+bool UCompushadyCBV::SetLayout(const FCompushadyResourceBinding& ResourceBinding)
+{
+	Constants.Empty();
+
+	for (const FCompushadyResourceConstant& Constant : ResourceBinding.Constants)
+	{
+		if (!IsValidOffset(Constant.Offset, Constant.Size))
+		{
+			UE_LOG(LogCompushady, Error, TEXT("Constant \"%s\" (offset: %d size: %d) does not fit in CBV of size %d"), *Constant.Name, Constant.Offset, Constant.Size, BufferData.Num());
+			Constants.Empty();
+			return false;
+		}
+		Constants.Add(Constant.Name, Constant);
+	}
+
+	return true;
+}
+
+int64 UCompushadyCBV::GetConstantOffset(const FString& Name) const
+{
+	const FCompushadyResourceConstant* Constant = Constants.Find(Name);
+	return Constant ? Constant->Offset : -1;
+}
+
+bool UCompushadyCBV::SetFloatByName(const FString& Name, const float Value)
+{
+	return SetValueByName(Name, Value);
+}
+
+bool UCompushadyCBV::SetDoubleByName(const FString& Name, const double Value)
+{
+	return SetValueByName(Name, Value);
+}
+
+bool UCompushadyCBV::SetIntByName(const FString& Name, const int32 Value)
+{
+	return SetValueByName(Name, Value);
+}
+
+bool UCompushadyCBV::SetUIntByName(const FString& Name, const int64 Value)
+{
+	if (Value < 0)
+	{
+		return false;
+	}
+	return SetValueByName(Name, static_cast<uint32>(Value));
+}
+
+bool UCompushadyCBV::SetFloatArrayByName(const FString& Name, const TArray<float>& Values)
+{
+	const FCompushadyResourceConstant* Constant = Constants.Find(Name);
+	if (!Constant || Constant->Size < Values.Num() * static_cast<int32>(sizeof(float)))
+	{
+		return false;
+	}
+	return SetArrayValue(Constant->Offset, Values);
+}
+
+bool UCompushadyCBV::SetVectorFloatByName(const FString& Name, const FVector Value)
+{
+	return SetValueByName(Name, FVector3f(Value));
+}
+
+bool UCompushadyCBV::SetLinearColorByName(const FString& Name, const FLinearColor Value)
+{
+	return SetValueByName(Name, Value);
+}
+
+bool UCompushadyCBV::SetTransformFloatByName(const FString& Name, const FTransform& Transform, const bool bTranspose)
+{
+	const FCompushadyResourceConstant* Constant = Constants.Find(Name);
+	if (!Constant || Constant->Size < 16 * static_cast<int32>(sizeof(float)))
+	{
+		return false;
+	}
+	return SetTransformFloat(Constant->Offset, Transform, bTranspose);
+}
+
+bool UCompushadyCBV::BuildStructCopyPlan(const UScriptStruct* ScriptStruct, TArray<FCompushadyCBVStructCopy>& Plan) const
+{
+	TArray<FCompushadyCBVStructCopy> NewPlan;
+
+	for (TFieldIterator<FProperty> It(ScriptStruct); It; ++It)
+	{
+		// user defined structs have mangled names
+		const FCompushadyResourceConstant* Constant = Constants.Find(It->GetAuthoredName());
+		if (!Constant)
+		{
+			continue;
+		}
+
+		const Compushady::CBV::EPropertyKind Kind = Compushady::CBV::GetPropertyKind(*It);
+		const int32 Size = It->GetSize();
+
+		FCompushadyCBVStructCopy Copy;
+		Copy.SourceOffset = It->GetOffset_ForInternal();
+		Copy.DestinationOffset = Constant->Offset;
+		Copy.Size = Size;
+		Copy.bDoubleToFloat = false;
+
+		if (Kind == Compushady::CBV::EPropertyKind::Plain && Size <= Constant->Size)
+		{
+			NewPlan.Add(Copy);
+		}
+		else if (Kind == Compushady::CBV::EPropertyKind::Double && Size <= Constant->Size)
+		{
+			NewPlan.Add(Copy);
+		}
+		else if (Kind == Compushady::CBV::EPropertyKind::Double && Size / 2 <= Constant->Size)
+		{
+			Copy.bDoubleToFloat = true;
+			NewPlan.Add(Copy);
+		}
+		else
+		{
+			UE_LOG(LogCompushady, Error, TEXT("Unable to map property \"%s\" of %s to constant \"%s\" (size: %d)"), *It->GetAuthoredName(), *ScriptStruct->GetName(), *Constant->Name, Constant->Size);
+			return false;
+		}
+	}
+
+	// merge contiguous copies, generally reducing the whole struct to a few memcpys
+	NewPlan.Sort([](const FCompushadyCBVStructCopy& A, const FCompushadyCBVStructCopy& B) { return A.DestinationOffset < B.DestinationOffset; });
+
+	Plan.Reset();
+	for (const FCompushadyCBVStructCopy& Copy : NewPlan)
+	{
+		if (Plan.Num() > 0)
+		{
+			FCompushadyCBVStructCopy& Last = Plan.Last();
+			const int32 LastDestinationSize = Last.bDoubleToFloat ? Last.Size / 2 : Last.Size;
+			if (Last.bDoubleToFloat == Copy.bDoubleToFloat && Last.SourceOffset + Last.Size == Copy.SourceOffset && Last.DestinationOffset + LastDestinationSize == Copy.DestinationOffset)
+			{
+				Last.Size += Copy.Size;
+				continue;
+			}
+		}
+		Plan.Add(Copy);
+	}
+
+	return true;
+}
+
+bool UCompushadyCBV::SetFromStruct(const UScriptStruct* ScriptStruct, const void* StructData)
+{
+	if (!ScriptStruct || !StructData)
+	{
+		return false;
+	}
+
+	TArray<FCompushadyCBVStructCopy> Plan;
+	if (!BuildStructCopyPlan(ScriptStruct, Plan))
+	{
+		return false;
+	}
+
+	const uint8* Source = reinterpret_cast<const uint8*>(StructData);
+	uint8* Destination = BufferData.GetData();
+
+	for (const FCompushadyCBVStructCopy& Copy : Plan)
+	{
+		if (Copy.bDoubleToFloat)
+		{
+			const double* Doubles = reinterpret_cast<const double*>(Source + Copy.SourceOffset);
+			float* Floats = reinterpret_cast<float*>(Destination + Copy.DestinationOffset);
+			for (int32 Index = 0; Index < Copy.Size / static_cast<int32>(sizeof(double)); Index++)
+			{
+				Floats[Index] = static_cast<float>(Doubles[Index]);
+			}
+		}
+		else
+		{
+			FMemory::Memcpy(Destination + Copy.DestinationOffset, Source + Copy.SourceOffset, Copy.Size);
+		}
+	}
+
+	bBufferDataDirty = true;
+	return true;
+}
+
+bool UCompushadyCBV::SetFromStruct(const int32& Struct)
+{
+	// never called directly, blueprints go through execSetFromStruct
+	check(0);
+	return false;
+}
+
+DEFINE_FUNCTION(UCompushadyCBV::execSetFromStruct)
+{
+	Stack.MostRecentProperty = nullptr;
+	Stack.MostRecentPropertyAddress = nullptr;
+	Stack.StepCompiledIn<FStructProperty>(nullptr);
+
+	const FStructProperty* StructProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+	const void* StructData = Stack.MostRecentPropertyAddress;
+
+	P_FINISH;
+
+	P_NATIVE_BEGIN;
+	*static_cast<bool*>(RESULT_PARAM) = StructProperty ? P_THIS->SetFromStruct(StructProperty->Struct, StructData) : false;
+	P_NATIVE_END;
+}
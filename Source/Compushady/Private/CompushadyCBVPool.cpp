@@ -0,0 +1,212 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#include "CompushadyCBVPool.h"
+#include "Compushady.h"
+
+bool UCompushadyCBVPool::InitializePool(const FString& Name, const int32 InSlotSize, const int32 InNumSlots)
+{
+	if (InSlotSize > MaxSlotSize)
+	{
+		UE_LOG(LogCompushady, Error, TEXT("Invalid CBV Pool SlotSize %d (max: %d)"), InSlotSize, MaxSlotSize);
+		return false;
+	}
+
+	if (InSlotSize <= 0 || InNumSlots <= 0 || static_cast<int64>(Align(InSlotSize, 256)) * InNumSlots > MAX_int32)
+	{
+		return false;
+	}
+
+	// 256 bytes is the d3d12 constant buffer alignment
+	SlotSize = Align(InSlotSize, 256);
+	NumSlots = InNumSlots;
+
+	SlotsData.AddZeroed(static_cast<int64>(SlotSize) * NumSlots);
+	AllocatedSlots.Init(false, NumSlots);
+	DirtySlots.Init(false, NumSlots);
+
+	FreeSlots.Reserve(NumSlots);
+	// reversed, so that slots are allocated from the start of the buffer
+	for (int32 Slot = NumSlots - 1; Slot >= 0; Slot--)
+	{
+		FreeSlots.Add(Slot);
+	}
+
+	InitializeFromPendingStructuredBuffer(Name, SlotsData.Num(), SlotSize);
+
+	return true;
+}
+
+int32 UCompushadyCBVPool::AllocateSlot()
+{
+	if (FreeSlots.Num() == 0)
+	{
+		return -1;
+	}
+
+	const int32 Slot = FreeSlots.Pop(false);
+	AllocatedSlots[Slot] = true;
+	return Slot;
+}
+
+bool UCompushadyCBVPool::FreeSlot(const int32 Slot)
+{
+	if (Slot < 0 || Slot >= NumSlots || !AllocatedSlots[Slot])
+	{
+		return false;
+	}
+
+	AllocatedSlots[Slot] = false;
+	FreeSlots.Add(Slot);
+	SlotSRVs.Remove(Slot);
+
+	// the next owner will find a clean slot
+	FMemory::Memzero(SlotsData.GetData() + GetSlotOffset(Slot), SlotSize);
+	if (!DirtySlots[Slot])
+	{
+		DirtySlots[Slot] = true;
+		NumDirtySlots++;
+	}
+	FirstDirtySlot = FMath::Min(FirstDirtySlot, Slot);
+	LastDirtySlot = FMath::Max(LastDirtySlot, Slot);
+
+	return true;
+}
+
+int32 UCompushadyCBVPool::GetSlotSize() const
+{
+	return SlotSize;
+}
+
+int32 UCompushadyCBVPool::GetNumSlots() const
+{
+	return NumSlots;
+}
+
+int32 UCompushadyCBVPool::GetNumAllocatedSlots() const
+{
+	return NumSlots - FreeSlots.Num();
+}
+
+int32 UCompushadyCBVPool::GetNumDirtySlots() const
+{
+	return NumDirtySlots;
+}
+
+int64 UCompushadyCBVPool::GetSlotOffset(const int32 Slot) const
+{
+	return static_cast<int64>(Slot) * SlotSize;
+}
+
+UCompushadySRV* UCompushadyCBVPool::GetSlotSRV(const int32 Slot)
+{
+	if (!IsValidSlot(Slot, 0, 0))
+	{
+		return nullptr;
+	}
+
+	if (UCompushadySRV** SlotSRV = SlotSRVs.Find(Slot))
+	{
+		return *SlotSRV;
+	}
+
+	// the pool is the outer of its slots views, this allows pipelines to upload the dirty slots
+	UCompushadySRV* SlotSRV = NewObject<UCompushadySRV>(this);
+	if (!SlotSRV->InitializeFromStructuredBuffer(GetBufferRHI(), Slot, 1))
+	{
+		return nullptr;
+	}
+
+	SlotSRVs.Add(Slot, SlotSRV);
+	return SlotSRV;
+}
+
+bool UCompushadyCBVPool::IsValidSlot(const int32 Slot, const int64 Offset, const int64 Size) const
+{
+	return Slot >= 0 && Slot < NumSlots && AllocatedSlots[Slot] && Offset >= 0 && Offset + Size <= SlotSize;
+}
+
+bool UCompushadyCBVPool::SetSlotData(const int32 Slot, const int64 Offset, const TArray<uint8>& Data)
+{
+	return SetSlotData(Slot, Offset, Data.GetData(), Data.Num());
+}
+
+bool UCompushadyCBVPool::SetSlotData(const int32 Slot, const int64 Offset, const void* Data, const int64 Size)
+{
+	if (!IsValidSlot(Slot, Offset, Size))
+	{
+		return false;
+	}
+
+	FMemory::Memcpy(SlotsData.GetData() + GetSlotOffset(Slot) + Offset, Data, Size);
+
+	if (!DirtySlots[Slot])
+	{
+		DirtySlots[Slot] = true;
+		NumDirtySlots++;
+	}
+	FirstDirtySlot = FMath::Min(FirstDirtySlot, Slot);
+	LastDirtySlot = FMath::Max(LastDirtySlot, Slot);
+
+	return true;
+}
+
+bool UCompushadyCBVPool::SetFloat(const int32 Slot, const int64 Offset, const float Value)
+{
+	return SetSlotValue(Slot, Offset, Value);
+}
+
+bool UCompushadyCBVPool::SetInt(const int32 Slot, const int64 Offset, const int32 Value)
+{
+	return SetSlotValue(Slot, Offset, Value);
+}
+
+bool UCompushadyCBVPool::SetUInt(const int32 Slot, const int64 Offset, const int64 Value)
+{
+	if (Value < 0)
+	{
+		return false;
+	}
+	return SetSlotValue(Slot, Offset, static_cast<uint32>(Value));
+}
+
+bool UCompushadyCBVPool::SetFloatArray(const int32 Slot, const int64 Offset, const TArray<float>& Values)
+{
+	return SetSlotData(Slot, Offset, Values.GetData(), Values.Num() * sizeof(float));
+}
+
+bool UCompushadyCBVPool::SetTransformFloat(const int32 Slot, const int64 Offset, const FTransform& Transform, const bool bTranspose)
+{
+	FMatrix44f Matrix(Transform.ToMatrixWithScale());
+	return SetSlotData(Slot, Offset, bTranspose ? Matrix.GetTransposed().M : Matrix.M, 16 * sizeof(float));
+}
+
+void UCompushadyCBVPool::Upload()
+{
+	if (NumDirtySlots == 0)
+	{
+		return;
+	}
+
+	// a single copy covering all of the dirty slots (the clean ones in the middle are just uploaded again)
+	const int64 Offset = GetSlotOffset(FirstDirtySlot);
+	TArray<uint8> Data(SlotsData.GetData() + Offset, GetSlotOffset(LastDirtySlot + 1) - Offset);
+
+	ENQUEUE_RENDER_COMMAND(DoCompushadyUploadCBVPool)(
+		[this, Offset, Data = MoveTemp(Data)](FRHICommandListImmediate& RHICmdList)
+		{
+			// the pool could still be pending in the game thread, but it is always ready here
+			void* LockedData = RHICmdList.LockBuffer(BufferRHIRef, Offset, Data.Num(), EResourceLockMode::RLM_WriteOnly);
+			if (!LockedData)
+			{
+				UE_LOG(LogCompushady, Error, TEXT("Unable to lock CBV Pool Buffer (%d bytes at %lld)"), Data.Num(), Offset);
+				return;
+			}
+			FMemory::Memcpy(LockedData, Data.GetData(), Data.Num());
+			RHICmdList.UnlockBuffer(BufferRHIRef);
+		});
+
+	DirtySlots.Init(false, NumSlots);
+	NumDirtySlots = 0;
+	FirstDirtySlot = MAX_int32;
+	LastDirtySlot = -1;
+}
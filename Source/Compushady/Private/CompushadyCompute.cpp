@@ -164,7 +164,7 @@ void UCompushadyCompute::Dispatch(const FCompushadyResourceArray& ResourceArray,
 	TrackResources(ResourceArray);
 
 	EnqueueToGPU(
-		[this, ResourceArray, XYZ](FRHICommandListImmediate& RHICmdList)
+		[this, ResourceArray = Compushady::Utils::SnapshotResourceArray(ResourceArray), XYZ](FRHICommandListImmediate& RHICmdList)
 		{
 			SetComputePipelineState(RHICmdList, ComputeShaderRef);
 			Compushady::Utils::SetupPipelineParameters(RHICmdList, ComputeShaderRef, ResourceArray, ResourceBindings);
@@ -277,7 +277,7 @@ void UCompushadyCompute::DispatchIndirect(const FCompushadyResourceArray& Resour
 	TrackResources(ResourceArray);
 
 	EnqueueToGPU(
-		[this, ResourceArray, BufferRHIRef, Offset](FRHICommandListImmediate& RHICmdList)
+		[this, ResourceArray = Compushady::Utils::SnapshotResourceArray(ResourceArray), BufferRHIRef, Offset](FRHICommandListImmediate& RHICmdList)
 		{
 			SetComputePipelineState(RHICmdList, ComputeShaderRef);
 			Compushady::Utils::SetupPipelineParameters(RHICmdList, ComputeShaderRef, ResourceArray, ResourceBindings);
@@ -0,0 +1,348 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#include "CompushadyConversion.h"
+#include "Math/Float16.h"
+
+void Compushady::Conversion::HalfToFloat(const uint16* Source, float* Destination, const int64 Elements)
+{
+	int64 Index = 0;
+	for (; Index + 8 <= Elements; Index += 8)
+	{
+		FPlatformMath::WideVectorLoadHalf(Destination + Index, Source + Index);
+	}
+
+	for (; Index < Elements; Index++)
+	{
+		FPlatformMath::LoadHalf(Destination + Index, Source + Index);
+	}
+}
+
+void Compushady::Conversion::FloatToHalf(const float* Source, uint16* Destination, const int64 Elements)
+{
+	int64 Index = 0;
+	for (; Index + 8 <= Elements; Index += 8)
+	{
+		FPlatformMath::WideVectorStoreHalf(Destination + Index, Source + Index);
+	}
+
+	for (; Index < Elements; Index++)
+	{
+		FPlatformMath::StoreHalf(Destination + Index, Source[Index]);
+	}
+}
+
+void Compushady::Conversion::Unorm8ToFloat(const uint8* Source, float* Destination, const int64 Elements)
+{
+	const VectorRegister4Float Scale = VectorSetFloat1(1.0f / 255.0f);
+
+	int64 Index = 0;
+	for (; Index + 4 <= Elements; Index += 4)
+	{
+		VectorStore(VectorMultiply(VectorLoadByte4(Source + Index), Scale), Destination + Index);
+	}
+
+	for (; Index < Elements; Index++)
+	{
+		Destination[Index] = Source[Index] / 255.0f;
+	}
+}
+
+void Compushady::Conversion::FloatToUnorm8(const float* Source, uint8* Destination, const int64 Elements)
+{
+	const VectorRegister4Float Scale = VectorSetFloat1(255.0f);
+	const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+
+	int64 Index = 0;
+	for (; Index + 4 <= Elements; Index += 4)
+	{
+		const VectorRegister4Float Clamped = VectorMin(VectorMax(VectorLoad(Source + Index), VectorZeroFloat()), VectorOneFloat());
+		// VectorStoreByte4 truncates
+		VectorStoreByte4(VectorMultiplyAdd(Clamped, Scale, Half), Destination + Index);
+	}
+
+	for (; Index < Elements; Index++)
+	{
+		Destination[Index] = static_cast<uint8>(FMath::Clamp(Source[Index], 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+}
+
+void Compushady::Conversion::Unorm16ToFloat(const uint16* Source, float* Destination, const int64 Elements)
+{
+	int64 Index = 0;
+	for (; Index + 4 <= Elements; Index += 4)
+	{
+		VectorStore(VectorLoadURGBA16N(Source + Index), Destination + Index);
+	}
+
+	for (; Index < Elements; Index++)
+	{
+		Destination[Index] = Source[Index] / 65535.0f;
+	}
+}
+
+void Compushady::Conversion::FloatToUnorm16(const float* Source, uint16* Destination, const int64 Elements)
+{
+	int64 Index = 0;
+	for (; Index + 4 <= Elements; Index += 4)
+	{
+		VectorStoreURGBA16N(VectorLoad(Source + Index), Destination + Index);
+	}
+
+	for (; Index < Elements; Index++)
+	{
+		Destination[Index] = static_cast<uint16>(FMath::Clamp(Source[Index], 0.0f, 1.0f) * 65535.0f + 0.5f);
+	}
+}
+
+void Compushady::Conversion::RGB10A2ToFloat(const uint32* Source, float* Destination, const int64 Pixels)
+{
+	for (int64 Index = 0; Index < Pixels; Index++)
+	{
+		VectorStore(VectorLoadURGB10A2N(const_cast<uint32*>(Source + Index)), Destination + Index * 4);
+	}
+}
+
+void Compushady::Conversion::FloatToRGB10A2(const float* Source, uint32* Destination, const int64 Pixels)
+{
+	for (int64 Index = 0; Index < Pixels; Index++)
+	{
+		VectorStoreURGB10A2N(VectorLoad(Source + Index * 4), Destination + Index);
+	}
+}
+
+void Compushady::Conversion::SwapRedBlue8(const uint8* Source, uint8* Destination, const int64 Pixels)
+{
+	const VectorRegister4Int GreenAlphaMask = MakeVectorRegisterInt(0xFF00FF00, 0xFF00FF00, 0xFF00FF00, 0xFF00FF00);
+	const VectorRegister4Int ByteMask = MakeVectorRegisterInt(0xFF, 0xFF, 0xFF, 0xFF);
+
+	int64 Index = 0;
+	for (; Index + 4 <= Pixels; Index += 4)
+	{
+		const VectorRegister4Int Value = VectorIntLoad(Source + Index * 4);
+		const VectorRegister4Int Red = VectorShiftLeftImm(VectorIntAnd(Value, ByteMask), 16);
+		const VectorRegister4Int Blue = VectorIntAnd(VectorShiftRightImmLogical(Value, 16), ByteMask);
+		VectorIntStore(VectorIntOr(VectorIntAnd(Value, GreenAlphaMask), VectorIntOr(Red, Blue)), Destination + Index * 4);
+	}
+
+	for (; Index < Pixels; Index++)
+	{
+		const uint8 Red = Source[Index * 4];
+		Destination[Index * 4] = Source[Index * 4 + 2];
+		Destination[Index * 4 + 1] = Source[Index * 4 + 1];
+		Destination[Index * 4 + 2] = Red;
+		Destination[Index * 4 + 3] = Source[Index * 4 + 3];
+	}
+}
+
+namespace Compushady
+{
+	namespace Conversion
+	{
+		// double rows of the (row vector) matrix narrowed to float registers
+		FORCEINLINE void LoadMatrixRows(const FTransform& Transform, VectorRegister4Float Rows[4])
+		{
+			const FMatrix Matrix = Transform.ToMatrixWithScale();
+			for (int32 Row = 0; Row < 4; Row++)
+			{
+				Rows[Row] = MakeVectorRegisterFloatFromDouble(VectorLoad(Matrix.M[Row]));
+			}
+		}
+
+		FORCEINLINE void TransposeRows(VectorRegister4Float Rows[4])
+		{
+			const VectorRegister4Float Low01 = VectorShuffle(Rows[0], Rows[1], 0, 1, 0, 1);
+			const VectorRegister4Float High01 = VectorShuffle(Rows[0], Rows[1], 2, 3, 2, 3);
+			const VectorRegister4Float Low23 = VectorShuffle(Rows[2], Rows[3], 0, 1, 0, 1);
+			const VectorRegister4Float High23 = VectorShuffle(Rows[2], Rows[3], 2, 3, 2, 3);
+			Rows[0] = VectorShuffle(Low01, Low23, 0, 2, 0, 2);
+			Rows[1] = VectorShuffle(Low01, Low23, 1, 3, 1, 3);
+			Rows[2] = VectorShuffle(High01, High23, 0, 2, 0, 2);
+			Rows[3] = VectorShuffle(High01, High23, 1, 3, 1, 3);
+		}
+	}
+}
+
+void Compushady::Conversion::TransformsToMatrix44f(const FTransform* Source, float* Destination, const int64 Transforms, const bool bTranspose)
+{
+	VectorRegister4Float Rows[4];
+	for (int64 Index = 0; Index < Transforms; Index++)
+	{
+		LoadMatrixRows(Source[Index], Rows);
+		if (bTranspose)
+		{
+			TransposeRows(Rows);
+		}
+
+		float* Matrix = Destination + Index * 16;
+		VectorStore(Rows[0], Matrix);
+		VectorStore(Rows[1], Matrix + 4);
+		VectorStore(Rows[2], Matrix + 8);
+		VectorStore(Rows[3], Matrix + 12);
+	}
+}
+
+void Compushady::Conversion::TransformsToMatrix34f(const FTransform* Source, float* Destination, const int64 Transforms)
+{
+	VectorRegister4Float Rows[4];
+	for (int64 Index = 0; Index < Transforms; Index++)
+	{
+		// the last row of the transposed matrix is always (0, 0, 0, 1)
+		LoadMatrixRows(Source[Index], Rows);
+		TransposeRows(Rows);
+
+		float* Matrix = Destination + Index * 12;
+		VectorStore(Rows[0], Matrix);
+		VectorStore(Rows[1], Matrix + 4);
+		VectorStore(Rows[2], Matrix + 8);
+	}
+}
+
+void Compushady::Conversion::TransformsToQuatTranslationScale(const FTransform* Source, float* Destination, const int64 Transforms)
+{
+	for (int64 Index = 0; Index < Transforms; Index++)
+	{
+		const FTransform& Transform = Source[Index];
+		const FQuat Rotation = Transform.GetRotation();
+		const FVector Translation = Transform.GetTranslation();
+		const FVector Scale = Transform.GetScale3D();
+
+		float* Packed = Destination + Index * 10;
+		VectorStore(MakeVectorRegisterFloatFromDouble(VectorLoad(&Rotation.X)), Packed);
+		Packed[4] = static_cast<float>(Translation.X);
+		Packed[5] = static_cast<float>(Translation.Y);
+		Packed[6] = static_cast<float>(Translation.Z);
+		Packed[7] = static_cast<float>(Scale.X);
+		Packed[8] = static_cast<float>(Scale.Y);
+		Packed[9] = static_cast<float>(Scale.Z);
+	}
+}
+
+bool Compushady::Conversion::SupportsPixelFormat(const EPixelFormat PixelFormat)
+{
+	switch (PixelFormat)
+	{
+	case EPixelFormat::PF_R32_FLOAT:
+	case EPixelFormat::PF_G32R32F:
+	case EPixelFormat::PF_R32G32B32F:
+	case EPixelFormat::PF_A32B32G32R32F:
+	case EPixelFormat::PF_R16F:
+	case EPixelFormat::PF_R16F_FILTER:
+	case EPixelFormat::PF_G16R16F:
+	case EPixelFormat::PF_G16R16F_FILTER:
+	case EPixelFormat::PF_FloatRGBA:
+	case EPixelFormat::PF_G8:
+	case EPixelFormat::PF_R8:
+	case EPixelFormat::PF_R8G8:
+	case EPixelFormat::PF_R8G8B8A8:
+	case EPixelFormat::PF_B8G8R8A8:
+	case EPixelFormat::PF_G16:
+	case EPixelFormat::PF_G16R16:
+	case EPixelFormat::PF_R16G16B16A16_UNORM:
+	case EPixelFormat::PF_A2B10G10R10:
+		return true;
+	default:
+		break;
+	}
+
+	return false;
+}
+
+bool Compushady::Conversion::PixelFormatToFloat(const EPixelFormat PixelFormat, const uint8* Source, const int64 Size, TArray<float>& Destination)
+{
+	switch (PixelFormat)
+	{
+	case EPixelFormat::PF_R32_FLOAT:
+	case EPixelFormat::PF_G32R32F:
+	case EPixelFormat::PF_R32G32B32F:
+	case EPixelFormat::PF_A32B32G32R32F:
+		Destination.SetNumUninitialized(Size / sizeof(float));
+		FMemory::Memcpy(Destination.GetData(), Source, Destination.Num() * sizeof(float));
+		return true;
+	case EPixelFormat::PF_R16F:
+	case EPixelFormat::PF_R16F_FILTER:
+	case EPixelFormat::PF_G16R16F:
+	case EPixelFormat::PF_G16R16F_FILTER:
+	case EPixelFormat::PF_FloatRGBA:
+		Destination.SetNumUninitialized(Size / sizeof(uint16));
+		HalfToFloat(reinterpret_cast<const uint16*>(Source), Destination.GetData(), Destination.Num());
+		return true;
+	case EPixelFormat::PF_G8:
+	case EPixelFormat::PF_R8:
+	case EPixelFormat::PF_R8G8:
+	case EPixelFormat::PF_R8G8B8A8:
+		Destination.SetNumUninitialized(Size);
+		Unorm8ToFloat(Source, Destination.GetData(), Destination.Num());
+		return true;
+	case EPixelFormat::PF_B8G8R8A8:
+	{
+		TArray64<uint8> Swapped;
+		Swapped.SetNumUninitialized(Size);
+		SwapRedBlue8(Source, Swapped.GetData(), Size / 4);
+		Destination.SetNumUninitialized(Size);
+		Unorm8ToFloat(Swapped.GetData(), Destination.GetData(), Destination.Num());
+		return true;
+	}
+	case EPixelFormat::PF_G16:
+	case EPixelFormat::PF_G16R16:
+	case EPixelFormat::PF_R16G16B16A16_UNORM:
+		Destination.SetNumUninitialized(Size / sizeof(uint16));
+		Unorm16ToFloat(reinterpret_cast<const uint16*>(Source), Destination.GetData(), Destination.Num());
+		return true;
+	case EPixelFormat::PF_A2B10G10R10:
+		Destination.SetNumUninitialized((Size / sizeof(uint32)) * 4);
+		RGB10A2ToFloat(reinterpret_cast<const uint32*>(Source), Destination.GetData(), Size / sizeof(uint32));
+		return true;
+	default:
+		break;
+	}
+
+	return false;
+}
+
+bool Compushady::Conversion::FloatToPixelFormat(const EPixelFormat PixelFormat, const float* Source, const int64 Elements, TArray64<uint8>& Destination)
+{
+	switch (PixelFormat)
+	{
+	case EPixelFormat::PF_R32_FLOAT:
+	case EPixelFormat::PF_G32R32F:
+	case EPixelFormat::PF_R32G32B32F:
+	case EPixelFormat::PF_A32B32G32R32F:
+		Destination.SetNumUninitialized(Elements * sizeof(float));
+		FMemory::Memcpy(Destination.GetData(), Source, Destination.Num());
+		return true;
+	case EPixelFormat::PF_R16F:
+	case EPixelFormat::PF_R16F_FILTER:
+	case EPixelFormat::PF_G16R16F:
+	case EPixelFormat::PF_G16R16F_FILTER:
+	case EPixelFormat::PF_FloatRGBA:
+		Destination.SetNumUninitialized(Elements * sizeof(uint16));
+		FloatToHalf(Source, reinterpret_cast<uint16*>(Destination.GetData()), Elements);
+		return true;
+	case EPixelFormat::PF_G8:
+	case EPixelFormat::PF_R8:
+	case EPixelFormat::PF_R8G8:
+	case EPixelFormat::PF_R8G8B8A8:
+		Destination.SetNumUninitialized(Elements);
+		FloatToUnorm8(Source, Destination.GetData(), Elements);
+		return true;
+	case EPixelFormat::PF_B8G8R8A8:
+		Destination.SetNumUninitialized(Elements);
+		FloatToUnorm8(Source, Destination.GetData(), Elements);
+		SwapRedBlue8(Destination.GetData(), Destination.GetData(), Elements / 4);
+		return true;
+	case EPixelFormat::PF_G16:
+	case EPixelFormat::PF_G16R16:
+	case EPixelFormat::PF_R16G16B16A16_UNORM:
+		Destination.SetNumUninitialized(Elements * sizeof(uint16));
+		FloatToUnorm16(Source, reinterpret_cast<uint16*>(Destination.GetData()), Elements);
+		return true;
+	case EPixelFormat::PF_A2B10G10R10:
+		Destination.SetNumUninitialized((Elements / 4) * sizeof(uint32));
+		FloatToRGB10A2(Source, reinterpret_cast<uint32*>(Destination.GetData()), Elements / 4);
+		return true;
+	default:
+		break;
+	}
+
+	return false;
+}
@@ -0,0 +1,240 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#include "CompushadyCurveAtlas.h"
+#include "Async/ParallelFor.h"
+#include "Curves/CurveFloat.h"
+#include "Curves/CurveLinearColor.h"
+#include "Curves/CurveVector.h"
+
+namespace Compushady
+{
+	namespace CurveAtlas
+	{
+		uint32 GetRichCurveHash(const FRichCurve& RichCurve, uint32 Hash)
+		{
+			Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(RichCurve.PreInfinityExtrap)));
+			Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(RichCurve.PostInfinityExtrap)));
+			Hash = HashCombine(Hash, GetTypeHash(RichCurve.DefaultValue));
+			for (const FRichCurveKey& Key : RichCurve.GetConstRefOfKeys())
+			{
+				Hash = HashCombine(Hash, GetTypeHash(Key.Time));
+				Hash = HashCombine(Hash, GetTypeHash(Key.Value));
+				Hash = HashCombine(Hash, GetTypeHash(Key.ArriveTangent));
+				Hash = HashCombine(Hash, GetTypeHash(Key.LeaveTangent));
+				Hash = HashCombine(Hash, GetTypeHash(Key.ArriveTangentWeight));
+				Hash = HashCombine(Hash, GetTypeHash(Key.LeaveTangentWeight));
+				Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Key.InterpMode) | static_cast<uint8>(Key.TangentMode) << 2 | static_cast<uint8>(Key.TangentWeightMode) << 5));
+			}
+			return Hash;
+		}
+	}
+}
+
+bool UCompushadyCurveAtlas::InitializeAtlas(const FString& Name, const TArray<UCurveBase*>& InCurves, const int32 InResolution, FString& ErrorMessages)
+{
+	if (InCurves.Num() == 0 || InResolution <= 0 || InCurves.Num() > static_cast<int32>(GMaxTextureDimensions) || InResolution > static_cast<int32>(GMaxTextureDimensions))
+	{
+		ErrorMessages = "Invalid number of Curves or Resolution";
+		return false;
+	}
+
+	for (const UCurveBase* Curve : InCurves)
+	{
+		if (!Curve || !(Curve->IsA<UCurveFloat>() || Curve->IsA<UCurveVector>() || Curve->IsA<UCurveLinearColor>()))
+		{
+			ErrorMessages = "Only Float, Vector and LinearColor Curves are supported";
+			return false;
+		}
+	}
+
+	Curves = InCurves;
+	Resolution = InResolution;
+
+	Texels.AddZeroed(Resolution * Curves.Num());
+	IndexTable.AddZeroed(Curves.Num());
+	// the first bake must process all of the curves
+	for (const UCurveBase* Curve : Curves)
+	{
+		CurveHashes.Add(~GetCurveHash(Curve));
+	}
+
+	FRHITextureCreateDesc TextureCreateDesc = FRHITextureCreateDesc::Create2D(*Name, Resolution, Curves.Num(), EPixelFormat::PF_A32B32G32R32F);
+	TextureCreateDesc.SetFlags(ETextureCreateFlags::ShaderResource);
+	FTextureRHIRef AtlasTextureRHIRef = RHICreateTexture(TextureCreateDesc);
+	if (!AtlasTextureRHIRef.IsValid() || !AtlasTextureRHIRef->IsValid())
+	{
+		ErrorMessages = "Unable to create Texture";
+		return false;
+	}
+
+	if (!InitializeFromTexture(AtlasTextureRHIRef))
+	{
+		ErrorMessages = "Unable to create SRV";
+		return false;
+	}
+
+	IndexTableSRV = NewObject<UCompushadySRV>(this);
+	IndexTableSRV->InitializeFromPendingStructuredBuffer(Name + "IndexTable", IndexTable.Num() * sizeof(FVector4f), sizeof(FVector4f));
+
+	Rebake();
+
+	return true;
+}
+
+int32 UCompushadyCurveAtlas::Rebake()
+{
+	TArray<int32> DirtyRows;
+	for (int32 Row = 0; Row < Curves.Num(); Row++)
+	{
+		const uint32 Hash = GetCurveHash(Curves[Row]);
+		if (Hash != CurveHashes[Row])
+		{
+			CurveHashes[Row] = Hash;
+			DirtyRows.Add(Row);
+		}
+	}
+
+	if (DirtyRows.Num() == 0)
+	{
+		return 0;
+	}
+
+	ParallelFor(DirtyRows.Num(), [&](const int32 Index)
+		{
+			BakeCurve(DirtyRows[Index]);
+		});
+
+	// contiguous dirty rows are uploaded with a single texture update
+	struct FRowsUpdate
+	{
+		int32 FirstRow;
+		int32 NumRows;
+	};
+
+	TArray<FRowsUpdate> RowsUpdates;
+	TArray<FLinearColor> UpdateTexels;
+	UpdateTexels.Reserve(DirtyRows.Num() * Resolution);
+	for (const int32 Row : DirtyRows)
+	{
+		if (RowsUpdates.Num() > 0 && RowsUpdates.Last().FirstRow + RowsUpdates.Last().NumRows == Row)
+		{
+			RowsUpdates.Last().NumRows++;
+		}
+		else
+		{
+			RowsUpdates.Add({ Row, 1 });
+		}
+		UpdateTexels.Append(Texels.GetData() + Row * Resolution, Resolution);
+	}
+
+	ENQUEUE_RENDER_COMMAND(DoCompushadyUpdateCurveAtlas)(
+		[this, AtlasTextureRHIRef = TextureRHIRef, Width = Resolution, RowsUpdates = MoveTemp(RowsUpdates), UpdateTexels = MoveTemp(UpdateTexels), IndexTableData = IndexTable](FRHICommandListImmediate& RHICmdList)
+		{
+			const FLinearColor* Data = UpdateTexels.GetData();
+			for (const FRowsUpdate& RowsUpdate : RowsUpdates)
+			{
+				FUpdateTextureRegion2D UpdateTextureRegion2D(0, RowsUpdate.FirstRow, 0, 0, Width, RowsUpdate.NumRows);
+				RHICmdList.UpdateTexture2D(AtlasTextureRHIRef, 0, UpdateTextureRegion2D, Width * sizeof(FLinearColor), reinterpret_cast<const uint8*>(Data));
+				Data += RowsUpdate.NumRows * Width;
+			}
+
+			// the index table is tiny, so it is always fully uploaded (it could be still pending in the game thread, but it is always ready here)
+			FBufferRHIRef IndexTableBufferRHIRef = IndexTableSRV->GetBufferRHI();
+			void* LockedData = RHICmdList.LockBuffer(IndexTableBufferRHIRef, 0, IndexTableData.Num() * sizeof(FVector4f), EResourceLockMode::RLM_WriteOnly);
+			FMemory::Memcpy(LockedData, IndexTableData.GetData(), IndexTableData.Num() * sizeof(FVector4f));
+			RHICmdList.UnlockBuffer(IndexTableBufferRHIRef);
+		});
+
+	return DirtyRows.Num();
+}
+
+void UCompushadyCurveAtlas::BakeCurve(const int32 Row)
+{
+	const UCurveBase* Curve = Curves[Row];
+
+	float MinTime = 0;
+	float MaxTime = 0;
+	Curve->GetTimeRange(MinTime, MaxTime);
+	const float Range = MaxTime - MinTime;
+
+	const UCurveFloat* CurveFloat = Cast<UCurveFloat>(Curve);
+	const UCurveVector* CurveVector = Cast<UCurveVector>(Curve);
+	const UCurveLinearColor* CurveLinearColor = Cast<UCurveLinearColor>(Curve);
+
+	FLinearColor* RowTexels = Texels.GetData() + Row * Resolution;
+	for (int32 Index = 0; Index < Resolution; Index++)
+	{
+		// sampled at the texel centers, to match the index table mapping
+		const float Time = MinTime + Range * (Index + 0.5f) / Resolution;
+		if (CurveFloat)
+		{
+			RowTexels[Index] = FLinearColor(CurveFloat->GetFloatValue(Time), 0, 0, 0);
+		}
+		else if (CurveVector)
+		{
+			const FVector Value = CurveVector->GetVectorValue(Time);
+			RowTexels[Index] = FLinearColor(Value.X, Value.Y, Value.Z, 0);
+		}
+		else if (CurveLinearColor)
+		{
+			RowTexels[Index] = CurveLinearColor->GetLinearColorValue(Time);
+		}
+	}
+
+	IndexTable[Row] = FVector4f(MinTime, Range > UE_SMALL_NUMBER ? 1.0f / Range : 0.0f, (Row + 0.5f) / Curves.Num(), Row);
+}
+
+uint32 UCompushadyCurveAtlas::GetCurveHash(const UCurveBase* Curve)
+{
+	uint32 Hash = 0;
+	if (const UCurveFloat* CurveFloat = Cast<UCurveFloat>(Curve))
+	{
+		Hash = Compushady::CurveAtlas::GetRichCurveHash(CurveFloat->FloatCurve, Hash);
+	}
+	else if (const UCurveVector* CurveVector = Cast<UCurveVector>(Curve))
+	{
+		for (const FRichCurve& RichCurve : CurveVector->FloatCurves)
+		{
+			Hash = Compushady::CurveAtlas::GetRichCurveHash(RichCurve, Hash);
+		}
+	}
+	else if (const UCurveLinearColor* CurveLinearColor = Cast<UCurveLinearColor>(Curve))
+	{
+		for (const FRichCurve& RichCurve : CurveLinearColor->FloatCurves)
+		{
+			Hash = Compushady::CurveAtlas::GetRichCurveHash(RichCurve, Hash);
+		}
+
+		// the color adjustments are applied by GetLinearColorValue
+		for (const float Adjustment : { CurveLinearColor->AdjustHue, CurveLinearColor->AdjustSaturation, CurveLinearColor->AdjustBrightness, CurveLinearColor->AdjustBrightnessCurve, CurveLinearColor->AdjustVibrance, CurveLinearColor->AdjustMinAlpha, CurveLinearColor->AdjustMaxAlpha })
+		{
+			Hash = HashCombine(Hash, GetTypeHash(Adjustment));
+		}
+	}
+	return Hash;
+}
+
+int32 UCompushadyCurveAtlas::GetCurveRow(UCurveBase* Curve) const
+{
+	return Curves.IndexOfByKey(Curve);
+}
+
+UCompushadySRV* UCompushadyCurveAtlas::GetIndexTableSRV() const
+{
+	return IndexTableSRV;
+}
+
+int32 UCompushadyCurveAtlas::GetResolution() const
+{
+	return Resolution;
+}
+
+int32 UCompushadyCurveAtlas::GetNumCurves() const
+{
+	return Curves.Num();
+}
+
+const TArray<FLinearColor>& UCompushadyCurveAtlas::GetTexels() const
+{
+	return Texels;
+}
@@ -442,7 +442,8 @@ bool Compushady::FixupDXIL(TArray<uint8>& ByteCode, FCompushadyShaderResourceBin
 		ShaderReflection->GetInputParameterDesc(Index, &SignatureDesc);
 		if (SignatureDesc.SystemValueType == D3D_NAME_UNDEFINED)
 		{
-			ShaderResourceBindings.InputSemantics.Add(FCompushadyShaderSemantic(UTF8_TO_TCHAR(SignatureDesc.SemanticName), SignatureDesc.SemanticIndex, SignatureDesc.Register, SignatureDesc.Mask));
+			const bool bInteger = SignatureDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32 || SignatureDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32;
+			ShaderResourceBindings.InputSemantics.Add(FCompushadyShaderSemantic(UTF8_TO_TCHAR(SignatureDesc.SemanticName), SignatureDesc.SemanticIndex, SignatureDesc.Register, SignatureDesc.Mask, bInteger));
 		}
 	}
 
@@ -486,9 +487,24 @@ bool Compushady::FixupDXIL(TArray<uint8>& ByteCode, FCompushadyShaderResourceBin
 		switch (BindDesc.Type)
 		{
 		case D3D_SIT_CBUFFER:
+		{
 			ResourceBinding.Type = ECompushadySharedResourceType::UniformBuffer;
+			ID3D12ShaderReflectionConstantBuffer* ConstantBuffer = ShaderReflection->GetConstantBufferByName(BindDesc.Name);
+			D3D12_SHADER_BUFFER_DESC BufferDesc;
+			if (ConstantBuffer && SUCCEEDED(ConstantBuffer->GetDesc(&BufferDesc)))
+			{
+				for (uint32 VariableIndex = 0; VariableIndex < BufferDesc.Variables; VariableIndex++)
+				{
+					D3D12_SHADER_VARIABLE_DESC VariableDesc;
+					if (SUCCEEDED(ConstantBuffer->GetVariableByIndex(VariableIndex)->GetDesc(&VariableDesc)))
+					{
+						ResourceBinding.Constants.Add({ UTF8_TO_TCHAR(VariableDesc.Name), VariableDesc.StartOffset, VariableDesc.Size });
+					}
+				}
+			}
 			CBVMapping.Add(BindDesc.BindPoint, ResourceBinding);
 			break;
+		}
 		case D3D_SIT_TEXTURE:
 			ResourceBinding.Type = BindDesc.Dimension == D3D_SRV_DIMENSION::D3D_SRV_DIMENSION_BUFFER ? ECompushadySharedResourceType::Buffer : ECompushadySharedResourceType::Texture;
 			SRVMapping.Add(BindDesc.BindPoint, ResourceBinding);
@@ -0,0 +1,386 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#include "CompushadyDataTable.h"
+#include "Compushady.h"
+#include "Async/ParallelFor.h"
+#include "UObject/EnumProperty.h"
+
+namespace Compushady
+{
+	namespace DataTable
+	{
+		struct FScalar
+		{
+			FString HLSLType;
+			int32 Size = 0;
+			ECopyKind Kind = ECopyKind::Copy;
+			const FProperty* Property = nullptr;
+		};
+
+		bool GetScalar(const FProperty* Property, const bool bDemoteDoubles, FScalar& Scalar)
+		{
+			Scalar.Property = Property;
+			Scalar.Size = 4;
+
+			if (Property->IsA<FFloatProperty>())
+			{
+				Scalar.HLSLType = "float";
+			}
+			else if (Property->IsA<FDoubleProperty>())
+			{
+				Scalar.HLSLType = bDemoteDoubles ? "float" : "double";
+				Scalar.Size = bDemoteDoubles ? 4 : 8;
+				Scalar.Kind = bDemoteDoubles ? ECopyKind::DoubleToFloat : ECopyKind::Copy;
+			}
+			else if (Property->IsA<FIntProperty>())
+			{
+				Scalar.HLSLType = "int";
+			}
+			else if (Property->IsA<FUInt32Property>())
+			{
+				Scalar.HLSLType = "uint";
+			}
+			else if (Property->IsA<FInt64Property>())
+			{
+				Scalar.HLSLType = "int64_t";
+				Scalar.Size = 8;
+			}
+			else if (Property->IsA<FUInt64Property>())
+			{
+				Scalar.HLSLType = "uint64_t";
+				Scalar.Size = 8;
+			}
+			else if (Property->IsA<FInt8Property>() || Property->IsA<FInt16Property>())
+			{
+				Scalar.HLSLType = "int";
+				Scalar.Kind = ECopyKind::SignedInt;
+			}
+			// FByteProperty includes the old style (TEnumAsByte) enums
+			else if (Property->IsA<FByteProperty>() || Property->IsA<FUInt16Property>())
+			{
+				Scalar.HLSLType = "uint";
+				Scalar.Kind = ECopyKind::UnsignedInt;
+			}
+			else if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+			{
+				Scalar.HLSLType = "uint";
+				Scalar.Kind = ECopyKind::UnsignedInt;
+				Scalar.Property = EnumProperty->GetUnderlyingProperty();
+			}
+			else if (Property->IsA<FBoolProperty>())
+			{
+				Scalar.HLSLType = "uint";
+				Scalar.Kind = ECopyKind::Bool;
+			}
+			else
+			{
+				return false;
+			}
+
+			return true;
+		}
+
+		FString GetHLSLName(const FString& Name)
+		{
+			FString HLSLName;
+			for (const TCHAR Char : Name)
+			{
+				HLSLName.AppendChar(FChar::IsAlnum(Char) ? Char : '_');
+			}
+
+			if (HLSLName.IsEmpty() || FChar::IsDigit(HLSLName[0]))
+			{
+				HLSLName.InsertAt(0, '_');
+			}
+
+			return HLSLName;
+		}
+
+		void AddColumn(FLayoutPlan& Plan, const FString& Name, const FString& HLSLType, const int32 ScalarSize, const TArray<FCopy>& Copies)
+		{
+			FColumn Column;
+			Column.Name = Name;
+			Column.HLSLType = HLSLType;
+			Column.Size = ScalarSize * Copies.Num();
+			Column.RowOffset = Align(Plan.RowSize, ScalarSize);
+
+			// merge contiguous copies (vectors generally become a single memcpy)
+			for (const FCopy& Copy : Copies)
+			{
+				if (Column.Copies.Num() > 0 && (Copy.Kind == ECopyKind::Copy || Copy.Kind == ECopyKind::DoubleToFloat))
+				{
+					FCopy& Last = Column.Copies.Last();
+					const int32 LastDestinationSize = Last.Kind == ECopyKind::DoubleToFloat ? Last.Size / 2 : Last.Size;
+					if (Last.Kind == Copy.Kind && Last.SourceOffset + Last.Size == Copy.SourceOffset && Last.DestinationOffset + LastDestinationSize == Copy.DestinationOffset)
+					{
+						Last.Size += Copy.Size;
+						continue;
+					}
+				}
+				Column.Copies.Add(Copy);
+			}
+
+			Plan.RowSize = Column.RowOffset + Column.Size;
+			Plan.Alignment = FMath::Max(Plan.Alignment, ScalarSize);
+			Plan.Columns.Add(MoveTemp(Column));
+		}
+
+		void AddProperty(FLayoutPlan& Plan, const FProperty* Property, const FString& Name, const int32 BaseOffset, const bool bDemoteDoubles)
+		{
+			if (Property->ArrayDim > 1)
+			{
+				UE_LOG(LogCompushady, Warning, TEXT("Skipping static array \"%s\" of %s"), *Name, *Plan.StructName);
+				return;
+			}
+
+			const int32 SourceOffset = BaseOffset + Property->GetOffset_ForInternal();
+
+			FScalar Scalar;
+			if (GetScalar(Property, bDemoteDoubles, Scalar))
+			{
+				FCopy Copy;
+				Copy.Kind = Scalar.Kind;
+				Copy.SourceOffset = SourceOffset;
+				Copy.Size = Scalar.Kind == ECopyKind::Copy || Scalar.Kind == ECopyKind::DoubleToFloat ? Property->GetSize() : Scalar.Size;
+				Copy.Property = Scalar.Property;
+				AddColumn(Plan, Name, Scalar.HLSLType, Scalar.Size, { Copy });
+				return;
+			}
+
+			const FStructProperty* StructProperty = CastField<FStructProperty>(Property);
+			if (!StructProperty)
+			{
+				UE_LOG(LogCompushady, Warning, TEXT("Skipping unsupported property \"%s\" of %s"), *Name, *Plan.StructName);
+				return;
+			}
+
+			// structs made of 2 to 4 scalars of the same type (FVector, FLinearColor, FIntPoint...) become hlsl vectors
+			TArray<FCopy> VectorCopies;
+			FString VectorType;
+			int32 VectorScalarSize = 0;
+			for (TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+			{
+				FScalar MemberScalar;
+				if (It->ArrayDim > 1 || !GetScalar(*It, bDemoteDoubles, MemberScalar) || (!VectorType.IsEmpty() && MemberScalar.HLSLType != VectorType))
+				{
+					VectorCopies.Empty();
+					break;
+				}
+
+				VectorType = MemberScalar.HLSLType;
+				VectorScalarSize = MemberScalar.Size;
+
+				FCopy Copy;
+				Copy.Kind = MemberScalar.Kind;
+				Copy.SourceOffset = SourceOffset + It->GetOffset_ForInternal();
+				Copy.DestinationOffset = VectorCopies.Num() * MemberScalar.Size;
+				Copy.Size = MemberScalar.Kind == ECopyKind::Copy || MemberScalar.Kind == ECopyKind::DoubleToFloat ? It->GetSize() : MemberScalar.Size;
+				Copy.Property = MemberScalar.Property;
+				VectorCopies.Add(Copy);
+			}
+
+			if (VectorCopies.Num() >= 2 && VectorCopies.Num() <= 4)
+			{
+				AddColumn(Plan, Name, FString::Printf(TEXT("%s%d"), *VectorType, VectorCopies.Num()), VectorScalarSize, VectorCopies);
+				return;
+			}
+
+			// any other struct is flattened
+			for (TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+			{
+				AddProperty(Plan, *It, Name + "_" + GetHLSLName(It->GetAuthoredName()), SourceOffset, bDemoteDoubles);
+			}
+		}
+
+		void PackColumn(const FColumn& Column, const uint8* Row, uint8* Destination)
+		{
+			for (const FCopy& Copy : Column.Copies)
+			{
+				const uint8* Source = Row + Copy.SourceOffset;
+				uint8* CopyDestination = Destination + Copy.DestinationOffset;
+				switch (Copy.Kind)
+				{
+				case ECopyKind::Copy:
+					FMemory::Memcpy(CopyDestination, Source, Copy.Size);
+					break;
+				case ECopyKind::DoubleToFloat:
+					for (int32 Index = 0; Index < Copy.Size / static_cast<int32>(sizeof(double)); Index++)
+					{
+						const float Value = static_cast<float>(reinterpret_cast<const double*>(Source)[Index]);
+						FMemory::Memcpy(CopyDestination + Index * sizeof(float), &Value, sizeof(float));
+					}
+					break;
+				case ECopyKind::SignedInt:
+				{
+					const int32 Value = static_cast<int32>(CastFieldChecked<FNumericProperty>(Copy.Property)->GetSignedIntPropertyValue(Source));
+					FMemory::Memcpy(CopyDestination, &Value, sizeof(int32));
+					break;
+				}
+				case ECopyKind::UnsignedInt:
+				{
+					const uint32 Value = static_cast<uint32>(CastFieldChecked<FNumericProperty>(Copy.Property)->GetUnsignedIntPropertyValue(Source));
+					FMemory::Memcpy(CopyDestination, &Value, sizeof(uint32));
+					break;
+				}
+				case ECopyKind::Bool:
+				{
+					const uint32 Value = CastFieldChecked<FBoolProperty>(Copy.Property)->GetPropertyValue(Source) ? 1 : 0;
+					FMemory::Memcpy(CopyDestination, &Value, sizeof(uint32));
+					break;
+				}
+				}
+			}
+		}
+	}
+}
+
+bool Compushady::DataTable::BuildLayoutPlan(const UScriptStruct* RowStruct, const bool bDemoteDoubles, FLayoutPlan& Plan)
+{
+	check(IsInGameThread());
+
+	if (!RowStruct)
+	{
+		return false;
+	}
+
+	Plan = FLayoutPlan();
+	Plan.StructName = GetHLSLName(RowStruct->GetName());
+
+	for (TFieldIterator<FProperty> It(RowStruct); It; ++It)
+	{
+		AddProperty(Plan, *It, GetHLSLName(It->GetAuthoredName()), 0, bDemoteDoubles);
+	}
+
+	Plan.RowSize = Align(Plan.RowSize, Plan.Alignment);
+
+	return true;
+}
+
+bool Compushady::DataTable::Pack(const UScriptStruct* RowStruct, TArrayView<const uint8* const> Rows, const ECompushadyDataTableLayout Layout, const bool bDemoteDoubles, TArray<uint8>& Data, int32& Stride, FString& HLSL, FString& ErrorMessages)
+{
+	FLayoutPlan Plan;
+	if (!BuildLayoutPlan(RowStruct, bDemoteDoubles, Plan))
+	{
+		ErrorMessages = "Invalid Row Struct";
+		return false;
+	}
+
+	if (Plan.Columns.Num() == 0)
+	{
+		ErrorMessages = FString::Printf(TEXT("%s has no supported properties"), *RowStruct->GetName());
+		return false;
+	}
+
+	if (Rows.Num() == 0)
+	{
+		ErrorMessages = "No rows to pack";
+		return false;
+	}
+
+	const bool bColumnar = Layout == ECompushadyDataTableLayout::Columnar;
+
+	// columns are aligned to the plan alignment, so 64 bit members are always naturally aligned
+	TArray<int64> ColumnOffsets;
+	int64 ColumnarSize = 0;
+	for (const FColumn& Column : Plan.Columns)
+	{
+		ColumnarSize = Align(ColumnarSize, Plan.Alignment);
+		ColumnOffsets.Add(ColumnarSize);
+		ColumnarSize += static_cast<int64>(Column.Size) * Rows.Num();
+	}
+
+	// the columnar size includes the padding between the columns (up to Plan.Alignment - 1 bytes each)
+	const int64 DataSize = bColumnar ? Align(ColumnarSize, 4) : static_cast<int64>(Plan.RowSize) * Rows.Num();
+	if (DataSize > MAX_int32)
+	{
+		ErrorMessages = "Too many rows";
+		return false;
+	}
+
+	// zeroed for the padding
+	Data.Empty();
+	Data.AddZeroed(static_cast<int32>(DataSize));
+
+	constexpr int32 RowsPerTask = 1024;
+	ParallelFor(FMath::DivideAndRoundUp(Rows.Num(), RowsPerTask), [&](const int32 Task)
+		{
+			const int32 FirstRow = Task * RowsPerTask;
+			const int32 LastRow = FMath::Min(FirstRow + RowsPerTask, Rows.Num());
+			for (int32 RowIndex = FirstRow; RowIndex < LastRow; RowIndex++)
+			{
+				for (int32 ColumnIndex = 0; ColumnIndex < Plan.Columns.Num(); ColumnIndex++)
+				{
+					const FColumn& Column = Plan.Columns[ColumnIndex];
+					const int64 Offset = bColumnar ? ColumnOffsets[ColumnIndex] + static_cast<int64>(RowIndex) * Column.Size : static_cast<int64>(RowIndex) * Plan.RowSize + Column.RowOffset;
+					PackColumn(Column, Rows[RowIndex], Data.GetData() + Offset);
+				}
+			}
+		}, Rows.Num() <= RowsPerTask ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	Stride = bColumnar ? sizeof(uint32) : Plan.RowSize;
+	HLSL = GenerateHLSL(Plan, Layout, Rows.Num());
+
+	return true;
+}
+
+bool Compushady::DataTable::PackDataTable(const UDataTable* DataTable, const ECompushadyDataTableLayout Layout, const bool bDemoteDoubles, TArray<uint8>& Data, int32& Stride, FString& HLSL, FString& ErrorMessages)
+{
+	if (!DataTable || !DataTable->GetRowStruct())
+	{
+		ErrorMessages = "Invalid DataTable";
+		return false;
+	}
+
+	// rows are packed in the DataTable order
+	const TMap<FName, uint8*>& RowMap = DataTable->GetRowMap();
+	TArray<const uint8*> Rows;
+	Rows.Reserve(RowMap.Num());
+	for (const TPair<FName, uint8*>& Pair : RowMap)
+	{
+		Rows.Add(Pair.Value);
+	}
+
+	return Pack(DataTable->GetRowStruct(), Rows, Layout, bDemoteDoubles, Data, Stride, HLSL, ErrorMessages);
+}
+
+FString Compushady::DataTable::GenerateHLSL(const FLayoutPlan& Plan, const ECompushadyDataTableLayout Layout, const int32 NumRows)
+{
+	FString HLSL;
+
+	if (Layout == ECompushadyDataTableLayout::Columnar)
+	{
+		// offsets are in uints, as the columnar buffer is exposed as a StructuredBuffer<uint>
+		HLSL += FString::Printf(TEXT("static const uint %s_Rows = %d;\n"), *Plan.StructName, NumRows);
+		int64 ColumnarSize = 0;
+		for (const FColumn& Column : Plan.Columns)
+		{
+			ColumnarSize = Align(ColumnarSize, Plan.Alignment);
+			HLSL += FString::Printf(TEXT("static const uint %s_%s = %lld; // %s, %d uints per row\n"), *Plan.StructName, *Column.Name, ColumnarSize / 4, *Column.HLSLType, Column.Size / 4);
+			ColumnarSize += static_cast<int64>(Column.Size) * NumRows;
+		}
+		return HLSL;
+	}
+
+	HLSL += FString::Printf(TEXT("struct %s\n{\n"), *Plan.StructName);
+	int32 Offset = 0;
+	int32 Padding = 0;
+	// explicit padding, so that the layout does not depend on the compiler packing rules
+	auto AddPadding = [&](const int32 NextOffset)
+		{
+			for (; Offset < NextOffset; Offset += 4)
+			{
+				HLSL += FString::Printf(TEXT("\tuint _padding%d;\n"), Padding++);
+			}
+		};
+
+	for (const FColumn& Column : Plan.Columns)
+	{
+		AddPadding(Column.RowOffset);
+		HLSL += FString::Printf(TEXT("\t%s %s;\n"), *Column.HLSLType, *Column.Name);
+		Offset = Column.RowOffset + Column.Size;
+	}
+	AddPadding(Plan.RowSize);
+
+	HLSL += "};\n";
+	return HLSL;
+}
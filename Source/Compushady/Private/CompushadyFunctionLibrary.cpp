@@ -2,7 +2,359 @@
 
 
 #include "CompushadyFunctionLibrary.h"
+#include "CompushadyConversion.h"
+#include "CompushadyDataTable.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
 #include "Serialization/ArrayWriter.h"
+#include "StaticMeshResources.h"
+
+namespace Compushady
+{
+	namespace ImageLoader
+	{
+		struct FDecodedImage
+		{
+			FIntPoint Size = FIntPoint::ZeroValue;
+			EPixelFormat PixelFormat = EPixelFormat::PF_Unknown;
+			TArray64<uint8> Pixels;
+			FString ErrorMessages;
+		};
+
+		// keep 16 bit and float images in their native format, everything else is converted to BGRA8
+		bool Decode(IImageWrapperModule& ImageWrapperModule, const FString& Filename, FDecodedImage& DecodedImage)
+		{
+			TArray64<uint8> ImageData;
+			if (!FFileHelper::LoadFileToArray(ImageData, *Filename))
+			{
+				DecodedImage.ErrorMessages = FString::Printf(TEXT("Unable to load \"%s\""), *Filename);
+				return false;
+			}
+
+			const EImageFormat ImageFormat = ImageWrapperModule.DetectImageFormat(ImageData.GetData(), ImageData.Num());
+			TSharedPtr<IImageWrapper> ImageWrapper = ImageFormat != EImageFormat::Invalid ? ImageWrapperModule.CreateImageWrapper(ImageFormat) : nullptr;
+			if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(ImageData.GetData(), ImageData.Num()))
+			{
+				DecodedImage.ErrorMessages = FString::Printf(TEXT("Unsupported image format for \"%s\""), *Filename);
+				return false;
+			}
+
+			// release the compressed data as soon as possible
+			ImageData.Empty();
+
+			const ERGBFormat SourceFormat = ImageWrapper->GetFormat();
+			const int32 SourceBitDepth = ImageWrapper->GetBitDepth();
+
+			ERGBFormat RGBFormat = ERGBFormat::BGRA;
+			int32 BitDepth = 8;
+			DecodedImage.PixelFormat = EPixelFormat::PF_B8G8R8A8;
+
+			if (SourceFormat == ERGBFormat::RGBAF || SourceFormat == ERGBFormat::BGRE)
+			{
+				RGBFormat = ERGBFormat::RGBAF;
+				BitDepth = SourceFormat == ERGBFormat::RGBAF ? SourceBitDepth : 32;
+				DecodedImage.PixelFormat = BitDepth == 16 ? EPixelFormat::PF_FloatRGBA : EPixelFormat::PF_A32B32G32R32F;
+			}
+			else if (SourceFormat == ERGBFormat::GrayF)
+			{
+				RGBFormat = ERGBFormat::GrayF;
+				BitDepth = SourceBitDepth;
+				DecodedImage.PixelFormat = BitDepth == 16 ? EPixelFormat::PF_R16F : EPixelFormat::PF_R32_FLOAT;
+			}
+			else if (SourceFormat == ERGBFormat::Gray)
+			{
+				RGBFormat = ERGBFormat::Gray;
+				BitDepth = SourceBitDepth == 16 ? 16 : 8;
+				DecodedImage.PixelFormat = BitDepth == 16 ? EPixelFormat::PF_G16 : EPixelFormat::PF_G8;
+			}
+			else if (SourceBitDepth == 16)
+			{
+				RGBFormat = ERGBFormat::RGBA;
+				BitDepth = 16;
+				DecodedImage.PixelFormat = EPixelFormat::PF_R16G16B16A16_UNORM;
+			}
+
+			TArray64<uint8> UncompressedBytes;
+			if (!ImageWrapper->GetRaw(RGBFormat, BitDepth, UncompressedBytes))
+			{
+				// fallback to the most common format
+				DecodedImage.PixelFormat = EPixelFormat::PF_B8G8R8A8;
+				if (!ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, UncompressedBytes))
+				{
+					DecodedImage.ErrorMessages = FString::Printf(TEXT("Unable to decode \"%s\""), *Filename);
+					return false;
+				}
+			}
+
+			DecodedImage.Size = FIntPoint(ImageWrapper->GetWidth(), ImageWrapper->GetHeight());
+			DecodedImage.Pixels = MoveTemp(UncompressedBytes);
+
+			return true;
+		}
+
+		bool DecodeAll(const TArray<FString>& Filenames, TArray<FDecodedImage>& DecodedImages, FString& ErrorMessages)
+		{
+			IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+
+			DecodedImages.SetNum(Filenames.Num());
+
+			// one file per task: loading and decoding are both done in the workers
+			ParallelFor(Filenames.Num(), [&](const int32 Index)
+				{
+					Decode(ImageWrapperModule, Filenames[Index], DecodedImages[Index]);
+				});
+
+			for (const FDecodedImage& DecodedImage : DecodedImages)
+			{
+				if (!DecodedImage.ErrorMessages.IsEmpty())
+				{
+					ErrorMessages = DecodedImage.ErrorMessages;
+					return false;
+				}
+			}
+
+			return true;
+		}
+	}
+}
+
+namespace Compushady
+{
+	namespace Upload
+	{
+		// Data is copied straight into the locked buffer, rendering commands are flushed so the caller memory is valid for the whole upload
+		FBufferRHIRef CreateBuffer(const FString& Name, TArrayView<const uint8> Data, const EBufferUsageFlags Usage, const uint32 Stride, const ERHIAccess InitialState)
+		{
+			if (Data.Num() == 0)
+			{
+				return nullptr;
+			}
+
+			FBufferRHIRef BufferRHIRef;
+
+			ENQUEUE_RENDER_COMMAND(DoCompushadyCreateBuffer)(
+				[&BufferRHIRef, &Name, Data, Usage, Stride, InitialState](FRHICommandListImmediate& RHICmdList)
+				{
+					FRHIResourceCreateInfo ResourceCreateInfo(*Name);
+					BufferRHIRef = COMPUSHADY_CREATE_BUFFER(Data.Num(), Usage, Stride, InitialState, ResourceCreateInfo);
+					if (BufferRHIRef.IsValid() && BufferRHIRef->IsValid())
+					{
+						void* LockedData = RHICmdList.LockBuffer(BufferRHIRef, 0, BufferRHIRef->GetSize(), EResourceLockMode::RLM_WriteOnly);
+						FMemory::Memcpy(LockedData, Data.GetData(), BufferRHIRef->GetSize());
+						RHICmdList.UnlockBuffer(BufferRHIRef);
+					}
+				});
+
+			FlushRenderingCommands();
+
+			if (!BufferRHIRef.IsValid() || !BufferRHIRef->IsValid())
+			{
+				return nullptr;
+			}
+
+			return BufferRHIRef;
+		}
+
+		UCompushadySRV* CreateSRVBuffer(const FString& Name, TArrayView<const uint8> Data, const EPixelFormat PixelFormat)
+		{
+			if (PixelFormat == EPixelFormat::PF_Unknown)
+			{
+				return nullptr;
+			}
+
+			FBufferRHIRef BufferRHIRef = CreateBuffer(Name, Data, EBufferUsageFlags::ShaderResource | EBufferUsageFlags::VertexBuffer, GPixelFormats[PixelFormat].BlockBytes, ERHIAccess::SRVMask);
+			if (!BufferRHIRef)
+			{
+				return nullptr;
+			}
+
+			UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
+			if (!CompushadySRV->InitializeFromBuffer(BufferRHIRef, PixelFormat))
+			{
+				return nullptr;
+			}
+
+			return CompushadySRV;
+		}
+
+		UCompushadySRV* CreateSRVFloatBuffer(const FString& Name, TArrayView<const float> Data, const EPixelFormat PixelFormat)
+		{
+			// half, unorm and packed formats are converted from float
+			const bool bNeedsConversion = Compushady::Conversion::SupportsPixelFormat(PixelFormat) && GPixelFormats[PixelFormat].BlockBytes != GPixelFormats[PixelFormat].NumComponents * sizeof(float);
+			if (bNeedsConversion)
+			{
+				TArray64<uint8> Bytes;
+				Compushady::Conversion::FloatToPixelFormat(PixelFormat, Data.GetData(), Data.Num(), Bytes);
+				return CreateSRVBuffer(Name, TArrayView<const uint8>(Bytes.GetData(), Bytes.Num()), PixelFormat);
+			}
+
+			return CreateSRVBuffer(Name, TArrayView<const uint8>(reinterpret_cast<const uint8*>(Data.GetData()), Data.Num() * sizeof(float)), PixelFormat);
+		}
+
+		UCompushadySRV* CreateSRVStructuredBuffer(const FString& Name, TArrayView<const uint8> Data, const int32 Stride)
+		{
+			FBufferRHIRef BufferRHIRef = CreateBuffer(Name, Data, EBufferUsageFlags::ShaderResource | EBufferUsageFlags::StructuredBuffer, Stride, ERHIAccess::UAVCompute);
+			if (!BufferRHIRef)
+			{
+				return nullptr;
+			}
+
+			UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
+			if (!CompushadySRV->InitializeFromStructuredBuffer(BufferRHIRef))
+			{
+				return nullptr;
+			}
+
+			return CompushadySRV;
+		}
+
+		template<typename T>
+		TArrayView<const uint8> AsBytes(TArrayView<const T> Data)
+		{
+			return TArrayView<const uint8>(reinterpret_cast<const uint8*>(Data.GetData()), Data.Num() * sizeof(T));
+		}
+
+		// owned data is kept alive by the render thread, so the SRV can be returned immediately in pending state
+		template<typename T>
+		UCompushadySRV* CreatePendingSRVBuffer(const FString& Name, TSharedRef<const T, ESPMode::ThreadSafe> Data, const EPixelFormat PixelFormat)
+		{
+			const int64 Size = Data->Num() * sizeof(typename T::ElementType);
+			if (Size == 0 || Size > MAX_uint32 || PixelFormat == EPixelFormat::PF_Unknown)
+			{
+				return nullptr;
+			}
+
+			UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
+			CompushadySRV->InitializeFromPendingBuffer(Name, Size, PixelFormat, [Data, Size](void* LockedData)
+				{
+					FMemory::Memcpy(LockedData, Data->GetData(), Size);
+				});
+
+			return CompushadySRV;
+		}
+
+		UCompushadySRV* CreatePendingSRVFloatBuffer(const FString& Name, TSharedRef<const TArray<float>, ESPMode::ThreadSafe> Data, const EPixelFormat PixelFormat)
+		{
+			const bool bNeedsConversion = Compushady::Conversion::SupportsPixelFormat(PixelFormat) && GPixelFormats[PixelFormat].BlockBytes != GPixelFormats[PixelFormat].NumComponents * sizeof(float);
+			if (bNeedsConversion)
+			{
+				TSharedRef<TArray64<uint8>, ESPMode::ThreadSafe> Bytes = MakeShared<TArray64<uint8>, ESPMode::ThreadSafe>();
+				Compushady::Conversion::FloatToPixelFormat(PixelFormat, Data->GetData(), Data->Num(), *Bytes);
+				return CreatePendingSRVBuffer<TArray64<uint8>>(Name, Bytes, PixelFormat);
+			}
+
+			return CreatePendingSRVBuffer<TArray<float>>(Name, Data, PixelFormat);
+		}
+
+		template<typename T>
+		UCompushadySRV* CreatePendingSRVStructuredBuffer(const FString& Name, TSharedRef<const TArray<T>, ESPMode::ThreadSafe> Data, const int32 Stride)
+		{
+			const int64 Size = Data->Num() * sizeof(T);
+			if (Size == 0 || Size > MAX_uint32 || Stride <= 0)
+			{
+				return nullptr;
+			}
+
+			UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
+			CompushadySRV->InitializeFromPendingStructuredBuffer(Name, Size, Stride, [Data, Size](void* LockedData)
+				{
+					FMemory::Memcpy(LockedData, Data->GetData(), Size);
+				});
+
+			return CompushadySRV;
+		}
+	}
+}
+
+namespace Compushady
+{
+	namespace MappedFile
+	{
+		// the file is mapped (and uploaded) in chunks of this size, so that only a small window of it is resident at any time
+		constexpr int64 ChunkSize = 16 * 1024 * 1024;
+
+		FBufferRHIRef CreateBuffer(const FString& Name, const FString& Filename, const int64 Offset, const int64 Size, const EBufferUsageFlags Usage, const uint32 Stride, const ERHIAccess InitialState)
+		{
+			IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+			const int64 FileSize = PlatformFile.FileSize(*Filename);
+			if (FileSize < 0)
+			{
+				UE_LOG(LogCompushady, Error, TEXT("Unable to open \"%s\""), *Filename);
+				return nullptr;
+			}
+
+			const int64 BufferSize = Size > 0 ? Size : FileSize - Offset;
+			if (Offset < 0 || BufferSize <= 0 || Offset + BufferSize > FileSize || BufferSize > MAX_uint32)
+			{
+				UE_LOG(LogCompushady, Error, TEXT("Invalid range %lld-%lld for \"%s\" (%lld bytes)"), Offset, Offset + BufferSize, *Filename, FileSize);
+				return nullptr;
+			}
+
+			// not all of the platforms support mapped files, fallback to chunked reads
+			TUniquePtr<IMappedFileHandle> MappedFileHandle(PlatformFile.OpenMapped(*Filename));
+			TUniquePtr<IFileHandle> FileHandle;
+			if (!MappedFileHandle)
+			{
+				FileHandle.Reset(PlatformFile.OpenRead(*Filename));
+				if (!FileHandle)
+				{
+					UE_LOG(LogCompushady, Error, TEXT("Unable to open \"%s\""), *Filename);
+					return nullptr;
+				}
+			}
+
+			FBufferRHIRef BufferRHIRef;
+			bool bSuccess = true;
+
+			ENQUEUE_RENDER_COMMAND(DoCompushadyCreateBufferFromFile)(
+				[&BufferRHIRef, &bSuccess, &MappedFileHandle, &FileHandle, Name, Offset, BufferSize, Usage, Stride, InitialState](FRHICommandListImmediate& RHICmdList)
+				{
+					FRHIResourceCreateInfo ResourceCreateInfo(*Name);
+					BufferRHIRef = COMPUSHADY_CREATE_BUFFER(BufferSize, Usage, Stride, InitialState, ResourceCreateInfo);
+					if (!BufferRHIRef.IsValid() || !BufferRHIRef->IsValid())
+					{
+						return;
+					}
+
+					for (int64 ChunkOffset = 0; ChunkOffset < BufferSize && bSuccess; ChunkOffset += ChunkSize)
+					{
+						const int64 CurrentChunkSize = FMath::Min(ChunkSize, BufferSize - ChunkOffset);
+						void* LockedData = RHICmdList.LockBuffer(BufferRHIRef, ChunkOffset, CurrentChunkSize, EResourceLockMode::RLM_WriteOnly);
+						if (MappedFileHandle)
+						{
+							TUniquePtr<IMappedFileRegion> MappedFileRegion(MappedFileHandle->MapRegion(Offset + ChunkOffset, CurrentChunkSize));
+							if (MappedFileRegion)
+							{
+								FMemory::Memcpy(LockedData, MappedFileRegion->GetMappedPtr(), CurrentChunkSize);
+							}
+							else
+							{
+								bSuccess = false;
+							}
+						}
+						else
+						{
+							bSuccess = FileHandle->Seek(Offset + ChunkOffset) && FileHandle->Read(reinterpret_cast<uint8*>(LockedData), CurrentChunkSize);
+						}
+						RHICmdList.UnlockBuffer(BufferRHIRef);
+					}
+				});
+
+			FlushRenderingCommands();
+
+			if (!bSuccess)
+			{
+				UE_LOG(LogCompushady, Error, TEXT("Unable to read \"%s\""), *Filename);
+				return nullptr;
+			}
+
+			return BufferRHIRef;
+		}
+	}
+}
 
 UCompushadyCBV* UCompushadyFunctionLibrary::CreateCompushadyCBV(const FString& Name, const int64 Size)
 {
@@ -37,6 +389,39 @@ UCompushadyCBV* UCompushadyFunctionLibrary::CreateCompushadyCBVFromFloatArray(co
 	return CompushadyCBV;
 }
 
+UCompushadyCBV* UCompushadyFunctionLibrary::CreateCompushadyCBVFromResourceBinding(const FString& Name, const FCompushadyResourceBinding& ResourceBinding)
+{
+	int64 Size = 0;
+	for (const FCompushadyResourceConstant& Constant : ResourceBinding.Constants)
+	{
+		Size = FMath::Max<int64>(Size, Constant.Offset + Constant.Size);
+	}
+
+	UCompushadyCBV* CompushadyCBV = NewObject<UCompushadyCBV>();
+	if (!CompushadyCBV->Initialize(Name, nullptr, Size))
+	{
+		return nullptr;
+	}
+
+	if (!CompushadyCBV->SetLayout(ResourceBinding))
+	{
+		return nullptr;
+	}
+
+	return CompushadyCBV;
+}
+
+UCompushadyCBVPool* UCompushadyFunctionLibrary::CreateCompushadyCBVPool(const FString& Name, const int32 SlotSize, const int32 NumSlots)
+{
+	UCompushadyCBVPool* CompushadyCBVPool = NewObject<UCompushadyCBVPool>();
+	if (!CompushadyCBVPool->InitializePool(Name, SlotSize, NumSlots))
+	{
+		return nullptr;
+	}
+
+	return CompushadyCBVPool;
+}
+
 UCompushadyCompute* UCompushadyFunctionLibrary::CreateCompushadyComputeFromHLSLFile(const FString& Filename, FString& ErrorMessages, const FString& EntryPoint)
 {
 	UCompushadyCompute* CompushadyCompute = NewObject<UCompushadyCompute>();
@@ -100,6 +485,18 @@ UCompushadyVideoEncoder* UCompushadyFunctionLibrary::CreateCompushadyVideoEncode
 	return CompushadyVideoEncoder;
 }
 
+UCompushadyImageSequenceExporter* UCompushadyFunctionLibrary::CreateCompushadyImageSequenceExporter(const FString& FilenamePrefix, const ECompushadyImageSequenceFormat Format, const ECompushadyImageSequencePolicy Policy, const int32 NumWorkers, const int32 MaxQueuedFrames)
+{
+	UCompushadyImageSequenceExporter* CompushadyImageSequenceExporter = NewObject<UCompushadyImageSequenceExporter>();
+
+	if (!CompushadyImageSequenceExporter->Initialize(FilenamePrefix, Format, Policy, NumWorkers, MaxQueuedFrames))
+	{
+		return nullptr;
+	}
+
+	return CompushadyImageSequenceExporter;
+}
+
 UCompushadyCompute* UCompushadyFunctionLibrary::CreateCompushadyComputeFromDXILFile(const FString& Filename, FString& ErrorMessages)
 {
 	UCompushadyCompute* CompushadyCompute = NewObject<UCompushadyCompute>();
@@ -205,6 +602,27 @@ UCompushadyRasterizer* UCompushadyFunctionLibrary::CreateCompushadyMSPSRasterize
 	return CompushadyRasterizer;
 }
 
+UCompushadyRasterizer* UCompushadyFunctionLibrary::CreateCompushadyASMSPSRasterizerFromHLSLString(const FString& AmplificationShaderSource, const FString& MeshShaderSource, const FString& PixelShaderSource, const FCompushadyRasterizerConfig& RasterizerConfig, FString& ErrorMessages, const FString& AmplificationShaderEntryPoint, const FString& MeshShaderEntryPoint, const FString& PixelShaderEntryPoint)
+{
+	UCompushadyRasterizer* CompushadyRasterizer = NewObject<UCompushadyRasterizer>();
+
+	TArray<uint8> AmplificationShaderCode;
+	Compushady::StringToShaderCode(AmplificationShaderSource, AmplificationShaderCode);
+
+	TArray<uint8> MeshShaderCode;
+	Compushady::StringToShaderCode(MeshShaderSource, MeshShaderCode);
+
+	TArray<uint8> PixelShaderCode;
+	Compushady::StringToShaderCode(PixelShaderSource, PixelShaderCode);
+
+	if (!CompushadyRasterizer->InitASMSPSFromHLSL(AmplificationShaderCode, AmplificationShaderEntryPoint, MeshShaderCode, MeshShaderEntryPoint, PixelShaderCode, PixelShaderEntryPoint, RasterizerConfig, ErrorMessages))
+	{
+		return nullptr;
+	}
+
+	return CompushadyRasterizer;
+}
+
 UCompushadyCompute* UCompushadyFunctionLibrary::CreateCompushadyComputeFromHLSLShaderAsset(UCompushadyShader* ShaderAsset, FString& ErrorMessages, const FString& EntryPoint)
 {
 	UCompushadyCompute* CompushadyCompute = NewObject<UCompushadyCompute>();
@@ -222,62 +640,98 @@ UCompushadyCompute* UCompushadyFunctionLibrary::CreateCompushadyComputeFromHLSLS
 
 UCompushadyUAV* UCompushadyFunctionLibrary::CreateCompushadyUAVBuffer(const FString& Name, const int64 Size, const EPixelFormat PixelFormat)
 {
-	FBufferRHIRef BufferRHIRef;
+	if (Size <= 0 || Size > MAX_uint32 || PixelFormat == EPixelFormat::PF_Unknown)
+	{
+		return nullptr;
+	}
 
-	ENQUEUE_RENDER_COMMAND(DoCompushadyCreateBuffer)(
-		[&BufferRHIRef, Name, Size, PixelFormat](FRHICommandListImmediate& RHICmdList)
-		{
-			FRHIResourceCreateInfo ResourceCreateInfo(*Name);
-			BufferRHIRef = COMPUSHADY_CREATE_BUFFER(Size, EBufferUsageFlags::ShaderResource | EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::VertexBuffer, GPixelFormats[PixelFormat].BlockBytes, ERHIAccess::UAVCompute, ResourceCreateInfo);
-		});
+	UCompushadyUAV* CompushadyUAV = NewObject<UCompushadyUAV>();
+	CompushadyUAV->InitializeFromPendingBuffer(Name, Size, PixelFormat);
 
-	FlushRenderingCommands();
+	return CompushadyUAV;
+}
 
-	if (!BufferRHIRef.IsValid() || !BufferRHIRef->IsValid())
+UCompushadyUAV* UCompushadyFunctionLibrary::CreateCompushadyUAVIndirectArgumentsBuffer(const FString& Name, const int64 Size)
+{
+	if (Size <= 0 || Size > MAX_uint32 || Size % sizeof(uint32) != 0)
 	{
 		return nullptr;
 	}
 
 	UCompushadyUAV* CompushadyUAV = NewObject<UCompushadyUAV>();
-	if (!CompushadyUAV->InitializeFromBuffer(BufferRHIRef, PixelFormat))
+	CompushadyUAV->InitializeFromPendingBuffer(Name, Size, EPixelFormat::PF_R32_UINT, EBufferUsageFlags::DrawIndirect);
+
+	return CompushadyUAV;
+}
+
+UCompushadyUAV* UCompushadyFunctionLibrary::CreateCompushadyUAVIndexBuffer(const FString& Name, const int64 Size, const EPixelFormat PixelFormat)
+{
+	if (Size <= 0 || Size > MAX_uint32 || (PixelFormat != EPixelFormat::PF_R16_UINT && PixelFormat != EPixelFormat::PF_R32_UINT) || Size % GPixelFormats[PixelFormat].BlockBytes != 0)
 	{
 		return nullptr;
 	}
 
+	UCompushadyUAV* CompushadyUAV = NewObject<UCompushadyUAV>();
+	CompushadyUAV->InitializeFromPendingBuffer(Name, Size, PixelFormat, EBufferUsageFlags::IndexBuffer);
+
 	return CompushadyUAV;
 }
 
 UCompushadyUAV* UCompushadyFunctionLibrary::CreateCompushadyUAVStructuredBuffer(const FString& Name, const int64 Size, const int32 Stride)
 {
-	FBufferRHIRef BufferRHIRef;
+	if (Size <= 0 || Size > MAX_uint32 || Stride <= 0)
+	{
+		return nullptr;
+	}
 
-	ENQUEUE_RENDER_COMMAND(DoCompushadyCreateBuffer)(
-		[&BufferRHIRef, Name, Size, Stride](FRHICommandListImmediate& RHICmdList)
-		{
-			FRHIResourceCreateInfo ResourceCreateInfo(*Name);
-			BufferRHIRef = COMPUSHADY_CREATE_BUFFER(Size, EBufferUsageFlags::ShaderResource | EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::StructuredBuffer, Stride, ERHIAccess::UAVCompute, ResourceCreateInfo);
-		});
+	UCompushadyUAV* CompushadyUAV = NewObject<UCompushadyUAV>();
+	CompushadyUAV->InitializeFromPendingStructuredBuffer(Name, Size, Stride);
+
+	return CompushadyUAV;
+}
 
-	FlushRenderingCommands();
+UCompushadyUAVPool* UCompushadyFunctionLibrary::CreateCompushadyUAVPool(const int32 EvictionFrames)
+{
+	UCompushadyUAVPool* CompushadyUAVPool = NewObject<UCompushadyUAVPool>();
+	CompushadyUAVPool->InitializePool(EvictionFrames);
 
-	if (!BufferRHIRef.IsValid() || !BufferRHIRef->IsValid())
+	return CompushadyUAVPool;
+}
+
+UCompushadyBufferArena* UCompushadyFunctionLibrary::CreateCompushadyBufferArena(const FString& Name, const int64 Size, const int32 Stride, FString& ErrorMessages)
+{
+	UCompushadyBufferArena* CompushadyBufferArena = NewObject<UCompushadyBufferArena>();
+	if (!CompushadyBufferArena->InitializeArena(Name, Size, Stride, ErrorMessages))
 	{
 		return nullptr;
 	}
 
-	UCompushadyUAV* CompushadyUAV = NewObject<UCompushadyUAV>();
-	if (!CompushadyUAV->InitializeFromStructuredBuffer(BufferRHIRef))
+	return CompushadyBufferArena;
+}
+
+UCompushadyMipGenerator* UCompushadyFunctionLibrary::CreateCompushadyMipGenerator(const ECompushadyMipReduction Reduction, FString& ErrorMessages)
+{
+	UCompushadyMipGenerator* CompushadyMipGenerator = NewObject<UCompushadyMipGenerator>();
+	if (!CompushadyMipGenerator->InitMipGenerator(Reduction, ErrorMessages))
 	{
 		return nullptr;
 	}
 
-	return CompushadyUAV;
+	return CompushadyMipGenerator;
 }
 
-UCompushadyUAV* UCompushadyFunctionLibrary::CreateCompushadyUAVTexture2D(const FString& Name, const int32 Width, const int32 Height, const EPixelFormat Format)
+UCompushadyUAV* UCompushadyFunctionLibrary::CreateCompushadyUAVTexture2D(const FString& Name, const int32 Width, const int32 Height, const EPixelFormat Format, const int32 NumMips)
 {
+	if (Width <= 0 || Height <= 0 || NumMips < 0)
+	{
+		return nullptr;
+	}
+
+	const int32 MaxMips = FMath::FloorLog2(FMath::Max(Width, Height)) + 1;
+
 	FRHITextureCreateDesc TextureCreateDesc = FRHITextureCreateDesc::Create2D(*Name, Width, Height, Format);
 	TextureCreateDesc.SetFlags(ETextureCreateFlags::ShaderResource | ETextureCreateFlags::UAV);
+	TextureCreateDesc.SetNumMips(NumMips == 0 ? MaxMips : FMath::Min(NumMips, MaxMips));
 
 	FTextureRHIRef TextureRHIRef = RHICreateTexture(TextureCreateDesc);
 	if (!TextureRHIRef.IsValid() || !TextureRHIRef->IsValid())
@@ -439,12 +893,8 @@ UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVFromTexture2D(UTe
 		Texture2D->UpdateResource();
 	}
 
-	FlushRenderingCommands();
-
-	FTextureResource* Resource = Texture2D->GetResource();
-
 	UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
-	if (!CompushadySRV->InitializeFromTexture(Resource->GetTextureRHI()))
+	if (!CompushadySRV->InitializeFromTextureResource(Texture2D->GetResource()))
 	{
 		return nullptr;
 	}
@@ -465,12 +915,8 @@ UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVFromTexture2DArra
 		Texture2DArray->UpdateResource();
 	}
 
-	FlushRenderingCommands();
-
-	FTextureResource* Resource = Texture2DArray->GetResource();
-
 	UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
-	if (!CompushadySRV->InitializeFromTexture(Resource->GetTextureRHI()))
+	if (!CompushadySRV->InitializeFromTextureResource(Texture2DArray->GetResource()))
 	{
 		return nullptr;
 	}
@@ -491,21 +937,134 @@ UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVFromTextureCube(U
 		TextureCube->UpdateResource();
 	}
 
-	FlushRenderingCommands();
+	UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
+	if (!CompushadySRV->InitializeFromTextureResource(TextureCube->GetResource()))
+	{
+		return nullptr;
+	}
+
+	return CompushadySRV;
+}
+
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVFromStaticMesh(UStaticMesh* StaticMesh, const int32 LOD, const ECompushadyStaticMeshStream Stream, FCompushadyStaticMeshStreamInfo& StreamInfo, FString& ErrorMessages)
+{
+	if (!StaticMesh)
+	{
+		ErrorMessages = "Invalid StaticMesh";
+		return nullptr;
+	}
+
+	if (StaticMesh->IsStreamable() && !StaticMesh->IsFullyStreamedIn())
+	{
+		StaticMesh->SetForceMipLevelsToBeResident(30.0f);
+		StaticMesh->WaitForStreaming();
+	}
+
+	FStaticMeshRenderData* RenderData = StaticMesh->GetRenderData();
+	if (!RenderData || !RenderData->LODResources.IsValidIndex(LOD))
+	{
+		ErrorMessages = FString::Printf(TEXT("Invalid LOD %d"), LOD);
+		return nullptr;
+	}
+
+	FStaticMeshLODResources& LODResources = RenderData->LODResources[LOD];
+	FStaticMeshVertexBuffers& VertexBuffers = LODResources.VertexBuffers;
+
+	StreamInfo = FCompushadyStaticMeshStreamInfo();
+	StreamInfo.NumVertices = LODResources.GetNumVertices();
+	StreamInfo.ElementsPerVertex = 1;
+
+	// the RHI buffers of the mesh are available only in the render thread
+	TFunction<FRHIBuffer*()> BufferFunction;
+
+	switch (Stream)
+	{
+	case ECompushadyStaticMeshStream::Positions:
+		StreamInfo.ElementsPerVertex = 3;
+		StreamInfo.Stride = 3 * sizeof(float);
+		StreamInfo.PixelFormat = EPixelFormat::PF_R32_FLOAT;
+		StreamInfo.HLSLType = "Buffer<float>";
+		BufferFunction = [&VertexBuffers]() { return VertexBuffers.PositionVertexBuffer.VertexBufferRHI.GetReference(); };
+		break;
+	case ECompushadyStaticMeshStream::Tangents:
+		// TangentX and TangentZ (the binormal sign is in w)
+		StreamInfo.ElementsPerVertex = 2;
+		StreamInfo.Stride = VertexBuffers.StaticMeshVertexBuffer.GetUseHighPrecisionTangentBasis() ? 16 : 8;
+		StreamInfo.PixelFormat = VertexBuffers.StaticMeshVertexBuffer.GetUseHighPrecisionTangentBasis() ? EPixelFormat::PF_R16G16B16A16_SNORM : EPixelFormat::PF_R8G8B8A8_SNORM;
+		StreamInfo.HLSLType = "Buffer<float4>";
+		BufferFunction = [&VertexBuffers]() { return VertexBuffers.StaticMeshVertexBuffer.TangentsVertexBuffer.VertexBufferRHI.GetReference(); };
+		break;
+	case ECompushadyStaticMeshStream::TexCoords:
+		// all of the uv channels of a vertex are contiguous
+		StreamInfo.ElementsPerVertex = VertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
+		StreamInfo.Stride = StreamInfo.ElementsPerVertex * (VertexBuffers.StaticMeshVertexBuffer.GetUseFullPrecisionUVs() ? 8 : 4);
+		StreamInfo.PixelFormat = VertexBuffers.StaticMeshVertexBuffer.GetUseFullPrecisionUVs() ? EPixelFormat::PF_G32R32F : EPixelFormat::PF_G16R16F;
+		StreamInfo.HLSLType = "Buffer<float2>";
+		BufferFunction = [&VertexBuffers]() { return VertexBuffers.StaticMeshVertexBuffer.TexCoordVertexBuffer.VertexBufferRHI.GetReference(); };
+		break;
+	case ECompushadyStaticMeshStream::Colors:
+		if (VertexBuffers.ColorVertexBuffer.GetNumVertices() == 0)
+		{
+			ErrorMessages = "StaticMesh has no vertex colors";
+			return nullptr;
+		}
+		// FColor is stored as BGRA, use .zyxw in hlsl
+		StreamInfo.Stride = 4;
+		StreamInfo.PixelFormat = EPixelFormat::PF_R8G8B8A8;
+		StreamInfo.HLSLType = "Buffer<float4>";
+		BufferFunction = [&VertexBuffers]() { return VertexBuffers.ColorVertexBuffer.VertexBufferRHI.GetReference(); };
+		break;
+	case ECompushadyStaticMeshStream::Indices:
+		StreamInfo.NumVertices = LODResources.IndexBuffer.GetNumIndices();
+		StreamInfo.Stride = LODResources.IndexBuffer.Is32Bit() ? 4 : 2;
+		StreamInfo.PixelFormat = LODResources.IndexBuffer.Is32Bit() ? EPixelFormat::PF_R32_UINT : EPixelFormat::PF_R16_UINT;
+		StreamInfo.HLSLType = "Buffer<uint>";
+		BufferFunction = [&LODResources]() { return LODResources.IndexBuffer.IndexBufferRHI.GetReference(); };
+		break;
+	}
 
-	FTextureResource* Resource = TextureCube->GetResource();
+	if (StreamInfo.NumVertices <= 0 || StreamInfo.ElementsPerVertex <= 0)
+	{
+		ErrorMessages = "Empty StaticMesh stream";
+		return nullptr;
+	}
 
 	UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
-	if (!CompushadySRV->InitializeFromTexture(Resource->GetTextureRHI()))
+	if (!CompushadySRV->InitializeFromRenderBuffer(BufferFunction, StreamInfo.PixelFormat))
 	{
+		ErrorMessages = "Unable to create SRV";
+		return nullptr;
+	}
+
+	// the buffers of meshes without CPU access usually cannot be viewed, the view creation is synchronized to report it
+	if (CompushadySRV->IsCreationFailed())
+	{
+		FRHIBuffer* Buffer = BufferFunction();
+		if (!Buffer)
+		{
+			ErrorMessages = "StaticMesh stream buffer not available";
+		}
+		else if (!EnumHasAnyFlags(Buffer->GetUsage(), EBufferUsageFlags::ShaderResource))
+		{
+			ErrorMessages = "StaticMesh stream buffer does not support Shader Resource Views (the mesh may require Allow CPU Access)";
+		}
+		else
+		{
+			ErrorMessages = "Unable to create SRV";
+		}
 		return nullptr;
 	}
 
 	return CompushadySRV;
 }
 
-UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVTexture2DFromImageFile(const FString& Name, const FString& Filename)
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVTexture2DFromImageFile(const FString& Name, const FString& Filename, const int32 NumMips)
 {
+	if (NumMips < 0)
+	{
+		return nullptr;
+	}
+
 	TArray<uint8> ImageData;
 	if (!FFileHelper::LoadFileToArray(ImageData, *Filename))
 	{
@@ -535,8 +1094,13 @@ UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVTexture2DFromImag
 		return nullptr;
 	}
 
-	FRHITextureCreateDesc TextureCreateDesc = FRHITextureCreateDesc::Create2D(*Name, ImageWrapper->GetWidth(), ImageWrapper->GetHeight(), EPixelFormat::PF_B8G8R8A8);
+	const int32 Width = ImageWrapper->GetWidth();
+	const int32 Height = ImageWrapper->GetHeight();
+	const int32 MaxMips = FMath::FloorLog2(FMath::Max(Width, Height)) + 1;
+
+	FRHITextureCreateDesc TextureCreateDesc = FRHITextureCreateDesc::Create2D(*Name, Width, Height, EPixelFormat::PF_B8G8R8A8);
 	TextureCreateDesc.SetFlags(ETextureCreateFlags::ShaderResource);
+	TextureCreateDesc.SetNumMips(NumMips == 0 ? MaxMips : FMath::Min(NumMips, MaxMips));
 	FTextureRHIRef TextureRHIRef = RHICreateTexture(TextureCreateDesc);
 
 	if (!TextureRHIRef.IsValid() || !TextureRHIRef->IsValid())
@@ -544,24 +1108,196 @@ UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVTexture2DFromImag
 		return nullptr;
 	}
 
+	// each mip is the 2x2 average of the previous one (the last row/column is reused for odd sizes)
+	TArray<TArray<uint8>> Mips;
+	Mips.Add(MoveTemp(UncompressedBytes));
+	for (int32 MipLevel = 1; MipLevel < static_cast<int32>(TextureRHIRef->GetNumMips()); MipLevel++)
+	{
+		const TArray<uint8>& Source = Mips.Last();
+		const int32 SourceWidth = FMath::Max(Width >> (MipLevel - 1), 1);
+		const int32 SourceHeight = FMath::Max(Height >> (MipLevel - 1), 1);
+		const int32 MipWidth = FMath::Max(Width >> MipLevel, 1);
+		const int32 MipHeight = FMath::Max(Height >> MipLevel, 1);
+
+		TArray<uint8> Mip;
+		Mip.AddUninitialized(MipWidth * MipHeight * 4);
+		for (int32 Y = 0; Y < MipHeight; Y++)
+		{
+			const int32 Y0 = FMath::Min(Y * 2, SourceHeight - 1);
+			const int32 Y1 = FMath::Min(Y * 2 + 1, SourceHeight - 1);
+			for (int32 X = 0; X < MipWidth; X++)
+			{
+				const int32 X0 = FMath::Min(X * 2, SourceWidth - 1);
+				const int32 X1 = FMath::Min(X * 2 + 1, SourceWidth - 1);
+				for (int32 Channel = 0; Channel < 4; Channel++)
+				{
+					const int32 Sum = Source[(Y0 * SourceWidth + X0) * 4 + Channel] + Source[(Y0 * SourceWidth + X1) * 4 + Channel] +
+						Source[(Y1 * SourceWidth + X0) * 4 + Channel] + Source[(Y1 * SourceWidth + X1) * 4 + Channel];
+					Mip[(Y * MipWidth + X) * 4 + Channel] = static_cast<uint8>((Sum + 2) / 4);
+				}
+			}
+		}
+		Mips.Add(MoveTemp(Mip));
+	}
+
+	// the pixels are owned by the render command, the SRV creation is enqueued after it
 	ENQUEUE_RENDER_COMMAND(DoCompushadyUpdateTexture2D)(
-		[TextureRHIRef, ImageWrapper, &UncompressedBytes](FRHICommandListImmediate& RHICmdList)
+		[TextureRHIRef, Width, Height, Mips = MoveTemp(Mips)](FRHICommandListImmediate& RHICmdList)
 		{
-			FUpdateTextureRegion2D UpdateTextureRegion2D(0, 0, 0, 0, ImageWrapper->GetWidth(), ImageWrapper->GetHeight());
-			RHICmdList.UpdateTexture2D(TextureRHIRef, 0, UpdateTextureRegion2D, ImageWrapper->GetWidth() * 4, UncompressedBytes.GetData());
+			for (int32 MipLevel = 0; MipLevel < Mips.Num(); MipLevel++)
+			{
+				const int32 MipWidth = FMath::Max(Width >> MipLevel, 1);
+				const int32 MipHeight = FMath::Max(Height >> MipLevel, 1);
+				FUpdateTextureRegion2D UpdateTextureRegion2D(0, 0, 0, 0, MipWidth, MipHeight);
+				RHICmdList.UpdateTexture2D(TextureRHIRef, MipLevel, UpdateTextureRegion2D, MipWidth * 4, Mips[MipLevel].GetData());
+			}
 		});
 
-	FlushRenderingCommands();
+	UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
+	if (!CompushadySRV->InitializeFromTexture(TextureRHIRef))
+	{
+		return nullptr;
+	}
+
+	return CompushadySRV;
+}
+
+TArray<UCompushadySRV*> UCompushadyFunctionLibrary::CreateCompushadySRVTexture2DsFromImageFiles(const TArray<FString>& Filenames, FString& ErrorMessages)
+{
+	TArray<UCompushadySRV*> SRVs;
+
+	TArray<Compushady::ImageLoader::FDecodedImage> DecodedImages;
+	if (!Compushady::ImageLoader::DecodeAll(Filenames, DecodedImages, ErrorMessages))
+	{
+		return SRVs;
+	}
+
+	TArray<FTextureRHIRef> Textures;
+	for (int32 Index = 0; Index < DecodedImages.Num(); Index++)
+	{
+		const Compushady::ImageLoader::FDecodedImage& DecodedImage = DecodedImages[Index];
+		FRHITextureCreateDesc TextureCreateDesc = FRHITextureCreateDesc::Create2D(*FPaths::GetBaseFilename(Filenames[Index]), DecodedImage.Size.X, DecodedImage.Size.Y, DecodedImage.PixelFormat);
+		TextureCreateDesc.SetFlags(ETextureCreateFlags::ShaderResource);
+		FTextureRHIRef TextureRHIRef = RHICreateTexture(TextureCreateDesc);
+		if (!TextureRHIRef.IsValid() || !TextureRHIRef->IsValid())
+		{
+			ErrorMessages = FString::Printf(TEXT("Unable to create texture for \"%s\""), *Filenames[Index]);
+			return SRVs;
+		}
+		Textures.Add(TextureRHIRef);
+	}
+
+	// all of the textures are updated in a single render command (that owns the decoded pixels)
+	ENQUEUE_RENDER_COMMAND(DoCompushadyUpdateTexture2Ds)(
+		[Textures, DecodedImages = MoveTemp(DecodedImages)](FRHICommandListImmediate& RHICmdList)
+		{
+			for (int32 Index = 0; Index < Textures.Num(); Index++)
+			{
+				const Compushady::ImageLoader::FDecodedImage& DecodedImage = DecodedImages[Index];
+				FUpdateTextureRegion2D UpdateTextureRegion2D(0, 0, 0, 0, DecodedImage.Size.X, DecodedImage.Size.Y);
+				RHICmdList.UpdateTexture2D(Textures[Index], 0, UpdateTextureRegion2D, DecodedImage.Size.X * GPixelFormats[DecodedImage.PixelFormat].BlockBytes, DecodedImage.Pixels.GetData());
+			}
+		});
+
+	for (FTextureRHIRef& TextureRHIRef : Textures)
+	{
+		UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
+		if (!CompushadySRV->InitializeFromTexture(TextureRHIRef))
+		{
+			ErrorMessages = "Unable to create SRV";
+			SRVs.Empty();
+			return SRVs;
+		}
+		SRVs.Add(CompushadySRV);
+	}
+
+	return SRVs;
+}
+
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVTexture2DArrayFromImageFiles(const FString& Name, const TArray<FString>& Filenames, FString& ErrorMessages)
+{
+	if (Filenames.Num() == 0)
+	{
+		ErrorMessages = "Empty list of files";
+		return nullptr;
+	}
+
+	TArray<Compushady::ImageLoader::FDecodedImage> DecodedImages;
+	if (!Compushady::ImageLoader::DecodeAll(Filenames, DecodedImages, ErrorMessages))
+	{
+		return nullptr;
+	}
+
+	const FIntPoint Size = DecodedImages[0].Size;
+	const EPixelFormat PixelFormat = DecodedImages[0].PixelFormat;
+
+	for (int32 Index = 1; Index < DecodedImages.Num(); Index++)
+	{
+		if (DecodedImages[Index].Size != Size || DecodedImages[Index].PixelFormat != PixelFormat)
+		{
+			ErrorMessages = FString::Printf(TEXT("\"%s\" (%dx%d %s) does not match the size or format of the first image (%dx%d %s)"), *Filenames[Index],
+				DecodedImages[Index].Size.X, DecodedImages[Index].Size.Y, GPixelFormats[DecodedImages[Index].PixelFormat].Name,
+				Size.X, Size.Y, GPixelFormats[PixelFormat].Name);
+			return nullptr;
+		}
+	}
+
+	FRHITextureCreateDesc TextureCreateDesc = FRHITextureCreateDesc::Create2DArray(*Name, Size.X, Size.Y, DecodedImages.Num(), PixelFormat);
+	TextureCreateDesc.SetFlags(ETextureCreateFlags::ShaderResource);
+	FTextureRHIRef TextureRHIRef = RHICreateTexture(TextureCreateDesc);
+
+	if (!TextureRHIRef.IsValid() || !TextureRHIRef->IsValid())
+	{
+		ErrorMessages = "Unable to create Texture2DArray";
+		return nullptr;
+	}
+
+	ENQUEUE_RENDER_COMMAND(DoCompushadyUpdateTexture2DArray)(
+		[TextureRHIRef, DecodedImages = MoveTemp(DecodedImages)](FRHICommandListImmediate& RHICmdList)
+		{
+			const int32 RowPitch = TextureRHIRef->GetSizeX() * GPixelFormats[TextureRHIRef->GetFormat()].BlockBytes;
+			for (int32 Slice = 0; Slice < DecodedImages.Num(); Slice++)
+			{
+				uint32 DestStride;
+				void* Data = RHICmdList.LockTexture2DArray(TextureRHIRef, Slice, 0, EResourceLockMode::RLM_WriteOnly, DestStride, false);
+				if (Data)
+				{
+					CopyTextureData2D(DecodedImages[Slice].Pixels.GetData(), Data, TextureRHIRef->GetSizeY(), TextureRHIRef->GetFormat(), RowPitch, DestStride);
+					RHICmdList.UnlockTexture2DArray(TextureRHIRef, Slice, 0, false);
+				}
+			}
+		});
 
 	UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
 	if (!CompushadySRV->InitializeFromTexture(TextureRHIRef))
 	{
+		ErrorMessages = "Unable to create SRV";
 		return nullptr;
 	}
 
 	return CompushadySRV;
 }
 
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVTexture2DArrayFromImageDirectory(const FString& Name, const FString& Directory, const FString& Extension, FString& ErrorMessages)
+{
+	TArray<FString> Filenames;
+	IFileManager::Get().FindFiles(Filenames, *Directory, *Extension);
+	if (Filenames.Num() == 0)
+	{
+		ErrorMessages = FString::Printf(TEXT("No files found in \"%s\""), *Directory);
+		return nullptr;
+	}
+
+	// slices follow the alphabetical order of the files
+	Filenames.Sort();
+	for (FString& Filename : Filenames)
+	{
+		Filename = FPaths::Combine(Directory, Filename);
+	}
+
+	return CreateCompushadySRVTexture2DArrayFromImageFiles(Name, Filenames, ErrorMessages);
+}
+
 UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVFromRenderTarget2D(UTextureRenderTarget2D* RenderTarget)
 {
 	if (!RenderTarget->GetResource() || !RenderTarget->GetResource()->IsInitialized())
@@ -570,12 +1306,9 @@ UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVFromRenderTarget2
 	}
 
 	RenderTarget->UpdateResourceImmediate(false);
-	FlushRenderingCommands();
-
-	FTextureResource* Resource = RenderTarget->GetResource();
 
 	UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
-	if (!CompushadySRV->InitializeFromTexture(Resource->GetTextureRHI()))
+	if (!CompushadySRV->InitializeFromTextureResource(RenderTarget->GetResource()))
 	{
 		return nullptr;
 	}
@@ -591,12 +1324,9 @@ UCompushadyRTV* UCompushadyFunctionLibrary::CreateCompushadyRTVFromRenderTarget2
 	}
 
 	RenderTarget->UpdateResourceImmediate(false);
-	FlushRenderingCommands();
-
-	FTextureResource* Resource = RenderTarget->GetResource();
 
 	UCompushadyRTV* CompushadyRTV = NewObject<UCompushadyRTV>();
-	if (!CompushadyRTV->InitializeFromTexture(Resource->GetTextureRHI()))
+	if (!CompushadyRTV->InitializeFromTextureResource(RenderTarget->GetResource()))
 	{
 		return nullptr;
 	}
@@ -627,7 +1357,7 @@ UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromDataTab
 		}
 	}
 
-	const TMap<FName, uint8*> RowMap = DataTable->GetRowMap();
+	const TMap<FName, uint8*>& RowMap = DataTable->GetRowMap();
 
 	Size *= RowMap.Num();
 
@@ -646,7 +1376,19 @@ UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromDataTab
 		}
 	}
 
-	return CreateCompushadySRVBufferFromByteArray(Name, Data, PixelFormat);
+	return CreateCompushadySRVBufferFromByteArray(Name, MoveTemp(Data), PixelFormat);
+}
+
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVStructuredBufferFromDataTable(const FString& Name, UDataTable* DataTable, const ECompushadyDataTableLayout Layout, FString& HLSL, FString& ErrorMessages, const bool bDemoteDoubles)
+{
+	TArray<uint8> Data;
+	int32 Stride = 0;
+	if (!Compushady::DataTable::PackDataTable(DataTable, Layout, bDemoteDoubles, Data, Stride, HLSL, ErrorMessages))
+	{
+		return nullptr;
+	}
+
+	return CreateCompushadySRVStructuredBufferFromByteArray(Name, MoveTemp(Data), Stride);
 }
 
 UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromCurveFloat(const FString& Name, UCurveFloat* CurveFloat, const float StartTime, const float EndTime, const int32 Steps)
@@ -660,6 +1402,7 @@ UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromCurveFl
 	float Time = StartTime;
 
 	TArray<float> Data;
+	Data.Reserve(Steps);
 
 	for (int32 Step = 0; Step < Steps; Step++)
 	{
@@ -667,32 +1410,18 @@ UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromCurveFl
 		Time += Delta;
 	}
 
-	FBufferRHIRef BufferRHIRef;
-
-	ENQUEUE_RENDER_COMMAND(DoCompushadyCreateBuffer)(
-		[&BufferRHIRef, Name, Data, Steps](FRHICommandListImmediate& RHICmdList)
-		{
-			FRHIResourceCreateInfo ResourceCreateInfo(*Name);
-			BufferRHIRef = COMPUSHADY_CREATE_BUFFER(Steps * sizeof(float), EBufferUsageFlags::ShaderResource | EBufferUsageFlags::VertexBuffer, sizeof(float), ERHIAccess::UAVCompute, ResourceCreateInfo);
-			void* LockedData = RHICmdList.LockBuffer(BufferRHIRef, 0, BufferRHIRef->GetSize(), EResourceLockMode::RLM_WriteOnly);
-			FMemory::Memcpy(LockedData, Data.GetData(), BufferRHIRef->GetSize());
-			RHICmdList.UnlockBuffer(BufferRHIRef);
-		});
-
-	FlushRenderingCommands();
-
-	if (!BufferRHIRef.IsValid() || !BufferRHIRef->IsValid())
-	{
-		return nullptr;
-	}
+	return CreateCompushadySRVBufferFromFloatArray(Name, MoveTemp(Data), EPixelFormat::PF_R32_FLOAT);
+}
 
-	UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
-	if (!CompushadySRV->InitializeFromBuffer(BufferRHIRef, EPixelFormat::PF_R32_FLOAT))
+UCompushadyCurveAtlas* UCompushadyFunctionLibrary::CreateCompushadyCurveAtlas(const FString& Name, const TArray<UCurveBase*>& Curves, const int32 Resolution, FString& ErrorMessages)
+{
+	UCompushadyCurveAtlas* CompushadyCurveAtlas = NewObject<UCompushadyCurveAtlas>();
+	if (!CompushadyCurveAtlas->InitializeAtlas(Name, Curves, Resolution, ErrorMessages))
 	{
 		return nullptr;
 	}
 
-	return CompushadySRV;
+	return CompushadyCurveAtlas;
 }
 
 UCompushadyUAV* UCompushadyFunctionLibrary::CreateCompushadyUAVFromRenderTarget2D(UTextureRenderTarget2D* RenderTarget)
@@ -709,12 +1438,9 @@ UCompushadyUAV* UCompushadyFunctionLibrary::CreateCompushadyUAVFromRenderTarget2
 	}
 
 	RenderTarget->UpdateResourceImmediate(false);
-	FlushRenderingCommands();
-
-	FTextureResource* Resource = RenderTarget->GetResource();
 
 	UCompushadyUAV* CompushadyUAV = NewObject<UCompushadyUAV>();
-	if (!CompushadyUAV->InitializeFromTexture(Resource->GetTextureRHI()))
+	if (!CompushadyUAV->InitializeFromTextureResource(RenderTarget->GetResource()))
 	{
 		return nullptr;
 	}
@@ -736,12 +1462,9 @@ UCompushadyUAV* UCompushadyFunctionLibrary::CreateCompushadyUAVFromRenderTarget2
 	}
 
 	RenderTargetArray->UpdateResourceImmediate(false);
-	FlushRenderingCommands();
-
-	FTextureResource* Resource = RenderTargetArray->GetResource();
 
 	UCompushadyUAV* CompushadyUAV = NewObject<UCompushadyUAV>();
-	if (!CompushadyUAV->InitializeFromTexture(Resource->GetTextureRHI()))
+	if (!CompushadyUAV->InitializeFromTextureResource(RenderTargetArray->GetResource()))
 	{
 		return nullptr;
 	}
@@ -763,12 +1486,9 @@ UCompushadyUAV* UCompushadyFunctionLibrary::CreateCompushadyUAVFromRenderTargetC
 	}
 
 	RenderTargetCube->UpdateResourceImmediate(false);
-	FlushRenderingCommands();
-
-	FTextureResource* Resource = RenderTargetCube->GetResource();
 
 	UCompushadyUAV* CompushadyUAV = NewObject<UCompushadyUAV>();
-	if (!CompushadyUAV->InitializeFromTexture(Resource->GetTextureRHI()))
+	if (!CompushadyUAV->InitializeFromTextureResource(RenderTargetCube->GetResource()))
 	{
 		return nullptr;
 	}
@@ -790,12 +1510,9 @@ UCompushadyUAV* UCompushadyFunctionLibrary::CreateCompushadyUAVFromRenderTargetV
 	}
 
 	RenderTargetVolume->UpdateResourceImmediate(false);
-	FlushRenderingCommands();
-
-	FTextureResource* Resource = RenderTargetVolume->GetResource();
 
 	UCompushadyUAV* CompushadyUAV = NewObject<UCompushadyUAV>();
-	if (!CompushadyUAV->InitializeFromTexture(Resource->GetTextureRHI()))
+	if (!CompushadyUAV->InitializeFromTextureResource(RenderTargetVolume->GetResource()))
 	{
 		return nullptr;
 	}
@@ -805,55 +1522,60 @@ UCompushadyUAV* UCompushadyFunctionLibrary::CreateCompushadyUAVFromRenderTargetV
 
 UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromFloatArray(const FString& Name, const TArray<float>& Data, const EPixelFormat PixelFormat)
 {
-	FBufferRHIRef BufferRHIRef;
+	return Compushady::Upload::CreateSRVFloatBuffer(Name, Data, PixelFormat);
+}
 
-	ENQUEUE_RENDER_COMMAND(DoCompushadyCreateBuffer)(
-		[&BufferRHIRef, Name, Data, PixelFormat](FRHICommandListImmediate& RHICmdList)
-		{
-			FRHIResourceCreateInfo ResourceCreateInfo(*Name);
-			BufferRHIRef = COMPUSHADY_CREATE_BUFFER(Data.Num() * sizeof(float), EBufferUsageFlags::ShaderResource | EBufferUsageFlags::VertexBuffer, GPixelFormats[PixelFormat].BlockBytes, ERHIAccess::SRVMask, ResourceCreateInfo);
-			void* LockedData = RHICmdList.LockBuffer(BufferRHIRef, 0, BufferRHIRef->GetSize(), EResourceLockMode::RLM_WriteOnly);
-			FMemory::Memcpy(LockedData, Data.GetData(), BufferRHIRef->GetSize());
-			RHICmdList.UnlockBuffer(BufferRHIRef);
-		});
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromFloatArray(const FString& Name, TArrayView<const float> Data, const EPixelFormat PixelFormat)
+{
+	return Compushady::Upload::CreateSRVFloatBuffer(Name, Data, PixelFormat);
+}
 
-	FlushRenderingCommands();
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromFloatArray(const FString& Name, TArray<float>&& Data, const EPixelFormat PixelFormat)
+{
+	return Compushady::Upload::CreatePendingSRVFloatBuffer(Name, MakeShared<TArray<float>, ESPMode::ThreadSafe>(MoveTemp(Data)), PixelFormat);
+}
 
-	if (!BufferRHIRef.IsValid() || !BufferRHIRef->IsValid())
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromFloatArray(const FString& Name, TSharedPtr<const TArray<float>, ESPMode::ThreadSafe> Data, const EPixelFormat PixelFormat)
+{
+	if (!Data)
 	{
 		return nullptr;
 	}
+	return Compushady::Upload::CreatePendingSRVFloatBuffer(Name, Data.ToSharedRef(), PixelFormat);
+}
 
-	UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
-	if (!CompushadySRV->InitializeFromBuffer(BufferRHIRef, PixelFormat))
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromByteArray(const FString& Name, const TArray<uint8>& Data, const EPixelFormat PixelFormat)
+{
+	return Compushady::Upload::CreateSRVBuffer(Name, Data, PixelFormat);
+}
+
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromByteArray(const FString& Name, TArrayView<const uint8> Data, const EPixelFormat PixelFormat)
+{
+	return Compushady::Upload::CreateSRVBuffer(Name, Data, PixelFormat);
+}
+
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromByteArray(const FString& Name, TArray<uint8>&& Data, const EPixelFormat PixelFormat)
+{
+	return Compushady::Upload::CreatePendingSRVBuffer<TArray<uint8>>(Name, MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(Data)), PixelFormat);
+}
+
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromByteArray(const FString& Name, TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Data, const EPixelFormat PixelFormat)
+{
+	if (!Data)
 	{
 		return nullptr;
 	}
-
-	return CompushadySRV;
+	return Compushady::Upload::CreatePendingSRVBuffer<TArray<uint8>>(Name, Data.ToSharedRef(), PixelFormat);
 }
 
-UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromByteArray(const FString& Name, const TArray<uint8>& Data, const EPixelFormat PixelFormat)
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromFile(const FString& Name, const FString& Filename, const EPixelFormat PixelFormat, const int64 Offset, const int64 Size)
 {
-	if (PixelFormat == EPixelFormat::PF_Unknown || Data.Num() == 0)
+	if (PixelFormat == EPixelFormat::PF_Unknown)
 	{
 		return nullptr;
 	}
 
-	FBufferRHIRef BufferRHIRef;
-
-	ENQUEUE_RENDER_COMMAND(DoCompushadyCreateBuffer)(
-		[&BufferRHIRef, Name, Data, PixelFormat](FRHICommandListImmediate& RHICmdList)
-		{
-			FRHIResourceCreateInfo ResourceCreateInfo(*Name);
-			BufferRHIRef = COMPUSHADY_CREATE_BUFFER(Data.Num(), EBufferUsageFlags::ShaderResource | EBufferUsageFlags::VertexBuffer, GPixelFormats[PixelFormat].BlockBytes, ERHIAccess::SRVMask, ResourceCreateInfo);
-			void* LockedData = RHICmdList.LockBuffer(BufferRHIRef, 0, BufferRHIRef->GetSize(), EResourceLockMode::RLM_WriteOnly);
-			FMemory::Memcpy(LockedData, Data.GetData(), BufferRHIRef->GetSize());
-			RHICmdList.UnlockBuffer(BufferRHIRef);
-		});
-
-	FlushRenderingCommands();
-
+	FBufferRHIRef BufferRHIRef = Compushady::MappedFile::CreateBuffer(Name, Filename, Offset, Size, EBufferUsageFlags::ShaderResource | EBufferUsageFlags::VertexBuffer, GPixelFormats[PixelFormat].BlockBytes, ERHIAccess::SRVMask);
 	if (!BufferRHIRef.IsValid() || !BufferRHIRef->IsValid())
 	{
 		return nullptr;
@@ -868,64 +1590,74 @@ UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromByteArr
 	return CompushadySRV;
 }
 
-UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVStructuredBufferFromFloatArray(const FString& Name, const TArray<float>& Data, const int32 Stride)
+UCompushadyUAV* UCompushadyFunctionLibrary::CreateCompushadyUAVBufferFromFile(const FString& Name, const FString& Filename, const EPixelFormat PixelFormat, const int64 Offset, const int64 Size)
 {
-	FBufferRHIRef BufferRHIRef;
-
-	ENQUEUE_RENDER_COMMAND(DoCompushadyCreateBuffer)(
-		[&BufferRHIRef, Name, Data, Stride](FRHICommandListImmediate& RHICmdList)
-		{
-			FRHIResourceCreateInfo ResourceCreateInfo(*Name);
-			BufferRHIRef = COMPUSHADY_CREATE_BUFFER(Data.Num() * sizeof(float), EBufferUsageFlags::ShaderResource | EBufferUsageFlags::StructuredBuffer, Stride, ERHIAccess::UAVCompute, ResourceCreateInfo);
-			void* LockedData = RHICmdList.LockBuffer(BufferRHIRef, 0, BufferRHIRef->GetSize(), EResourceLockMode::RLM_WriteOnly);
-			FMemory::Memcpy(LockedData, Data.GetData(), BufferRHIRef->GetSize());
-			RHICmdList.UnlockBuffer(BufferRHIRef);
-		});
-
-	FlushRenderingCommands();
+	if (PixelFormat == EPixelFormat::PF_Unknown)
+	{
+		return nullptr;
+	}
 
+	FBufferRHIRef BufferRHIRef = Compushady::MappedFile::CreateBuffer(Name, Filename, Offset, Size, EBufferUsageFlags::ShaderResource | EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::VertexBuffer, GPixelFormats[PixelFormat].BlockBytes, ERHIAccess::UAVCompute);
 	if (!BufferRHIRef.IsValid() || !BufferRHIRef->IsValid())
 	{
 		return nullptr;
 	}
 
-	UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
-	if (!CompushadySRV->InitializeFromStructuredBuffer(BufferRHIRef))
+	UCompushadyUAV* CompushadyUAV = NewObject<UCompushadyUAV>();
+	if (!CompushadyUAV->InitializeFromBuffer(BufferRHIRef, PixelFormat))
 	{
 		return nullptr;
 	}
 
-	return CompushadySRV;
+	return CompushadyUAV;
 }
 
-UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVStructuredBufferFromByteArray(const FString& Name, const TArray<uint8>& Data, const int32 Stride)
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVStructuredBufferFromFloatArray(const FString& Name, const TArray<float>& Data, const int32 Stride)
 {
-	FBufferRHIRef BufferRHIRef;
+	return Compushady::Upload::CreateSRVStructuredBuffer(Name, Compushady::Upload::AsBytes<float>(Data), Stride);
+}
 
-	ENQUEUE_RENDER_COMMAND(DoCompushadyCreateBuffer)(
-		[&BufferRHIRef, Name, Data, Stride](FRHICommandListImmediate& RHICmdList)
-		{
-			FRHIResourceCreateInfo ResourceCreateInfo(*Name);
-			BufferRHIRef = COMPUSHADY_CREATE_BUFFER(Data.Num(), EBufferUsageFlags::ShaderResource | EBufferUsageFlags::StructuredBuffer, Stride, ERHIAccess::UAVCompute, ResourceCreateInfo);
-			void* LockedData = RHICmdList.LockBuffer(BufferRHIRef, 0, BufferRHIRef->GetSize(), EResourceLockMode::RLM_WriteOnly);
-			FMemory::Memcpy(LockedData, Data.GetData(), BufferRHIRef->GetSize());
-			RHICmdList.UnlockBuffer(BufferRHIRef);
-		});
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVStructuredBufferFromFloatArray(const FString& Name, TArrayView<const float> Data, const int32 Stride)
+{
+	return Compushady::Upload::CreateSRVStructuredBuffer(Name, Compushady::Upload::AsBytes(Data), Stride);
+}
 
-	FlushRenderingCommands();
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVStructuredBufferFromFloatArray(const FString& Name, TArray<float>&& Data, const int32 Stride)
+{
+	return Compushady::Upload::CreatePendingSRVStructuredBuffer<float>(Name, MakeShared<TArray<float>, ESPMode::ThreadSafe>(MoveTemp(Data)), Stride);
+}
 
-	if (!BufferRHIRef.IsValid() || !BufferRHIRef->IsValid())
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVStructuredBufferFromFloatArray(const FString& Name, TSharedPtr<const TArray<float>, ESPMode::ThreadSafe> Data, const int32 Stride)
+{
+	if (!Data)
 	{
 		return nullptr;
 	}
+	return Compushady::Upload::CreatePendingSRVStructuredBuffer<float>(Name, Data.ToSharedRef(), Stride);
+}
 
-	UCompushadySRV* CompushadySRV = NewObject<UCompushadySRV>();
-	if (!CompushadySRV->InitializeFromStructuredBuffer(BufferRHIRef))
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVStructuredBufferFromByteArray(const FString& Name, const TArray<uint8>& Data, const int32 Stride)
+{
+	return Compushady::Upload::CreateSRVStructuredBuffer(Name, Data, Stride);
+}
+
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVStructuredBufferFromByteArray(const FString& Name, TArrayView<const uint8> Data, const int32 Stride)
+{
+	return Compushady::Upload::CreateSRVStructuredBuffer(Name, Data, Stride);
+}
+
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVStructuredBufferFromByteArray(const FString& Name, TArray<uint8>&& Data, const int32 Stride)
+{
+	return Compushady::Upload::CreatePendingSRVStructuredBuffer<uint8>(Name, MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(Data)), Stride);
+}
+
+UCompushadySRV* UCompushadyFunctionLibrary::CreateCompushadySRVStructuredBufferFromByteArray(const FString& Name, TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Data, const int32 Stride)
+{
+	if (!Data)
 	{
 		return nullptr;
 	}
-
-	return CompushadySRV;
+	return Compushady::Upload::CreatePendingSRVStructuredBuffer<uint8>(Name, Data.ToSharedRef(), Stride);
 }
 
 UCompushadySoundWave* UCompushadyFunctionLibrary::CreateCompushadySoundWave(const UCompushadyCompute* Compute, const FCompushadyResourceArray& ResourceArray, const float Duration)
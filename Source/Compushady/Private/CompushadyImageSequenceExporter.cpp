@@ -0,0 +1,433 @@
+// Copyright 2023 - Roberto De Ioris.
+
+
+#include "CompushadyImageSequenceExporter.h"
+#include "Async/Async.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Misc/FileHelper.h"
+#include "RHIGPUReadback.h"
+
+struct FCompushadyImageSequenceFrame
+{
+	FString Filename;
+	FIntPoint Size;
+	EPixelFormat PixelFormat;
+	TArray64<uint8> Data;
+};
+
+struct FCompushadyImageSequenceExporterState
+{
+	FString FilenamePrefix;
+	ECompushadyImageSequenceFormat Format;
+	ECompushadyImageSequencePolicy Policy;
+	int32 NumWorkers;
+	int32 MaxQueuedFrames;
+
+	IImageWrapperModule* ImageWrapperModule = nullptr;
+
+	FCriticalSection Lock;
+	TQueue<TSharedPtr<FCompushadyImageSequenceFrame>> Frames;
+	int32 NumActiveWorkers = 0;
+
+	// frames accepted by ExportFrame and not yet written (or failed)
+	std::atomic<int32> NumQueuedFrames = 0;
+	std::atomic<int64> NumExportedFrames = 0;
+	std::atomic<int64> NumDroppedFrames = 0;
+	std::atomic<int64> NumFailedFrames = 0;
+
+	FEvent* FrameCompletedEvent = nullptr;
+
+	// a copy in flight, mapped (in order) by the render thread when its fence is signaled
+	struct FPendingReadback
+	{
+		TUniquePtr<FRHIGPUTextureReadback> Readback;
+		TSharedPtr<FCompushadyImageSequenceFrame> Frame;
+		FIntPoint Size;
+		EPixelFormat PixelFormat;
+	};
+
+	// accessed only by the render thread
+	TArray<FPendingReadback> PendingReadbacks;
+	// readbacks that can be reused for frames with the same size and format
+	TArray<FPendingReadback> FreeReadbacks;
+
+	FCompushadyImageSequenceExporterState()
+	{
+		FrameCompletedEvent = FPlatformProcess::GetSynchEventFromPool();
+	}
+
+	~FCompushadyImageSequenceExporterState()
+	{
+		FPlatformProcess::ReturnSynchEventToPool(FrameCompletedEvent);
+	}
+
+	bool Encode(const FCompushadyImageSequenceFrame& Frame) const
+	{
+		if (Format == ECompushadyImageSequenceFormat::Raw)
+		{
+			return FFileHelper::SaveArrayToFile(Frame.Data, *Frame.Filename);
+		}
+
+		ERGBFormat RGBFormat = ERGBFormat::Invalid;
+		int32 BitDepth = 0;
+
+		if (Format == ECompushadyImageSequenceFormat::PNG)
+		{
+			switch (Frame.PixelFormat)
+			{
+			case EPixelFormat::PF_B8G8R8A8:
+				RGBFormat = ERGBFormat::BGRA;
+				BitDepth = 8;
+				break;
+			case EPixelFormat::PF_R8G8B8A8:
+				RGBFormat = ERGBFormat::RGBA;
+				BitDepth = 8;
+				break;
+			case EPixelFormat::PF_R16G16B16A16_UNORM:
+				RGBFormat = ERGBFormat::RGBA;
+				BitDepth = 16;
+				break;
+			case EPixelFormat::PF_G8:
+				RGBFormat = ERGBFormat::Gray;
+				BitDepth = 8;
+				break;
+			case EPixelFormat::PF_G16:
+				RGBFormat = ERGBFormat::Gray;
+				BitDepth = 16;
+				break;
+			default:
+				break;
+			}
+		}
+		else if (Format == ECompushadyImageSequenceFormat::EXR)
+		{
+			switch (Frame.PixelFormat)
+			{
+			case EPixelFormat::PF_FloatRGBA:
+				RGBFormat = ERGBFormat::RGBAF;
+				BitDepth = 16;
+				break;
+			case EPixelFormat::PF_A32B32G32R32F:
+				RGBFormat = ERGBFormat::RGBAF;
+				BitDepth = 32;
+				break;
+			case EPixelFormat::PF_R16F:
+				RGBFormat = ERGBFormat::GrayF;
+				BitDepth = 16;
+				break;
+			case EPixelFormat::PF_R32_FLOAT:
+				RGBFormat = ERGBFormat::GrayF;
+				BitDepth = 32;
+				break;
+			default:
+				break;
+			}
+		}
+
+		if (RGBFormat == ERGBFormat::Invalid)
+		{
+			UE_LOG(LogCompushady, Error, TEXT("Unsupported PixelFormat %s for image sequence frame %s"), GPixelFormats[Frame.PixelFormat].Name, *Frame.Filename);
+			return false;
+		}
+
+		TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule->CreateImageWrapper(Format == ECompushadyImageSequenceFormat::PNG ? EImageFormat::PNG : EImageFormat::EXR);
+		if (!ImageWrapper.IsValid())
+		{
+			return false;
+		}
+
+		if (!ImageWrapper->SetRaw(Frame.Data.GetData(), Frame.Data.Num(), Frame.Size.X, Frame.Size.Y, RGBFormat, BitDepth))
+		{
+			return false;
+		}
+
+		return FFileHelper::SaveArrayToFile(ImageWrapper->GetCompressed(), *Frame.Filename);
+	}
+
+	void FrameCompleted(const bool bSuccess)
+	{
+		if (bSuccess)
+		{
+			NumExportedFrames++;
+		}
+		else
+		{
+			NumFailedFrames++;
+		}
+		NumQueuedFrames--;
+		FrameCompletedEvent->Trigger();
+	}
+};
+
+namespace Compushady
+{
+	namespace ImageSequence
+	{
+		void Work(TSharedRef<FCompushadyImageSequenceExporterState, ESPMode::ThreadSafe> State)
+		{
+			for (;;)
+			{
+				TSharedPtr<FCompushadyImageSequenceFrame> Frame;
+				{
+					FScopeLock ScopeLock(&State->Lock);
+					if (!State->Frames.Dequeue(Frame))
+					{
+						State->NumActiveWorkers--;
+						return;
+					}
+				}
+
+				State->FrameCompleted(State->Encode(*Frame));
+			}
+		}
+
+		void Push(TSharedRef<FCompushadyImageSequenceExporterState, ESPMode::ThreadSafe> State, TSharedPtr<FCompushadyImageSequenceFrame> Frame)
+		{
+			bool bSpawnWorker = false;
+			{
+				FScopeLock ScopeLock(&State->Lock);
+				State->Frames.Enqueue(Frame);
+				if (State->NumActiveWorkers < State->NumWorkers)
+				{
+					State->NumActiveWorkers++;
+					bSpawnWorker = true;
+				}
+			}
+
+			if (bSpawnWorker)
+			{
+				AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [State]()
+					{
+						Work(State);
+					});
+			}
+		}
+
+		// maps the completed copies (or all of them when bWait is true) and hands them to the workers
+		void Poll(TSharedRef<FCompushadyImageSequenceExporterState, ESPMode::ThreadSafe> State, FRHICommandListImmediate& RHICmdList, const bool bWait)
+		{
+			if (bWait && State->PendingReadbacks.Num() > 0)
+			{
+				RHICmdList.SubmitCommandsAndFlushGPU();
+				RHICmdList.BlockUntilGPUIdle();
+			}
+
+			// the frames reach the workers in the same order of ExportFrame
+			while (State->PendingReadbacks.Num() > 0 && (bWait || State->PendingReadbacks[0].Readback->IsReady()))
+			{
+				FCompushadyImageSequenceExporterState::FPendingReadback PendingReadback = MoveTemp(State->PendingReadbacks[0]);
+				State->PendingReadbacks.RemoveAt(0);
+
+				FCompushadyImageSequenceFrame& Frame = *PendingReadback.Frame;
+
+				int32 RowPitchInPixels = 0;
+				const uint8* Data = reinterpret_cast<const uint8*>(PendingReadback.Readback->Lock(RowPitchInPixels));
+				if (!Data)
+				{
+					State->FrameCompleted(false);
+					continue;
+				}
+
+				const int64 BlockBytes = GPixelFormats[Frame.PixelFormat].BlockBytes;
+				const int64 SourcePitch = RowPitchInPixels * BlockBytes;
+				const int64 DestPitch = Frame.Size.X * BlockBytes;
+
+				Frame.Data.SetNumUninitialized(DestPitch * Frame.Size.Y);
+
+				if (SourcePitch == DestPitch)
+				{
+					FMemory::Memcpy(Frame.Data.GetData(), Data, DestPitch * Frame.Size.Y);
+				}
+				else
+				{
+					for (int32 Y = 0; Y < Frame.Size.Y; Y++)
+					{
+						FMemory::Memcpy(Frame.Data.GetData() + Y * DestPitch, Data + Y * SourcePitch, DestPitch);
+					}
+				}
+
+				PendingReadback.Readback->Unlock();
+
+				Push(State, PendingReadback.Frame);
+
+				PendingReadback.Frame = nullptr;
+				State->FreeReadbacks.Add(MoveTemp(PendingReadback));
+			}
+		}
+	}
+}
+
+bool UCompushadyImageSequenceExporter::Initialize(const FString& InFilenamePrefix, const ECompushadyImageSequenceFormat InFormat, const ECompushadyImageSequencePolicy InPolicy, const int32 NumWorkers, const int32 MaxQueuedFrames)
+{
+	if (NumWorkers <= 0 || MaxQueuedFrames <= 0)
+	{
+		return false;
+	}
+
+	State = MakeShared<FCompushadyImageSequenceExporterState, ESPMode::ThreadSafe>();
+	State->FilenamePrefix = InFilenamePrefix;
+	State->Format = InFormat;
+	State->Policy = InPolicy;
+	State->NumWorkers = NumWorkers;
+	State->MaxQueuedFrames = MaxQueuedFrames;
+	// the module must be loaded in the game thread
+	State->ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+
+	NextFrameNumber = 0;
+
+	// the copies are polled every tick, so the frames reach the workers without waiting for the next ExportFrame
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([StateRef = State.ToSharedRef()](float DeltaTime)
+		{
+			if (StateRef->NumQueuedFrames > 0)
+			{
+				ENQUEUE_RENDER_COMMAND(DoCompushadyImageSequencePoll)(
+					[StateRef](FRHICommandListImmediate& RHICmdList)
+					{
+						Compushady::ImageSequence::Poll(StateRef, RHICmdList, false);
+					});
+			}
+			return true;
+		}));
+
+	return true;
+}
+
+bool UCompushadyImageSequenceExporter::ExportFrame(UCompushadyResource* FrameResource)
+{
+	if (!State || !FrameResource || !FrameResource->IsValidTexture())
+	{
+		return false;
+	}
+
+	FTextureRHIRef TextureRHIRef = FrameResource->GetTextureRHI();
+	if (TextureRHIRef->GetDesc().Dimension != ETextureDimension::Texture2D)
+	{
+		UE_LOG(LogCompushady, Error, TEXT("Only 2D textures can be exported as image sequence frames"));
+		return false;
+	}
+
+	TSharedRef<FCompushadyImageSequenceExporterState, ESPMode::ThreadSafe> StateRef = State.ToSharedRef();
+	const int32 MaxQueuedFrames = State->MaxQueuedFrames;
+
+	if (State->NumQueuedFrames >= MaxQueuedFrames)
+	{
+		if (State->Policy == ECompushadyImageSequencePolicy::Drop)
+		{
+			State->NumDroppedFrames++;
+			NextFrameNumber++;
+			return false;
+		}
+
+		while (State->NumQueuedFrames >= MaxQueuedFrames)
+		{
+			// the queue could be full of copies waiting for the GPU
+			ENQUEUE_RENDER_COMMAND(DoCompushadyImageSequencePoll)(
+				[StateRef](FRHICommandListImmediate& RHICmdList)
+				{
+					Compushady::ImageSequence::Poll(StateRef, RHICmdList, true);
+				});
+			State->FrameCompletedEvent->Wait();
+		}
+	}
+
+	State->NumQueuedFrames++;
+
+	static const TCHAR* Extensions[] = { TEXT("png"), TEXT("exr"), TEXT("raw") };
+
+	TSharedPtr<FCompushadyImageSequenceFrame> Frame = MakeShared<FCompushadyImageSequenceFrame>();
+	Frame->Filename = FString::Printf(TEXT("%s%06lld.%s"), *State->FilenamePrefix, NextFrameNumber++, Extensions[static_cast<int32>(State->Format)]);
+	Frame->Size = FIntPoint(TextureRHIRef->GetDesc().Extent);
+	Frame->PixelFormat = TextureRHIRef->GetDesc().Format;
+
+	// the render thread only enqueues the copy, it is mapped a few frames later (when its fence is signaled) and encoded by the workers
+	ENQUEUE_RENDER_COMMAND(DoCompushadyImageSequenceReadback)(
+		[StateRef, TextureRHIRef, Frame](FRHICommandListImmediate& RHICmdList)
+		{
+			Compushady::ImageSequence::Poll(StateRef, RHICmdList, false);
+
+			FCompushadyImageSequenceExporterState::FPendingReadback PendingReadback;
+			const int32 FreeReadbackIndex = StateRef->FreeReadbacks.IndexOfByPredicate([&Frame](const FCompushadyImageSequenceExporterState::FPendingReadback& FreeReadback)
+				{
+					return FreeReadback.Size == Frame->Size && FreeReadback.PixelFormat == Frame->PixelFormat;
+				});
+
+			if (FreeReadbackIndex != INDEX_NONE)
+			{
+				PendingReadback = MoveTemp(StateRef->FreeReadbacks[FreeReadbackIndex]);
+				StateRef->FreeReadbacks.RemoveAtSwap(FreeReadbackIndex);
+			}
+			else
+			{
+				PendingReadback.Readback = MakeUnique<FRHIGPUTextureReadback>(TEXT("CompushadyImageSequenceReadback"));
+				PendingReadback.Size = Frame->Size;
+				PendingReadback.PixelFormat = Frame->PixelFormat;
+			}
+
+			RHICmdList.Transition(FRHITransitionInfo(TextureRHIRef, ERHIAccess::Unknown, ERHIAccess::CopySrc));
+			PendingReadback.Readback->EnqueueCopy(RHICmdList, TextureRHIRef);
+			PendingReadback.Frame = Frame;
+
+			StateRef->PendingReadbacks.Add(MoveTemp(PendingReadback));
+		});
+
+	return true;
+}
+
+void UCompushadyImageSequenceExporter::Flush()
+{
+	if (!State)
+	{
+		return;
+	}
+
+	TSharedRef<FCompushadyImageSequenceExporterState, ESPMode::ThreadSafe> StateRef = State.ToSharedRef();
+	ENQUEUE_RENDER_COMMAND(DoCompushadyImageSequencePoll)(
+		[StateRef](FRHICommandListImmediate& RHICmdList)
+		{
+			Compushady::ImageSequence::Poll(StateRef, RHICmdList, true);
+		});
+
+	while (State->NumQueuedFrames > 0)
+	{
+		State->FrameCompletedEvent->Wait();
+	}
+}
+
+int64 UCompushadyImageSequenceExporter::GetNumExportedFrames() const
+{
+	return State ? State->NumExportedFrames.load() : 0;
+}
+
+int64 UCompushadyImageSequenceExporter::GetNumDroppedFrames() const
+{
+	return State ? State->NumDroppedFrames.load() : 0;
+}
+
+int64 UCompushadyImageSequenceExporter::GetNumFailedFrames() const
+{
+	return State ? State->NumFailedFrames.load() : 0;
+}
+
+int32 UCompushadyImageSequenceExporter::GetNumQueuedFrames() const
+{
+	return State ? State->NumQueuedFrames.load() : 0;
+}
+
+void UCompushadyImageSequenceExporter::BeginDestroy()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+	// pending frames keep the state alive, so they will be written even after the UObject is gone
+	if (State)
+	{
+		ENQUEUE_RENDER_COMMAND(DoCompushadyImageSequencePoll)(
+			[StateRef = State.ToSharedRef()](FRHICommandListImmediate& RHICmdList)
+			{
+				Compushady::ImageSequence::Poll(StateRef, RHICmdList, true);
+			});
+	}
+	State = nullptr;
+	Super::BeginDestroy();
+}
@@ -0,0 +1,431 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#include "CompushadyMipGenerator.h"
+#include "Compushady.h"
+#include "CompushadyFunctionLibrary.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace Compushady
+{
+	namespace MipGenerator
+	{
+		const TCHAR* Reduce = TEXT(R"(
+float4 Reduce(float4 A, float4 B, float4 C, float4 D)
+{
+#if REDUCTION == 1
+	return min(min(A, B), min(C, D));
+#elif REDUCTION == 2
+	return max(max(A, B), max(C, D));
+#else
+	return (A + B + C + D) * 0.25;
+#endif
+}
+)");
+
+		const TCHAR* PerMip = TEXT(R"(
+RWTexture2D<float4> Source;
+RWTexture2D<float4> Destination;
+
+[numthreads(8, 8, 1)]
+void main(uint3 DispatchThreadId : SV_DispatchThreadID)
+{
+	uint2 SourceSize;
+	Source.GetDimensions(SourceSize.x, SourceSize.y);
+	uint2 DestinationSize;
+	Destination.GetDimensions(DestinationSize.x, DestinationSize.y);
+
+	if (any(DispatchThreadId.xy >= DestinationSize))
+	{
+		return;
+	}
+
+	const uint2 Last = SourceSize - 1;
+	const uint2 Coord = DispatchThreadId.xy * 2;
+	Destination[DispatchThreadId.xy] = Reduce(Source[min(Coord, Last)], Source[min(Coord + uint2(1, 0), Last)], Source[min(Coord + uint2(0, 1), Last)], Source[min(Coord + uint2(1, 1), Last)]);
+}
+)");
+
+		// mips 1 to 6 are generated by each group (from a 64x64 tile), the last group generates mips 7 to 12 from mip 6.
+		// out of range texels are reduced from clamped loads, so they never introduce values not in the texture.
+		const TCHAR* SinglePass = TEXT(R"(
+cbuffer Constants
+{
+	uint NumMips;
+	uint NumGroups;
+};
+
+RWTexture2D<float4> Mip0;
+RWTexture2D<float4> Mip1;
+RWTexture2D<float4> Mip2;
+RWTexture2D<float4> Mip3;
+RWTexture2D<float4> Mip4;
+RWTexture2D<float4> Mip5;
+globallycoherent RWTexture2D<float4> Mip6;
+RWTexture2D<float4> Mip7;
+RWTexture2D<float4> Mip8;
+RWTexture2D<float4> Mip9;
+RWTexture2D<float4> Mip10;
+RWTexture2D<float4> Mip11;
+RWTexture2D<float4> Mip12;
+globallycoherent RWStructuredBuffer<uint> Counter;
+
+groupshared float4 Tile[32][32];
+groupshared uint bIsLastGroup;
+
+void StoreMip(uint Mip, uint2 Coord, float4 Value)
+{
+	uint2 Mip0Size;
+	Mip0.GetDimensions(Mip0Size.x, Mip0Size.y);
+	if (Mip >= NumMips || any(Coord >= max(Mip0Size >> Mip, 1)))
+	{
+		return;
+	}
+
+	switch (Mip)
+	{
+	case 1: Mip1[Coord] = Value; break;
+	case 2: Mip2[Coord] = Value; break;
+	case 3: Mip3[Coord] = Value; break;
+	case 4: Mip4[Coord] = Value; break;
+	case 5: Mip5[Coord] = Value; break;
+	case 6: Mip6[Coord] = Value; break;
+	case 7: Mip7[Coord] = Value; break;
+	case 8: Mip8[Coord] = Value; break;
+	case 9: Mip9[Coord] = Value; break;
+	case 10: Mip10[Coord] = Value; break;
+	case 11: Mip11[Coord] = Value; break;
+	case 12: Mip12[Coord] = Value; break;
+	}
+}
+
+// reduces the 32x32 tile to 5 more mips (16x16 to 1x1)
+void ReduceTile(uint2 TileCoord, uint LocalIndex, uint FirstMip)
+{
+	[unroll]
+	for (uint Step = 0; Step < 5; Step++)
+	{
+		const uint Size = 16 >> Step;
+		const uint2 Local = uint2(LocalIndex % Size, LocalIndex / Size);
+		const bool bActive = LocalIndex < Size * Size;
+		float4 Value = 0;
+		if (bActive)
+		{
+			const uint2 Coord = Local * 2;
+			Value = Reduce(Tile[Coord.y][Coord.x], Tile[Coord.y][Coord.x + 1], Tile[Coord.y + 1][Coord.x], Tile[Coord.y + 1][Coord.x + 1]);
+			StoreMip(FirstMip + Step, TileCoord * Size + Local, Value);
+		}
+		GroupMemoryBarrierWithGroupSync();
+		if (bActive)
+		{
+			Tile[Local.y][Local.x] = Value;
+		}
+		GroupMemoryBarrierWithGroupSync();
+	}
+}
+
+[numthreads(256, 1, 1)]
+void main(uint3 GroupId : SV_GroupID, uint LocalIndex : SV_GroupIndex)
+{
+	uint2 Mip0Size;
+	Mip0.GetDimensions(Mip0Size.x, Mip0Size.y);
+	const uint2 Mip0Last = Mip0Size - 1;
+
+	for (uint Index = LocalIndex; Index < 32 * 32; Index += 256)
+	{
+		const uint2 Local = uint2(Index % 32, Index / 32);
+		const uint2 Coord = GroupId.xy * 32 + Local;
+		const uint2 SourceCoord = Coord * 2;
+		const float4 Value = Reduce(Mip0[min(SourceCoord, Mip0Last)], Mip0[min(SourceCoord + uint2(1, 0), Mip0Last)], Mip0[min(SourceCoord + uint2(0, 1), Mip0Last)], Mip0[min(SourceCoord + uint2(1, 1), Mip0Last)]);
+		StoreMip(1, Coord, Value);
+		Tile[Local.y][Local.x] = Value;
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	ReduceTile(GroupId.xy, LocalIndex, 2);
+
+	if (NumMips <= 7)
+	{
+		return;
+	}
+
+	// mip 6 must be visible to the last group
+	DeviceMemoryBarrierWithGroupSync();
+
+	if (LocalIndex == 0)
+	{
+		uint PreviousGroups;
+		InterlockedAdd(Counter[0], 1, PreviousGroups);
+		bIsLastGroup = PreviousGroups == NumGroups - 1 ? 1 : 0;
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	if (bIsLastGroup == 0)
+	{
+		return;
+	}
+
+	// ready for the next dispatch
+	if (LocalIndex == 0)
+	{
+		Counter[0] = 0;
+	}
+
+	const uint2 Mip6Last = max(Mip0Size >> 6, 1) - 1;
+	for (uint Index = LocalIndex; Index < 32 * 32; Index += 256)
+	{
+		const uint2 Local = uint2(Index % 32, Index / 32);
+		const uint2 SourceCoord = Local * 2;
+		const float4 Value = Reduce(Mip6[min(SourceCoord, Mip6Last)], Mip6[min(SourceCoord + uint2(1, 0), Mip6Last)], Mip6[min(SourceCoord + uint2(0, 1), Mip6Last)], Mip6[min(SourceCoord + uint2(1, 1), Mip6Last)]);
+		StoreMip(7, Local, Value);
+		Tile[Local.y][Local.x] = Value;
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	ReduceTile(uint2(0, 0), LocalIndex, 8);
+}
+)");
+
+		UCompushadyCompute* CreateCompute(const ECompushadyMipReduction Reduction, const TCHAR* Source, FString& ErrorMessages)
+		{
+			const FString HLSL = FString::Printf(TEXT("#define REDUCTION %d\n%s%s"), static_cast<int32>(Reduction), Reduce, Source);
+			return UCompushadyFunctionLibrary::CreateCompushadyComputeFromHLSLString(HLSL, ErrorMessages);
+		}
+	}
+}
+
+bool UCompushadyMipGenerator::InitMipGenerator(const ECompushadyMipReduction InReduction, FString& ErrorMessages)
+{
+	Reduction = InReduction;
+
+	SinglePassCompute = Compushady::MipGenerator::CreateCompute(Reduction, Compushady::MipGenerator::SinglePass, ErrorMessages);
+	if (!SinglePassCompute)
+	{
+		return false;
+	}
+
+	PerMipCompute = Compushady::MipGenerator::CreateCompute(Reduction, Compushady::MipGenerator::PerMip, ErrorMessages);
+	if (!PerMipCompute)
+	{
+		return false;
+	}
+
+	Counter = NewObject<UCompushadyUAV>(this);
+	Counter->InitializeFromPendingStructuredBuffer(TEXT("CompushadyMipGeneratorCounter"), sizeof(uint32), sizeof(uint32), [](void* Data)
+		{
+			FMemory::Memzero(Data, sizeof(uint32));
+		});
+
+	InitFence(this);
+
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &UCompushadyMipGenerator::PurgeMipChains);
+
+	return true;
+}
+
+void UCompushadyMipGenerator::PurgeMipChains()
+{
+	for (TMap<TWeakObjectPtr<UCompushadyUAV>, FMipChain>::TIterator It = MipChains.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UCompushadyMipGenerator::BeginDestroy()
+{
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	MipChains.Empty();
+
+	Super::BeginDestroy();
+}
+
+const UCompushadyMipGenerator::FMipChain* UCompushadyMipGenerator::GetMipChain(UCompushadyUAV* UAV, FString& ErrorMessages)
+{
+	if (!UAV || !UAV->IsValidTexture())
+	{
+		ErrorMessages = "Invalid UAV Texture";
+		return nullptr;
+	}
+
+	FTextureRHIRef TextureRHIRef = UAV->GetTextureRHI();
+	if (TextureRHIRef->GetDesc().Dimension != ETextureDimension::Texture2D)
+	{
+		ErrorMessages = "Only 2D Textures are supported";
+		return nullptr;
+	}
+
+	if (TextureRHIRef->GetNumMips() < 2)
+	{
+		ErrorMessages = "The Texture has no mips";
+		return nullptr;
+	}
+
+	PurgeMipChains();
+
+	if (const FMipChain* MipChain = MipChains.Find(UAV))
+	{
+		return MipChain;
+	}
+
+	FMipChain MipChain;
+	for (int32 MipLevel = 0; MipLevel < static_cast<int32>(TextureRHIRef->GetNumMips()); MipLevel++)
+	{
+		UCompushadyUAV* MipUAV = NewObject<UCompushadyUAV>(this);
+		if (!MipUAV->InitializeFromTextureMip(TextureRHIRef, MipLevel))
+		{
+			ErrorMessages = FString::Printf(TEXT("Unable to create UAV for mip %d"), MipLevel);
+			return nullptr;
+		}
+		MipChain.Mips.Add(TStrongObjectPtr<UCompushadyUAV>(MipUAV));
+	}
+
+	if (CanUseSinglePass(MipChain))
+	{
+		const FIntVector Size = UAV->GetTextureSize();
+		UCompushadyCBV* Constants = UCompushadyFunctionLibrary::CreateCompushadyCBV(TEXT("CompushadyMipGeneratorConstants"), sizeof(uint32) * 2);
+		Constants->SetUInt(0, static_cast<uint32>(MipChain.Mips.Num()));
+		Constants->SetUInt(sizeof(uint32), static_cast<uint32>(FMath::DivideAndRoundUp(Size.X, 64) * FMath::DivideAndRoundUp(Size.Y, 64)));
+		MipChain.Constants = TStrongObjectPtr<UCompushadyCBV>(Constants);
+	}
+
+	return &MipChains.Add(UAV, MoveTemp(MipChain));
+}
+
+bool UCompushadyMipGenerator::CanUseSinglePass(const FMipChain& MipChain) const
+{
+	return MipChain.Mips.Num() <= MaxSinglePassMips && MipChain.Mips[0]->GetTextureSize().X <= 4096 && MipChain.Mips[0]->GetTextureSize().Y <= 4096;
+}
+
+TFunction<void(FRHICommandListImmediate&)> UCompushadyMipGenerator::GetGenerateFunction(UCompushadyUAV* UAV, const bool bPerMip, FString& ErrorMessages)
+{
+	const FMipChain* MipChain = GetMipChain(UAV, ErrorMessages);
+	if (!MipChain)
+	{
+		return nullptr;
+	}
+
+	TrackResource(UAV);
+
+	if (!bPerMip && CanUseSinglePass(*MipChain))
+	{
+		// the bindings are resolved by name, the mips not in the texture are never written (but must be bound)
+		FCompushadyResourceArray ResourceArray;
+		ResourceArray.CBVs.Add(MipChain->Constants.Get());
+		for (const FCompushadyResourceBinding& Binding : SinglePassCompute->ResourceBindings.UAVs)
+		{
+			if (Binding.Name == TEXT("Counter"))
+			{
+				ResourceArray.UAVs.Add(Counter);
+			}
+			else
+			{
+				const int32 MipLevel = FCString::Atoi(*Binding.Name.RightChop(3));
+				ResourceArray.UAVs.Add(MipChain->Mips[FMath::Min(MipLevel, MipChain->Mips.Num() - 1)].Get());
+			}
+		}
+
+		FString ValidationErrorMessages;
+		if (!Compushady::Utils::ValidateResourceBindings(ResourceArray, SinglePassCompute->ResourceBindings, ValidationErrorMessages))
+		{
+			ErrorMessages = ValidationErrorMessages;
+			return nullptr;
+		}
+
+		const FIntVector Size = UAV->GetTextureSize();
+		const FIntVector XYZ(FMath::DivideAndRoundUp(Size.X, 64), FMath::DivideAndRoundUp(Size.Y, 64), 1);
+
+		return [this, ResourceArray = Compushady::Utils::SnapshotResourceArray(ResourceArray), XYZ](FRHICommandListImmediate& RHICmdList)
+			{
+				FComputeShaderRHIRef ComputeShaderRef = SinglePassCompute->GetRHI();
+				SetComputePipelineState(RHICmdList, ComputeShaderRef);
+				Compushady::Utils::SetupPipelineParameters(RHICmdList, ComputeShaderRef, ResourceArray, SinglePassCompute->ResourceBindings);
+				RHICmdList.DispatchComputeShader(XYZ.X, XYZ.Y, XYZ.Z);
+			};
+	}
+
+	TArray<FCompushadyResourceArray> ResourceArrays;
+	TArray<FIntVector> Dispatches;
+	const FIntVector Size = UAV->GetTextureSize();
+	for (int32 MipLevel = 1; MipLevel < MipChain->Mips.Num(); MipLevel++)
+	{
+		FCompushadyResourceArray ResourceArray;
+		for (const FCompushadyResourceBinding& Binding : PerMipCompute->ResourceBindings.UAVs)
+		{
+			ResourceArray.UAVs.Add(MipChain->Mips[Binding.Name == TEXT("Source") ? MipLevel - 1 : MipLevel].Get());
+		}
+		ResourceArrays.Add(ResourceArray);
+		Dispatches.Add(FIntVector(FMath::DivideAndRoundUp(FMath::Max(Size.X >> MipLevel, 1), 8), FMath::DivideAndRoundUp(FMath::Max(Size.Y >> MipLevel, 1), 8), 1));
+	}
+
+	return [this, ResourceArrays, Dispatches](FRHICommandListImmediate& RHICmdList)
+		{
+			FComputeShaderRHIRef ComputeShaderRef = PerMipCompute->GetRHI();
+			SetComputePipelineState(RHICmdList, ComputeShaderRef);
+			for (int32 Index = 0; Index < ResourceArrays.Num(); Index++)
+			{
+				// the UAV transitions between the dispatches act as barriers
+				Compushady::Utils::SetupPipelineParameters(RHICmdList, ComputeShaderRef, ResourceArrays[Index], PerMipCompute->ResourceBindings);
+				RHICmdList.DispatchComputeShader(Dispatches[Index].X, Dispatches[Index].Y, Dispatches[Index].Z);
+			}
+		};
+}
+
+void UCompushadyMipGenerator::GenerateMips(UCompushadyUAV* UAV, const FCompushadySignaled& OnSignaled)
+{
+	FString ErrorMessages;
+	TFunction<void(FRHICommandListImmediate&)> Function = GetGenerateFunction(UAV, false, ErrorMessages);
+	if (!Function)
+	{
+		OnSignaled.ExecuteIfBound(false, ErrorMessages);
+		return;
+	}
+
+	EnqueueToGPU(Function, OnSignaled);
+}
+
+void UCompushadyMipGenerator::GenerateMipsPerMip(UCompushadyUAV* UAV, const FCompushadySignaled& OnSignaled)
+{
+	FString ErrorMessages;
+	TFunction<void(FRHICommandListImmediate&)> Function = GetGenerateFunction(UAV, true, ErrorMessages);
+	if (!Function)
+	{
+		OnSignaled.ExecuteIfBound(false, ErrorMessages);
+		return;
+	}
+
+	EnqueueToGPU(Function, OnSignaled);
+}
+
+bool UCompushadyMipGenerator::GenerateMipsSync(UCompushadyUAV* UAV, const bool bPerMip)
+{
+	FString ErrorMessages;
+	TFunction<void(FRHICommandListImmediate&)> Function = GetGenerateFunction(UAV, bPerMip, ErrorMessages);
+	if (!Function)
+	{
+		UE_LOG(LogCompushady, Error, TEXT("%s"), *ErrorMessages);
+		return false;
+	}
+
+	EnqueueToGPUSync([this, Function](FRHICommandListImmediate& RHICmdList)
+		{
+			Function(RHICmdList);
+			WaitForGPU(RHICmdList);
+		});
+
+	UntrackResources();
+
+	return true;
+}
+
+bool UCompushadyMipGenerator::IsRunning() const
+{
+	return ICompushadySignalable::IsRunning();
+}
+
+ECompushadyMipReduction UCompushadyMipGenerator::GetReduction() const
+{
+	return Reduction;
+}
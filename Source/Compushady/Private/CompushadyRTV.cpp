@@ -2,6 +2,7 @@
 
 
 #include "CompushadyRTV.h"
+#include "TextureResource.h"
 
 bool UCompushadyRTV::InitializeFromTexture(FTextureRHIRef InTextureRHIRef)
 {
@@ -22,6 +23,37 @@ bool UCompushadyRTV::InitializeFromTexture(FTextureRHIRef InTextureRHIRef)
 	return true;
 }
 
+bool UCompushadyRTV::InitializeFromTextureResource(FTextureResource* InTextureResource)
+{
+	if (!InTextureResource)
+	{
+		return false;
+	}
+
+	const FName OwnerName = *GetPathName();
+
+	EnqueueCreation(
+		[this, InTextureResource, OwnerName](FRHICommandListImmediate& RHICmdList)
+		{
+			TextureRHIRef = InTextureResource->GetTextureRHI();
+			if (!TextureRHIRef)
+			{
+				UE_LOG(LogCompushady, Error, TEXT("Texture Resource not available"));
+				bCreationFailed = true;
+				return;
+			}
+
+			if (TextureRHIRef->GetOwnerName() == NAME_None)
+			{
+				TextureRHIRef->SetOwnerName(OwnerName);
+			}
+
+			RHITransitionInfo = FRHITransitionInfo(TextureRHIRef, ERHIAccess::Unknown, ERHIAccess::RTV);
+		});
+
+	return true;
+}
+
 void UCompushadyRTV::Clear(FLinearColor Color, const FCompushadySignaled& OnSignaled)
 {
 	if (IsRunning())
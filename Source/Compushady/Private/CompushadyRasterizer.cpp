@@ -4,8 +4,121 @@
 #include "CompushadyRasterizer.h"
 #include "CommonRenderResources.h"
 #include "Compushady.h"
+#include "PipelineStateCache.h"
 #include "Serialization/ArrayWriter.h"
 
+namespace Compushady
+{
+	namespace Rasterizer
+	{
+		// viewport, scissor and stencil reference, resolved in the game thread
+		struct FRasterizeState
+		{
+			FVector3f ViewportMin = FVector3f::ZeroVector;
+			FVector3f ViewportMax = FVector3f::ZeroVector;
+			bool bScissor = false;
+			FIntRect ScissorRect;
+			uint32 StencilRef = 0;
+		};
+
+		bool GetRasterizeState(const FCompushadyRasterizeConfig& RasterizeConfig, const FIntVector RenderTargetSize, FRasterizeState& RasterizeState, FString& ErrorMessages)
+		{
+			if (RasterizeConfig.Viewport.IsValid)
+			{
+				RasterizeState.ViewportMin = FVector3f(RasterizeConfig.Viewport.Min);
+				RasterizeState.ViewportMax = FVector3f(RasterizeConfig.Viewport.Max);
+				if (RasterizeState.ViewportMax.X <= RasterizeState.ViewportMin.X || RasterizeState.ViewportMax.Y <= RasterizeState.ViewportMin.Y)
+				{
+					ErrorMessages = FString::Printf(TEXT("Invalid Viewport %s"), *RasterizeConfig.Viewport.ToString());
+					return false;
+				}
+			}
+			else
+			{
+				RasterizeState.ViewportMin = FVector3f(0, 0, 0);
+				RasterizeState.ViewportMax = FVector3f(RenderTargetSize.X, RenderTargetSize.Y, 1);
+			}
+
+			RasterizeState.bScissor = RasterizeConfig.Scissor.bIsValid;
+			if (RasterizeState.bScissor)
+			{
+				RasterizeState.ScissorRect = FIntRect(
+					FMath::FloorToInt32(RasterizeConfig.Scissor.Min.X), FMath::FloorToInt32(RasterizeConfig.Scissor.Min.Y),
+					FMath::CeilToInt32(RasterizeConfig.Scissor.Max.X), FMath::CeilToInt32(RasterizeConfig.Scissor.Max.Y));
+			}
+
+			RasterizeState.StencilRef = static_cast<uint32>(RasterizeConfig.StencilValue);
+
+			return true;
+		}
+
+		// the per-draw constants replace the first bytes of the first CBV (for the current draw only)
+		bool SetDrawConstants(FCompushadyResourceArray& ResourceArray, const TArray<uint8>& Constants, FString& ErrorMessages)
+		{
+			if (Constants.Num() == 0 || ResourceArray.CBVs.Num() == 0)
+			{
+				return true;
+			}
+
+			const TArray<uint8>& BufferData = ResourceArray.CBVSnapshots.IsValidIndex(0) && ResourceArray.CBVSnapshots[0].IsValid() ? *ResourceArray.CBVSnapshots[0] : ResourceArray.CBVs[0]->GetBufferData();
+			if (Constants.Num() > BufferData.Num())
+			{
+				ErrorMessages = FString::Printf(TEXT("Draw constants (%d bytes) do not fit in the CBV (%d bytes)"), Constants.Num(), BufferData.Num());
+				return false;
+			}
+
+			TSharedRef<TArray<uint8>, ESPMode::ThreadSafe> DrawBufferData = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(BufferData);
+			FMemory::Memcpy(DrawBufferData->GetData(), Constants.GetData(), Constants.Num());
+
+			if (ResourceArray.CBVSnapshots.Num() < ResourceArray.CBVs.Num())
+			{
+				ResourceArray.CBVSnapshots.SetNum(ResourceArray.CBVs.Num());
+			}
+			ResourceArray.CBVSnapshots[0] = DrawBufferData;
+
+			return true;
+		}
+
+		template<bool bDepthWrite>
+		FRHIDepthStencilState* GetDepthStencilState(const ECompushadyRasterizerDepthCompare DepthCompare)
+		{
+			switch (DepthCompare)
+			{
+			case(ECompushadyRasterizerDepthCompare::Never):
+				return TStaticDepthStencilState<bDepthWrite, CF_Never>::GetRHI();
+			case(ECompushadyRasterizerDepthCompare::Less):
+				return TStaticDepthStencilState<bDepthWrite, CF_Less>::GetRHI();
+			case(ECompushadyRasterizerDepthCompare::LessEqual):
+				return TStaticDepthStencilState<bDepthWrite, CF_LessEqual>::GetRHI();
+			case(ECompushadyRasterizerDepthCompare::Greater):
+				return TStaticDepthStencilState<bDepthWrite, CF_Greater>::GetRHI();
+			case(ECompushadyRasterizerDepthCompare::GreaterEqual):
+				return TStaticDepthStencilState<bDepthWrite, CF_GreaterEqual>::GetRHI();
+			case(ECompushadyRasterizerDepthCompare::Equal):
+				return TStaticDepthStencilState<bDepthWrite, CF_Equal>::GetRHI();
+			case(ECompushadyRasterizerDepthCompare::NotEqual):
+				return TStaticDepthStencilState<bDepthWrite, CF_NotEqual>::GetRHI();
+			default:
+				break;
+			}
+			return TStaticDepthStencilState<bDepthWrite, CF_Always>::GetRHI();
+		}
+
+		void SetRasterizeState(FRHICommandList& RHICmdList, const FRasterizeState& RasterizeState)
+		{
+			RHICmdList.SetViewport(RasterizeState.ViewportMin.X, RasterizeState.ViewportMin.Y, RasterizeState.ViewportMin.Z, RasterizeState.ViewportMax.X, RasterizeState.ViewportMax.Y, RasterizeState.ViewportMax.Z);
+			if (RasterizeState.bScissor)
+			{
+				RHICmdList.SetScissorRect(true, RasterizeState.ScissorRect.Min.X, RasterizeState.ScissorRect.Min.Y, RasterizeState.ScissorRect.Max.X, RasterizeState.ScissorRect.Max.Y);
+			}
+			else
+			{
+				RHICmdList.SetScissorRect(false, 0, 0, 0, 0);
+			}
+		}
+	}
+}
+
 bool UCompushadyRasterizer::InitVSPSFromHLSL(const TArray<uint8>& VertexShaderCode, const FString& VertexShaderEntryPoint, const TArray<uint8>& PixelShaderCode, const FString& PixelShaderEntryPoint, const FCompushadyRasterizerConfig& RasterizerConfig, FString& ErrorMessages)
 {
 	RHIInterfaceType = RHIGetInterfaceType();
@@ -49,18 +162,80 @@ bool UCompushadyRasterizer::InitMSPSFromHLSL(const TArray<uint8>& MeshShaderCode
 		return false;
 	}
 
+	// a previous amplification stage must not be bound to the new pipeline
+	AmplificationShaderRef.SafeRelease();
+	ASResourceBindings = FCompushadyResourceBindings();
+
 	return CreateMSPSRasterizerPipeline(MeshShaderByteCode, PixelShaderByteCode, MeshShaderResourceBindings, PixelShaderResourceBindings, RasterizerConfig, ErrorMessages);
 }
 
-bool UCompushadyRasterizer::CreateVSPSRasterizerPipeline(TArray<uint8>& VertexShaderByteCode, TArray<uint8>& PixelShaderByteCode, Compushady::FCompushadyShaderResourceBindings VertexShaderResourceBindings, Compushady::FCompushadyShaderResourceBindings PixelShaderResourceBindings, const FCompushadyRasterizerConfig& RasterizerConfig, FString& ErrorMessages)
+bool UCompushadyRasterizer::InitASMSPSFromHLSL(const TArray<uint8>& AmplificationShaderCode, const FString& AmplificationShaderEntryPoint, const TArray<uint8>& MeshShaderCode, const FString& MeshShaderEntryPoint, const TArray<uint8>& PixelShaderCode, const FString& PixelShaderEntryPoint, const FCompushadyRasterizerConfig& RasterizerConfig, FString& ErrorMessages)
 {
-	// check for semantics
-	if (VertexShaderResourceBindings.InputSemantics.Num() > 0)
+	RHIInterfaceType = RHIGetInterfaceType();
+
+	FIntVector ThreadGroupSize;
+
+	TArray<uint8> AmplificationShaderByteCode;
+	Compushady::FCompushadyShaderResourceBindings AmplificationShaderResourceBindings;
+	if (!Compushady::CompileHLSL(AmplificationShaderCode, AmplificationShaderEntryPoint, "as_6_5", AmplificationShaderByteCode, AmplificationShaderResourceBindings, ThreadGroupSize, ErrorMessages))
 	{
-		ErrorMessages = FString::Printf(TEXT("Unsupported input semantic in vertex shader: %s/%d"), *(VertexShaderResourceBindings.InputSemantics[0]).Name, VertexShaderResourceBindings.InputSemantics[0].Index);
 		return false;
 	}
 
+	TArray<uint8> MeshShaderByteCode;
+	Compushady::FCompushadyShaderResourceBindings MeshShaderResourceBindings;
+	if (!Compushady::CompileHLSL(MeshShaderCode, MeshShaderEntryPoint, "ms_6_5", MeshShaderByteCode, MeshShaderResourceBindings, ThreadGroupSize, ErrorMessages))
+	{
+		return false;
+	}
+
+	TArray<uint8> PixelShaderByteCode;
+	Compushady::FCompushadyShaderResourceBindings PixelShaderResourceBindings;
+	if (!Compushady::CompileHLSL(PixelShaderCode, PixelShaderEntryPoint, "ps_6_0", PixelShaderByteCode, PixelShaderResourceBindings, ThreadGroupSize, ErrorMessages))
+	{
+		return false;
+	}
+
+	if (!CreateAmplificationShader(AmplificationShaderByteCode, AmplificationShaderResourceBindings, ErrorMessages))
+	{
+		return false;
+	}
+
+	return CreateMSPSRasterizerPipeline(MeshShaderByteCode, PixelShaderByteCode, MeshShaderResourceBindings, PixelShaderResourceBindings, RasterizerConfig, ErrorMessages);
+}
+
+bool UCompushadyRasterizer::CreateVSPSRasterizerPipeline(TArray<uint8>& VertexShaderByteCode, TArray<uint8>& PixelShaderByteCode, Compushady::FCompushadyShaderResourceBindings VertexShaderResourceBindings, Compushady::FCompushadyShaderResourceBindings PixelShaderResourceBindings, const FCompushadyRasterizerConfig& RasterizerConfig, FString& ErrorMessages)
+{
+	// check for semantics (the RHIs bind the vertex declaration elements to the ATTRIBUTE<AttributeIndex> inputs)
+	FVertexDeclarationElementList VertexShaderElements;
+	for (const Compushady::FCompushadyShaderSemantic& Semantic : VertexShaderResourceBindings.InputSemantics)
+	{
+		if (!Semantic.Name.Equals(TEXT("ATTRIBUTE"), ESearchCase::IgnoreCase) || Semantic.Index >= MaxVertexElementCount)
+		{
+			ErrorMessages = FString::Printf(TEXT("Unsupported input semantic in vertex shader: %s/%d (only ATTRIBUTE0-%d are supported)"), *Semantic.Name, Semantic.Index, MaxVertexElementCount - 1);
+			return false;
+		}
+
+		const uint32 NumComponents = FMath::CountBits(Semantic.Mask);
+		EVertexElementType VertexElementType = VET_None;
+		if (Semantic.bInteger)
+		{
+			VertexElementType = NumComponents == 1 ? VET_UInt : VET_None;
+		}
+		else if (NumComponents >= 1 && NumComponents <= 4)
+		{
+			VertexElementType = static_cast<EVertexElementType>(VET_Float1 + NumComponents - 1);
+		}
+
+		if (VertexElementType == VET_None)
+		{
+			ErrorMessages = FString::Printf(TEXT("Unsupported vertex shader input type for %s/%d (only float1-4 and uint are supported)"), *Semantic.Name, Semantic.Index);
+			return false;
+		}
+
+		VertexShaderElements.Add(FVertexElement(static_cast<uint8>(Semantic.Index), 0, VertexElementType, static_cast<uint8>(Semantic.Index), static_cast<uint16>(NumComponents * sizeof(uint32))));
+	}
+
 	for (const Compushady::FCompushadyShaderSemantic& Semantic : PixelShaderResourceBindings.InputSemantics)
 	{
 		if (!VertexShaderResourceBindings.OutputSemantics.Contains(Semantic))
@@ -116,7 +291,8 @@ bool UCompushadyRasterizer::CreateVSPSRasterizerPipeline(TArray<uint8>& VertexSh
 
 	FillPipelineStateInitializer(RasterizerConfig);
 
-	PipelineStateInitializer.BoundShaderState.VertexDeclarationRHI = GEmptyVertexDeclaration.VertexDeclarationRHI;
+	VertexDeclarationElements = VertexShaderElements;
+	PipelineStateInitializer.BoundShaderState.VertexDeclarationRHI = VertexDeclarationElements.Num() > 0 ? PipelineStateCache::GetOrCreateVertexDeclaration(VertexDeclarationElements) : GEmptyVertexDeclaration.VertexDeclarationRHI;
 	PipelineStateInitializer.BoundShaderState.VertexShaderRHI = VertexShaderRef;
 	PipelineStateInitializer.BoundShaderState.PixelShaderRHI = PixelShaderRef;
 
@@ -158,13 +334,60 @@ void UCompushadyRasterizer::FillPipelineStateInitializer(const FCompushadyRaster
 		}
 	}
 
-	PipelineStateInitializer.DepthStencilState = TStaticDepthStencilState<false, CF_Always>::GetRHI();
+	// without depth test the depth is always written (when enabled)
+	const ECompushadyRasterizerDepthCompare DepthCompare = RasterizerConfig.bDepthTest ? RasterizerConfig.DepthCompare : ECompushadyRasterizerDepthCompare::Always;
+	PipelineStateInitializer.DepthStencilState = RasterizerConfig.bDepthWrite ? Compushady::Rasterizer::GetDepthStencilState<true>(DepthCompare) : Compushady::Rasterizer::GetDepthStencilState<false>(DepthCompare);
+	bDepthEnabled = RasterizerConfig.bDepthTest || RasterizerConfig.bDepthWrite;
 	PipelineStateInitializer.BlendState = TStaticBlendState<>::GetRHI();
 	PipelineStateInitializer.PrimitiveType = PT_TriangleList;
+
+	// the cached initializers are copies of the old one
+	PipelineStateInitializers.Empty();
+}
+
+bool UCompushadyRasterizer::CreateAmplificationShader(TArray<uint8>& AmplificationShaderByteCode, Compushady::FCompushadyShaderResourceBindings AmplificationShaderResourceBindings, FString& ErrorMessages)
+{
+	// the payload for the mesh shader is not a semantic, so the amplification shader has neither inputs nor outputs
+	if (AmplificationShaderResourceBindings.InputSemantics.Num() > 0)
+	{
+		ErrorMessages = FString::Printf(TEXT("Unsupported input semantic in amplification shader: %s/%d"), *(AmplificationShaderResourceBindings.InputSemantics[0]).Name, AmplificationShaderResourceBindings.InputSemantics[0].Index);
+		return false;
+	}
+
+	if (!Compushady::Utils::CreateResourceBindings(AmplificationShaderResourceBindings, ASResourceBindings, ErrorMessages))
+	{
+		return false;
+	}
+
+	TArray<uint8> ASByteCode;
+	FSHAHash ASHash;
+	if (!Compushady::ToUnrealShader(AmplificationShaderByteCode, ASByteCode, ASResourceBindings.NumCBVs, ASResourceBindings.NumSRVs, ASResourceBindings.NumUAVs, ASResourceBindings.NumSamplers, ASHash))
+	{
+		ErrorMessages = "Unable to add Unreal metadata to the amplification shader";
+		return false;
+	}
+
+	AmplificationShaderRef = RHICreateAmplificationShader(ASByteCode, ASHash);
+	if (!AmplificationShaderRef.IsValid() || !AmplificationShaderRef->IsValid())
+	{
+		ErrorMessages = "Unable to create Amplification Shader";
+		return false;
+	}
+
+	AmplificationShaderRef->SetHash(ASHash);
+
+	return true;
 }
 
 bool UCompushadyRasterizer::CreateMSPSRasterizerPipeline(TArray<uint8>& MeshShaderByteCode, TArray<uint8>& PixelShaderByteCode, Compushady::FCompushadyShaderResourceBindings MeshShaderResourceBindings, Compushady::FCompushadyShaderResourceBindings PixelShaderResourceBindings, const FCompushadyRasterizerConfig& RasterizerConfig, FString& ErrorMessages)
 {
+	// the mesh dispatches have no DSV
+	if (RasterizerConfig.bDepthTest || RasterizerConfig.bDepthWrite)
+	{
+		ErrorMessages = "Depth test/write is not supported by mesh shader Rasterizers";
+		return false;
+	}
+
 	// check for semantics
 	if (MeshShaderResourceBindings.InputSemantics.Num() > 0)
 	{
@@ -229,6 +452,7 @@ bool UCompushadyRasterizer::CreateMSPSRasterizerPipeline(TArray<uint8>& MeshShad
 
 	PipelineStateInitializer.BoundShaderState.VertexDeclarationRHI = nullptr;
 	PipelineStateInitializer.BoundShaderState.SetMeshShader(MeshShaderRef);
+	PipelineStateInitializer.BoundShaderState.SetAmplificationShader(AmplificationShaderRef);
 	PipelineStateInitializer.BoundShaderState.PixelShaderRHI = PixelShaderRef;
 
 	InitFence(this);
@@ -236,11 +460,11 @@ bool UCompushadyRasterizer::CreateMSPSRasterizerPipeline(TArray<uint8>& MeshShad
 	return true;
 }
 
-void UCompushadyRasterizer::Draw(const FCompushadyResourceArray& VSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, const int32 NumVertices, const int32 NumInstances, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled)
+void UCompushadyRasterizer::Draw(const FCompushadyResourceArray& VSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, const int32 NumVertices, const int32 NumInstances, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig)
 {
-	if (IsRunning())
+	if (!VertexShaderRef.IsValid())
 	{
-		OnSignaled.ExecuteIfBound(false, "The Rasterizer is already running");
+		OnSignaled.ExecuteIfBound(false, "The Rasterizer has no Vertex Shader");
 		return;
 	}
 
@@ -256,72 +480,309 @@ void UCompushadyRasterizer::Draw(const FCompushadyResourceArray& VSResourceArray
 		return;
 	}
 
-	if (RTVs.Num() < 1 || RTVs.Num() > 8)
+	EnqueueDraw(VSResourceArray, PSResourceArray, RTVs, DSV, bClearColor, bClearDepthStencil, OnSignaled, RasterizeConfig, {},
+		[NumVertices, NumInstances](FRHICommandListImmediate& RHICmdList)
+		{
+			RHICmdList.DrawPrimitive(0, NumVertices / 3, NumInstances);
+		}, NumVertices);
+}
+
+void UCompushadyRasterizer::DrawBatch(const TArray<FCompushadyRasterizerDraw>& Draws, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig)
+{
+	if (!VertexShaderRef.IsValid())
 	{
-		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid number of RTVs %d"), RTVs.Num()));
+		OnSignaled.ExecuteIfBound(false, "The Rasterizer has no Vertex Shader");
 		return;
 	}
 
-	if (!CheckResourceBindings(VSResourceArray, VSResourceBindings, OnSignaled))
+	if (Draws.Num() == 0)
 	{
+		OnSignaled.ExecuteIfBound(false, "Empty Draws batch");
 		return;
 	}
 
-	if (!CheckResourceBindings(PSResourceArray, PSResourceBindings, OnSignaled))
+	TArray<FRenderPassDraw> RenderPassDraws;
+	TArray<TPair<UCompushadyResource*, ERHIAccess>> Buffers;
+	for (int32 DrawIndex = 0; DrawIndex < Draws.Num(); DrawIndex++)
+	{
+		const FCompushadyRasterizerDraw& Draw = Draws[DrawIndex];
+		if (Draw.NumInstances <= 0)
+		{
+			OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid number of instances %d for draw %d"), Draw.NumInstances, DrawIndex));
+			return;
+		}
+
+		FRenderPassDraw& RenderPassDraw = RenderPassDraws.AddDefaulted_GetRef();
+		RenderPassDraw.VSOrMSResourceArray = Draw.VSResourceArray;
+		RenderPassDraw.PSResourceArray = Draw.PSResourceArray;
+		RenderPassDraw.VSOrMSConstants = Draw.VSConstants;
+		RenderPassDraw.PSConstants = Draw.PSConstants;
+
+		if (Draw.IndexBuffer)
+		{
+			if (Draw.NumIndices <= 0 || Draw.FirstIndex < 0)
+			{
+				OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid number of indices %d or first index %d for draw %d"), Draw.NumIndices, Draw.FirstIndex, DrawIndex));
+				return;
+			}
+
+			if (!CheckBuffer(TEXT("IndexBuffer"), Draw.IndexBuffer, EBufferUsageFlags::IndexBuffer, 0, 0, OnSignaled))
+			{
+				return;
+			}
+
+			FBufferRHIRef IndexBufferRHIRef = Draw.IndexBuffer->GetBufferRHI();
+			if ((static_cast<int64>(Draw.FirstIndex) + Draw.NumIndices) * IndexBufferRHIRef->GetStride() > Draw.IndexBuffer->GetBufferSize())
+			{
+				OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("IndexBuffer is too small for %d indices starting at %d (draw %d)"), Draw.NumIndices, Draw.FirstIndex, DrawIndex));
+				return;
+			}
+
+			Buffers.AddUnique({ Draw.IndexBuffer, ERHIAccess::VertexOrIndexBuffer });
+			RenderPassDraw.DrawFunction = [IndexBufferRHIRef, NumIndices = Draw.NumIndices, FirstIndex = Draw.FirstIndex, BaseVertex = Draw.BaseVertex, NumInstances = Draw.NumInstances](FRHICommandListImmediate& RHICmdList)
+				{
+					RHICmdList.DrawIndexedPrimitive(IndexBufferRHIRef, BaseVertex, 0, 0, FirstIndex, NumIndices / 3, NumInstances);
+				};
+		}
+		else
+		{
+			if (Draw.NumVertices <= 0)
+			{
+				OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid number of vertices %d for draw %d"), Draw.NumVertices, DrawIndex));
+				return;
+			}
+
+			RenderPassDraw.NumVertices = Draw.NumVertices;
+			RenderPassDraw.DrawFunction = [NumVertices = Draw.NumVertices, NumInstances = Draw.NumInstances](FRHICommandListImmediate& RHICmdList)
+				{
+					RHICmdList.DrawPrimitive(0, NumVertices / 3, NumInstances);
+				};
+		}
+	}
+
+	EnqueueRenderPass(RenderPassDraws, RTVs, DSV, bClearColor, bClearDepthStencil, OnSignaled, RasterizeConfig, Buffers);
+}
+
+void UCompushadyRasterizer::DrawIndexed(const FCompushadyResourceArray& VSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, UCompushadyResource* IndexBuffer, const int32 NumIndices, const int32 NumInstances, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig)
+{
+	if (!VertexShaderRef.IsValid())
 	{
+		OnSignaled.ExecuteIfBound(false, "The Rasterizer has no Vertex Shader");
 		return;
 	}
 
-	TStaticArray<FRHITexture*, 8> RenderTargets = {};
-	uint32 RenderTargetsEnabled = 0;
-	//PipelineStateInitializer.RenderTargetsEnabled = 0;
-	for (int32 Index = 0; Index < RTVs.Num(); Index++)
+	if (NumIndices <= 0)
 	{
-		RenderTargets[Index] = RTVs[Index]->GetTextureRHI();
-		RenderTargetsEnabled++;
-		//PipelineStateInitializer.RenderTargetsEnabled++;
-		//PipelineStateInitializer.RenderTargetFormats[Index] = RTVs[Index]->GetTexturePixelFormat();
-		TrackResource(RTVs[Index]);
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid number of indices %d"), NumIndices));
+		return;
 	}
 
-	TrackResources(VSResourceArray);
-	TrackResources(PSResourceArray);
+	if (NumInstances <= 0)
+	{
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid number of instances %d"), NumInstances));
+		return;
+	}
 
-	EnqueueToGPU(
-		[this, NumVertices, NumInstances, VSResourceArray, PSResourceArray, RenderTargets, RenderTargetsEnabled, bClearColor, bClearDepthStencil](FRHICommandListImmediate& RHICmdList)
+	if (!CheckBuffer(TEXT("IndexBuffer"), IndexBuffer, EBufferUsageFlags::IndexBuffer, 0, 0, OnSignaled))
+	{
+		return;
+	}
+
+	FBufferRHIRef IndexBufferRHIRef = IndexBuffer->GetBufferRHI();
+	if (static_cast<int64>(NumIndices) * IndexBufferRHIRef->GetStride() > IndexBuffer->GetBufferSize())
+	{
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("IndexBuffer is too small for %d indices"), NumIndices));
+		return;
+	}
+
+	EnqueueDraw(VSResourceArray, PSResourceArray, RTVs, DSV, bClearColor, bClearDepthStencil, OnSignaled, RasterizeConfig, { {IndexBuffer, ERHIAccess::VertexOrIndexBuffer} },
+		[IndexBufferRHIRef, NumIndices, NumInstances](FRHICommandListImmediate& RHICmdList)
 		{
-			for (uint32 RenderTargetIndex = 0; RenderTargetIndex < RenderTargetsEnabled; RenderTargetIndex++)
+			RHICmdList.DrawIndexedPrimitive(IndexBufferRHIRef, 0, 0, 0, 0, NumIndices / 3, NumInstances);
+		});
+}
+
+void UCompushadyRasterizer::DrawIndirect(const FCompushadyResourceArray& VSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, UCompushadyResource* ArgumentsBuffer, const int64 ArgumentsOffset, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig)
+{
+	if (!VertexShaderRef.IsValid())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Rasterizer has no Vertex Shader");
+		return;
+	}
+
+	if (!CheckBuffer(TEXT("ArgumentsBuffer"), ArgumentsBuffer, EBufferUsageFlags::DrawIndirect, ArgumentsOffset, sizeof(FRHIDrawIndirectParameters), OnSignaled))
+	{
+		return;
+	}
+
+	EnqueueDraw(VSResourceArray, PSResourceArray, RTVs, DSV, bClearColor, bClearDepthStencil, OnSignaled, RasterizeConfig, { {ArgumentsBuffer, ERHIAccess::IndirectArgs} },
+		[ArgumentsBufferRHIRef = ArgumentsBuffer->GetBufferRHI(), ArgumentsOffset](FRHICommandListImmediate& RHICmdList)
+		{
+			RHICmdList.DrawPrimitiveIndirect(ArgumentsBufferRHIRef, static_cast<uint32>(ArgumentsOffset));
+		});
+}
+
+void UCompushadyRasterizer::DrawIndexedIndirect(const FCompushadyResourceArray& VSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, UCompushadyResource* IndexBuffer, UCompushadyResource* ArgumentsBuffer, const int64 ArgumentsOffset, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig)
+{
+	if (!VertexShaderRef.IsValid())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Rasterizer has no Vertex Shader");
+		return;
+	}
+
+	if (!CheckBuffer(TEXT("IndexBuffer"), IndexBuffer, EBufferUsageFlags::IndexBuffer, 0, 0, OnSignaled))
+	{
+		return;
+	}
+
+	if (!CheckBuffer(TEXT("ArgumentsBuffer"), ArgumentsBuffer, EBufferUsageFlags::DrawIndirect, ArgumentsOffset, sizeof(FRHIDrawIndexedIndirectParameters), OnSignaled))
+	{
+		return;
+	}
+
+	EnqueueDraw(VSResourceArray, PSResourceArray, RTVs, DSV, bClearColor, bClearDepthStencil, OnSignaled, RasterizeConfig, { {IndexBuffer, ERHIAccess::VertexOrIndexBuffer}, {ArgumentsBuffer, ERHIAccess::IndirectArgs} },
+		[IndexBufferRHIRef = IndexBuffer->GetBufferRHI(), ArgumentsBufferRHIRef = ArgumentsBuffer->GetBufferRHI(), ArgumentsOffset](FRHICommandListImmediate& RHICmdList)
+		{
+			RHICmdList.DrawIndexedPrimitiveIndirect(IndexBufferRHIRef, ArgumentsBufferRHIRef, static_cast<uint32>(ArgumentsOffset));
+		});
+}
+
+void UCompushadyRasterizer::MultiDrawIndexedIndirect(const FCompushadyResourceArray& VSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, UCompushadyResource* IndexBuffer, UCompushadyResource* ArgumentsBuffer, const int64 ArgumentsOffset, UCompushadyResource* CountBuffer, const int64 CountBufferOffset, const int32 MaxDrawArguments, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig)
+{
+	if (!VertexShaderRef.IsValid())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Rasterizer has no Vertex Shader");
+		return;
+	}
+
+	if (MaxDrawArguments <= 0)
+	{
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid number of draw arguments %d"), MaxDrawArguments));
+		return;
+	}
+
+	if (!CheckBuffer(TEXT("IndexBuffer"), IndexBuffer, EBufferUsageFlags::IndexBuffer, 0, 0, OnSignaled))
+	{
+		return;
+	}
+
+	if (!CheckBuffer(TEXT("ArgumentsBuffer"), ArgumentsBuffer, EBufferUsageFlags::DrawIndirect, ArgumentsOffset, static_cast<int64>(sizeof(FRHIDrawIndexedIndirectParameters)) * MaxDrawArguments, OnSignaled))
+	{
+		return;
+	}
+
+	TArray<TPair<UCompushadyResource*, ERHIAccess>> Buffers = { {IndexBuffer, ERHIAccess::VertexOrIndexBuffer}, {ArgumentsBuffer, ERHIAccess::IndirectArgs} };
+	FBufferRHIRef CountBufferRHIRef;
+	if (CountBuffer)
+	{
+		if (!CheckBuffer(TEXT("CountBuffer"), CountBuffer, EBufferUsageFlags::DrawIndirect, CountBufferOffset, sizeof(uint32), OnSignaled))
+		{
+			return;
+		}
+		Buffers.Add({ CountBuffer, ERHIAccess::IndirectArgs });
+		CountBufferRHIRef = CountBuffer->GetBufferRHI();
+	}
+
+	// the GPU count requires RHI support (ExecuteIndirect or vkCmdDrawIndexedIndirectCount), the fallback always issues MaxDrawArguments draws
+	const bool bMultiDraw = CountBufferRHIRef.IsValid() && GRHISupportsMultiDrawIndirect;
+
+	EnqueueDraw(VSResourceArray, PSResourceArray, RTVs, DSV, bClearColor, bClearDepthStencil, OnSignaled, RasterizeConfig, Buffers,
+		[IndexBufferRHIRef = IndexBuffer->GetBufferRHI(), ArgumentsBufferRHIRef = ArgumentsBuffer->GetBufferRHI(), ArgumentsOffset, CountBufferRHIRef, CountBufferOffset, MaxDrawArguments, bMultiDraw](FRHICommandListImmediate& RHICmdList)
+		{
+			if (bMultiDraw)
 			{
-				RHICmdList.Transition(FRHITransitionInfo(RenderTargets[RenderTargetIndex], ERHIAccess::Unknown, ERHIAccess::RTV));
-				if (bClearColor)
-				{
-					ClearRenderTarget(RHICmdList, RenderTargets[RenderTargetIndex]);
-				}
+				RHICmdList.MultiDrawIndexedPrimitiveIndirect(IndexBufferRHIRef, ArgumentsBufferRHIRef, static_cast<uint32>(ArgumentsOffset), CountBufferRHIRef, static_cast<uint32>(CountBufferOffset), MaxDrawArguments);
+				return;
 			}
 
-			FRHIRenderPassInfo PassInfo(RenderTargetsEnabled, const_cast<FRHITexture**>(RenderTargets.GetData()), ERenderTargetActions::Load_Store);
-			RHICmdList.BeginRenderPass(PassInfo, TEXT("UCompushadyRasterizer::Draw"));
+			// the GPU count is ignored here, the unused arguments are expected to have a zero InstanceCount
+			for (int32 DrawIndex = 0; DrawIndex < MaxDrawArguments; DrawIndex++)
+			{
+				RHICmdList.DrawIndexedPrimitiveIndirect(IndexBufferRHIRef, ArgumentsBufferRHIRef, static_cast<uint32>(ArgumentsOffset + DrawIndex * sizeof(FRHIDrawIndexedIndirectParameters)));
+			}
+		});
+}
 
-			//RHICmdList.SetViewport(0, 0, 0.0f, RenderTargets[0]->GetDesc().Extent.X, RenderTargets[0]->GetDesc().Extent.Y, 1.0f);
-			RHICmdList.SetViewport(0, 0, 0.0f, 1024, 1024, 1.0f);
-			RHICmdList.SetScissorRect(false, 0, 0, 0, 0);
-			RHICmdList.SetStencilRef(0);
+void UCompushadyRasterizer::DispatchMesh(const FCompushadyResourceArray& MSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, const FIntVector XYZ, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig)
+{
+	if (!MeshShaderRef.IsValid())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Rasterizer has no Mesh Shader");
+		return;
+	}
 
-			RHICmdList.ApplyCachedRenderTargets(PipelineStateInitializer);
+	if (XYZ.GetMin() <= 0)
+	{
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid Thread Group Size %s"), *XYZ.ToString()));
+		return;
+	}
 
-			SetGraphicsPipelineState(RHICmdList, PipelineStateInitializer, 0);// , EApplyRendertargetOption::DoNothing, false, EPSOPrecacheResult::Untracked);
+	EnqueueDraw(MSResourceArray, PSResourceArray, RTVs, nullptr, false, false, OnSignaled, RasterizeConfig, {},
+		[XYZ](FRHICommandListImmediate& RHICmdList)
+		{
+			RHICmdList.DispatchMeshShader(XYZ.X, XYZ.Y, XYZ.Z);
+		});
+}
 
-			Compushady::Utils::SetupPipelineParameters(RHICmdList, VertexShaderRef, VSResourceArray, VSResourceBindings);
-			Compushady::Utils::SetupPipelineParameters(RHICmdList, PixelShaderRef, PSResourceArray, PSResourceBindings, {});
+void UCompushadyRasterizer::DispatchAmplification(const FCompushadyResourceArray& ASResourceArray, const FCompushadyResourceArray& MSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, const FIntVector XYZ, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig)
+{
+	if (!AmplificationShaderRef.IsValid())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Rasterizer has no Amplification Shader");
+		return;
+	}
 
-			RHICmdList.DrawPrimitive(0, NumVertices / 3, NumInstances);
+	if (XYZ.GetMin() <= 0)
+	{
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid Thread Group Size %s"), *XYZ.ToString()));
+		return;
+	}
 
-			RHICmdList.EndRenderPass();
+	FRenderPassDraw RenderPassDraw;
+	RenderPassDraw.ASResourceArray = ASResourceArray;
+	RenderPassDraw.VSOrMSResourceArray = MSResourceArray;
+	RenderPassDraw.PSResourceArray = PSResourceArray;
+	RenderPassDraw.DrawFunction = [XYZ](FRHICommandListImmediate& RHICmdList)
+		{
+			// the mesh shader groups are launched by the amplification shader
+			RHICmdList.DispatchMeshShader(XYZ.X, XYZ.Y, XYZ.Z);
+		};
 
-		}, OnSignaled);
+	EnqueueRenderPass({ RenderPassDraw }, RTVs, nullptr, false, false, OnSignaled, RasterizeConfig, {});
+}
+
+void UCompushadyRasterizer::DispatchMeshIndirect(const FCompushadyResourceArray& MSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyResource* ArgumentsBuffer, const int64 ArgumentsOffset, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig)
+{
+	if (!MeshShaderRef.IsValid())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Rasterizer has no Mesh Shader");
+		return;
+	}
+
+	if (!CheckBuffer(TEXT("ArgumentsBuffer"), ArgumentsBuffer, EBufferUsageFlags::DrawIndirect, ArgumentsOffset, sizeof(uint32) * 3, OnSignaled))
+	{
+		return;
+	}
+
+	EnqueueDraw(MSResourceArray, PSResourceArray, RTVs, nullptr, false, false, OnSignaled, RasterizeConfig, { {ArgumentsBuffer, ERHIAccess::IndirectArgs} },
+		[ArgumentsBufferRHIRef = ArgumentsBuffer->GetBufferRHI(), ArgumentsOffset](FRHICommandListImmediate& RHICmdList)
+		{
+			RHICmdList.DispatchIndirectMeshShader(ArgumentsBufferRHIRef, static_cast<uint32>(ArgumentsOffset));
+		});
 }
 
-void UCompushadyRasterizer::DispatchMesh(const FCompushadyResourceArray& MSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, const FIntVector XYZ, const FCompushadySignaled& OnSignaled)
+void UCompushadyRasterizer::EnqueueDraw(const FCompushadyResourceArray& VSOrMSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*>& RTVs, UCompushadyDSV* DSV, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig, const TArray<TPair<UCompushadyResource*, ERHIAccess>>& Buffers, TFunction<void(FRHICommandListImmediate& RHICmdList)> DrawFunction, const int32 NumVertices)
+{
+	FRenderPassDraw RenderPassDraw;
+	RenderPassDraw.VSOrMSResourceArray = VSOrMSResourceArray;
+	RenderPassDraw.PSResourceArray = PSResourceArray;
+	RenderPassDraw.DrawFunction = DrawFunction;
+	RenderPassDraw.NumVertices = NumVertices;
+
+	EnqueueRenderPass({ RenderPassDraw }, RTVs, DSV, bClearColor, bClearDepthStencil, OnSignaled, RasterizeConfig, Buffers);
+}
+
+void UCompushadyRasterizer::EnqueueRenderPass(const TArray<FRenderPassDraw>& Draws, const TArray<UCompushadyRTV*>& RTVs, UCompushadyDSV* DSV, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig, const TArray<TPair<UCompushadyResource*, ERHIAccess>>& Buffers)
 {
 	if (IsRunning())
 	{
@@ -329,58 +790,315 @@ void UCompushadyRasterizer::DispatchMesh(const FCompushadyResourceArray& MSResou
 		return;
 	}
 
-	if (XYZ.GetMin() <= 0)
+	const bool bMeshShader = MeshShaderRef.IsValid();
+	const bool bAmplificationShader = AmplificationShaderRef.IsValid();
+
+	for (const FRenderPassDraw& Draw : Draws)
 	{
-		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid Thread Group Size %s"), *XYZ.ToString()));
-		return;
+		if (bAmplificationShader && !CheckResourceBindings(Draw.ASResourceArray, ASResourceBindings, OnSignaled))
+		{
+			return;
+		}
+
+		if (!CheckResourceBindings(Draw.VSOrMSResourceArray, bMeshShader ? MSResourceBindings : VSResourceBindings, OnSignaled))
+		{
+			return;
+		}
+
+		if (!CheckResourceBindings(Draw.PSResourceArray, PSResourceBindings, OnSignaled))
+		{
+			return;
+		}
 	}
 
-	if (RTVs.Num() < 1 || RTVs.Num() > 8)
+	if (bDepthEnabled && !DSV)
 	{
-		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid number of RTVs %d"), RTVs.Num()));
+		OnSignaled.ExecuteIfBound(false, "The Rasterizer requires a DSV for depth test/write");
 		return;
 	}
 
-	if (!CheckResourceBindings(MSResourceArray, MSResourceBindings, OnSignaled))
+	FString ErrorMessages;
+	FPipelineStateInitializerPtr RasterizerPipelineStateInitializer = GetPipelineStateInitializer(RTVs, DSV, ErrorMessages);
+	if (!RasterizerPipelineStateInitializer)
 	{
+		OnSignaled.ExecuteIfBound(false, ErrorMessages);
 		return;
 	}
 
-	if (!CheckResourceBindings(PSResourceArray, PSResourceBindings, OnSignaled))
+	Compushady::Rasterizer::FRasterizeState RasterizeState;
+	if (!Compushady::Rasterizer::GetRasterizeState(RasterizeConfig, RTVs.Num() > 0 ? RTVs[0]->GetTextureSize() : DSV->GetTextureSize(), RasterizeState, ErrorMessages))
 	{
+		OnSignaled.ExecuteIfBound(false, ErrorMessages);
 		return;
 	}
 
+	TArray<TPair<UCompushadyResource*, ERHIAccess>> DrawBuffers = Buffers;
+	TArray<TPair<uint32, FBufferRHIRef>> VertexStreams;
+	if (!bMeshShader)
+	{
+		// the streams must cover the vertices of the non indexed draws, while the indexed and indirect ones (whose range is in GPU memory)
+		// require all of the streams to have the same number of vertices
+		int32 MaxNumVertices = 0;
+		bool bUnknownNumVertices = false;
+		for (const FRenderPassDraw& Draw : Draws)
+		{
+			MaxNumVertices = FMath::Max(MaxNumVertices, Draw.NumVertices);
+			bUnknownNumVertices |= Draw.NumVertices == 0;
+		}
+
+		int64 StreamNumVertices = -1;
+		for (const FVertexElement& VertexElement : VertexDeclarationElements)
+		{
+			UCompushadyResource* VertexBuffer = VertexBuffers.IsValidIndex(VertexElement.StreamIndex) ? VertexBuffers[VertexElement.StreamIndex] : nullptr;
+			const FString VertexBufferName = FString::Printf(TEXT("VertexBuffer for ATTRIBUTE%u"), VertexElement.StreamIndex);
+			if (!CheckBuffer(*VertexBufferName, VertexBuffer, EBufferUsageFlags::VertexBuffer, 0, static_cast<int64>(VertexElement.Stride) * FMath::Max(MaxNumVertices, 1), OnSignaled))
+			{
+				return;
+			}
+
+			const int64 NumVertices = VertexBuffer->GetBufferSize() / VertexElement.Stride;
+			if (bUnknownNumVertices && StreamNumVertices >= 0 && NumVertices != StreamNumVertices)
+			{
+				OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("%s has %lld vertices, while the previous streams have %lld"), *VertexBufferName, NumVertices, StreamNumVertices));
+				return;
+			}
+			StreamNumVertices = NumVertices;
+			DrawBuffers.Add({ VertexBuffer, ERHIAccess::VertexOrIndexBuffer });
+			VertexStreams.Add({ VertexElement.StreamIndex, VertexBuffer->GetBufferRHI() });
+		}
+	}
+
+	// every draw gets its own snapshot of the CBVs (and of its constants)
+	TArray<FRenderPassDraw> SnapshotDraws;
+	for (const FRenderPassDraw& Draw : Draws)
+	{
+		FRenderPassDraw& SnapshotDraw = SnapshotDraws.AddDefaulted_GetRef();
+		SnapshotDraw.ASResourceArray = Compushady::Utils::SnapshotResourceArray(Draw.ASResourceArray);
+		SnapshotDraw.VSOrMSResourceArray = Compushady::Utils::SnapshotResourceArray(Draw.VSOrMSResourceArray);
+		SnapshotDraw.PSResourceArray = Compushady::Utils::SnapshotResourceArray(Draw.PSResourceArray);
+		SnapshotDraw.DrawFunction = Draw.DrawFunction;
+
+		if (!Compushady::Rasterizer::SetDrawConstants(SnapshotDraw.VSOrMSResourceArray, Draw.VSOrMSConstants, ErrorMessages) || !Compushady::Rasterizer::SetDrawConstants(SnapshotDraw.PSResourceArray, Draw.PSConstants, ErrorMessages))
+		{
+			OnSignaled.ExecuteIfBound(false, ErrorMessages);
+			return;
+		}
+	}
+
 	TStaticArray<FRHITexture*, 8> RenderTargets = {};
-	PipelineStateInitializer.RenderTargetsEnabled = 0;
+	const uint32 RenderTargetsEnabled = RTVs.Num();
 	for (int32 Index = 0; Index < RTVs.Num(); Index++)
 	{
 		RenderTargets[Index] = RTVs[Index]->GetTextureRHI();
-		PipelineStateInitializer.RenderTargetsEnabled++;
-		PipelineStateInitializer.RenderTargetFormats[Index] = RTVs[Index]->GetTexturePixelFormat();
 		TrackResource(RTVs[Index]);
 	}
 
-	TrackResources(MSResourceArray);
-	TrackResources(PSResourceArray);
+	FTextureRHIRef DepthStencilTarget;
+	if (DSV)
+	{
+		DepthStencilTarget = DSV->GetTextureRHI();
+		TrackResource(DSV);
+	}
+
+	TArray<FRHITransitionInfo> BuffersTransitions;
+	for (const TPair<UCompushadyResource*, ERHIAccess>& Buffer : DrawBuffers)
+	{
+		BuffersTransitions.Add(FRHITransitionInfo(Buffer.Key->GetBufferRHI(), ERHIAccess::Unknown, Buffer.Value));
+		TrackResource(Buffer.Key);
+	}
+
+	for (const FRenderPassDraw& Draw : Draws)
+	{
+		TrackResources(Draw.ASResourceArray);
+		TrackResources(Draw.VSOrMSResourceArray);
+		TrackResources(Draw.PSResourceArray);
+	}
 
 	EnqueueToGPU(
-		[this, XYZ, MSResourceArray, PSResourceArray, RenderTargets](FRHICommandListImmediate& RHICmdList)
+		[this, bMeshShader, bAmplificationShader, Draws = MoveTemp(SnapshotDraws), RenderTargets, RenderTargetsEnabled, bClearColor, DepthStencilTarget, bClearDepthStencil, RasterizerPipelineStateInitializer, RasterizeState, BuffersTransitions, VertexStreams](FRHICommandListImmediate& RHICmdList)
 		{
-			FRHIRenderPassInfo PassInfo(PipelineStateInitializer.RenderTargetsEnabled, const_cast<FRHITexture**>(RenderTargets.GetData()), ERenderTargetActions::Load_Store);
-			RHICmdList.BeginRenderPass(PassInfo, TEXT("UCompushadyRasterizer::DispatchMesh"));
-			RHICmdList.SetViewport(0, 0, 0.0f, RenderTargets[0]->GetDesc().Extent.X, RenderTargets[0]->GetDesc().Extent.Y, 1.0f);
+			for (uint32 RenderTargetIndex = 0; RenderTargetIndex < RenderTargetsEnabled; RenderTargetIndex++)
+			{
+				RHICmdList.Transition(FRHITransitionInfo(RenderTargets[RenderTargetIndex], ERHIAccess::Unknown, ERHIAccess::RTV));
+				if (bClearColor)
+				{
+					ClearRenderTarget(RHICmdList, RenderTargets[RenderTargetIndex]);
+				}
+			}
 
-			SetGraphicsPipelineState(RHICmdList, PipelineStateInitializer, 0);
-			Compushady::Utils::SetupPipelineParameters(RHICmdList, MeshShaderRef, MSResourceArray, MSResourceBindings);
-			Compushady::Utils::SetupPipelineParameters(RHICmdList, PixelShaderRef, PSResourceArray, PSResourceBindings, {});
+			if (BuffersTransitions.Num() > 0)
+			{
+				RHICmdList.Transition(BuffersTransitions);
+			}
 
-			RHICmdList.DispatchMeshShader(XYZ.X, XYZ.Y, XYZ.Z);
+			// the color targets are cleared before, the depth one is cleared by the render pass
+			FRHIRenderPassInfo PassInfo;
+			for (uint32 RenderTargetIndex = 0; RenderTargetIndex < RenderTargetsEnabled; RenderTargetIndex++)
+			{
+				PassInfo.ColorRenderTargets[RenderTargetIndex].RenderTarget = RenderTargets[RenderTargetIndex];
+				PassInfo.ColorRenderTargets[RenderTargetIndex].Action = ERenderTargetActions::Load_Store;
+			}
+
+			if (DepthStencilTarget)
+			{
+				RHICmdList.Transition(FRHITransitionInfo(DepthStencilTarget, ERHIAccess::Unknown, ERHIAccess::DSVWrite));
+				PassInfo.DepthStencilRenderTarget.DepthStencilTarget = DepthStencilTarget;
+				PassInfo.DepthStencilRenderTarget.Action = bClearDepthStencil ? EDepthStencilTargetActions::ClearDepthStencil_StoreDepthStencil : EDepthStencilTargetActions::LoadDepthStencil_StoreDepthStencil;
+				PassInfo.DepthStencilRenderTarget.ExclusiveDepthStencil = FExclusiveDepthStencil::DepthWrite_StencilWrite;
+			}
+
+			RHICmdList.BeginRenderPass(PassInfo, TEXT("UCompushadyRasterizer"));
+
+			Compushady::Rasterizer::SetRasterizeState(RHICmdList, RasterizeState);
+
+			// the render target formats are already in the initializer, so no ApplyCachedRenderTargets is required
+			SetGraphicsPipelineState(RHICmdList, *RasterizerPipelineStateInitializer, RasterizeState.StencilRef);
+
+			for (const TPair<uint32, FBufferRHIRef>& VertexStream : VertexStreams)
+			{
+				RHICmdList.SetStreamSource(VertexStream.Key, VertexStream.Value, 0);
+			}
+
+			for (const FRenderPassDraw& Draw : Draws)
+			{
+				if (bAmplificationShader)
+				{
+					Compushady::Utils::SetupPipelineParameters(RHICmdList, AmplificationShaderRef, Draw.ASResourceArray, ASResourceBindings);
+				}
+
+				if (bMeshShader)
+				{
+					Compushady::Utils::SetupPipelineParameters(RHICmdList, MeshShaderRef, Draw.VSOrMSResourceArray, MSResourceBindings);
+				}
+				else
+				{
+					Compushady::Utils::SetupPipelineParameters(RHICmdList, VertexShaderRef, Draw.VSOrMSResourceArray, VSResourceBindings);
+				}
+				// depth only passes have no pixel shader
+				if (RenderTargetsEnabled > 0)
+				{
+					Compushady::Utils::SetupPipelineParameters(RHICmdList, PixelShaderRef, Draw.PSResourceArray, PSResourceBindings, {});
+				}
+
+				Draw.DrawFunction(RHICmdList);
+			}
 
 			RHICmdList.EndRenderPass();
+
 		}, OnSignaled);
 }
 
+bool UCompushadyRasterizer::CheckBuffer(const TCHAR* Name, UCompushadyResource* Buffer, const EBufferUsageFlags Usage, const int64 Offset, const int64 Size, const FCompushadySignaled& OnSignaled)
+{
+	if (!Buffer || !Buffer->IsValidBuffer())
+	{
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid %s"), Name));
+		return false;
+	}
+
+	if (!EnumHasAnyFlags(Buffer->GetBufferRHI()->GetUsage(), Usage))
+	{
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("%s has not been created with the required usage flags"), Name));
+		return false;
+	}
+
+	if (Offset < 0 || Offset % sizeof(uint32) != 0 || Offset + Size > Buffer->GetBufferSize())
+	{
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid %s offset %lld (size: %lld)"), Name, Offset, Buffer->GetBufferSize()));
+		return false;
+	}
+
+	return true;
+}
+
+void UCompushadyRasterizer::SetVertexBuffers(const TArray<UCompushadyResource*>& InVertexBuffers)
+{
+	VertexBuffers = InVertexBuffers;
+}
+
+bool UCompushadyRasterizer::PrecachePipelineState(const TArray<UCompushadyRTV*>& RTVs, UCompushadyDSV* DSV)
+{
+	FString ErrorMessages;
+	if (!GetPipelineStateInitializer(RTVs, DSV, ErrorMessages))
+	{
+		UE_LOG(LogCompushady, Error, TEXT("%s"), *ErrorMessages);
+		return false;
+	}
+	return true;
+}
+
+UCompushadyRasterizer::FPipelineStateInitializerPtr UCompushadyRasterizer::GetPipelineStateInitializer(const TArray<UCompushadyRTV*>& RTVs, UCompushadyDSV* DSV, FString& ErrorMessages)
+{
+	// no RTVs for depth only passes
+	if ((RTVs.Num() < 1 && !DSV) || RTVs.Num() > MaxSimultaneousRenderTargets)
+	{
+		ErrorMessages = FString::Printf(TEXT("Invalid number of RTVs %d"), RTVs.Num());
+		return nullptr;
+	}
+
+	FPipelineStateKey Key;
+	Key.RenderTargetsEnabled = RTVs.Num();
+	for (int32 Index = 0; Index < RTVs.Num(); Index++)
+	{
+		if (!RTVs[Index] || !RTVs[Index]->IsValidTexture())
+		{
+			ErrorMessages = FString::Printf(TEXT("Invalid RTV %d"), Index);
+			return nullptr;
+		}
+		Key.RenderTargetFormats[Index] = RTVs[Index]->GetTexturePixelFormat();
+		Key.RenderTargetFlags[Index] = RTVs[Index]->GetTextureRHI()->GetDesc().Flags;
+	}
+
+	if (DSV)
+	{
+		if (!DSV->IsValidTexture())
+		{
+			ErrorMessages = "Invalid DSV";
+			return nullptr;
+		}
+		Key.DepthStencilTargetFormat = DSV->GetTexturePixelFormat();
+		Key.DepthStencilTargetFlag = DSV->GetTextureRHI()->GetDesc().Flags;
+	}
+
+	Key.NumSamples = RTVs.Num() > 0 ? RTVs[0]->GetTextureRHI()->GetDesc().NumSamples : DSV->GetTextureRHI()->GetDesc().NumSamples;
+
+	if (const FPipelineStateInitializerPtr* CachedPipelineStateInitializer = PipelineStateInitializers.Find(Key))
+	{
+		return *CachedPipelineStateInitializer;
+	}
+
+	TSharedRef<FGraphicsPipelineStateInitializer, ESPMode::ThreadSafe> NewPipelineStateInitializer = MakeShared<FGraphicsPipelineStateInitializer, ESPMode::ThreadSafe>(PipelineStateInitializer);
+	NewPipelineStateInitializer->RenderTargetsEnabled = Key.RenderTargetsEnabled;
+	for (int32 Index = 0; Index < RTVs.Num(); Index++)
+	{
+		NewPipelineStateInitializer->RenderTargetFormats[Index] = Key.RenderTargetFormats[Index];
+		NewPipelineStateInitializer->RenderTargetFlags[Index] = Key.RenderTargetFlags[Index];
+	}
+	NewPipelineStateInitializer->NumSamples = Key.NumSamples;
+
+	if (DSV)
+	{
+		NewPipelineStateInitializer->DepthStencilTargetFormat = Key.DepthStencilTargetFormat;
+		NewPipelineStateInitializer->DepthStencilTargetFlag = Key.DepthStencilTargetFlag;
+	}
+
+	if (RTVs.Num() == 0)
+	{
+		NewPipelineStateInitializer->BoundShaderState.PixelShaderRHI = nullptr;
+	}
+
+	// starts compiling the PSO before the first draw needs it
+	ENQUEUE_RENDER_COMMAND(DoCompushadyPrecacheGraphicsPipelineState)(
+		[NewPipelineStateInitializer](FRHICommandListImmediate& RHICmdList)
+		{
+			PipelineStateCache::GetAndOrCreateGraphicsPipelineState(RHICmdList, *NewPipelineStateInitializer, EApplyRendertargetOption::DoNothing);
+		});
+
+	PipelineStateInitializers.Add(Key, NewPipelineStateInitializer);
+
+	return NewPipelineStateInitializer;
+}
+
 bool UCompushadyRasterizer::IsRunning() const
 {
 	return ICompushadySignalable::IsRunning();
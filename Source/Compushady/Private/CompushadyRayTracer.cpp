@@ -161,7 +161,7 @@ void UCompushadyRayTracer::DispatchRays(const FCompushadyResourceArray& Resource
 	TrackResources(ResourceArray);
 
 	EnqueueToGPU(
-		[this, XYZ, ResourceArray](FRHICommandListImmediate& RHICmdList)
+		[this, XYZ, ResourceArray = Compushady::Utils::SnapshotResourceArray(ResourceArray)](FRHICommandListImmediate& RHICmdList)
 		{
 			//RHICmdList.RayTraceDispatch(PipelineState);
 		}, OnSignaled);
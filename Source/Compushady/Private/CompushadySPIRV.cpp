@@ -129,6 +129,17 @@ bool Compushady::FixupSPIRV(TArray<uint8>& ByteCode, FCompushadyShaderResourceBi
 	TMap<uint32, uint32> SpirVSampledImages;
 	// track Block decorations (for recognizing CBVs)
 	TSet<uint32> SpirVBlocks;
+	// types and constants used for building the CBVs members layout
+	TMap<uint32, TArray<uint32>> SpirVTypes;
+	TMap<uint32, uint32> SpirVConstants;
+	TMap<uint32, uint32> SpirVArrayStrides;
+	// struct id -> (member index -> (Name, Offset, MatrixStride))
+	TMap<uint32, TMap<uint32, TTuple<FString, uint32, uint32>>> SpirVMembers;
+	// stage inputs, their semantics and the offsets of their Location decorations (for the vertex shader attributes)
+	TSet<uint32> SpirVInputs;
+	TMap<uint32, FString> SpirVSemantics;
+	TMap<uint32, int32> SpirVLocationOffsets;
+	bool bVertexShader = false;
 
 	while (Offset < SpirV.Num())
 	{
@@ -157,6 +168,14 @@ bool Compushady::FixupSPIRV(TArray<uint8>& ByteCode, FCompushadyShaderResourceBi
 					FCompushadySpirVDecoration& Decoration = Bindings.FindOrAdd(SpirV[Offset + 1]);
 					Decoration.DescriptorSetOffset = Offset + 3;
 				}
+				else if (SpirV[Offset + 2] == 6) // ArrayStride
+				{
+					SpirVArrayStrides.Add(SpirV[Offset + 1], SpirV[Offset + 3]);
+				}
+				else if (SpirV[Offset + 2] == 30) // Location
+				{
+					SpirVLocationOffsets.Add(SpirV[Offset + 1], Offset + 3);
+				}
 			}
 			else if (Size > 2 && SpirV[Offset + 2] == 2) // Block
 			{
@@ -173,6 +192,35 @@ bool Compushady::FixupSPIRV(TArray<uint8>& ByteCode, FCompushadyShaderResourceBi
 				Decoration.Name = UTF8_TO_TCHAR(Name);
 			}
 		}
+		// get the struct members names
+		else if (Opcode == 6 && (Offset + Size < SpirV.Num())) // OpMemberName(6) + id + member + String
+		{
+			if (Size > 3)
+			{
+				const char* Name = reinterpret_cast<char*>(&SpirV[Offset + 3]);
+				SpirVMembers.FindOrAdd(SpirV[Offset + 1]).FindOrAdd(SpirV[Offset + 2]).Get<0>() = UTF8_TO_TCHAR(Name);
+			}
+		}
+		// get the struct members offsets
+		else if (Opcode == 72 && (Offset + Size < SpirV.Num()) && Size > 4) // OpMemberDecorate(72) + id + member + Decoration + Value
+		{
+			if (SpirV[Offset + 3] == 35) // Offset
+			{
+				SpirVMembers.FindOrAdd(SpirV[Offset + 1]).FindOrAdd(SpirV[Offset + 2]).Get<1>() = SpirV[Offset + 4];
+			}
+			else if (SpirV[Offset + 3] == 7) // MatrixStride
+			{
+				SpirVMembers.FindOrAdd(SpirV[Offset + 1]).FindOrAdd(SpirV[Offset + 2]).Get<2>() = SpirV[Offset + 4];
+			}
+		}
+		else if ((Opcode == 21 || Opcode == 22 || Opcode == 23 || Opcode == 24 || Opcode == 28) && (Offset + Size < SpirV.Num()) && Size > 2) // OpTypeInt/OpTypeFloat/OpTypeVector/OpTypeMatrix/OpTypeArray + id + ...
+		{
+			SpirVTypes.Add(SpirV[Offset + 1], TArray<uint32>(&SpirV[Offset], Size));
+		}
+		else if (Opcode == 43 && (Offset + Size < SpirV.Num()) && Size > 3) // OpConstant + id_type + id + Value
+		{
+			SpirVConstants.Add(SpirV[Offset + 2], SpirV[Offset + 3]);
+		}
 		// get the reflection friendly type
 		else if (Opcode == 5632 && (Offset + Size < SpirV.Num())) // OpDecorateString(5632) + id + Decoration(UserTypeGOOGLE/5636) + String
 		{
@@ -182,10 +230,16 @@ bool Compushady::FixupSPIRV(TArray<uint8>& ByteCode, FCompushadyShaderResourceBi
 				FCompushadySpirVDecoration& Decoration = Bindings.FindOrAdd(SpirV[Offset + 1]);
 				Decoration.ReflectionType = UTF8_TO_TCHAR(DecorationString);
 			}
+			else if (Size > 3 && SpirV[Offset + 2] == 5635) // UserSemantic
+			{
+				const char* DecorationString = reinterpret_cast<char*>(&SpirV[Offset + 3]);
+				SpirVSemantics.Add(SpirV[Offset + 1], UTF8_TO_TCHAR(DecorationString));
+			}
 		}
 		// patch the EntryPoint Name
 		else if (Opcode == 15 && (Offset + Size < SpirV.Num()) && Size > 8) // OpEntryPoint(15) + ExecutionModel + id + Name + ...
 		{
+			bVertexShader = SpirV[Offset + 1] == 0; // Vertex
 			uint32* EntryPointPtr = reinterpret_cast<uint32*>(SpirVEntryPoint);
 			for (int32 Index = 0; Index < 6; Index++)
 			{
@@ -196,6 +250,10 @@ bool Compushady::FixupSPIRV(TArray<uint8>& ByteCode, FCompushadyShaderResourceBi
 		{
 			FCompushadySpirVDecoration& Decoration = Bindings.FindOrAdd(SpirV[Offset + 2]);
 			Decoration.TypeId = SpirV[Offset + 1];
+			if (SpirV[Offset + 3] == 1) // Input
+			{
+				SpirVInputs.Add(SpirV[Offset + 2]);
+			}
 		}
 		else if (Opcode == 32 && (Offset + Size < SpirV.Num()) && Size > 3) // OpTypePointer + id + StorageClass + id_type
 		{
@@ -212,6 +270,7 @@ bool Compushady::FixupSPIRV(TArray<uint8>& ByteCode, FCompushadyShaderResourceBi
 		else if (Opcode == 30 && (Offset + Size < SpirV.Num()) && Size > 1) // OpTypeStruct + id + ...
 		{
 			SpirVStructs.Add(SpirV[Offset + 1], Opcode);
+			SpirVTypes.Add(SpirV[Offset + 1], TArray<uint32>(&SpirV[Offset], Size));
 		}
 		else if (Opcode == 16 && (Offset + Size < SpirV.Num()) && Size > 5 && SpirV[Offset + 2] == 17) // OpExecutionMode + id + LocalSize(17) + X + Y + Z ...
 		{
@@ -231,6 +290,115 @@ bool Compushady::FixupSPIRV(TArray<uint8>& ByteCode, FCompushadyShaderResourceBi
 		}
 	}
 
+	// vertex shader inputs (builtins have no Location), ATTRIBUTE<N> semantics are moved to Location N
+	// as the vertex declaration attribute index is the Location of the input
+	if (bVertexShader)
+	{
+		for (const uint32 InputId : SpirVInputs)
+		{
+			const int32* LocationOffset = SpirVLocationOffsets.Find(InputId);
+			const FString* Semantic = SpirVSemantics.Find(InputId);
+			if (!LocationOffset || !Semantic)
+			{
+				continue;
+			}
+
+			int32 DigitsIndex = Semantic->Len();
+			while (DigitsIndex > 0 && FChar::IsDigit((*Semantic)[DigitsIndex - 1]))
+			{
+				DigitsIndex--;
+			}
+
+			const FString SemanticName = Semantic->Left(DigitsIndex);
+			const uint32 SemanticIndex = DigitsIndex < Semantic->Len() ? FCString::Atoi(*Semantic->Mid(DigitsIndex)) : 0;
+			if (SemanticName.Equals(TEXT("ATTRIBUTE"), ESearchCase::IgnoreCase))
+			{
+				SpirV[*LocationOffset] = SemanticIndex;
+			}
+
+			uint32 NumComponents = 1;
+			uint32 ComponentTypeId = SpirVPointers.Contains(Bindings[InputId].TypeId) ? SpirVPointers[Bindings[InputId].TypeId] : 0;
+			if (SpirVTypes.Contains(ComponentTypeId) && (SpirVTypes[ComponentTypeId][0] & 0xFFFF) == 23 && SpirVTypes[ComponentTypeId].Num() > 3) // OpTypeVector
+			{
+				NumComponents = SpirVTypes[ComponentTypeId][3];
+				ComponentTypeId = SpirVTypes[ComponentTypeId][2];
+			}
+			const bool bInteger = SpirVTypes.Contains(ComponentTypeId) && (SpirVTypes[ComponentTypeId][0] & 0xFFFF) == 21; // OpTypeInt
+
+			ShaderResourceBindings.InputSemantics.Add(FCompushadyShaderSemantic(SemanticName, SemanticIndex, SpirV[*LocationOffset], (1 << NumComponents) - 1, bInteger));
+		}
+	}
+
+	// compute the size of a type following the std140/hlsl strides (0 for unknown types)
+	TFunction<uint32(const uint32, const uint32)> GetTypeSize = [&](const uint32 TypeId, const uint32 MatrixStride) -> uint32
+		{
+			if (!SpirVTypes.Contains(TypeId))
+			{
+				return 0;
+			}
+
+			const TArray<uint32>& Type = SpirVTypes[TypeId];
+			switch (Type[0] & 0xFFFF)
+			{
+			case 21: // OpTypeInt
+			case 22: // OpTypeFloat
+				return Type[2] / 8;
+			case 23: // OpTypeVector
+				return Type.Num() > 3 ? GetTypeSize(Type[2], 0) * Type[3] : 0;
+			case 24: // OpTypeMatrix
+				if (Type.Num() > 3 && Type[3] > 0)
+				{
+					const uint32 ColumnSize = GetTypeSize(Type[2], 0);
+					return MatrixStride > 0 ? MatrixStride * (Type[3] - 1) + ColumnSize : ColumnSize * Type[3];
+				}
+				return 0;
+			case 28: // OpTypeArray
+				if (Type.Num() > 3 && SpirVConstants.Contains(Type[3]) && SpirVConstants[Type[3]] > 0)
+				{
+					const uint32 ElementSize = GetTypeSize(Type[2], MatrixStride);
+					const uint32* ArrayStride = SpirVArrayStrides.Find(TypeId);
+					return ArrayStride ? *ArrayStride * (SpirVConstants[Type[3]] - 1) + ElementSize : ElementSize * SpirVConstants[Type[3]];
+				}
+				return 0;
+			case 30: // OpTypeStruct
+			{
+				uint32 StructSize = 0;
+				const TMap<uint32, TTuple<FString, uint32, uint32>>* Members = SpirVMembers.Find(TypeId);
+				for (int32 MemberIndex = 2; MemberIndex < Type.Num(); MemberIndex++)
+				{
+					const TTuple<FString, uint32, uint32>* Member = Members ? Members->Find(MemberIndex - 2) : nullptr;
+					if (Member)
+					{
+						StructSize = FMath::Max(StructSize, Member->Get<1>() + GetTypeSize(Type[MemberIndex], Member->Get<2>()));
+					}
+				}
+				return StructSize;
+			}
+			default:
+				break;
+			}
+			return 0;
+		};
+
+	auto GetConstants = [&](const uint32 StructId, TArray<FCompushadyShaderConstant>& Constants)
+		{
+			if (!SpirVTypes.Contains(StructId) || !SpirVMembers.Contains(StructId))
+			{
+				return;
+			}
+
+			const TArray<uint32>& Type = SpirVTypes[StructId];
+			const TMap<uint32, TTuple<FString, uint32, uint32>>& Members = SpirVMembers[StructId];
+			for (int32 MemberIndex = 2; MemberIndex < Type.Num(); MemberIndex++)
+			{
+				const TTuple<FString, uint32, uint32>* Member = Members.Find(MemberIndex - 2);
+				if (Member)
+				{
+					Constants.Add({ Member->Get<0>(), Member->Get<1>(), GetTypeSize(Type[MemberIndex], Member->Get<2>()) });
+				}
+			}
+		};
+
 	int32 UniformBufferType = VulkanShaderHeader.GlobalDescriptorTypes.Add(EVulkanBindingType::UniformBuffer);
 	int32 ImageType = VulkanShaderHeader.GlobalDescriptorTypes.Add(EVulkanBindingType::Image);
 	int32 BufferType = VulkanShaderHeader.GlobalDescriptorTypes.Add(EVulkanBindingType::UniformTexelBuffer);
@@ -268,6 +436,7 @@ bool Compushady::FixupSPIRV(TArray<uint8>& ByteCode, FCompushadyShaderResourceBi
 					ResourceBinding.Type = ECompushadySharedResourceType::Buffer;
 					ResourceBinding.BindingIndex = Pair.Value.Binding;
 					ResourceBinding.SlotIndex = VulkanShaderHeader.UniformBuffers.Add(UniformBufferInfo);
+					GetConstants(TypeId, ResourceBinding.Constants);
 					VulkanShaderHeader.UniformBufferSpirvInfos.Add(SpirvInfo);
 
 					CBVMapping.Add(ResourceBinding.BindingIndex, ResourceBinding);
@@ -353,6 +522,10 @@ bool Compushady::FixupSPIRV(TArray<uint8>& ByteCode, FCompushadyShaderResourceBi
 			ResourceBinding.Type = ECompushadySharedResourceType::UniformBuffer;
 			ResourceBinding.BindingIndex = Pair.Value.Binding;
 			ResourceBinding.SlotIndex = VulkanShaderHeader.UniformBuffers.Add(UniformBufferInfo);
+			if (SpirVPointers.Contains(Pair.Value.TypeId))
+			{
+				GetConstants(SpirVPointers[Pair.Value.TypeId], ResourceBinding.Constants);
+			}
 			VulkanShaderHeader.UniformBufferSpirvInfos.Add(SpirvInfo);
 
 			CBVMapping.Add(ResourceBinding.BindingIndex, ResourceBinding);
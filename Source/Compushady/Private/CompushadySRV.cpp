@@ -2,6 +2,7 @@
 
 
 #include "CompushadySRV.h"
+#include "TextureResource.h"
 
 bool UCompushadySRV::InitializeFromTexture(FTextureRHIRef InTextureRHIRef)
 {
@@ -12,20 +13,12 @@ bool UCompushadySRV::InitializeFromTexture(FTextureRHIRef InTextureRHIRef)
 
 	TextureRHIRef = InTextureRHIRef;
 
-	ENQUEUE_RENDER_COMMAND(DoCompushadyCreateShaderResourceView)(
+	EnqueueCreation(
 		[this](FRHICommandListImmediate& RHICmdList)
 		{
-
-			SRVRHIRef = COMPUSHADY_CREATE_SRV(TextureRHIRef, 0);
-
+			CreateTextureView(RHICmdList);
 		});
 
-	FlushRenderingCommands();
-	if (!SRVRHIRef)
-	{
-		return false;
-	}
-
 	InitFence(this);
 
 	if (InTextureRHIRef->GetOwnerName() == NAME_None)
@@ -38,6 +31,42 @@ bool UCompushadySRV::InitializeFromTexture(FTextureRHIRef InTextureRHIRef)
 	return true;
 }
 
+bool UCompushadySRV::InitializeFromTextureResource(FTextureResource* InTextureResource)
+{
+	if (!InTextureResource)
+	{
+		return false;
+	}
+
+	const FName OwnerName = *GetPathName();
+
+	// the RHI texture of the resource is available only in the render thread
+	EnqueueCreation(
+		[this, InTextureResource, OwnerName](FRHICommandListImmediate& RHICmdList)
+		{
+			TextureRHIRef = InTextureResource->GetTextureRHI();
+			if (!TextureRHIRef)
+			{
+				UE_LOG(LogCompushady, Error, TEXT("Texture Resource not available"));
+				bCreationFailed = true;
+				return;
+			}
+
+			if (TextureRHIRef->GetOwnerName() == NAME_None)
+			{
+				TextureRHIRef->SetOwnerName(OwnerName);
+			}
+
+			RHITransitionInfo = FRHITransitionInfo(TextureRHIRef, ERHIAccess::Unknown, ERHIAccess::SRVMask);
+
+			CreateTextureView(RHICmdList);
+		});
+
+	InitFence(this);
+
+	return true;
+}
+
 bool UCompushadySRV::InitializeFromSceneTexture(const ECompushadySceneTexture InSceneTexture)
 {
 	if (InSceneTexture == ECompushadySceneTexture::None)
@@ -59,21 +88,80 @@ bool UCompushadySRV::InitializeFromBuffer(FBufferRHIRef InBufferRHIRef, const EP
 
 	BufferRHIRef = InBufferRHIRef;
 
-	ENQUEUE_RENDER_COMMAND(DoCompushadyCreateShaderResourceView)(
+	EnqueueCreation(
 		[this, PixelFormat](FRHICommandListImmediate& RHICmdList)
 		{
+			CreateBufferView(RHICmdList, PixelFormat);
+		});
 
-			SRVRHIRef = COMPUSHADY_CREATE_SRV(BufferRHIRef, GPixelFormats[PixelFormat].BlockBytes, PixelFormat);
+	InitFence(this);
 
+	if (InBufferRHIRef->GetOwnerName() == NAME_None)
+	{
+		InBufferRHIRef->SetOwnerName(*GetPathName());
+	}
+
+	RHITransitionInfo = FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::SRVMask);
+
+	return true;
+}
+
+bool UCompushadySRV::InitializeFromRenderBuffer(TFunction<FRHIBuffer*()> BufferFunction, const EPixelFormat PixelFormat)
+{
+	if (!BufferFunction)
+	{
+		return false;
+	}
+
+	EnqueueCreation(
+		[this, BufferFunction, PixelFormat](FRHICommandListImmediate& RHICmdList)
+		{
+			BufferRHIRef = BufferFunction();
+			if (!BufferRHIRef)
+			{
+				UE_LOG(LogCompushady, Error, TEXT("Render Buffer not available"));
+				bCreationFailed = true;
+				return;
+			}
+
+			if (!EnumHasAnyFlags(BufferRHIRef->GetUsage(), EBufferUsageFlags::ShaderResource))
+			{
+				UE_LOG(LogCompushady, Error, TEXT("Render Buffer \"%s\" does not support Shader Resource Views"), *BufferRHIRef->GetName().ToString());
+				BufferRHIRef = nullptr;
+				bCreationFailed = true;
+				return;
+			}
+
+			// the engine still uses the buffer for drawing, so it is kept in a read state valid for both
+			RHITransitionInfo = FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::VertexOrIndexBuffer | ERHIAccess::SRVMask);
+			CreateBufferView(RHICmdList, PixelFormat);
 		});
 
-	FlushRenderingCommands();
+	InitFence(this);
 
-	if (!SRVRHIRef)
+	return true;
+}
+
+bool UCompushadySRV::InitializeFromStructuredBuffer(FBufferRHIRef InBufferRHIRef)
+{
+	if (!InBufferRHIRef)
 	{
 		return false;
 	}
 
+	if (InBufferRHIRef->GetStride() == 0)
+	{
+		return false;
+	}
+
+	BufferRHIRef = InBufferRHIRef;
+
+	EnqueueCreation(
+		[this](FRHICommandListImmediate& RHICmdList)
+		{
+			CreateBufferView(RHICmdList, EPixelFormat::PF_Unknown);
+		});
+
 	InitFence(this);
 
 	if (InBufferRHIRef->GetOwnerName() == NAME_None)
@@ -86,45 +174,101 @@ bool UCompushadySRV::InitializeFromBuffer(FBufferRHIRef InBufferRHIRef, const EP
 	return true;
 }
 
-bool UCompushadySRV::InitializeFromStructuredBuffer(FBufferRHIRef InBufferRHIRef)
+bool UCompushadySRV::InitializeFromStructuredBuffer(FBufferRHIRef InBufferRHIRef, const uint32 FirstElement, const uint32 NumElements)
 {
+#if COMPUSHADY_UE_VERSION >= 53
 	if (!InBufferRHIRef)
 	{
 		return false;
 	}
 
-	if (InBufferRHIRef->GetStride() == 0)
+	if (InBufferRHIRef->GetStride() == 0 || NumElements == 0 || (static_cast<uint64>(FirstElement) + NumElements) * InBufferRHIRef->GetStride() > InBufferRHIRef->GetSize())
 	{
 		return false;
 	}
 
 	BufferRHIRef = InBufferRHIRef;
+	BufferViewOffset = static_cast<int64>(FirstElement) * InBufferRHIRef->GetStride();
+	BufferViewSize = static_cast<int64>(NumElements) * InBufferRHIRef->GetStride();
 
-	ENQUEUE_RENDER_COMMAND(DoCompushadyCreateShaderResourceView)(
-		[this](FRHICommandListImmediate& RHICmdList)
+	EnqueueCreation(
+		[this, FirstElement, NumElements](FRHICommandListImmediate& RHICmdList)
+		{
+			SRVRHIRef = COMPUSHADY_CREATE_SRV(BufferRHIRef, FRHIViewDesc::CreateBufferSRV()
+				.SetType(FRHIViewDesc::EBufferType::Structured)
+				.SetStride(BufferRHIRef->GetStride())
+				.SetOffsetInBytes(FirstElement * BufferRHIRef->GetStride())
+				.SetNumElements(NumElements));
+
+			if (!SRVRHIRef)
+			{
+				UE_LOG(LogCompushady, Error, TEXT("Unable to create Shader Resource View for \"%s\""), *BufferRHIRef->GetName().ToString());
+				bCreationFailed = true;
+			}
+		});
+
+	InitFence(this);
+
+	RHITransitionInfo = FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::SRVMask);
+
+	return true;
+#else
+	UE_LOG(LogCompushady, Error, TEXT("Structured Buffer range views require Unreal Engine 5.3"));
+	return false;
+#endif
+}
+
+void UCompushadySRV::InitializeFromPendingBuffer(const FString& Name, const int64 Size, const EPixelFormat PixelFormat, TFunction<void(void*)> FillFunction)
+{
+	EnqueueBufferCreation(Name, Size, EBufferUsageFlags::ShaderResource | EBufferUsageFlags::VertexBuffer, GPixelFormats[PixelFormat].BlockBytes, ERHIAccess::SRVMask, FillFunction,
+		[this, PixelFormat](FRHICommandListImmediate& RHICmdList)
 		{
+			RHITransitionInfo = FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::SRVMask);
+			CreateBufferView(RHICmdList, PixelFormat);
+		});
 
-			SRVRHIRef = COMPUSHADY_CREATE_SRV(BufferRHIRef);
+	InitFence(this);
+}
 
+void UCompushadySRV::InitializeFromPendingStructuredBuffer(const FString& Name, const int64 Size, const int32 Stride, TFunction<void(void*)> FillFunction)
+{
+	EnqueueBufferCreation(Name, Size, EBufferUsageFlags::ShaderResource | EBufferUsageFlags::StructuredBuffer, Stride, ERHIAccess::SRVMask, FillFunction,
+		[this](FRHICommandListImmediate& RHICmdList)
+		{
+			RHITransitionInfo = FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::SRVMask);
+			CreateBufferView(RHICmdList, EPixelFormat::PF_Unknown);
 		});
 
-	FlushRenderingCommands();
+	InitFence(this);
+}
 
+void UCompushadySRV::CreateTextureView(FRHICommandListImmediate& RHICmdList)
+{
+	// all of the mips are exposed, so that mipmapped textures can be sampled at any level
+	SRVRHIRef = COMPUSHADY_CREATE_SRV(TextureRHIRef, FRHITextureSRVCreateInfo(0, TextureRHIRef->GetNumMips()));
 	if (!SRVRHIRef)
 	{
-		return false;
+		UE_LOG(LogCompushady, Error, TEXT("Unable to create Shader Resource View for \"%s\""), *TextureRHIRef->GetName().ToString());
+		bCreationFailed = true;
 	}
+}
 
-	InitFence(this);
-
-	if (InBufferRHIRef->GetOwnerName() == NAME_None)
+void UCompushadySRV::CreateBufferView(FRHICommandListImmediate& RHICmdList, const EPixelFormat PixelFormat)
+{
+	if (PixelFormat == EPixelFormat::PF_Unknown)
 	{
-		InBufferRHIRef->SetOwnerName(*GetPathName());
+		SRVRHIRef = COMPUSHADY_CREATE_SRV(BufferRHIRef);
+	}
+	else
+	{
+		SRVRHIRef = COMPUSHADY_CREATE_SRV(BufferRHIRef, GPixelFormats[PixelFormat].BlockBytes, PixelFormat);
 	}
 
-	RHITransitionInfo = FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::SRVMask);
-
-	return true;
+	if (!SRVRHIRef)
+	{
+		UE_LOG(LogCompushady, Error, TEXT("Unable to create Shader Resource View for \"%s\""), *BufferRHIRef->GetName().ToString());
+		bCreationFailed = true;
+	}
 }
 
 FTextureRHIRef UCompushadySRV::GetRHI(const FPostProcessMaterialInputs& PPInputs) const
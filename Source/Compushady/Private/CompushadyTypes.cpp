@@ -3,28 +3,244 @@
 
 #include "CompushadyTypes.h"
 #include "CompushadyCBV.h"
+#include "CompushadyCBVPool.h"
+#include "CompushadyConversion.h"
 #include "CompushadySampler.h"
 #include "CompushadySRV.h"
 #include "CompushadyUAV.h"
 #include "IImageWrapper.h"
 #include "IImageWrapperModule.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
 #include "Serialization/ArrayWriter.h"
 
+namespace Compushady
+{
+	namespace Readback
+	{
+		// number of staging buffers (and chunks) copied per GPU round trip
+		constexpr int32 NumStagingBuffers = 4;
+		constexpr int64 DefaultChunkSize = 64 * 1024 * 1024;
+
+		struct FTextureReadbackLayout
+		{
+			FIntPoint AtlasSize = FIntPoint::ZeroValue;
+			TArray<FCompushadyTextureReadbackRegion> Regions;
+			TArray<FRHICopyTextureInfo> Copies;
+		};
+
+		// every slice gets a cell containing its mip chain stacked vertically, cells are arranged in a grid
+		bool ComputeTextureReadbackLayout(FRHITexture* Texture, const int32 FirstSlice, const int32 NumSlices, const int32 FirstMip, const int32 NumMips, FTextureReadbackLayout& Layout, FString& ErrorMessages)
+		{
+			const FRHITextureDesc& Desc = Texture->GetDesc();
+			const bool bIsVolume = Desc.Dimension == ETextureDimension::Texture3D;
+			const int32 TotalSlices = bIsVolume ? Desc.Depth : (Desc.IsTextureCube() ? Desc.ArraySize * 6 : Desc.ArraySize);
+
+			if (GPixelFormats[Desc.Format].BlockSizeX != 1 || GPixelFormats[Desc.Format].BlockSizeY != 1)
+			{
+				ErrorMessages = FString::Printf(TEXT("Unsupported block compressed PixelFormat %s"), GPixelFormats[Desc.Format].Name);
+				return false;
+			}
+
+			if (FirstSlice < 0 || NumSlices <= 0 || FirstSlice + NumSlices > TotalSlices)
+			{
+				ErrorMessages = FString::Printf(TEXT("Invalid slices range %d-%d (expected 0-%d)"), FirstSlice, FirstSlice + NumSlices, TotalSlices);
+				return false;
+			}
+
+			if (FirstMip < 0 || NumMips <= 0 || FirstMip + NumMips > Desc.NumMips)
+			{
+				ErrorMessages = FString::Printf(TEXT("Invalid mips range %d-%d (expected 0-%d)"), FirstMip, FirstMip + NumMips, Desc.NumMips);
+				return false;
+			}
+
+			const FIntPoint CellSize(FMath::Max(Desc.Extent.X >> FirstMip, 1), [&]()
+				{
+					int32 Height = 0;
+					for (int32 Mip = FirstMip; Mip < FirstMip + NumMips; Mip++)
+					{
+						Height += FMath::Max(Desc.Extent.Y >> Mip, 1);
+					}
+					return Height;
+				}());
+
+			const int32 MaxDimension = GetMax2DTextureDimension();
+			const int32 Columns = FMath::Clamp(MaxDimension / CellSize.X, 1, NumSlices);
+			const int32 Rows = FMath::DivideAndRoundUp(NumSlices, Columns);
+
+			Layout.AtlasSize = FIntPoint(Columns * CellSize.X, Rows * CellSize.Y);
+			if (Layout.AtlasSize.X > MaxDimension || Layout.AtlasSize.Y > MaxDimension)
+			{
+				ErrorMessages = FString::Printf(TEXT("Readback of %d slices and %d mips (%dx%d) does not fit in a single staging texture"), NumSlices, NumMips, Layout.AtlasSize.X, Layout.AtlasSize.Y);
+				return false;
+			}
+
+			for (int32 SliceIndex = 0; SliceIndex < NumSlices; SliceIndex++)
+			{
+				const int32 Slice = FirstSlice + SliceIndex;
+				const int32 CellX = (SliceIndex % Columns) * CellSize.X;
+				int32 CellY = (SliceIndex / Columns) * CellSize.Y;
+
+				for (int32 Mip = FirstMip; Mip < FirstMip + NumMips; Mip++)
+				{
+					const FIntPoint MipSize(FMath::Max(Desc.Extent.X >> Mip, 1), FMath::Max(Desc.Extent.Y >> Mip, 1));
+
+					// volume mips have less slices
+					if (!bIsVolume || Slice < FMath::Max(Desc.Depth >> Mip, 1))
+					{
+						FCompushadyTextureReadbackRegion Region;
+						Region.Slice = Slice;
+						Region.Mip = Mip;
+						Region.Size = MipSize;
+						// Offset and RowPitch are resolved after mapping
+						Region.Offset = CellX;
+						Region.RowPitch = CellY;
+						Layout.Regions.Add(Region);
+
+						FRHICopyTextureInfo CopyTextureInfo;
+						CopyTextureInfo.Size = FIntVector(MipSize.X, MipSize.Y, 1);
+						CopyTextureInfo.SourceMipIndex = Mip;
+						if (bIsVolume)
+						{
+							CopyTextureInfo.SourcePosition.Z = Slice;
+						}
+						else
+						{
+							CopyTextureInfo.SourceSliceIndex = Slice;
+						}
+						CopyTextureInfo.DestPosition = FIntVector(CellX, CellY, 0);
+						Layout.Copies.Add(CopyTextureInfo);
+					}
+
+					CellY += MipSize.Y;
+				}
+			}
+
+			return true;
+		}
+
+		void MapTextureReadbackLayout(FRHICommandListImmediate& RHICmdList, FRHITexture* Texture, FTextureRHIRef& ReadbackTexture, FTextureReadbackLayout& Layout, TFunction<void(const uint8*, const TArray<FCompushadyTextureReadbackRegion>&)> InFunction)
+		{
+			if (!ReadbackTexture.IsValid() || ReadbackTexture->GetSizeXY() != Layout.AtlasSize || ReadbackTexture->GetFormat() != Texture->GetFormat())
+			{
+				FRHITextureCreateDesc TextureCreateDesc = FRHITextureCreateDesc::Create2D(TEXT("CompushadyReadbackAtlas"), Layout.AtlasSize.X, Layout.AtlasSize.Y, Texture->GetFormat());
+				TextureCreateDesc.SetFlags(ETextureCreateFlags::CPUReadback);
+				ReadbackTexture = RHICreateTexture(TextureCreateDesc);
+			}
+
+			RHICmdList.Transition(FRHITransitionInfo(Texture, ERHIAccess::Unknown, ERHIAccess::CopySrc));
+			for (const FRHICopyTextureInfo& CopyTextureInfo : Layout.Copies)
+			{
+				RHICmdList.CopyTexture(Texture, ReadbackTexture, CopyTextureInfo);
+			}
+			RHICmdList.SubmitCommandsAndFlushGPU();
+			RHICmdList.BlockUntilGPUIdle();
+
+			int32 Width = 0;
+			int32 Height = 0;
+			void* Data = nullptr;
+			RHICmdList.MapStagingSurface(ReadbackTexture, Data, Width, Height);
+			if (Data)
+			{
+				const int64 BlockBytes = GPixelFormats[Texture->GetFormat()].BlockBytes;
+				const int64 RowPitch = Width * BlockBytes;
+				for (FCompushadyTextureReadbackRegion& Region : Layout.Regions)
+				{
+					Region.Offset = Region.RowPitch * RowPitch + Region.Offset * BlockBytes;
+					Region.RowPitch = RowPitch;
+				}
+				InFunction(reinterpret_cast<const uint8*>(Data), Layout.Regions);
+				RHICmdList.UnmapStagingSurface(ReadbackTexture);
+			}
+		}
+	}
+}
+
 FTextureRHIRef UCompushadyResource::GetTextureRHI() const
 {
+	WaitForCreation();
 	return TextureRHIRef;
 }
 
 FBufferRHIRef UCompushadyResource::GetBufferRHI() const
 {
+	WaitForCreation();
 	return BufferRHIRef;
 }
 
 const FRHITransitionInfo& UCompushadyResource::GetRHITransitionInfo() const
 {
+	WaitForCreation();
 	return RHITransitionInfo;
 }
 
+bool UCompushadyResource::IsPending() const
+{
+	return CreationCompletionEvent && !CreationCompletionEvent->IsComplete();
+}
+
+bool UCompushadyResource::IsReadyForFinishDestroy()
+{
+	// the creation command enqueued in the render thread still references this object
+	return Super::IsReadyForFinishDestroy() && !IsPending();
+}
+
+bool UCompushadyResource::IsCreationFailed() const
+{
+	WaitForCreation();
+	return bCreationFailed;
+}
+
+void UCompushadyResource::WaitForCreation() const
+{
+	if (IsInGameThread() && IsPending())
+	{
+		FTaskGraphInterface::Get().WaitUntilTaskCompletes(CreationCompletionEvent);
+	}
+}
+
+void UCompushadyResource::EnqueueCreation(TFunction<void(FRHICommandListImmediate& RHICmdList)> InFunction)
+{
+	ENQUEUE_RENDER_COMMAND(DoCompushadyCreateResource)(
+		[InFunction](FRHICommandListImmediate& RHICmdList)
+		{
+			InFunction(RHICmdList);
+		});
+
+	// like BeginFence, this task is executed by the render thread after the creation command
+	CreationCompletionEvent = FFunctionGraphTask::CreateAndDispatchWhenReady([] {}, TStatId(), nullptr, ENamedThreads::GetRenderThread());
+}
+
+void UCompushadyResource::EnqueueBufferCreation(const FString& Name, const int64 Size, const EBufferUsageFlags Usage, const uint32 Stride, const ERHIAccess InitialState, TFunction<void(void*)> FillFunction, TFunction<void(FRHICommandListImmediate& RHICmdList)> OnCreated)
+{
+	const FName OwnerName = *GetPathName();
+
+	EnqueueCreation([this, Name, Size, Usage, Stride, InitialState, FillFunction, OnCreated, OwnerName](FRHICommandListImmediate& RHICmdList)
+		{
+			FRHIResourceCreateInfo ResourceCreateInfo(*Name);
+			FBufferRHIRef NewBufferRHIRef = COMPUSHADY_CREATE_BUFFER(Size, Usage, Stride, InitialState, ResourceCreateInfo);
+			if (!NewBufferRHIRef.IsValid() || !NewBufferRHIRef->IsValid())
+			{
+				UE_LOG(LogCompushady, Error, TEXT("Unable to create Buffer \"%s\" (%lld bytes)"), *Name, Size);
+				bCreationFailed = true;
+				return;
+			}
+
+			if (FillFunction)
+			{
+				void* LockedData = RHICmdList.LockBuffer(NewBufferRHIRef, 0, Size, EResourceLockMode::RLM_WriteOnly);
+				FillFunction(LockedData);
+				RHICmdList.UnlockBuffer(NewBufferRHIRef);
+			}
+
+			NewBufferRHIRef->SetOwnerName(OwnerName);
+			BufferRHIRef = NewBufferRHIRef;
+
+			OnCreated(RHICmdList);
+		});
+}
+
 FStagingBufferRHIRef UCompushadyResource::GetStagingBuffer()
 {
 	if (!StagingBufferRHIRef.IsValid() || !StagingBufferRHIRef->IsValid())
@@ -39,7 +255,7 @@ FBufferRHIRef UCompushadyResource::GetUploadBuffer(FRHICommandListImmediate& RHI
 	if (!UploadBufferRHIRef.IsValid() || !UploadBufferRHIRef->IsValid())
 	{
 		FRHIResourceCreateInfo ResourceCreateInfo(TEXT(""));
-		UploadBufferRHIRef = COMPUSHADY_CREATE_BUFFER(BufferRHIRef->GetSize(), EBufferUsageFlags::VertexBuffer, BufferRHIRef->GetStride(), ERHIAccess::CopySrc, ResourceCreateInfo);
+		UploadBufferRHIRef = COMPUSHADY_CREATE_BUFFER(GetBufferSize(), EBufferUsageFlags::VertexBuffer, BufferRHIRef->GetStride(), ERHIAccess::CopySrc, ResourceCreateInfo);
 	}
 
 	return UploadBufferRHIRef;
@@ -109,6 +325,141 @@ bool UCompushadyResource::UpdateTextureSliceSync(const TArray<uint8>& Pixels, co
 	return UpdateTextureSliceSync(Pixels.GetData(), Pixels.Num(), Slice);
 }
 
+void UCompushadyResource::UpdateTextureAsync(TSharedRef<TArray64<uint8>, ESPMode::ThreadSafe> Pixels, const TArray<FCompushadyTextureUploadRegion>& Regions, const FCompushadySignaled& OnSignaled)
+{
+	if (IsRunning())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Resource is already being processed by another task");
+		return;
+	}
+
+	if (!IsValidTexture())
+	{
+		OnSignaled.ExecuteIfBound(false, "The resource is not a valid Texture");
+		return;
+	}
+
+	const FRHITextureDesc& Desc = TextureRHIRef->GetDesc();
+	const FPixelFormatInfo& PixelFormatInfo = GPixelFormats[Desc.Format];
+	const bool bIsVolume = Desc.Dimension == ETextureDimension::Texture3D;
+
+	if (PixelFormatInfo.BlockSizeX != 1 || PixelFormatInfo.BlockSizeY != 1)
+	{
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Unsupported block compressed PixelFormat %s"), PixelFormatInfo.Name));
+		return;
+	}
+
+	if (Desc.IsTextureCube())
+	{
+		OnSignaled.ExecuteIfBound(false, "Cube textures are not supported");
+		return;
+	}
+
+	// resolve and validate regions in the game thread, so that the render thread only copies data
+	TArray<FCompushadyTextureUploadRegion> ResolvedRegions = Regions;
+	for (FCompushadyTextureUploadRegion& Region : ResolvedRegions)
+	{
+		if (Region.Mip < 0 || Region.Mip >= Desc.NumMips)
+		{
+			OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid Mip %d"), Region.Mip));
+			return;
+		}
+
+		const FIntPoint MipSize(FMath::Max(Desc.Extent.X >> Region.Mip, 1), FMath::Max(Desc.Extent.Y >> Region.Mip, 1));
+		const int32 MipSlices = bIsVolume ? FMath::Max(Desc.Depth >> Region.Mip, 1) : Desc.ArraySize;
+
+		if (Region.Size.X == 0 && Region.Size.Y == 0)
+		{
+			Region.Size = MipSize - Region.Offset;
+		}
+
+		if (Region.Offset.X < 0 || Region.Offset.Y < 0 || Region.Size.X <= 0 || Region.Size.Y <= 0 || Region.Offset.X + Region.Size.X > MipSize.X || Region.Offset.Y + Region.Size.Y > MipSize.Y)
+		{
+			OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid region %dx%d at %dx%d for mip %d"), Region.Size.X, Region.Size.Y, Region.Offset.X, Region.Offset.Y, Region.Mip));
+			return;
+		}
+
+		if (Region.Slice < 0 || Region.NumSlices <= 0 || Region.Slice + Region.NumSlices > MipSlices)
+		{
+			OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid slices range %d-%d (expected 0-%d)"), Region.Slice, Region.Slice + Region.NumSlices, MipSlices));
+			return;
+		}
+
+		// locked array slices are fully overwritten
+		if (!bIsVolume && Desc.Dimension != ETextureDimension::Texture2D && Region.Size != MipSize)
+		{
+			OnSignaled.ExecuteIfBound(false, "Partial regions are not supported for Texture2DArray");
+			return;
+		}
+
+		if (Region.RowPitch == 0)
+		{
+			Region.RowPitch = Region.Size.X * PixelFormatInfo.BlockBytes;
+		}
+
+		if (Region.DataOffset < 0 || Region.RowPitch < Region.Size.X * PixelFormatInfo.BlockBytes || Region.DataOffset + Region.RowPitch * Region.Size.Y * Region.NumSlices > Pixels->Num())
+		{
+			OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Not enough data for region at offset %lld (expected %lld bytes, got %lld)"), Region.DataOffset, Region.RowPitch * Region.Size.Y * Region.NumSlices, Pixels->Num() - Region.DataOffset));
+			return;
+		}
+	}
+
+	EnqueueToGPU(
+		[this, Pixels, ResolvedRegions](FRHICommandListImmediate& RHICmdList)
+		{
+			const ETextureDimension Dimension = TextureRHIRef->GetDesc().Dimension;
+			for (const FCompushadyTextureUploadRegion& Region : ResolvedRegions)
+			{
+				const uint8* Ptr = Pixels->GetData() + Region.DataOffset;
+				const int64 DepthPitch = Region.RowPitch * Region.Size.Y;
+
+				if (Dimension == ETextureDimension::Texture2D)
+				{
+					FUpdateTextureRegion2D UpdateRegion(Region.Offset.X, Region.Offset.Y, 0, 0, Region.Size.X, Region.Size.Y);
+					RHICmdList.UpdateTexture2D(TextureRHIRef, Region.Mip, UpdateRegion, Region.RowPitch, Ptr);
+				}
+				else if (Dimension == ETextureDimension::Texture2DArray)
+				{
+					for (int32 Slice = 0; Slice < Region.NumSlices; Slice++)
+					{
+						uint32 DestStride;
+						void* Data = RHICmdList.LockTexture2DArray(TextureRHIRef, Region.Slice + Slice, Region.Mip, EResourceLockMode::RLM_WriteOnly, DestStride, false);
+						if (Data)
+						{
+							CopyTextureData2D(Ptr + DepthPitch * Slice, Data, Region.Size.Y, TextureRHIRef->GetFormat(), Region.RowPitch, DestStride);
+							RHICmdList.UnlockTexture2DArray(TextureRHIRef, Region.Slice + Slice, Region.Mip, false);
+						}
+					}
+				}
+				else if (Dimension == ETextureDimension::Texture3D)
+				{
+					// all of the slices are uploaded with a single copy
+					FUpdateTextureRegion3D UpdateRegion(Region.Offset.X, Region.Offset.Y, Region.Slice, 0, 0, 0, Region.Size.X, Region.Size.Y, Region.NumSlices);
+					RHICmdList.UpdateTexture3D(TextureRHIRef, Region.Mip, UpdateRegion, Region.RowPitch, DepthPitch, Ptr);
+				}
+			}
+		}, OnSignaled);
+}
+
+void UCompushadyResource::UpdateTextureAsync(TArray64<uint8>&& Pixels, const TArray<FCompushadyTextureUploadRegion>& Regions, const FCompushadySignaled& OnSignaled)
+{
+	UpdateTextureAsync(MakeShared<TArray64<uint8>, ESPMode::ThreadSafe>(MoveTemp(Pixels)), Regions, OnSignaled);
+}
+
+void UCompushadyResource::UpdateTextureSlicesAsync(const TArray<uint8>& Pixels, const int32 FirstSlice, const int32 NumSlices, const FCompushadySignaled& OnSignaled)
+{
+	FCompushadyTextureUploadRegion Region;
+	Region.Slice = FirstSlice;
+	Region.NumSlices = NumSlices;
+
+	UpdateTextureRegionsAsync(Pixels, { Region }, OnSignaled);
+}
+
+void UCompushadyResource::UpdateTextureRegionsAsync(const TArray<uint8>& Pixels, const TArray<FCompushadyTextureUploadRegion>& Regions, const FCompushadySignaled& OnSignaled)
+{
+	UpdateTextureAsync(TArray64<uint8>(Pixels), Regions, OnSignaled);
+}
+
 void UCompushadyResource::ReadbackAllToFloatArray(const FCompushadySignaledWithFloatArrayPayload& OnSignaled)
 {
 	if (IsRunning())
@@ -123,10 +474,10 @@ void UCompushadyResource::ReadbackAllToFloatArray(const FCompushadySignaledWithF
 		{
 			FStagingBufferRHIRef StagingBuffer = GetStagingBuffer();
 			RHICmdList.Transition(FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::CopySrc));
-			RHICmdList.CopyToStagingBuffer(BufferRHIRef, StagingBuffer, 0, BufferRHIRef->GetSize());
+			RHICmdList.CopyToStagingBuffer(BufferRHIRef, StagingBuffer, static_cast<uint32>(BufferViewOffset), static_cast<uint32>(GetBufferSize()));
 			WaitForGPU(RHICmdList);
-			uint8* Data = reinterpret_cast<uint8*>(RHICmdList.LockStagingBuffer(StagingBuffer, nullptr, 0, BufferRHIRef->GetSize()));
-			const uint32 FloatBufferSize = BufferRHIRef->GetSize() / sizeof(float);
+			uint8* Data = reinterpret_cast<uint8*>(RHICmdList.LockStagingBuffer(StagingBuffer, nullptr, 0, static_cast<uint32>(GetBufferSize())));
+			const uint32 FloatBufferSize = GetBufferSize() / sizeof(float);
 			ReadbackCacheFloats.Empty(FloatBufferSize);
 			ReadbackCacheFloats.Append(reinterpret_cast<const float*>(Data), FloatBufferSize);
 			RHICmdList.UnlockStagingBuffer(StagingBuffer);
@@ -135,12 +486,14 @@ void UCompushadyResource::ReadbackAllToFloatArray(const FCompushadySignaledWithF
 
 bool UCompushadyResource::IsValidTexture() const
 {
-	return TextureRHIRef.IsValid() && TextureRHIRef->IsValid();
+	WaitForCreation();
+	return !bCreationFailed && TextureRHIRef.IsValid() && TextureRHIRef->IsValid();
 }
 
 bool UCompushadyResource::IsValidBuffer() const
 {
-	return BufferRHIRef.IsValid() && BufferRHIRef->IsValid();
+	WaitForCreation();
+	return !bCreationFailed && BufferRHIRef.IsValid() && BufferRHIRef->IsValid();
 }
 
 EPixelFormat UCompushadyResource::GetTexturePixelFormat() const
@@ -155,54 +508,308 @@ EPixelFormat UCompushadyResource::GetTexturePixelFormat() const
 
 void UCompushadyResource::ReadbackTextureToPngFile(const FString& Filename, const FCompushadySignaled& OnSignaled)
 {
+	if (IsRunning())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Resource is already being processed by another task");
+		return;
+	}
+
 	if (!IsValidTexture())
 	{
 		OnSignaled.ExecuteIfBound(false, "The resource is not a valid Texture");
 		return;
 	}
 
-	auto PngWriter = [this, Filename](const void* Data)
+	const EPixelFormat PixelFormat = GetTexturePixelFormat();
+	if (GPixelFormats[PixelFormat].NumComponents != 4 || !Compushady::Conversion::SupportsPixelFormat(PixelFormat))
+	{
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Unsupported PixelFormat %s"), GPixelFormats[PixelFormat].Name));
+		return;
+	}
+
+	TSharedRef<Compushady::Readback::FTextureReadbackLayout> Layout = MakeShared<Compushady::Readback::FTextureReadbackLayout>();
+	FString LayoutErrorMessages;
+	if (!Compushady::Readback::ComputeTextureReadbackLayout(TextureRHIRef, 0, 1, 0, 1, *Layout, LayoutErrorMessages))
+	{
+		OnSignaled.ExecuteIfBound(false, LayoutErrorMessages);
+		return;
+	}
+
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+
+	struct FCompushadyPngReadback
+	{
+		TArray64<uint8> Pixels;
+		FIntPoint Size = FIntPoint::ZeroValue;
+	};
+
+	TSharedRef<FCompushadyPngReadback, ESPMode::ThreadSafe> Readback = MakeShared<FCompushadyPngReadback, ESPMode::ThreadSafe>();
+	TSharedRef<FString, ESPMode::ThreadSafe> ErrorMessages = MakeShared<FString, ESPMode::ThreadSafe>();
+
+	// the render thread only copies the mapped pixels, the conversion and the compression happen in a background task
+	ENQUEUE_RENDER_COMMAND(DoCompushadyReadbackTextureToPngFile)(
+		[this, Layout, PixelFormat, Readback](FRHICommandListImmediate& RHICmdList)
 		{
-			FIntVector Size = GetTextureSize();
-			IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+			Compushady::Readback::MapTextureReadbackLayout(RHICmdList, TextureRHIRef, ReadbackAtlasTextureRHIRef, *Layout, [PixelFormat, Readback](const uint8* Data, const TArray<FCompushadyTextureReadbackRegion>& Regions)
+				{
+					const FCompushadyTextureReadbackRegion& Region = Regions[0];
+					const int64 RowSize = Region.Size.X * GPixelFormats[PixelFormat].BlockBytes;
+					Readback->Pixels.SetNumUninitialized(RowSize * Region.Size.Y);
+					Readback->Size = Region.Size;
+					CopyTextureData2D(Data + Region.Offset, Readback->Pixels.GetData(), Region.Size.Y, PixelFormat, Region.RowPitch, RowSize);
+				});
+		});
 
-			TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
-			if (ImageWrapper.IsValid())
+	FGraphEventArray Prerequisites;
+	Prerequisites.Add(FFunctionGraphTask::CreateAndDispatchWhenReady([] {}, TStatId(), nullptr, ENamedThreads::GetRenderThread()));
+
+	FGraphEventRef WorkerCompletionEvent = FFunctionGraphTask::CreateAndDispatchWhenReady([Filename, PixelFormat, &ImageWrapperModule, Readback, ErrorMessages]()
+		{
+			TArray64<uint8>& Pixels = Readback->Pixels;
+			if (Pixels.Num() == 0)
 			{
+				*ErrorMessages = "Unable to map the texture";
+				return;
+			}
 
-				if (ImageWrapper->SetRaw(Data, Size.X * Size.Y * GPixelFormats[GetTextureRHI()->GetDesc().Format].BlockBytes, Size.X, Size.Y, ERGBFormat::BGRA, 8))
-				{
+			ERGBFormat RGBFormat = ERGBFormat::BGRA;
+			int32 BitDepth = 8;
 
-					TArray64<uint8> CompressedBytes = ImageWrapper->GetCompressed();
-					FFileHelper::SaveArrayToFile(CompressedBytes, *Filename);
+			if (PixelFormat == EPixelFormat::PF_R8G8B8A8)
+			{
+				RGBFormat = ERGBFormat::RGBA;
+			}
+			else if (PixelFormat != EPixelFormat::PF_B8G8R8A8)
+			{
+				// everything else (16 bit, half, float, packed) is stored as RGBA16
+				TArray<float> Floats;
+				if (!Compushady::Conversion::PixelFormatToFloat(PixelFormat, Pixels.GetData(), Pixels.Num(), Floats))
+				{
+					*ErrorMessages = FString::Printf(TEXT("Unable to convert PixelFormat %s"), GPixelFormats[PixelFormat].Name);
+					return;
 				}
+				Pixels.SetNumUninitialized(Floats.Num() * sizeof(uint16));
+				Compushady::Conversion::FloatToUnorm16(Floats.GetData(), reinterpret_cast<uint16*>(Pixels.GetData()), Floats.Num());
+				RGBFormat = ERGBFormat::RGBA;
+				BitDepth = 16;
 			}
-		};
 
-	MapReadAndExecute(PngWriter, OnSignaled);
+			TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+			if (!ImageWrapper.IsValid() || !ImageWrapper->SetRaw(Pixels.GetData(), Pixels.Num(), Readback->Size.X, Readback->Size.Y, RGBFormat, BitDepth))
+			{
+				*ErrorMessages = "Unable to encode PNG";
+				return;
+			}
+
+			if (!FFileHelper::SaveArrayToFile(ImageWrapper->GetCompressed(), *Filename))
+			{
+				*ErrorMessages = FString::Printf(TEXT("Unable to write file \"%s\""), *Filename);
+			}
+		}, TStatId(), &Prerequisites, ENamedThreads::AnyBackgroundThreadNormalTask);
+
+	BeginFence(OnSignaled, WorkerCompletionEvent, ErrorMessages);
 }
 
 void UCompushadyResource::ReadbackAllToFile(const FString& Filename, const FCompushadySignaled& OnSignaled)
 {
-	auto FileWriter = [this, Filename](const void* Data)
+	if (IsValidBuffer())
+	{
+		ReadbackAllToFileStreamed(Filename, Compushady::Readback::DefaultChunkSize, {}, OnSignaled);
+		return;
+	}
+
+	if (!IsValidTexture())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Resource is in invalid state or is not mappable");
+		return;
+	}
+
+	// textures are written with all of their slices and mips (in the readback regions order), without row padding
+	const FRHITextureDesc& Desc = GetTextureRHI()->GetDesc();
+	const int32 NumSlices = Desc.Dimension == ETextureDimension::Texture3D ? Desc.Depth : GetTextureNumSlices();
+	const EPixelFormat PixelFormat = Desc.Format;
+
+	auto FileWriter = [Filename, PixelFormat](const uint8* Data, const TArray<FCompushadyTextureReadbackRegion>& Regions)
 		{
-			int32 Size = 0;
-			if (IsValidBuffer())
+			TArray64<uint8> Bytes;
+			for (const FCompushadyTextureReadbackRegion& Region : Regions)
 			{
-				Size = GetBufferSize();
+				const int64 RowSize = Region.Size.X * GPixelFormats[PixelFormat].BlockBytes;
+				const int64 Offset = Bytes.Num();
+				Bytes.AddUninitialized(RowSize * Region.Size.Y);
+				CopyTextureData2D(Data + Region.Offset, Bytes.GetData() + Offset, Region.Size.Y, PixelFormat, Region.RowPitch, RowSize);
 			}
-			else if (IsValidTexture())
+			FFileHelper::SaveArrayToFile(Bytes, *Filename);
+		};
+
+	MapTextureSlicesAndExecute(FileWriter, OnSignaled, 0, NumSlices, 0, Desc.NumMips);
+}
+
+void UCompushadyResource::ReadbackAllToFileStreamed(const FString& Filename, const int64 ChunkSize, const FCompushadyProgress& OnProgress, const FCompushadySignaled& OnSignaled)
+{
+	if (IsRunning())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Resource is already being processed by another task");
+		return;
+	}
+
+	if (!IsValidBuffer())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Resource is in invalid state or is not mappable");
+		return;
+	}
+
+	if (ChunkSize <= 0 || ChunkSize > MAX_uint32)
+	{
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid ChunkSize %lld"), ChunkSize));
+		return;
+	}
+
+	TSharedPtr<IFileHandle, ESPMode::ThreadSafe> FileHandle = MakeShareable(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Filename));
+	if (!FileHandle.IsValid())
+	{
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Unable to open file \"%s\" for writing"), *Filename));
+		return;
+	}
+
+	const FBufferRHIRef SourceBufferRHIRef = BufferRHIRef;
+	const int64 TotalSize = GetBufferSize();
+	const int64 StagingSize = FMath::Min(ChunkSize, TotalSize);
+	TSharedRef<FString, ESPMode::ThreadSafe> ErrorMessages = MakeShared<FString, ESPMode::ThreadSafe>();
+
+	// the whole loop runs in a background task, the render thread is involved only for copying
+	// a batch of chunks (one GPU wait per batch) while the previous batch is being written to disk.
+	FGraphEventRef WorkerCompletionEvent = FFunctionGraphTask::CreateAndDispatchWhenReady([this, SourceBufferRHIRef, FileHandle, TotalSize, StagingSize, OnProgress, ErrorMessages]()
+		{
+			constexpr int32 NumStagingBuffers = Compushady::Readback::NumStagingBuffers;
+
+			struct FCompushadyReadbackBatch
 			{
-				Size = TextureRHIRef->GetDesc().CalcMemorySizeEstimate();
+				int64 Offset = 0;
+				int32 NumChunks = 0;
+				TArray64<uint8> Chunks[NumStagingBuffers];
+				FEvent* Event = nullptr;
+			};
+
+			TArray<FStagingBufferRHIRef> StagingBuffers;
+			FCompushadyReadbackBatch Batches[2];
+
+			auto EnqueueBatch = [this, &StagingBuffers, SourceBufferRHIRef, TotalSize, StagingSize](FCompushadyReadbackBatch& Batch, const int64 Offset)
+				{
+					Batch.Offset = Offset;
+					Batch.NumChunks = FMath::Min<int64>(NumStagingBuffers, FMath::DivideAndRoundUp(TotalSize - Offset, StagingSize));
+					Batch.Event = FPlatformProcess::GetSynchEventFromPool();
+
+					ENQUEUE_RENDER_COMMAND(DoCompushadyStreamedReadback)(
+						[this, &StagingBuffers, &Batch, SourceBufferRHIRef, TotalSize, StagingSize](FRHICommandListImmediate& RHICmdList)
+						{
+							while (StagingBuffers.Num() < NumStagingBuffers)
+							{
+								StagingBuffers.Add(RHICreateStagingBuffer());
+							}
+
+							RHICmdList.Transition(FRHITransitionInfo(SourceBufferRHIRef, ERHIAccess::Unknown, ERHIAccess::CopySrc));
+							for (int32 ChunkIndex = 0; ChunkIndex < Batch.NumChunks; ChunkIndex++)
+							{
+								const int64 ChunkOffset = Batch.Offset + ChunkIndex * StagingSize;
+								const int64 ChunkSize = FMath::Min(StagingSize, TotalSize - ChunkOffset);
+								RHICmdList.CopyToStagingBuffer(SourceBufferRHIRef, StagingBuffers[ChunkIndex], static_cast<uint32>(BufferViewOffset + ChunkOffset), static_cast<uint32>(ChunkSize));
+							}
+
+							WaitForGPU(RHICmdList);
+
+							for (int32 ChunkIndex = 0; ChunkIndex < Batch.NumChunks; ChunkIndex++)
+							{
+								const int64 ChunkOffset = Batch.Offset + ChunkIndex * StagingSize;
+								const int64 ChunkSize = FMath::Min(StagingSize, TotalSize - ChunkOffset);
+								Batch.Chunks[ChunkIndex].SetNumUninitialized(ChunkSize);
+								const void* Data = RHICmdList.LockStagingBuffer(StagingBuffers[ChunkIndex], nullptr, 0, static_cast<uint32>(ChunkSize));
+								if (Data)
+								{
+									FMemory::Memcpy(Batch.Chunks[ChunkIndex].GetData(), Data, ChunkSize);
+									RHICmdList.UnlockStagingBuffer(StagingBuffers[ChunkIndex]);
+								}
+								else
+								{
+									Batch.Chunks[ChunkIndex].Empty();
+								}
+							}
+
+							Batch.Event->Trigger();
+						});
+				};
+
+			auto WaitBatch = [](FCompushadyReadbackBatch& Batch)
+				{
+					if (Batch.Event)
+					{
+						Batch.Event->Wait();
+						FPlatformProcess::ReturnSynchEventToPool(Batch.Event);
+						Batch.Event = nullptr;
+					}
+				};
+
+			int64 NextOffset = 0;
+			int32 CurrentBatch = 0;
+
+			EnqueueBatch(Batches[CurrentBatch], NextOffset);
+			NextOffset += Batches[CurrentBatch].NumChunks * StagingSize;
+
+			while (Batches[CurrentBatch].Event)
+			{
+				FCompushadyReadbackBatch& Batch = Batches[CurrentBatch];
+				WaitBatch(Batch);
+
+				// start copying the next batch while this one is written
+				if (NextOffset < TotalSize)
+				{
+					FCompushadyReadbackBatch& NextBatch = Batches[1 - CurrentBatch];
+					EnqueueBatch(NextBatch, NextOffset);
+					NextOffset += NextBatch.NumChunks * StagingSize;
+				}
+
+				int64 WrittenOffset = Batch.Offset;
+				for (int32 ChunkIndex = 0; ChunkIndex < Batch.NumChunks; ChunkIndex++)
+				{
+					const TArray64<uint8>& Chunk = Batch.Chunks[ChunkIndex];
+					if (Chunk.Num() == 0)
+					{
+						*ErrorMessages = FString::Printf(TEXT("Unable to map staging buffer at offset %lld"), WrittenOffset);
+						break;
+					}
+					if (!FileHandle->Write(Chunk.GetData(), Chunk.Num()))
+					{
+						*ErrorMessages = FString::Printf(TEXT("Unable to write %lld bytes at offset %lld"), Chunk.Num(), WrittenOffset);
+						break;
+					}
+					WrittenOffset += Chunk.Num();
+				}
+
+				if (!ErrorMessages->IsEmpty())
+				{
+					// the in-flight batch references our stack, so wait for it
+					WaitBatch(Batches[1 - CurrentBatch]);
+					break;
+				}
+
+				if (OnProgress.IsBound())
+				{
+					AsyncTask(ENamedThreads::GameThread, [OnProgress, WrittenOffset, TotalSize]()
+						{
+							OnProgress.ExecuteIfBound(WrittenOffset, TotalSize);
+						});
+				}
+
+				CurrentBatch = 1 - CurrentBatch;
 			}
-			if (Size > 0)
+
+			if (ErrorMessages->IsEmpty() && !FileHandle->Flush())
 			{
-				TArrayView<const uint8> ArrayView = TArrayView<const uint8>(reinterpret_cast<const uint8*>(Data), Size);
-				FFileHelper::SaveArrayToFile(ArrayView, *Filename);
+				*ErrorMessages = "Unable to flush file";
 			}
-		};
+		}, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
 
-	MapReadAndExecute(FileWriter, OnSignaled);
+	BeginFence(OnSignaled, WorkerCompletionEvent, ErrorMessages);
 }
 
 void UCompushadyResource::ReadbackToFloatArray(const int32 Offset, const int32 Elements, const FCompushadySignaledWithFloatArrayPayload& OnSignaled)
@@ -219,15 +826,94 @@ void UCompushadyResource::ReadbackToFloatArray(const int32 Offset, const int32 E
 		{
 			FStagingBufferRHIRef StagingBuffer = GetStagingBuffer();
 			RHICmdList.Transition(FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::CopySrc));
-			RHICmdList.CopyToStagingBuffer(BufferRHIRef, StagingBuffer, 0, BufferRHIRef->GetSize());
+			RHICmdList.CopyToStagingBuffer(BufferRHIRef, StagingBuffer, static_cast<uint32>(BufferViewOffset), static_cast<uint32>(GetBufferSize()));
 			WaitForGPU(RHICmdList);
-			uint8* Data = reinterpret_cast<uint8*>(RHICmdList.LockStagingBuffer(StagingBuffer, nullptr, 0, BufferRHIRef->GetSize()));
+			uint8* Data = reinterpret_cast<uint8*>(RHICmdList.LockStagingBuffer(StagingBuffer, nullptr, 0, static_cast<uint32>(GetBufferSize())));
 			ReadbackCacheFloats.Empty(Elements);
 			ReadbackCacheFloats.Append(reinterpret_cast<const float*>(Data) + Offset, Elements);
 			RHICmdList.UnlockStagingBuffer(StagingBuffer);
 		}, OnSignaled, ReadbackCacheFloats);
 }
 
+void UCompushadyResource::ReadbackToHalfAsFloatArray(const int32 Offset, const int32 Elements, const FCompushadySignaledWithFloatArrayPayload& OnSignaled)
+{
+	if (IsRunning())
+	{
+		TArray<float> Values;
+		OnSignaled.ExecuteIfBound(false, Values, "The Resource is already being processed by another task");
+		return;
+	}
+
+	if (!IsValidBuffer() || Offset < 0 || Elements < 0 || (static_cast<int64>(Offset) + Elements) * sizeof(uint16) > GetBufferSize())
+	{
+		TArray<float> Values;
+		OnSignaled.ExecuteIfBound(false, Values, "Invalid Buffer or range");
+		return;
+	}
+
+	EnqueueToGPU(
+		[this, Offset, Elements](FRHICommandListImmediate& RHICmdList)
+		{
+			FStagingBufferRHIRef StagingBuffer = GetStagingBuffer();
+			RHICmdList.Transition(FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::CopySrc));
+			RHICmdList.CopyToStagingBuffer(BufferRHIRef, StagingBuffer, static_cast<uint32>(BufferViewOffset), static_cast<uint32>(GetBufferSize()));
+			WaitForGPU(RHICmdList);
+			uint8* Data = reinterpret_cast<uint8*>(RHICmdList.LockStagingBuffer(StagingBuffer, nullptr, 0, static_cast<uint32>(GetBufferSize())));
+			ReadbackCacheFloats.SetNumUninitialized(Elements);
+			Compushady::Conversion::HalfToFloat(reinterpret_cast<const uint16*>(Data) + Offset, ReadbackCacheFloats.GetData(), Elements);
+			RHICmdList.UnlockStagingBuffer(StagingBuffer);
+		}, OnSignaled, ReadbackCacheFloats);
+}
+
+void UCompushadyResource::ReadbackTextureSliceToFloatArray(const int32 Slice, const FCompushadySignaledWithFloatArrayPayload& OnSignaled)
+{
+	if (IsRunning())
+	{
+		TArray<float> Values;
+		OnSignaled.ExecuteIfBound(false, Values, "The Resource is already being processed by another task");
+		return;
+	}
+
+	if (!IsValidTexture())
+	{
+		TArray<float> Values;
+		OnSignaled.ExecuteIfBound(false, Values, "The resource is not a valid Texture");
+		return;
+	}
+
+	const EPixelFormat PixelFormat = GetTexturePixelFormat();
+	if (!Compushady::Conversion::SupportsPixelFormat(PixelFormat))
+	{
+		TArray<float> Values;
+		OnSignaled.ExecuteIfBound(false, Values, FString::Printf(TEXT("Unsupported PixelFormat %s"), GPixelFormats[PixelFormat].Name));
+		return;
+	}
+
+	Compushady::Readback::FTextureReadbackLayout Layout;
+	FString ErrorMessages;
+	if (!Compushady::Readback::ComputeTextureReadbackLayout(TextureRHIRef, Slice, 1, 0, 1, Layout, ErrorMessages))
+	{
+		TArray<float> Values;
+		OnSignaled.ExecuteIfBound(false, Values, ErrorMessages);
+		return;
+	}
+
+	EnqueueToGPU(
+		[this, Layout, PixelFormat](FRHICommandListImmediate& RHICmdList) mutable
+		{
+			ReadbackCacheFloats.Empty();
+			Compushady::Readback::MapTextureReadbackLayout(RHICmdList, TextureRHIRef, ReadbackAtlasTextureRHIRef, Layout, [this, PixelFormat](const uint8* Data, const TArray<FCompushadyTextureReadbackRegion>& Regions)
+				{
+					const FCompushadyTextureReadbackRegion& Region = Regions[0];
+					const int64 RowSize = Region.Size.X * GPixelFormats[PixelFormat].BlockBytes;
+					TArray64<uint8> Pixels;
+					Pixels.SetNumUninitialized(RowSize * Region.Size.Y);
+					CopyTextureData2D(Data + Region.Offset, Pixels.GetData(), Region.Size.Y, PixelFormat, Region.RowPitch, RowSize);
+					Compushady::Conversion::PixelFormatToFloat(PixelFormat, Pixels.GetData(), Pixels.Num(), ReadbackCacheFloats);
+				});
+		}, OnSignaled, ReadbackCacheFloats);
+}
+
 void UCompushadyResource::CopyToRenderTarget2D(UTextureRenderTarget2D* RenderTarget, const FCompushadySignaled& OnSignaled, const FCompushadyTextureCopyInfo& CopyInfo)
 {
 	if (IsRunning())
@@ -251,7 +937,7 @@ void UCompushadyResource::CopyToRenderTarget2D(UTextureRenderTarget2D* RenderTar
 		return;
 	}
 
-	if (!CopyTexture_Internal(Resource->GetTextureRHI(), TextureRHIRef, CopyInfo, OnSignaled))
+	if (!CopyTexture_Internal(Resource->GetTextureRHI(), GetTextureRHI(), CopyInfo, OnSignaled))
 	{
 		return;
 	}
@@ -279,7 +965,7 @@ void UCompushadyResource::CopyFromMediaTexture(UMediaTexture* MediaTexture, cons
 		return;
 	}
 
-	if (!CopyTexture_Internal(TextureRHIRef, Resource->GetTextureRHI(), CopyInfo, OnSignaled))
+	if (!CopyTexture_Internal(GetTextureRHI(), Resource->GetTextureRHI(), CopyInfo, OnSignaled))
 	{
 		return;
 	}
@@ -309,7 +995,7 @@ void UCompushadyResource::CopyToRenderTarget2DArray(UTextureRenderTarget2DArray*
 		return;
 	}
 
-	if (!CopyTexture_Internal(Resource->GetTextureRHI(), TextureRHIRef, CopyInfo, OnSignaled))
+	if (!CopyTexture_Internal(Resource->GetTextureRHI(), GetTextureRHI(), CopyInfo, OnSignaled))
 	{
 		return;
 	}
@@ -460,6 +1146,7 @@ void UCompushadyResource::OnSignalReceived()
 
 FIntVector UCompushadyResource::GetTextureThreadGroupSize(const FIntVector XYZ, const bool bUseNumSlicesForZ) const
 {
+	WaitForCreation();
 	if (TextureRHIRef.IsValid())
 	{
 		if (XYZ.X <= 0 || XYZ.Y <= 0 || XYZ.Z <= 0)
@@ -480,6 +1167,7 @@ FIntVector UCompushadyResource::GetTextureThreadGroupSize(const FIntVector XYZ,
 
 FIntVector UCompushadyResource::GetTextureSize() const
 {
+	WaitForCreation();
 	if (TextureRHIRef.IsValid() && TextureRHIRef->IsValid())
 	{
 		return TextureRHIRef->GetSizeXYZ();
@@ -490,15 +1178,17 @@ FIntVector UCompushadyResource::GetTextureSize() const
 
 int64 UCompushadyResource::GetBufferSize() const
 {
+	WaitForCreation();
 	if (BufferRHIRef.IsValid() && BufferRHIRef->IsValid())
 	{
-		return static_cast<int64>(BufferRHIRef->GetSize());
+		return BufferViewSize > 0 ? BufferViewSize : static_cast<int64>(BufferRHIRef->GetSize());
 	}
 	return 0;
 }
 
 int32 UCompushadyResource::GetTextureNumSlices() const
 {
+	WaitForCreation();
 	if (TextureRHIRef.IsValid())
 	{
 		const FRHITextureDesc& Desc = TextureRHIRef->GetDesc();
@@ -526,9 +1216,9 @@ void UCompushadyResource::MapReadAndExecute(TFunction<void(const void*)> InFunct
 			{
 				FStagingBufferRHIRef StagingBuffer = GetStagingBuffer();
 				RHICmdList.Transition(FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::CopySrc));
-				RHICmdList.CopyToStagingBuffer(BufferRHIRef, StagingBuffer, 0, BufferRHIRef->GetSize());
+				RHICmdList.CopyToStagingBuffer(BufferRHIRef, StagingBuffer, static_cast<uint32>(BufferViewOffset), static_cast<uint32>(GetBufferSize()));
 				WaitForGPU(RHICmdList);
-				void* Data = RHICmdList.LockStagingBuffer(StagingBuffer, nullptr, 0, BufferRHIRef->GetSize());
+				void* Data = RHICmdList.LockStagingBuffer(StagingBuffer, nullptr, 0, static_cast<uint32>(GetBufferSize()));
 				if (Data)
 				{
 					InFunction(Data);
@@ -560,7 +1250,7 @@ void UCompushadyResource::MapWriteAndExecute(TFunction<void(void*)> InFunction,
 			[this, InFunction](FRHICommandListImmediate& RHICmdList)
 			{
 				FBufferRHIRef UploadBuffer = GetUploadBuffer(RHICmdList);
-				void* Data = RHICmdList.LockBuffer(UploadBuffer, 0, UploadBuffer->GetSize(), EResourceLockMode::RLM_WriteOnly);
+				void* Data = RHICmdList.LockBuffer(UploadBuffer, 0, static_cast<uint32>(GetBufferSize()), EResourceLockMode::RLM_WriteOnly);
 				if (Data)
 				{
 					InFunction(Data);
@@ -568,7 +1258,7 @@ void UCompushadyResource::MapWriteAndExecute(TFunction<void(void*)> InFunction,
 				}
 				RHICmdList.Transition(FRHITransitionInfo(UploadBuffer, ERHIAccess::Unknown, ERHIAccess::CopySrc));
 				RHICmdList.Transition(FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::CopyDest));
-				RHICmdList.CopyBufferRegion(BufferRHIRef, 0, UploadBuffer, 0, UploadBuffer->GetSize());
+				RHICmdList.CopyBufferRegion(BufferRHIRef, BufferViewOffset, UploadBuffer, 0, GetBufferSize());
 			}, OnSignaled);
 	}
 	else
@@ -595,9 +1285,9 @@ bool UCompushadyResource::MapReadAndExecuteSync(TFunction<void(const void*)> InF
 		{
 			FStagingBufferRHIRef StagingBuffer = GetStagingBuffer();
 			RHICmdList.Transition(FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::CopySrc));
-			RHICmdList.CopyToStagingBuffer(BufferRHIRef, StagingBuffer, 0, BufferRHIRef->GetSize());
+			RHICmdList.CopyToStagingBuffer(BufferRHIRef, StagingBuffer, static_cast<uint32>(BufferViewOffset), static_cast<uint32>(GetBufferSize()));
 			WaitForGPU(RHICmdList);
-			void* Data = RHICmdList.LockStagingBuffer(StagingBuffer, nullptr, 0, BufferRHIRef->GetSize());
+			void* Data = RHICmdList.LockStagingBuffer(StagingBuffer, nullptr, 0, static_cast<uint32>(GetBufferSize()));
 			if (Data)
 			{
 				InFunction(Data);
@@ -624,7 +1314,7 @@ bool UCompushadyResource::MapWriteAndExecuteSync(TFunction<void(void*)> InFuncti
 		[this, InFunction](FRHICommandListImmediate& RHICmdList)
 		{
 			FBufferRHIRef UploadBuffer = GetUploadBuffer(RHICmdList);
-			void* Data = RHICmdList.LockBuffer(UploadBuffer, 0, UploadBuffer->GetSize(), EResourceLockMode::RLM_WriteOnly);
+			void* Data = RHICmdList.LockBuffer(UploadBuffer, 0, static_cast<uint32>(GetBufferSize()), EResourceLockMode::RLM_WriteOnly);
 			if (Data)
 			{
 				InFunction(Data);
@@ -632,12 +1322,94 @@ bool UCompushadyResource::MapWriteAndExecuteSync(TFunction<void(void*)> InFuncti
 			}
 			RHICmdList.Transition(FRHITransitionInfo(UploadBuffer, ERHIAccess::Unknown, ERHIAccess::CopySrc));
 			RHICmdList.Transition(FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::CopyDest));
-			RHICmdList.CopyBufferRegion(BufferRHIRef, 0, UploadBuffer, 0, UploadBuffer->GetSize());
+			RHICmdList.CopyBufferRegion(BufferRHIRef, BufferViewOffset, UploadBuffer, 0, GetBufferSize());
 		});
 
 	return true;
 }
 
+int32 UCompushadyResource::GetTransformLayoutSize(const ECompushadyTransformLayout Layout)
+{
+	switch (Layout)
+	{
+	case ECompushadyTransformLayout::Matrix4x4:
+		return 16 * sizeof(float);
+	case ECompushadyTransformLayout::Matrix3x4:
+		return 12 * sizeof(float);
+	case ECompushadyTransformLayout::QuatTranslationScale:
+		return 10 * sizeof(float);
+	default:
+		return 0;
+	}
+}
+
+void UCompushadyResource::UpdateStructuredBufferFromTransforms(const TArray<FTransform>& Transforms, const ECompushadyTransformLayout Layout, const FCompushadySignaled& OnSignaled, const int64 Offset)
+{
+	UpdateStructuredBufferFromTransforms(TArrayView<const FTransform>(Transforms), Layout, OnSignaled, Offset);
+}
+
+void UCompushadyResource::UpdateStructuredBufferFromTransforms(TArrayView<const FTransform> Transforms, const ECompushadyTransformLayout Layout, const FCompushadySignaled& OnSignaled, const int64 Offset)
+{
+	if (IsRunning())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Resource is already being processed by another task");
+		return;
+	}
+
+	if (!IsValidBuffer())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Resource is not a valid Buffer");
+		return;
+	}
+
+	const int64 Size = static_cast<int64>(Transforms.Num()) * GetTransformLayoutSize(Layout);
+	if (Size == 0 || Offset < 0 || Offset + Size > GetBufferSize())
+	{
+		OnSignaled.ExecuteIfBound(false, FString::Printf(TEXT("Invalid transforms upload size (%lld bytes at offset %lld, buffer size: %lld)"), Size, Offset, GetBufferSize()));
+		return;
+	}
+
+	// the transforms are owned by the render command, they are converted straight into the locked upload buffer
+	TSharedRef<TArray<FTransform>, ESPMode::ThreadSafe> OwnedTransforms = MakeShared<TArray<FTransform>, ESPMode::ThreadSafe>(Transforms);
+
+	EnqueueToGPU(
+		[this, OwnedTransforms, Layout, Offset, Size](FRHICommandListImmediate& RHICmdList)
+		{
+			FBufferRHIRef UploadBuffer = GetUploadBuffer(RHICmdList);
+			float* Data = reinterpret_cast<float*>(RHICmdList.LockBuffer(UploadBuffer, 0, Size, EResourceLockMode::RLM_WriteOnly));
+			if (Data)
+			{
+				constexpr int32 TransformsPerTask = 1024;
+				const int32 FloatsPerTransform = GetTransformLayoutSize(Layout) / sizeof(float);
+				const TArray<FTransform>& Transforms = *OwnedTransforms;
+				ParallelFor(FMath::DivideAndRoundUp(Transforms.Num(), TransformsPerTask), [&](const int32 Task)
+					{
+						const int32 First = Task * TransformsPerTask;
+						const int32 Num = FMath::Min(TransformsPerTask, Transforms.Num() - First);
+						float* Destination = Data + static_cast<int64>(First) * FloatsPerTransform;
+						switch (Layout)
+						{
+						case ECompushadyTransformLayout::Matrix4x4:
+							Compushady::Conversion::TransformsToMatrix44f(Transforms.GetData() + First, Destination, Num);
+							break;
+						case ECompushadyTransformLayout::Matrix3x4:
+							Compushady::Conversion::TransformsToMatrix34f(Transforms.GetData() + First, Destination, Num);
+							break;
+						case ECompushadyTransformLayout::QuatTranslationScale:
+							Compushady::Conversion::TransformsToQuatTranslationScale(Transforms.GetData() + First, Destination, Num);
+							break;
+						default:
+							break;
+						}
+					});
+				RHICmdList.UnlockBuffer(UploadBuffer);
+			}
+			RHICmdList.Transition(FRHITransitionInfo(UploadBuffer, ERHIAccess::Unknown, ERHIAccess::CopySrc));
+			RHICmdList.Transition(FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::CopyDest));
+			RHICmdList.CopyBufferRegion(BufferRHIRef, BufferViewOffset + Offset, UploadBuffer, 0, Size);
+		}, OnSignaled);
+}
+
 void UCompushadyResource::MapReadAndExecuteInGameThread(TFunction<void(const void*)> InFunction, const FCompushadySignaled& OnSignaled)
 {
 	auto Wrapper = [this, InFunction](const void* Data)
@@ -709,10 +1481,100 @@ bool UCompushadyResource::MapTextureSliceAndExecuteSync(TFunction<void(const voi
 	return true;
 }
 
+void UCompushadyResource::MapTextureSlicesAndExecute(TFunction<void(const uint8*, const TArray<FCompushadyTextureReadbackRegion>&)> InFunction, const FCompushadySignaled& OnSignaled, const int32 FirstSlice, const int32 NumSlices, const int32 FirstMip, const int32 NumMips)
+{
+	if (IsRunning())
+	{
+		OnSignaled.ExecuteIfBound(false, "The Resource is already being processed by another task");
+		return;
+	}
+
+	if (!IsValidTexture())
+	{
+		OnSignaled.ExecuteIfBound(false, "The resource is not a valid Texture");
+		return;
+	}
+
+	TSharedRef<Compushady::Readback::FTextureReadbackLayout> Layout = MakeShared<Compushady::Readback::FTextureReadbackLayout>();
+	FString ErrorMessages;
+	if (!Compushady::Readback::ComputeTextureReadbackLayout(TextureRHIRef, FirstSlice, NumSlices, FirstMip, NumMips, *Layout, ErrorMessages))
+	{
+		OnSignaled.ExecuteIfBound(false, ErrorMessages);
+		return;
+	}
+
+	EnqueueToGPU(
+		[this, InFunction, Layout](FRHICommandListImmediate& RHICmdList)
+		{
+			Compushady::Readback::MapTextureReadbackLayout(RHICmdList, TextureRHIRef, ReadbackAtlasTextureRHIRef, *Layout, InFunction);
+		}, OnSignaled);
+}
+
+bool UCompushadyResource::MapTextureSlicesAndExecuteSync(TFunction<void(const uint8*, const TArray<FCompushadyTextureReadbackRegion>&)> InFunction, const int32 FirstSlice, const int32 NumSlices, const int32 FirstMip, const int32 NumMips)
+{
+	if (IsRunning() || !IsValidTexture())
+	{
+		return false;
+	}
+
+	Compushady::Readback::FTextureReadbackLayout Layout;
+	FString ErrorMessages;
+	if (!Compushady::Readback::ComputeTextureReadbackLayout(TextureRHIRef, FirstSlice, NumSlices, FirstMip, NumMips, Layout, ErrorMessages))
+	{
+		UE_LOG(LogCompushady, Error, TEXT("%s"), *ErrorMessages);
+		return false;
+	}
+
+	bool bMapped = false;
+	EnqueueToGPUSync(
+		[this, InFunction, &Layout, &bMapped](FRHICommandListImmediate& RHICmdList)
+		{
+			Compushady::Readback::MapTextureReadbackLayout(RHICmdList, TextureRHIRef, ReadbackAtlasTextureRHIRef, Layout, [InFunction, &bMapped](const uint8* Data, const TArray<FCompushadyTextureReadbackRegion>& Regions)
+				{
+					InFunction(Data, Regions);
+					bMapped = true;
+				});
+		});
+
+	return bMapped;
+}
+
+bool UCompushadyResource::ReadbackTextureSlicesSync(const int32 FirstSlice, const int32 NumSlices, const int32 FirstMip, const int32 NumMips, TArray<uint8>& Bytes, TArray<FCompushadyTextureReadbackRegion>& Regions)
+{
+	const int64 BlockBytes = GPixelFormats[GetTexturePixelFormat()].BlockBytes;
+
+	return MapTextureSlicesAndExecuteSync([&Bytes, &Regions, BlockBytes](const uint8* Data, const TArray<FCompushadyTextureReadbackRegion>& MappedRegions)
+		{
+			int64 Size = 0;
+			for (const FCompushadyTextureReadbackRegion& Region : MappedRegions)
+			{
+				Size = FMath::Max(Size, Region.Offset + Region.RowPitch * (Region.Size.Y - 1) + Region.Size.X * BlockBytes);
+			}
+			Bytes.Empty();
+			Bytes.Append(Data, Size);
+			Regions = MappedRegions;
+		}, FirstSlice, NumSlices, FirstMip, NumMips);
+}
+
 namespace Compushady
 {
 	namespace Pipeline
 	{
+		FUniformBufferRHIRef GetCBVRHI(FRHICommandList& RHICmdList, const FCompushadyResourceArray& ResourceArray, const int32 Index)
+		{
+			UCompushadyCBV* CBV = ResourceArray.CBVs[Index];
+			if (ResourceArray.CBVSnapshots.IsValidIndex(Index) && ResourceArray.CBVSnapshots[Index].IsValid())
+			{
+				return CBV->CreateSnapshotRHI(*ResourceArray.CBVSnapshots[Index]);
+			}
+
+			if (CBV->BufferDataIsDirty())
+			{
+				CBV->SyncBufferData(RHICmdList);
+			}
+			return CBV->GetRHI();
+		}
+
 		template<typename SHADER_TYPE>
 		void SetupParameters(FRHICommandList& RHICmdList, SHADER_TYPE Shader, const FCompushadyResourceArray& ResourceArray, const FCompushadyResourceBindings& ResourceBindings, const FPostProcessMaterialInputs& PPInputs)
 		{
@@ -722,14 +1584,10 @@ namespace Compushady
 
 			for (int32 Index = 0; Index < ResourceArray.CBVs.Num(); Index++)
 			{
-				if (ResourceArray.CBVs[Index]->BufferDataIsDirty())
-				{
-					ResourceArray.CBVs[Index]->SyncBufferData(RHICmdList);
-				}
 #if COMPUSHADY_UE_VERSION >= 53
-				BatchedParameters.SetShaderUniformBuffer(ResourceBindings.CBVs[Index].SlotIndex, ResourceArray.CBVs[Index]->GetRHI());
+				BatchedParameters.SetShaderUniformBuffer(ResourceBindings.CBVs[Index].SlotIndex, GetCBVRHI(RHICmdList, ResourceArray, Index));
 #else
-				RHICmdList.SetShaderUniformBuffer(Shader, ResourceBindings.CBVs[Index].SlotIndex, ResourceArray.CBVs[Index]->GetRHI());
+				RHICmdList.SetShaderUniformBuffer(Shader, ResourceBindings.CBVs[Index].SlotIndex, GetCBVRHI(RHICmdList, ResourceArray, Index));
 #endif
 			}
 
@@ -780,18 +1638,14 @@ namespace Compushady
 #endif
 		}
 
-		// Special case for UE 5.2 where a VertexShader and a MeshShader cannot have UAVs
+		// Special case for UE 5.2 where a VertexShader, a MeshShader and an AmplificationShader cannot have UAVs
 #if COMPUSHADY_UE_VERSION < 53
 		template<>
 		void SetupParameters(FRHICommandListImmediate& RHICmdList, FVertexShaderRHIRef Shader, const FCompushadyResourceArray& ResourceArray, const FCompushadyResourceBindings& ResourceBindings)
 		{
 			for (int32 Index = 0; Index < ResourceArray.CBVs.Num(); Index++)
 			{
-				if (ResourceArray.CBVs[Index]->BufferDataIsDirty())
-				{
-					ResourceArray.CBVs[Index]->SyncBufferData(RHICmdList);
-				}
-				RHICmdList.SetShaderUniformBuffer(Shader, ResourceBindings.CBVs[Index].SlotIndex, ResourceArray.CBVs[Index]->GetRHI());
+				RHICmdList.SetShaderUniformBuffer(Shader, ResourceBindings.CBVs[Index].SlotIndex, GetCBVRHI(RHICmdList, ResourceArray, Index));
 			}
 
 			for (int32 Index = 0; Index < ResourceArray.SRVs.Num(); Index++)
@@ -811,11 +1665,27 @@ namespace Compushady
 		{
 			for (int32 Index = 0; Index < ResourceArray.CBVs.Num(); Index++)
 			{
-				if (ResourceArray.CBVs[Index]->BufferDataIsDirty())
-				{
-					ResourceArray.CBVs[Index]->SyncBufferData(RHICmdList);
-				}
-				RHICmdList.SetShaderUniformBuffer(Shader, ResourceBindings.CBVs[Index].SlotIndex, ResourceArray.CBVs[Index]->GetRHI());
+				RHICmdList.SetShaderUniformBuffer(Shader, ResourceBindings.CBVs[Index].SlotIndex, GetCBVRHI(RHICmdList, ResourceArray, Index));
+			}
+
+			for (int32 Index = 0; Index < ResourceArray.SRVs.Num(); Index++)
+			{
+				RHICmdList.Transition(ResourceArray.SRVs[Index]->GetRHITransitionInfo());
+				RHICmdList.SetShaderResourceViewParameter(Shader, ResourceBindings.SRVs[Index].SlotIndex, ResourceArray.SRVs[Index]->GetRHI());
+			}
+
+			for (int32 Index = 0; Index < ResourceArray.Samplers.Num(); Index++)
+			{
+				RHICmdList.SetShaderSampler(Shader, ResourceBindings.Samplers[Index].SlotIndex, ResourceArray.Samplers[Index]->GetRHI());
+			}
+		}
+
+		template<>
+		void SetupParameters(FRHICommandListImmediate& RHICmdList, FAmplificationShaderRHIRef Shader, const FCompushadyResourceArray& ResourceArray, const FCompushadyResourceBindings& ResourceBindings)
+		{
+			for (int32 Index = 0; Index < ResourceArray.CBVs.Num(); Index++)
+			{
+				RHICmdList.SetShaderUniformBuffer(Shader, ResourceBindings.CBVs[Index].SlotIndex, GetCBVRHI(RHICmdList, ResourceArray, Index));
 			}
 
 			for (int32 Index = 0; Index < ResourceArray.SRVs.Num(); Index++)
@@ -833,6 +1703,46 @@ namespace Compushady
 	}
 }
 
+FCompushadyResourceArray Compushady::Utils::SnapshotResourceArray(const FCompushadyResourceArray& ResourceArray)
+{
+	FCompushadyResourceArray SnapshotResourceArray = ResourceArray;
+	SnapshotResourceArray.CBVSnapshots.Empty();
+
+	// CBV pools (and their slots views) upload their dirty slots before the work is enqueued
+	for (UCompushadySRV* SRV : ResourceArray.SRVs)
+	{
+		UCompushadyCBVPool* CBVPool = SRV ? Cast<UCompushadyCBVPool>(SRV) : nullptr;
+		if (!CBVPool && SRV)
+		{
+			CBVPool = Cast<UCompushadyCBVPool>(SRV->GetOuter());
+		}
+
+		if (CBVPool)
+		{
+			CBVPool->Upload();
+		}
+	}
+
+	for (UCompushadyCBV* CBV : ResourceArray.CBVs)
+	{
+		if (CBV && CBV->IsSnapshotMode())
+		{
+			SnapshotResourceArray.CBVSnapshots.SetNum(ResourceArray.CBVs.Num());
+			break;
+		}
+	}
+
+	for (int32 Index = 0; Index < SnapshotResourceArray.CBVSnapshots.Num(); Index++)
+	{
+		if (ResourceArray.CBVs[Index] && ResourceArray.CBVs[Index]->IsSnapshotMode())
+		{
+			SnapshotResourceArray.CBVSnapshots[Index] = ResourceArray.CBVs[Index]->Snapshot();
+		}
+	}
+
+	return SnapshotResourceArray;
+}
+
 void Compushady::Utils::SetupPipelineParameters(FRHICommandList& RHICmdList, FComputeShaderRHIRef Shader, const FCompushadyResourceArray& ResourceArray, const FCompushadyResourceBindings& ResourceBindings)
 {
 	Compushady::Pipeline::SetupParameters(RHICmdList, Shader, ResourceArray, ResourceBindings, {});
@@ -848,6 +1758,11 @@ void Compushady::Utils::SetupPipelineParameters(FRHICommandList& RHICmdList, FMe
 	Compushady::Pipeline::SetupParameters(RHICmdList, Shader, ResourceArray, ResourceBindings, {});
 }
 
+void Compushady::Utils::SetupPipelineParameters(FRHICommandList& RHICmdList, FAmplificationShaderRHIRef Shader, const FCompushadyResourceArray& ResourceArray, const FCompushadyResourceBindings& ResourceBindings)
+{
+	Compushady::Pipeline::SetupParameters(RHICmdList, Shader, ResourceArray, ResourceBindings, {});
+}
+
 void Compushady::Utils::SetupPipelineParameters(FRHICommandList& RHICmdList, FPixelShaderRHIRef Shader, const FCompushadyResourceArray& ResourceArray, const FCompushadyResourceBindings& ResourceBindings, const FPostProcessMaterialInputs& PPInputs)
 {
 	Compushady::Pipeline::SetupParameters(RHICmdList, Shader, ResourceArray, ResourceBindings, PPInputs);
@@ -858,12 +1773,7 @@ void Compushady::Utils::SetupPipelineParameters(FRHICommandList& RHICmdList, FRa
 
 	for (int32 Index = 0; Index < ResourceArray.CBVs.Num(); Index++)
 	{
-		if (ResourceArray.CBVs[Index]->BufferDataIsDirty())
-		{
-			ResourceArray.CBVs[Index]->SyncBufferData(RHICmdList);
-		}
-
-		GlobalResources.SetUniformBuffer(ResourceBindings.CBVs[Index].SlotIndex, ResourceArray.CBVs[Index]->GetRHI());
+		GlobalResources.SetUniformBuffer(ResourceBindings.CBVs[Index].SlotIndex, Compushady::Pipeline::GetCBVRHI(RHICmdList, ResourceArray, Index));
 	}
 
 	for (int32 Index = 0; Index < ResourceArray.SRVs.Num(); Index++)
@@ -947,6 +1857,12 @@ bool Compushady::Utils::ValidateResourceBindings(const FCompushadyResourceArray&
 			ErrorMessages = FString::Printf(TEXT("SRV %d cannot be null"), Index);
 			return false;
 		}
+
+		if (SRVs[Index]->IsCreationFailed())
+		{
+			ErrorMessages = FString::Printf(TEXT("SRV %d creation failed"), Index);
+			return false;
+		}
 	}
 
 	if (UAVs.Num() != ResourceBindings.UAVs.Num())
@@ -962,6 +1878,12 @@ bool Compushady::Utils::ValidateResourceBindings(const FCompushadyResourceArray&
 			ErrorMessages = FString::Printf(TEXT("UAV %d cannot be null"), Index);
 			return false;
 		}
+
+		if (UAVs[Index]->IsCreationFailed())
+		{
+			ErrorMessages = FString::Printf(TEXT("UAV %d creation failed"), Index);
+			return false;
+		}
 	}
 
 	if (Samplers.Num() != ResourceBindings.Samplers.Num())
@@ -1015,6 +1937,15 @@ bool Compushady::Utils::CreateResourceBindings(Compushady::FCompushadyShaderReso
 		ResourceBinding.SlotIndex = ShaderResourceBinding.SlotIndex;
 		ResourceBinding.Name = ShaderResourceBinding.Name;
 
+		for (const Compushady::FCompushadyShaderConstant& ShaderConstant : ShaderResourceBinding.Constants)
+		{
+			FCompushadyResourceConstant Constant;
+			Constant.Name = ShaderConstant.Name;
+			Constant.Offset = ShaderConstant.Offset;
+			Constant.Size = ShaderConstant.Size;
+			ResourceBinding.Constants.Add(Constant);
+		}
+
 		OutBindings.CBVs.Add(ResourceBinding);
 		OutBindings.CBVsMap.Add(ResourceBinding.Name, ResourceBinding);
 		OutBindings.CBVsSlotMap.Add(ResourceBinding.SlotIndex, ResourceBinding);
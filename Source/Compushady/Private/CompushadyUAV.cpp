@@ -3,6 +3,7 @@
 
 #include "CompushadyUAV.h"
 #include "CompushadySRV.h"
+#include "TextureResource.h"
 
 bool UCompushadyUAV::InitializeFromTexture(FTextureRHIRef InTextureRHIRef)
 {
@@ -13,25 +14,78 @@ bool UCompushadyUAV::InitializeFromTexture(FTextureRHIRef InTextureRHIRef)
 
 	TextureRHIRef = InTextureRHIRef;
 
-	EnqueueToGPUSync(
+	EnqueueCreation(
 		[this](FRHICommandListImmediate& RHICmdList)
 		{
-			UAVRHIRef = COMPUSHADY_CREATE_UAV(TextureRHIRef);
+			CreateTextureView(RHICmdList);
 		});
 
-	if (!UAVRHIRef)
+	InitFence(this);
+
+	if (InTextureRHIRef->GetOwnerName() == NAME_None)
+	{
+		InTextureRHIRef->SetOwnerName(*GetPathName());
+	}
+
+	RHITransitionInfo = FRHITransitionInfo(TextureRHIRef, ERHIAccess::Unknown, ERHIAccess::UAVMask);
+
+	return true;
+}
+
+bool UCompushadyUAV::InitializeFromTextureMip(FTextureRHIRef InTextureRHIRef, const int32 MipLevel)
+{
+	if (!InTextureRHIRef || MipLevel < 0 || MipLevel >= static_cast<int32>(InTextureRHIRef->GetNumMips()))
 	{
 		return false;
 	}
 
+	TextureRHIRef = InTextureRHIRef;
+
+	EnqueueCreation(
+		[this, MipLevel](FRHICommandListImmediate& RHICmdList)
+		{
+			CreateTextureView(RHICmdList, MipLevel);
+		});
+
 	InitFence(this);
 
-	if (InTextureRHIRef->GetOwnerName() == NAME_None)
+	RHITransitionInfo = FRHITransitionInfo(TextureRHIRef, ERHIAccess::Unknown, ERHIAccess::UAVMask);
+
+	return true;
+}
+
+bool UCompushadyUAV::InitializeFromTextureResource(FTextureResource* InTextureResource)
+{
+	if (!InTextureResource)
 	{
-		InTextureRHIRef->SetOwnerName(*GetPathName());
+		return false;
 	}
 
-	RHITransitionInfo = FRHITransitionInfo(TextureRHIRef, ERHIAccess::Unknown, ERHIAccess::UAVMask);
+	const FName OwnerName = *GetPathName();
+
+	// the RHI texture of the resource is available only in the render thread
+	EnqueueCreation(
+		[this, InTextureResource, OwnerName](FRHICommandListImmediate& RHICmdList)
+		{
+			TextureRHIRef = InTextureResource->GetTextureRHI();
+			if (!TextureRHIRef)
+			{
+				UE_LOG(LogCompushady, Error, TEXT("Texture Resource not available"));
+				bCreationFailed = true;
+				return;
+			}
+
+			if (TextureRHIRef->GetOwnerName() == NAME_None)
+			{
+				TextureRHIRef->SetOwnerName(OwnerName);
+			}
+
+			RHITransitionInfo = FRHITransitionInfo(TextureRHIRef, ERHIAccess::Unknown, ERHIAccess::UAVMask);
+
+			CreateTextureView(RHICmdList);
+		});
+
+	InitFence(this);
 
 	return true;
 }
@@ -45,17 +99,12 @@ bool UCompushadyUAV::InitializeFromBuffer(FBufferRHIRef InBufferRHIRef, const EP
 
 	BufferRHIRef = InBufferRHIRef;
 
-	EnqueueToGPUSync(
+	EnqueueCreation(
 		[this, PixelFormat](FRHICommandListImmediate& RHICmdList)
 		{
-			UAVRHIRef = COMPUSHADY_CREATE_UAV(BufferRHIRef, static_cast<uint8>(PixelFormat));
+			CreateBufferView(RHICmdList, PixelFormat);
 		});
 
-	if (!UAVRHIRef)
-	{
-		return false;
-	}
-
 	InitFence(this);
 
 	if (InBufferRHIRef->GetOwnerName() == NAME_None)
@@ -82,17 +131,12 @@ bool UCompushadyUAV::InitializeFromStructuredBuffer(FBufferRHIRef InBufferRHIRef
 
 	BufferRHIRef = InBufferRHIRef;
 
-	EnqueueToGPUSync(
+	EnqueueCreation(
 		[this](FRHICommandListImmediate& RHICmdList)
 		{
-			UAVRHIRef = COMPUSHADY_CREATE_UAV(BufferRHIRef, false, false);
+			CreateBufferView(RHICmdList, EPixelFormat::PF_Unknown);
 		});
 
-	if (!UAVRHIRef)
-	{
-		return false;
-	}
-
 	InitFence(this);
 
 	if (InBufferRHIRef->GetOwnerName() == NAME_None)
@@ -105,6 +149,102 @@ bool UCompushadyUAV::InitializeFromStructuredBuffer(FBufferRHIRef InBufferRHIRef
 	return true;
 }
 
+bool UCompushadyUAV::InitializeFromStructuredBuffer(FBufferRHIRef InBufferRHIRef, const uint32 FirstElement, const uint32 NumElements)
+{
+#if COMPUSHADY_UE_VERSION >= 53
+	if (!InBufferRHIRef)
+	{
+		return false;
+	}
+
+	if (InBufferRHIRef->GetStride() == 0 || NumElements == 0 || (static_cast<uint64>(FirstElement) + NumElements) * InBufferRHIRef->GetStride() > InBufferRHIRef->GetSize())
+	{
+		return false;
+	}
+
+	BufferRHIRef = InBufferRHIRef;
+	BufferViewOffset = static_cast<int64>(FirstElement) * InBufferRHIRef->GetStride();
+	BufferViewSize = static_cast<int64>(NumElements) * InBufferRHIRef->GetStride();
+
+	EnqueueCreation(
+		[this, FirstElement, NumElements](FRHICommandListImmediate& RHICmdList)
+		{
+			UAVRHIRef = COMPUSHADY_CREATE_UAV(BufferRHIRef, FRHIViewDesc::CreateBufferUAV()
+				.SetType(FRHIViewDesc::EBufferType::Structured)
+				.SetStride(BufferRHIRef->GetStride())
+				.SetOffsetInBytes(FirstElement * BufferRHIRef->GetStride())
+				.SetNumElements(NumElements));
+
+			if (!UAVRHIRef)
+			{
+				UE_LOG(LogCompushady, Error, TEXT("Unable to create Unordered Access View for \"%s\""), *BufferRHIRef->GetName().ToString());
+				bCreationFailed = true;
+			}
+		});
+
+	InitFence(this);
+
+	RHITransitionInfo = FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::UAVMask);
+
+	return true;
+#else
+	UE_LOG(LogCompushady, Error, TEXT("Structured Buffer range views require Unreal Engine 5.3"));
+	return false;
+#endif
+}
+
+void UCompushadyUAV::InitializeFromPendingBuffer(const FString& Name, const int64 Size, const EPixelFormat PixelFormat, const EBufferUsageFlags AdditionalUsage)
+{
+	EnqueueBufferCreation(Name, Size, EBufferUsageFlags::ShaderResource | EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::VertexBuffer | AdditionalUsage, GPixelFormats[PixelFormat].BlockBytes, ERHIAccess::UAVCompute, nullptr,
+		[this, PixelFormat](FRHICommandListImmediate& RHICmdList)
+		{
+			RHITransitionInfo = FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::UAVMask);
+			CreateBufferView(RHICmdList, PixelFormat);
+		});
+
+	InitFence(this);
+}
+
+void UCompushadyUAV::InitializeFromPendingStructuredBuffer(const FString& Name, const int64 Size, const int32 Stride, TFunction<void(void*)> FillFunction)
+{
+	EnqueueBufferCreation(Name, Size, EBufferUsageFlags::ShaderResource | EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::StructuredBuffer, Stride, ERHIAccess::UAVCompute, FillFunction,
+		[this](FRHICommandListImmediate& RHICmdList)
+		{
+			RHITransitionInfo = FRHITransitionInfo(BufferRHIRef, ERHIAccess::Unknown, ERHIAccess::UAVMask);
+			CreateBufferView(RHICmdList, EPixelFormat::PF_Unknown);
+		});
+
+	InitFence(this);
+}
+
+void UCompushadyUAV::CreateTextureView(FRHICommandListImmediate& RHICmdList, const int32 MipLevel)
+{
+	UAVRHIRef = COMPUSHADY_CREATE_UAV(TextureRHIRef, MipLevel);
+	if (!UAVRHIRef)
+	{
+		UE_LOG(LogCompushady, Error, TEXT("Unable to create Unordered Access View for \"%s\""), *TextureRHIRef->GetName().ToString());
+		bCreationFailed = true;
+	}
+}
+
+void UCompushadyUAV::CreateBufferView(FRHICommandListImmediate& RHICmdList, const EPixelFormat PixelFormat)
+{
+	if (PixelFormat == EPixelFormat::PF_Unknown)
+	{
+		UAVRHIRef = COMPUSHADY_CREATE_UAV(BufferRHIRef, false, false);
+	}
+	else
+	{
+		UAVRHIRef = COMPUSHADY_CREATE_UAV(BufferRHIRef, static_cast<uint8>(PixelFormat));
+	}
+
+	if (!UAVRHIRef)
+	{
+		UE_LOG(LogCompushady, Error, TEXT("Unable to create Unordered Access View for \"%s\""), *BufferRHIRef->GetName().ToString());
+		bCreationFailed = true;
+	}
+}
+
 FUnorderedAccessViewRHIRef UCompushadyUAV::GetRHI() const
 {
 	return UAVRHIRef;
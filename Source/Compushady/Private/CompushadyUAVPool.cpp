@@ -0,0 +1,244 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#include "CompushadyUAVPool.h"
+#include "CompushadyFunctionLibrary.h"
+#include "RenderUtils.h"
+
+DECLARE_MEMORY_STAT(TEXT("UAV Pool Memory"), STAT_CompushadyUAVPoolMemory, STATGROUP_Compushady);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("UAV Pool Hits"), STAT_CompushadyUAVPoolHits, STATGROUP_Compushady);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("UAV Pool Misses"), STAT_CompushadyUAVPoolMisses, STATGROUP_Compushady);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("UAV Pool Hit Rate"), STAT_CompushadyUAVPoolHitRate, STATGROUP_Compushady);
+
+namespace Compushady
+{
+	namespace UAVPool
+	{
+		// global counters (for all of the pools), used by the hit rate stat
+		int64 TotalHits = 0;
+		int64 TotalMisses = 0;
+	}
+}
+
+void UCompushadyUAVPool::InitializePool(const int32 InEvictionFrames)
+{
+	EvictionFrames = FMath::Max(InEvictionFrames, 0);
+}
+
+UCompushadyUAV* UCompushadyUAVPool::AcquireUAVBuffer(const FString& Name, const int64 Size, const EPixelFormat PixelFormat)
+{
+	FCompushadyUAVPoolKey Key;
+	Key.Kind = FCompushadyUAVPoolKey::EKind::Buffer;
+	Key.Size = Size;
+	Key.PixelFormat = PixelFormat;
+
+	return Acquire(Key, [&]()
+		{
+			return UCompushadyFunctionLibrary::CreateCompushadyUAVBuffer(Name, Size, PixelFormat);
+		});
+}
+
+UCompushadyUAV* UCompushadyUAVPool::AcquireUAVStructuredBuffer(const FString& Name, const int64 Size, const int32 Stride)
+{
+	FCompushadyUAVPoolKey Key;
+	Key.Kind = FCompushadyUAVPoolKey::EKind::StructuredBuffer;
+	Key.Size = Size;
+	Key.Stride = Stride;
+
+	return Acquire(Key, [&]()
+		{
+			return UCompushadyFunctionLibrary::CreateCompushadyUAVStructuredBuffer(Name, Size, Stride);
+		});
+}
+
+UCompushadyUAV* UCompushadyUAVPool::AcquireUAVTexture2D(const FString& Name, const int32 Width, const int32 Height, const EPixelFormat Format)
+{
+	FCompushadyUAVPoolKey Key;
+	Key.Kind = FCompushadyUAVPoolKey::EKind::Texture2D;
+	Key.Extent = FIntVector(Width, Height, 1);
+	Key.Size = CalculateImageBytes(Width, Height, 1, Format);
+	Key.PixelFormat = Format;
+
+	return Acquire(Key, [&]()
+		{
+			return UCompushadyFunctionLibrary::CreateCompushadyUAVTexture2D(Name, Width, Height, Format);
+		});
+}
+
+UCompushadyUAV* UCompushadyUAVPool::AcquireUAVTexture2DArray(const FString& Name, const int32 Width, const int32 Height, const int32 Slices, const EPixelFormat Format)
+{
+	FCompushadyUAVPoolKey Key;
+	Key.Kind = FCompushadyUAVPoolKey::EKind::Texture2DArray;
+	Key.Extent = FIntVector(Width, Height, Slices);
+	Key.Size = CalculateImageBytes(Width, Height, Slices, Format);
+	Key.PixelFormat = Format;
+
+	return Acquire(Key, [&]()
+		{
+			return UCompushadyFunctionLibrary::CreateCompushadyUAVTexture2DArray(Name, Width, Height, Slices, Format);
+		});
+}
+
+UCompushadyUAV* UCompushadyUAVPool::AcquireUAVTexture3D(const FString& Name, const int32 Width, const int32 Height, const int32 Depth, const EPixelFormat Format)
+{
+	FCompushadyUAVPoolKey Key;
+	Key.Kind = FCompushadyUAVPoolKey::EKind::Texture3D;
+	Key.Extent = FIntVector(Width, Height, Depth);
+	Key.Size = CalculateImageBytes(Width, Height, Depth, Format);
+	Key.PixelFormat = Format;
+
+	return Acquire(Key, [&]()
+		{
+			return UCompushadyFunctionLibrary::CreateCompushadyUAVTexture3D(Name, Width, Height, Depth, Format);
+		});
+}
+
+UCompushadyUAV* UCompushadyUAVPool::Acquire(const FCompushadyUAVPoolKey& Key, TFunction<UCompushadyUAV*()> CreateFunction)
+{
+	Evict();
+
+	if (UCompushadyUAV** FreeUAV = FreeUAVs.Find(Key))
+	{
+		UCompushadyUAV* UAV = *FreeUAV;
+		FreeUAVs.RemoveSingle(Key, UAV);
+		PooledUAVs[UAV].bAcquired = true;
+
+		NumHits++;
+		Compushady::UAVPool::TotalHits++;
+		INC_DWORD_STAT(STAT_CompushadyUAVPoolHits);
+		UpdateStats(0);
+
+		return UAV;
+	}
+
+	UCompushadyUAV* UAV = CreateFunction();
+	if (!UAV)
+	{
+		return nullptr;
+	}
+
+	FPooledUAV PooledUAV;
+	PooledUAV.Key = Key;
+	PooledUAV.Bytes = Key.Size;
+	PooledUAV.bAcquired = true;
+
+	UAVs.Add(UAV);
+	PooledUAVs.Add(UAV, PooledUAV);
+
+	NumMisses++;
+	Compushady::UAVPool::TotalMisses++;
+	INC_DWORD_STAT(STAT_CompushadyUAVPoolMisses);
+	UpdateStats(PooledUAV.Bytes);
+
+	return UAV;
+}
+
+bool UCompushadyUAVPool::Release(UCompushadyUAV* UAV)
+{
+	FPooledUAV* PooledUAV = PooledUAVs.Find(UAV);
+	if (!PooledUAV || !PooledUAV->bAcquired)
+	{
+		return false;
+	}
+
+	PooledUAV->bAcquired = false;
+	PooledUAV->LastReleasedFrame = GFrameCounter;
+	FreeUAVs.Add(PooledUAV->Key, UAV);
+
+	return true;
+}
+
+int32 UCompushadyUAVPool::Evict()
+{
+	TArray<UCompushadyUAV*> EvictedUAVs;
+	for (const TPair<UCompushadyUAV*, FPooledUAV>& Pair : PooledUAVs)
+	{
+		if (!Pair.Value.bAcquired && GFrameCounter - Pair.Value.LastReleasedFrame > static_cast<uint64>(EvictionFrames))
+		{
+			EvictedUAVs.Add(Pair.Key);
+		}
+	}
+
+	for (UCompushadyUAV* UAV : EvictedUAVs)
+	{
+		RemoveUAV(UAV);
+	}
+
+	return EvictedUAVs.Num();
+}
+
+void UCompushadyUAVPool::Trim()
+{
+	TArray<UCompushadyUAV*> FreeUAVsToRemove;
+	FreeUAVs.GenerateValueArray(FreeUAVsToRemove);
+
+	for (UCompushadyUAV* UAV : FreeUAVsToRemove)
+	{
+		RemoveUAV(UAV);
+	}
+}
+
+void UCompushadyUAVPool::RemoveUAV(UCompushadyUAV* UAV)
+{
+	const FPooledUAV PooledUAV = PooledUAVs.FindAndRemoveChecked(UAV);
+	FreeUAVs.RemoveSingle(PooledUAV.Key, UAV);
+	UAVs.RemoveSingleSwap(UAV);
+
+	// the RHI resources are released when the UAV is garbage collected
+	UpdateStats(-PooledUAV.Bytes);
+}
+
+void UCompushadyUAVPool::UpdateStats(const int64 BytesDelta)
+{
+	PooledBytes += BytesDelta;
+	if (BytesDelta > 0)
+	{
+		INC_MEMORY_STAT_BY(STAT_CompushadyUAVPoolMemory, BytesDelta);
+	}
+	else if (BytesDelta < 0)
+	{
+		DEC_MEMORY_STAT_BY(STAT_CompushadyUAVPoolMemory, -BytesDelta);
+	}
+
+	const int64 TotalRequests = Compushady::UAVPool::TotalHits + Compushady::UAVPool::TotalMisses;
+	SET_FLOAT_STAT(STAT_CompushadyUAVPoolHitRate, TotalRequests > 0 ? static_cast<float>(Compushady::UAVPool::TotalHits) / TotalRequests : 0.0f);
+}
+
+int64 UCompushadyUAVPool::GetPooledBytes() const
+{
+	return PooledBytes;
+}
+
+int32 UCompushadyUAVPool::GetNumPooledUAVs() const
+{
+	return UAVs.Num();
+}
+
+int32 UCompushadyUAVPool::GetNumFreeUAVs() const
+{
+	return FreeUAVs.Num();
+}
+
+int64 UCompushadyUAVPool::GetNumHits() const
+{
+	return NumHits;
+}
+
+int64 UCompushadyUAVPool::GetNumMisses() const
+{
+	return NumMisses;
+}
+
+float UCompushadyUAVPool::GetHitRate() const
+{
+	const int64 Requests = NumHits + NumMisses;
+	return Requests > 0 ? static_cast<float>(NumHits) / Requests : 0.0f;
+}
+
+void UCompushadyUAVPool::BeginDestroy()
+{
+	UpdateStats(-PooledBytes);
+	PooledUAVs.Empty();
+	FreeUAVs.Empty();
+
+	Super::BeginDestroy();
+}
@@ -4,6 +4,20 @@
 #include "CompushadyFunctionLibrary.h"
 #include "Misc/AutomationTest.h"
 
+namespace Compushady
+{
+	namespace Tests
+	{
+		void AddConstant(FCompushadyResourceBinding& ResourceBinding, const FString& Name, const int32 Offset, const int32 Size)
+		{
+			FCompushadyResourceConstant Constant;
+			Constant.Name = Name;
+			Constant.Offset = Offset;
+			Constant.Size = Size;
+			ResourceBinding.Constants.Add(Constant);
+		}
+	}
+}
 
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyCBVTest_Empty, "Compushady.CBV.Empty", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
 
@@ -191,4 +205,196 @@ bool FCompushadyCBVTest_Cleaned::RunTest(const FString& Parameters)
 
 	return true;
 }
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyCBVTest_SetByName, "Compushady.CBV.SetByName", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyCBVTest_SetByName::RunTest(const FString& Parameters)
+{
+	FCompushadyResourceBinding ResourceBinding;
+	Compushady::Tests::AddConstant(ResourceBinding, TEXT("Scale"), 0, 4);
+	Compushady::Tests::AddConstant(ResourceBinding, TEXT("Counter"), 4, 4);
+	Compushady::Tests::AddConstant(ResourceBinding, TEXT("Color"), 16, 16);
+
+	UCompushadyCBV* CBV = UCompushadyFunctionLibrary::CreateCompushadyCBVFromResourceBinding(TestName, ResourceBinding);
+	if (!TestNotNull(TEXT("CBV"), CBV))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("GetBufferSize()"), CBV->GetBufferSize(), 32LL);
+	TestEqual(TEXT("GetConstantOffset(\"Color\")"), CBV->GetConstantOffset(TEXT("Color")), 16LL);
+	TestEqual(TEXT("GetConstantOffset(\"Unknown\")"), CBV->GetConstantOffset(TEXT("Unknown")), -1LL);
+
+	TestTrue(TEXT("SetFloatByName(\"Scale\")"), CBV->SetFloatByName(TEXT("Scale"), 2.5f));
+	TestTrue(TEXT("SetIntByName(\"Counter\")"), CBV->SetIntByName(TEXT("Counter"), 17));
+	TestFalse(TEXT("SetIntByName(\"Unknown\")"), CBV->SetIntByName(TEXT("Unknown"), 17));
+	// too big for the constant
+	TestFalse(TEXT("SetDoubleByName(\"Scale\")"), CBV->SetDoubleByName(TEXT("Scale"), 1.0));
+
+	float Scale = 0;
+	CBV->GetFloat(0, Scale);
+	int32 Counter = 0;
+	CBV->GetInt(4, Counter);
+
+	TestEqual(TEXT("Scale"), Scale, 2.5f);
+	TestEqual(TEXT("Counter"), Counter, 17);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyCBVTest_SetFromStruct, "Compushady.CBV.SetFromStruct", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyCBVTest_SetFromStruct::RunTest(const FString& Parameters)
+{
+	// FVector is made of doubles, so they will be converted to floats
+	FCompushadyResourceBinding ResourceBinding;
+	Compushady::Tests::AddConstant(ResourceBinding, TEXT("X"), 0, 4);
+	Compushady::Tests::AddConstant(ResourceBinding, TEXT("Y"), 4, 4);
+	Compushady::Tests::AddConstant(ResourceBinding, TEXT("Z"), 8, 4);
+
+	UCompushadyCBV* CBV = UCompushadyFunctionLibrary::CreateCompushadyCBVFromResourceBinding(TestName, ResourceBinding);
+	if (!TestNotNull(TEXT("CBV"), CBV))
+	{
+		return false;
+	}
+
+	CBV->BufferDataClean();
+
+	TestTrue(TEXT("SetFromStruct(FVector)"), CBV->SetFromStruct(FVector(1, 2, 3)));
+	TestTrue(TEXT("BufferDataIsDirty()"), CBV->BufferDataIsDirty());
+
+	float Value = 0;
+	CBV->GetFloat(8, Value);
+	TestEqual(TEXT("Z"), Value, 3.0f);
+
+	// the cached plan must be reused
+	TestTrue(TEXT("SetFromStruct(FVector)"), CBV->SetFromStruct(FVector(4, 5, 6)));
+	CBV->GetFloat(4, Value);
+	TestEqual(TEXT("Y"), Value, 5.0f);
+
+	// FLinearColor has no matching constant, so nothing is copied
+	TestTrue(TEXT("SetFromStruct(FLinearColor)"), CBV->SetFromStruct(FLinearColor(7, 8, 9, 10)));
+	CBV->GetFloat(0, Value);
+	TestEqual(TEXT("X"), Value, 4.0f);
+
+	return true;
+}
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyCBVTest_Snapshot, "Compushady.CBV.Snapshot", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyCBVTest_Snapshot::RunTest(const FString& Parameters)
+{
+	UCompushadyCBV* CBV = NewObject<UCompushadyCBV>();
+	CBV->Initialize(TestName, nullptr, 4);
+
+	TestFalse(TEXT("Snapshot().IsValid()"), CBV->Snapshot().IsValid());
+
+	CBV->SetSnapshotMode(true);
+	CBV->SetInt(0, 17);
+
+	TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Snapshot0 = CBV->Snapshot();
+	TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Snapshot1 = CBV->Snapshot();
+
+	// unchanged data must not be copied again
+	TestTrue(TEXT("Snapshot0 == Snapshot1"), Snapshot0 == Snapshot1);
+
+	CBV->SetInt(0, 22);
+
+	TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Snapshot2 = CBV->Snapshot();
+
+	TestTrue(TEXT("Snapshot0 != Snapshot2"), Snapshot0 != Snapshot2);
+	TestEqual(TEXT("Snapshot0"), *reinterpret_cast<const int32*>(Snapshot0->GetData()), 17);
+	TestEqual(TEXT("Snapshot2"), *reinterpret_cast<const int32*>(Snapshot2->GetData()), 22);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyCBVTest_Pool, "Compushady.CBV.Pool", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyCBVTest_Pool::RunTest(const FString& Parameters)
+{
+	// bigger than the structured buffer max stride
+	AddExpectedError(TEXT("Invalid CBV Pool SlotSize"));
+	TestNull(TEXT("CreateCompushadyCBVPool(4096)"), UCompushadyFunctionLibrary::CreateCompushadyCBVPool(TestName, 4096, 4));
+
+	UCompushadyCBVPool* CBVPool = UCompushadyFunctionLibrary::CreateCompushadyCBVPool(TestName, 16, 4);
+	if (!TestNotNull(TEXT("CBVPool"), CBVPool))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("GetSlotSize()"), CBVPool->GetSlotSize(), 256);
+	TestEqual(TEXT("GetBufferSize()"), CBVPool->GetBufferSize(), 1024LL);
+
+	const int32 Slot0 = CBVPool->AllocateSlot();
+	const int32 Slot1 = CBVPool->AllocateSlot();
+	const int32 Slot2 = CBVPool->AllocateSlot();
+
+	TestEqual(TEXT("Slot0"), Slot0, 0);
+	TestEqual(TEXT("Slot2"), Slot2, 2);
+	TestEqual(TEXT("GetNumAllocatedSlots()"), CBVPool->GetNumAllocatedSlots(), 3);
+
+	TestTrue(TEXT("SetFloat(Slot0)"), CBVPool->SetFloat(Slot0, 0, 1.5f));
+	TestTrue(TEXT("SetInt(Slot2)"), CBVPool->SetInt(Slot2, 12, 17));
+	TestTrue(TEXT("SetFloat(Slot2)"), CBVPool->SetFloat(Slot2, 0, 3.5f));
+	// out of the slot
+	TestFalse(TEXT("SetInt(Slot1)"), CBVPool->SetInt(Slot1, 254, 17));
+	// not allocated
+	TestFalse(TEXT("SetInt(3)"), CBVPool->SetInt(3, 0, 17));
+
+	TestEqual(TEXT("GetNumDirtySlots()"), CBVPool->GetNumDirtySlots(), 2);
+
+	CBVPool->Upload();
+
+	TestEqual(TEXT("GetNumDirtySlots()"), CBVPool->GetNumDirtySlots(), 0);
+
+	TArray<uint8> Output;
+	Output.AddZeroed(1024);
+
+	CBVPool->MapReadAndExecuteSync([&Output](const void* Data)
+		{
+			FMemory::Memcpy(Output.GetData(), Data, Output.Num());
+		});
+
+	TestEqual(TEXT("Slot0[0]"), *reinterpret_cast<const float*>(Output.GetData()), 1.5f);
+	TestEqual(TEXT("Slot2[12]"), *reinterpret_cast<const int32*>(Output.GetData() + 512 + 12), 17);
+
+	// the slot view starts at the slot offset, so the shader sees it as the first element
+	FString ErrorMessages;
+	const FString Code = "struct FSlot { float4 Data[16]; }; StructuredBuffer<FSlot> Slot; RWBuffer<float> SlotOutput; [numthreads(1, 1, 1)] void main() { SlotOutput[0] = Slot[0].Data[0].x; SlotOutput[1] = asint(Slot[0].Data[0].w); }";
+	UCompushadyCompute* Compute = UCompushadyFunctionLibrary::CreateCompushadyComputeFromHLSLString(Code, ErrorMessages, "main");
+	if (!TestNotNull(TEXT("Compute"), Compute))
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	UCompushadySRV* SlotSRV = CBVPool->GetSlotSRV(Slot2);
+	if (!TestNotNull(TEXT("GetSlotSRV(Slot2)"), SlotSRV))
+	{
+		return false;
+	}
+	TestNull(TEXT("GetSlotSRV(3)"), CBVPool->GetSlotSRV(3));
+
+	UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVBuffer(TestName, 2 * sizeof(float), EPixelFormat::PF_R32_FLOAT);
+	Compute->DispatchByMap({ {"Slot", SlotSRV}, {"SlotOutput", UAV} }, FIntVector(1, 1, 1), FCompushadySignaled(), {});
+
+	// the readback is enqueued after the dispatch
+	TArray<float> SlotOutput;
+	SlotOutput.AddZeroed(2);
+
+	UAV->MapReadAndExecuteSync([&SlotOutput](const void* Data)
+		{
+			FMemory::Memcpy(SlotOutput.GetData(), Data, SlotOutput.Num() * sizeof(float));
+		});
+
+	TestEqual(TEXT("SlotOutput[0]"), SlotOutput[0], 3.5f);
+	TestEqual(TEXT("SlotOutput[1]"), SlotOutput[1], 17.0f);
+
+	TestTrue(TEXT("FreeSlot(Slot1)"), CBVPool->FreeSlot(Slot1));
+	TestFalse(TEXT("FreeSlot(Slot1)"), CBVPool->FreeSlot(Slot1));
+	TestEqual(TEXT("AllocateSlot()"), CBVPool->AllocateSlot(), Slot1);
+
+	return true;
+}
+
 #endif
@@ -0,0 +1,239 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#if WITH_DEV_AUTOMATION_TESTS
+#include "CompushadyConversion.h"
+#include "CompushadyDataTable.h"
+#include "Misc/AutomationTest.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyConversionTest_Half, "Compushady.Conversion.Half", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyConversionTest_Half::RunTest(const FString& Parameters)
+{
+	// 11 elements for testing both the vector and the scalar paths
+	TArray<float> Input = { 0, 1, -1, 0.5f, 2, 1024, -0.25f, 3, 4, 5, 65504 };
+	TArray<uint16> Halfs;
+	Halfs.AddZeroed(Input.Num());
+	TArray<float> Output;
+	Output.AddZeroed(Input.Num());
+
+	Compushady::Conversion::FloatToHalf(Input.GetData(), Halfs.GetData(), Input.Num());
+	Compushady::Conversion::HalfToFloat(Halfs.GetData(), Output.GetData(), Input.Num());
+
+	for (int32 Index = 0; Index < Input.Num(); Index++)
+	{
+		TestEqual(FString::Printf(TEXT("Output[%d]"), Index), Output[Index], Input[Index]);
+	}
+
+	TestEqual(TEXT("Halfs[1]"), Halfs[1], 0x3C00);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyConversionTest_Unorm, "Compushady.Conversion.Unorm", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyConversionTest_Unorm::RunTest(const FString& Parameters)
+{
+	TArray<float> Input = { 0, 1, 0.5f, 2, -1, 0.25f };
+
+	TArray<uint8> Unorm8;
+	Unorm8.AddZeroed(Input.Num());
+	Compushady::Conversion::FloatToUnorm8(Input.GetData(), Unorm8.GetData(), Input.Num());
+
+	TestEqual(TEXT("Unorm8[0]"), Unorm8[0], 0);
+	TestEqual(TEXT("Unorm8[1]"), Unorm8[1], 255);
+	TestEqual(TEXT("Unorm8[2]"), Unorm8[2], 128);
+	TestEqual(TEXT("Unorm8[3]"), Unorm8[3], 255);
+	TestEqual(TEXT("Unorm8[4]"), Unorm8[4], 0);
+	TestEqual(TEXT("Unorm8[5]"), Unorm8[5], 64);
+
+	TArray<uint16> Unorm16;
+	Unorm16.AddZeroed(Input.Num());
+	Compushady::Conversion::FloatToUnorm16(Input.GetData(), Unorm16.GetData(), Input.Num());
+
+	TestEqual(TEXT("Unorm16[1]"), Unorm16[1], 65535);
+	TestTrue(TEXT("Unorm16[2]"), FMath::Abs(Unorm16[2] - 32768) <= 1);
+	TestEqual(TEXT("Unorm16[4]"), Unorm16[4], 0);
+
+	TArray<float> Output;
+	Output.AddZeroed(Input.Num());
+	Compushady::Conversion::Unorm16ToFloat(Unorm16.GetData(), Output.GetData(), Input.Num());
+
+	TestEqual(TEXT("Output[1]"), Output[1], 1.0f);
+	TestEqual(TEXT("Output[2]"), Output[2], 0.5f, 1.0f / 65535.0f);
+	TestEqual(TEXT("Output[5]"), Output[5], 0.25f, 1.0f / 65535.0f);
+
+	Compushady::Conversion::Unorm8ToFloat(Unorm8.GetData(), Output.GetData(), Input.Num());
+
+	TestEqual(TEXT("Output[1]"), Output[1], 1.0f);
+	TestEqual(TEXT("Output[5]"), Output[5], 64.0f / 255.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyConversionTest_SwapRedBlue8, "Compushady.Conversion.SwapRedBlue8", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyConversionTest_SwapRedBlue8::RunTest(const FString& Parameters)
+{
+	TArray<uint8> Pixels;
+	for (int32 Index = 0; Index < 5; Index++)
+	{
+		Pixels.Append({ static_cast<uint8>(Index), 100, 200, 255 });
+	}
+
+	Compushady::Conversion::SwapRedBlue8(Pixels.GetData(), Pixels.GetData(), 5);
+
+	TestEqual(TEXT("Pixels[0]"), Pixels[0], 200);
+	TestEqual(TEXT("Pixels[2]"), Pixels[2], 0);
+	TestEqual(TEXT("Pixels[3]"), Pixels[3], 255);
+	TestEqual(TEXT("Pixels[17]"), Pixels[17], 100);
+	TestEqual(TEXT("Pixels[18]"), Pixels[18], 4);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyConversionTest_RGB10A2, "Compushady.Conversion.RGB10A2", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyConversionTest_RGB10A2::RunTest(const FString& Parameters)
+{
+	TArray<uint32> Pixels = { 1023 | (0 << 10) | (1023 << 20) | (3U << 30) };
+
+	TArray<float> Output;
+	TestTrue(TEXT("PixelFormatToFloat"), Compushady::Conversion::PixelFormatToFloat(EPixelFormat::PF_A2B10G10R10, reinterpret_cast<const uint8*>(Pixels.GetData()), sizeof(uint32), Output));
+
+	TestEqual(TEXT("Output.Num()"), Output.Num(), 4);
+	TestEqual(TEXT("Output[0]"), Output[0], 1.0f);
+	TestEqual(TEXT("Output[1]"), Output[1], 0.0f);
+	TestEqual(TEXT("Output[2]"), Output[2], 1.0f);
+	TestEqual(TEXT("Output[3]"), Output[3], 1.0f);
+
+	TArray64<uint8> Bytes;
+	TestTrue(TEXT("FloatToPixelFormat"), Compushady::Conversion::FloatToPixelFormat(EPixelFormat::PF_A2B10G10R10, Output.GetData(), Output.Num(), Bytes));
+	TestEqual(TEXT("Bytes"), *reinterpret_cast<const uint32*>(Bytes.GetData()), Pixels[0]);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyConversionTest_Transforms, "Compushady.Conversion.Transforms", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyConversionTest_Transforms::RunTest(const FString& Parameters)
+{
+	TArray<FTransform> Transforms = { FTransform::Identity, FTransform(FRotator(10, 20, 30), FVector(1, 2, 3), FVector(4, 5, 6)) };
+
+	const FMatrix44f Matrix(Transforms[1].ToMatrixWithScale());
+
+	TArray<float> Output;
+	Output.AddZeroed(Transforms.Num() * 16);
+
+	Compushady::Conversion::TransformsToMatrix44f(Transforms.GetData(), Output.GetData(), Transforms.Num(), false);
+	TestTrue(TEXT("Matrix4x4"), FMemory::Memcmp(Output.GetData() + 16, Matrix.M, 16 * sizeof(float)) == 0);
+
+	Compushady::Conversion::TransformsToMatrix44f(Transforms.GetData(), Output.GetData(), Transforms.Num(), true);
+	TestTrue(TEXT("Matrix4x4 Transposed"), FMemory::Memcmp(Output.GetData() + 16, Matrix.GetTransposed().M, 16 * sizeof(float)) == 0);
+	TestEqual(TEXT("Output[0]"), Output[0], 1.0f);
+	TestEqual(TEXT("Output[15]"), Output[15], 1.0f);
+
+	Compushady::Conversion::TransformsToMatrix34f(Transforms.GetData(), Output.GetData(), Transforms.Num());
+	TestTrue(TEXT("Matrix3x4"), FMemory::Memcmp(Output.GetData() + 12, Matrix.GetTransposed().M, 12 * sizeof(float)) == 0);
+
+	Compushady::Conversion::TransformsToQuatTranslationScale(Transforms.GetData(), Output.GetData(), Transforms.Num());
+	const FQuat4f Rotation(Transforms[1].GetRotation());
+	TestEqual(TEXT("Rotation.X"), Output[10], Rotation.X);
+	TestEqual(TEXT("Rotation.W"), Output[13], Rotation.W);
+	TestEqual(TEXT("Translation.Z"), Output[16], 3.0f);
+	TestEqual(TEXT("Scale.X"), Output[17], 4.0f);
+	TestEqual(TEXT("Scale.Z"), Output[19], 6.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyConversionTest_DataTable, "Compushady.Conversion.DataTable", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyConversionTest_DataTable::RunTest(const FString& Parameters)
+{
+	// FBox covers vectors (Min and Max), doubles demotion and byte widening (IsValid)
+	TArray<FBox> Boxes = { FBox(FVector(1, 2, 3), FVector(4, 5, 6)), FBox(ForceInit) };
+	TArray<const uint8*> Rows = { reinterpret_cast<const uint8*>(&Boxes[0]), reinterpret_cast<const uint8*>(&Boxes[1]) };
+
+	TArray<uint8> Data;
+	int32 Stride = 0;
+	FString HLSL;
+	FString ErrorMessages;
+
+	TestTrue(TEXT("Interleaved"), Compushady::DataTable::Pack(TBaseStructure<FBox>::Get(), Rows, ECompushadyDataTableLayout::Interleaved, true, Data, Stride, HLSL, ErrorMessages));
+	TestEqual(TEXT("Stride"), Stride, 28);
+	TestEqual(TEXT("Data.Num()"), Data.Num(), 56);
+	const float* Floats = reinterpret_cast<const float*>(Data.GetData());
+	TestEqual(TEXT("Min.Z"), Floats[2], 3.0f);
+	TestEqual(TEXT("Max.X"), Floats[3], 4.0f);
+	TestEqual(TEXT("IsValid"), reinterpret_cast<const uint32*>(Data.GetData())[6], 1u);
+	TestEqual(TEXT("IsValid[1]"), reinterpret_cast<const uint32*>(Data.GetData())[13], 0u);
+	TestTrue(TEXT("HLSL"), HLSL.Contains(TEXT("float3 Min;")) && HLSL.Contains(TEXT("uint IsValid;")));
+
+	TestTrue(TEXT("Columnar"), Compushady::DataTable::Pack(TBaseStructure<FBox>::Get(), Rows, ECompushadyDataTableLayout::Columnar, true, Data, Stride, HLSL, ErrorMessages));
+	TestEqual(TEXT("Stride"), Stride, 4);
+	Floats = reinterpret_cast<const float*>(Data.GetData());
+	TestEqual(TEXT("Max[0].X"), Floats[6], 4.0f);
+	TestEqual(TEXT("IsValid[0]"), reinterpret_cast<const uint32*>(Data.GetData())[12], 1u);
+	TestTrue(TEXT("HLSL"), HLSL.Contains(TEXT("Box_Max = 6;")));
+
+	// doubles are 8 bytes aligned, so the row gets padded
+	TestTrue(TEXT("Doubles"), Compushady::DataTable::Pack(TBaseStructure<FBox>::Get(), Rows, ECompushadyDataTableLayout::Interleaved, false, Data, Stride, HLSL, ErrorMessages));
+	TestEqual(TEXT("Stride"), Stride, 56);
+	TestEqual(TEXT("Max.Y"), reinterpret_cast<const double*>(Data.GetData())[4], 5.0);
+	TestTrue(TEXT("HLSL"), HLSL.Contains(TEXT("double3 Max;")) && HLSL.Contains(TEXT("_padding0;")));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyConversionTest_Benchmark, "Compushady.Conversion.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FCompushadyConversionTest_Benchmark::RunTest(const FString& Parameters)
+{
+	// 64M elements, enough for not being cache bound
+	constexpr int64 Elements = 64 * 1024 * 1024;
+	constexpr int32 Iterations = 4;
+
+	TArray64<float> Floats;
+	Floats.SetNumUninitialized(Elements);
+	for (int64 Index = 0; Index < Elements; Index++)
+	{
+		Floats[Index] = (Index % 1024) / 1024.0f;
+	}
+
+	TArray64<uint8> Bytes;
+	Bytes.SetNumZeroed(Elements * sizeof(float));
+
+	// bandwidth is computed as the sum of read and written bytes
+	auto Benchmark = [this](const TCHAR* Name, const int64 ProcessedBytes, TFunction<void()> Function)
+		{
+			Function();
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+			{
+				Function();
+			}
+			const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+			AddInfo(FString::Printf(TEXT("%s: %.2f GB/s"), Name, (ProcessedBytes * Iterations) / ElapsedTime / (1024.0 * 1024.0 * 1024.0)));
+		};
+
+	uint16* Halfs = reinterpret_cast<uint16*>(Bytes.GetData());
+	Benchmark(TEXT("FloatToHalf"), Elements * (sizeof(float) + sizeof(uint16)), [&]() { Compushady::Conversion::FloatToHalf(Floats.GetData(), Halfs, Elements); });
+	Benchmark(TEXT("HalfToFloat"), Elements * (sizeof(float) + sizeof(uint16)), [&]() { Compushady::Conversion::HalfToFloat(Halfs, Floats.GetData(), Elements); });
+
+	Benchmark(TEXT("FloatToUnorm8"), Elements * (sizeof(float) + sizeof(uint8)), [&]() { Compushady::Conversion::FloatToUnorm8(Floats.GetData(), Bytes.GetData(), Elements); });
+	Benchmark(TEXT("Unorm8ToFloat"), Elements * (sizeof(float) + sizeof(uint8)), [&]() { Compushady::Conversion::Unorm8ToFloat(Bytes.GetData(), Floats.GetData(), Elements); });
+
+	uint16* Unorm16 = reinterpret_cast<uint16*>(Bytes.GetData());
+	Benchmark(TEXT("FloatToUnorm16"), Elements * (sizeof(float) + sizeof(uint16)), [&]() { Compushady::Conversion::FloatToUnorm16(Floats.GetData(), Unorm16, Elements); });
+	Benchmark(TEXT("Unorm16ToFloat"), Elements * (sizeof(float) + sizeof(uint16)), [&]() { Compushady::Conversion::Unorm16ToFloat(Unorm16, Floats.GetData(), Elements); });
+
+	uint32* Packed = reinterpret_cast<uint32*>(Bytes.GetData());
+	Benchmark(TEXT("FloatToRGB10A2"), Elements * sizeof(float) + (Elements / 4) * sizeof(uint32), [&]() { Compushady::Conversion::FloatToRGB10A2(Floats.GetData(), Packed, Elements / 4); });
+	Benchmark(TEXT("RGB10A2ToFloat"), Elements * sizeof(float) + (Elements / 4) * sizeof(uint32), [&]() { Compushady::Conversion::RGB10A2ToFloat(Packed, Floats.GetData(), Elements / 4); });
+
+	Benchmark(TEXT("SwapRedBlue8"), Elements * sizeof(uint32) * 2, [&]() { Compushady::Conversion::SwapRedBlue8(Bytes.GetData(), Bytes.GetData(), Elements); });
+
+	return true;
+}
+
+#endif
@@ -157,4 +157,41 @@ bool FCompushadyDXCTest_Bindings::RunTest(const FString& Parameters)
 }
 
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyDXCTest_Constants, "Compushady.DXC.Constants", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyDXCTest_Constants::RunTest(const FString& Parameters)
+{
+	TArray<uint8> ByteCode;
+	Compushady::FCompushadyShaderResourceBindings Bindings;
+	FIntVector ThreadGroupSize;
+	FString ErrorMessages;
+
+	TArray<uint8> ShaderCode;
+	Compushady::StringToShaderCode("cbuffer Config : register(b0) { float scale; uint counter; float4 color; float3x3 rotation; }; RWBuffer<float> Output0; [numthreads(1, 1, 1)] void main() { Output0[0] = scale * counter + color.x + rotation[1][1]; }", ShaderCode);
+
+	const bool bSuccess = Compushady::CompileHLSL(ShaderCode, "main", "cs_6_0", ByteCode, Bindings, ThreadGroupSize, ErrorMessages);
+
+	TestTrue(TEXT("bSuccess"), bSuccess);
+
+	if (!TestEqual(TEXT("Bindings.CBVs.Num()"), Bindings.CBVs.Num(), 1))
+	{
+		return false;
+	}
+
+	const TArray<Compushady::FCompushadyShaderConstant>& Constants = Bindings.CBVs[0].Constants;
+	if (!TestEqual(TEXT("Constants.Num()"), Constants.Num(), 4))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Constants[1].Name"), Constants[1].Name, TEXT("counter"));
+	TestEqual(TEXT("Constants[1].Offset"), Constants[1].Offset, 4U);
+	TestEqual(TEXT("Constants[2].Offset"), Constants[2].Offset, 16U);
+	TestEqual(TEXT("Constants[2].Size"), Constants[2].Size, 16U);
+	TestEqual(TEXT("Constants[3].Offset"), Constants[3].Offset, 32U);
+	TestEqual(TEXT("Constants[3].Size"), Constants[3].Size, 44U);
+
+	return true;
+}
+
 #endif
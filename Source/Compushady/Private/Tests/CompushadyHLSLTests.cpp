@@ -104,4 +104,49 @@ bool FCompushadyHLSLTest_RWBuffer::RunTest(const FString& Parameters)
 	return true;
 }
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyHLSLTest_CBVSnapshots, "Compushady.HLSL.CBVSnapshots", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyHLSLTest_CBVSnapshots::RunTest(const FString& Parameters)
+{
+	FString ErrorMessages;
+	const FString Code = "cbuffer Config { uint index; uint value; }; RWBuffer<uint> Output; [numthreads(1,1,1)] void main() { Output[index] = value; }";
+	UCompushadyCompute* Compute = UCompushadyFunctionLibrary::CreateCompushadyComputeFromHLSLString(Code, ErrorMessages, "main");
+
+	UCompushadyCBV* CBV = UCompushadyFunctionLibrary::CreateCompushadyCBV(TestName, 8);
+	CBV->SetSnapshotMode(true);
+
+	UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVBuffer(TestName, 16, EPixelFormat::PF_R32_UINT);
+
+	FCompushadySignaled Signal;
+	Signal.BindUFunction(Compute, TEXT("StoreLastSignal"));
+
+	// no waiting between the dispatches, every one must get its own constants
+	for (uint32 Index = 0; Index < 4; Index++)
+	{
+		CBV->SetUInt(0, Index);
+		CBV->SetUInt(4, 0xdead0000 + Index);
+		Compute->DispatchByMap({ {"Config", CBV}, {"Output", UAV} }, FIntVector(1, 1, 1), Signal, {});
+	}
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitCompute(this, Compute, [this, Compute, UAV]()
+		{
+			TestTrue("Compute->bLastSuccess", Compute->bLastSuccess);
+
+			TArray<uint32> Output;
+			Output.AddZeroed(4);
+
+			UAV->MapReadAndExecuteSync([&Output](const void* Data)
+				{
+					FMemory::Memcpy(Output.GetData(), Data, 4 * sizeof(uint32));
+				});
+
+			TestEqual(TEXT("Output[0]"), Output[0], 0xdead0000);
+			TestEqual(TEXT("Output[1]"), Output[1], 0xdead0001);
+			TestEqual(TEXT("Output[2]"), Output[2], 0xdead0002);
+			TestEqual(TEXT("Output[3]"), Output[3], 0xdead0003);
+		}));
+
+	return true;
+}
+
 #endif
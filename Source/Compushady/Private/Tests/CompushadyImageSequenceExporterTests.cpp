@@ -0,0 +1,103 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#if WITH_DEV_AUTOMATION_TESTS
+#include "CompushadyFunctionLibrary.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+namespace Compushady
+{
+	namespace Tests
+	{
+		double BenchmarkImageSequenceExporter(FAutomationTestBase& Test, const ECompushadyImageSequenceFormat Format, const EPixelFormat PixelFormat, const int32 NumFrames)
+		{
+			UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVTexture2D(Test.GetTestName(), 3840, 2160, PixelFormat);
+			if (!UAV)
+			{
+				return 0;
+			}
+
+			const FString Directory = FPaths::Combine(FPaths::ProjectIntermediateDir(), TEXT("CompushadyImageSequence"));
+			UCompushadyImageSequenceExporter* Exporter = UCompushadyFunctionLibrary::CreateCompushadyImageSequenceExporter(FPaths::Combine(Directory, TEXT("Frame_")), Format, ECompushadyImageSequencePolicy::Block, FPlatformMisc::NumberOfCoresIncludingHyperthreads(), 16);
+			if (!Exporter)
+			{
+				return 0;
+			}
+
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < NumFrames; Index++)
+			{
+				Exporter->ExportFrame(UAV);
+			}
+			FlushRenderingCommands();
+			Exporter->Flush();
+			const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+
+			Test.TestEqual(TEXT("GetNumExportedFrames()"), Exporter->GetNumExportedFrames(), static_cast<int64>(NumFrames));
+			Test.TestEqual(TEXT("GetNumDroppedFrames()"), Exporter->GetNumDroppedFrames(), static_cast<int64>(0));
+
+			IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+			return NumFrames / ElapsedTime;
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyImageSequenceExporterTest_Drop, "Compushady.ImageSequenceExporter.Drop", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyImageSequenceExporterTest_Drop::RunTest(const FString& Parameters)
+{
+	UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVTexture2D(TestName, 8, 8, EPixelFormat::PF_B8G8R8A8);
+
+	const FString Directory = FPaths::Combine(FPaths::ProjectIntermediateDir(), TEXT("CompushadyImageSequenceDrop"));
+	UCompushadyImageSequenceExporter* Exporter = UCompushadyFunctionLibrary::CreateCompushadyImageSequenceExporter(FPaths::Combine(Directory, TEXT("Frame_")), ECompushadyImageSequenceFormat::PNG, ECompushadyImageSequencePolicy::Drop, 1, 1);
+
+	// the first frame is still in the readback/encoding pipeline, so the second one finds the queue full
+	TestTrue(TEXT("ExportFrame(UAV)"), Exporter->ExportFrame(UAV));
+	TestFalse(TEXT("ExportFrame(UAV)"), Exporter->ExportFrame(UAV));
+
+	FlushRenderingCommands();
+	Exporter->Flush();
+
+	TestEqual(TEXT("GetNumExportedFrames()"), Exporter->GetNumExportedFrames(), static_cast<int64>(1));
+	TestEqual(TEXT("GetNumDroppedFrames()"), Exporter->GetNumDroppedFrames(), static_cast<int64>(1));
+	TestTrue(TEXT("FileExists"), FPaths::FileExists(FPaths::Combine(Directory, TEXT("Frame_000000.png"))));
+
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyImageSequenceExporterTest_RejectTexture3D, "Compushady.ImageSequenceExporter.RejectTexture3D", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyImageSequenceExporterTest_RejectTexture3D::RunTest(const FString& Parameters)
+{
+	UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVTexture3D(TestName, 8, 8, 8, EPixelFormat::PF_B8G8R8A8);
+
+	const FString Directory = FPaths::Combine(FPaths::ProjectIntermediateDir(), TEXT("CompushadyImageSequenceRejectTexture3D"));
+	UCompushadyImageSequenceExporter* Exporter = UCompushadyFunctionLibrary::CreateCompushadyImageSequenceExporter(FPaths::Combine(Directory, TEXT("Frame_")), ECompushadyImageSequenceFormat::PNG, ECompushadyImageSequencePolicy::Block, 1, 1);
+
+	AddExpectedError(TEXT("Only 2D textures can be exported"));
+
+	TestFalse(TEXT("ExportFrame(UAV)"), Exporter->ExportFrame(UAV));
+	TestEqual(TEXT("GetNumQueuedFrames()"), Exporter->GetNumQueuedFrames(), 0);
+
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyImageSequenceExporterTest_Benchmark, "Compushady.ImageSequenceExporter.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FCompushadyImageSequenceExporterTest_Benchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumFrames = 120;
+
+	AddInfo(FString::Printf(TEXT("4K RGBA8 PNG: %.2f fps"), Compushady::Tests::BenchmarkImageSequenceExporter(*this, ECompushadyImageSequenceFormat::PNG, EPixelFormat::PF_R8G8B8A8, NumFrames)));
+	AddInfo(FString::Printf(TEXT("4K RGBA16F EXR: %.2f fps"), Compushady::Tests::BenchmarkImageSequenceExporter(*this, ECompushadyImageSequenceFormat::EXR, EPixelFormat::PF_FloatRGBA, NumFrames)));
+	AddInfo(FString::Printf(TEXT("4K RGBA16F Raw: %.2f fps"), Compushady::Tests::BenchmarkImageSequenceExporter(*this, ECompushadyImageSequenceFormat::Raw, EPixelFormat::PF_FloatRGBA, NumFrames)));
+
+	return true;
+}
+
+#endif
@@ -64,4 +64,727 @@ bool FCompushadyRasterizerTest_Simple::RunTest(const FString& Parameters)
 	return true;
 }
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyRasterizerTest_ViewportScissor, "Compushady.Rasterizer.ViewportScissor", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyRasterizerTest_ViewportScissor::RunTest(const FString& Parameters)
+{
+	FString ErrorMessages;
+	// a single triangle covering the whole viewport
+	const FString VSCode = "float4 main(uint vid : SV_VertexID) : SV_Position { return float4(vid == 1 ? 3 : -1, vid == 2 ? 3 : -1, 0, 1); }";
+	const FString PSCode = "float4 main(float4 pos : SV_position) : SV_Target0 { return float4(1, 0, 0, 1); }";
+	UCompushadyRasterizer* Rasterizer = UCompushadyFunctionLibrary::CreateCompushadyVSPSRasterizerFromHLSLString(VSCode, PSCode, FCompushadyRasterizerConfig(), ErrorMessages, "main", "main");
+
+	UCompushadyRTV* RTV = UCompushadyFunctionLibrary::CreateCompushadyRTVTexture2D(TestName, 8, 8, EPixelFormat::PF_R8G8B8A8, FLinearColor::Black);
+
+	TestTrue(TEXT("PrecachePipelineState"), Rasterizer->PrecachePipelineState({ RTV }, nullptr));
+
+	// left half viewport, top half scissor
+	FCompushadyRasterizeConfig RasterizeConfig;
+	RasterizeConfig.Viewport = FBox(FVector(0, 0, 0), FVector(4, 8, 1));
+	RasterizeConfig.Scissor = FBox2D(FVector2D(0, 0), FVector2D(8, 4));
+
+	FCompushadySignaled Signal;
+	Signal.BindUFunction(Rasterizer, TEXT("StoreLastSignal"));
+	Rasterizer->Draw({}, {}, { RTV }, nullptr, 3, 1, true, false, Signal, RasterizeConfig);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitRasterizer(this, Rasterizer, [this, Rasterizer, RTV]()
+		{
+			TestTrue("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+			TArray<uint32> Output;
+			Output.AddZeroed(8 * 8);
+
+			RTV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+				{
+					CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R8G8B8A8, RowPitch, 8 * sizeof(uint32));
+				}, 0);
+
+			TestEqual(TEXT("Output[0]"), Output[0], 0xff0000ff);
+			TestEqual(TEXT("Output[3 * 8 + 3]"), Output[3 * 8 + 3], 0xff0000ff);
+			TestEqual(TEXT("Output[4]"), Output[4], 0xff000000);
+			TestEqual(TEXT("Output[4 * 8]"), Output[4 * 8], 0xff000000);
+		}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyRasterizerTest_DrawIndexedIndirect, "Compushady.Rasterizer.DrawIndexedIndirect", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyRasterizerTest_DrawIndexedIndirect::RunTest(const FString& Parameters)
+{
+	FString ErrorMessages;
+	// vertex 0 is never indexed
+	const FString VSCode = "float4 main(uint vid : SV_VertexID) : SV_Position { if (vid == 1) { return float4(-1, -1, 0, 1); } else if (vid == 2) { return float4(0, 1, 0, 1); } else if (vid == 3) { return float4(1, -1, 0, 1); } return float4(0, 0, 0, 0); }";
+	const FString PSCode = "float4 main(float4 pos : SV_position) : SV_Target0 { return float4(1, 0, 0, 1); }";
+	UCompushadyRasterizer* Rasterizer = UCompushadyFunctionLibrary::CreateCompushadyVSPSRasterizerFromHLSLString(VSCode, PSCode, FCompushadyRasterizerConfig(), ErrorMessages, "main", "main");
+
+	UCompushadyRTV* RTV = UCompushadyFunctionLibrary::CreateCompushadyRTVTexture2D(TestName, 8, 8, EPixelFormat::PF_R8G8B8A8, FLinearColor::Black);
+
+	UCompushadyUAV* IndexBuffer = UCompushadyFunctionLibrary::CreateCompushadyUAVIndexBuffer(TestName, 3 * sizeof(uint32), EPixelFormat::PF_R32_UINT);
+	IndexBuffer->MapWriteAndExecuteSync([](void* Data)
+		{
+			uint32* Indices = reinterpret_cast<uint32*>(Data);
+			Indices[0] = 1;
+			Indices[1] = 2;
+			Indices[2] = 3;
+		});
+
+	// the first draw arguments are empty, the second ones are at offset 20
+	UCompushadyUAV* ArgumentsBuffer = UCompushadyFunctionLibrary::CreateCompushadyUAVIndirectArgumentsBuffer(TestName, 2 * sizeof(FRHIDrawIndexedIndirectParameters));
+	ArgumentsBuffer->MapWriteAndExecuteSync([](void* Data)
+		{
+			FRHIDrawIndexedIndirectParameters* Arguments = reinterpret_cast<FRHIDrawIndexedIndirectParameters*>(Data);
+			Arguments[0] = {};
+			Arguments[1] = {};
+			Arguments[1].IndexCountPerInstance = 3;
+			Arguments[1].InstanceCount = 1;
+		});
+
+	FCompushadySignaled Signal;
+	Signal.BindUFunction(Rasterizer, TEXT("StoreLastSignal"));
+	Rasterizer->DrawIndexedIndirect({}, {}, { RTV }, nullptr, IndexBuffer, ArgumentsBuffer, sizeof(FRHIDrawIndexedIndirectParameters), true, false, Signal, FCompushadyRasterizeConfig());
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitRasterizer(this, Rasterizer, [this, Rasterizer, RTV]()
+		{
+			TestTrue("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+			TArray<uint32> Output;
+			Output.AddZeroed(8 * 8);
+
+			RTV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+				{
+					CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R8G8B8A8, RowPitch, 8 * sizeof(uint32));
+				}, 0);
+
+			TestEqual(TEXT("Output[7 * 8]"), Output[7 * 8], 0xff0000ff);
+			TestEqual(TEXT("Output[7 * 8 + 7]"), Output[7 * 8 + 7], 0xff0000ff);
+			TestEqual(TEXT("Output[3 * 8 + 4]"), Output[3 * 8 + 4], 0xff0000ff);
+			TestEqual(TEXT("Output[0]"), Output[0], 0xff000000);
+		}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyRasterizerTest_GPUIndirectArguments, "Compushady.Rasterizer.GPUIndirectArguments", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyRasterizerTest_GPUIndirectArguments::RunTest(const FString& Parameters)
+{
+	FString ErrorMessages;
+	// vertex 0 is never used, vertices 1-3 are the bottom triangle, vertices 4-6 cover the top left corner
+	const FString VSCode = "float4 main(uint vid : SV_VertexID) : SV_Position { if (vid == 1) { return float4(-1, -1, 0, 1); } else if (vid == 2) { return float4(0, 1, 0, 1); } else if (vid == 3) { return float4(1, -1, 0, 1); }"
+		"else if (vid == 4) { return float4(-1, 0, 0, 1); } else if (vid == 5) { return float4(-1, 1, 0, 1); } else if (vid == 6) { return float4(0, 1, 0, 1); } return float4(0, 0, 0, 0); }";
+	const FString PSCode = "float4 main(float4 pos : SV_position) : SV_Target0 { return float4(1, 0, 0, 1); }";
+	UCompushadyRasterizer* Rasterizer = UCompushadyFunctionLibrary::CreateCompushadyVSPSRasterizerFromHLSLString(VSCode, PSCode, FCompushadyRasterizerConfig(), ErrorMessages, "main", "main");
+	if (!TestNotNull(TEXT("Rasterizer"), Rasterizer))
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	// the indexed arguments are: an empty draw, the bottom triangle and the top left triangle (excluded by the count)
+	const FString CSCode = "RWBuffer<uint> Arguments; RWBuffer<uint> Count; RWBuffer<uint> DrawArguments; [numthreads(1, 1, 1)] void main() {"
+		"for (uint i = 0; i < 5; i++) { Arguments[i] = 0; } Arguments[5] = 3; Arguments[6] = 1; Arguments[7] = 0; Arguments[8] = 0; Arguments[9] = 0;"
+		"Arguments[10] = 3; Arguments[11] = 1; Arguments[12] = 3; Arguments[13] = 0; Arguments[14] = 0; Count[0] = 2;"
+		"DrawArguments[0] = 3; DrawArguments[1] = 1; DrawArguments[2] = 1; DrawArguments[3] = 0; }";
+	UCompushadyCompute* Compute = UCompushadyFunctionLibrary::CreateCompushadyComputeFromHLSLString(CSCode, ErrorMessages, "main");
+	if (!TestNotNull(TEXT("Compute"), Compute))
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	UCompushadyUAV* IndexBuffer = UCompushadyFunctionLibrary::CreateCompushadyUAVIndexBuffer(TestName, 6 * sizeof(uint32), EPixelFormat::PF_R32_UINT);
+	IndexBuffer->MapWriteAndExecuteSync([](void* Data)
+		{
+			uint32* Indices = reinterpret_cast<uint32*>(Data);
+			for (uint32 Index = 0; Index < 6; Index++)
+			{
+				Indices[Index] = Index + 1;
+			}
+		});
+
+	UCompushadyUAV* ArgumentsBuffer = UCompushadyFunctionLibrary::CreateCompushadyUAVIndirectArgumentsBuffer(TestName, 3 * sizeof(FRHIDrawIndexedIndirectParameters));
+	UCompushadyUAV* CountBuffer = UCompushadyFunctionLibrary::CreateCompushadyUAVIndirectArgumentsBuffer(TestName, sizeof(uint32));
+	UCompushadyUAV* DrawArgumentsBuffer = UCompushadyFunctionLibrary::CreateCompushadyUAVIndirectArgumentsBuffer(TestName, sizeof(FRHIDrawIndirectParameters));
+
+	UCompushadyRTV* RTV = UCompushadyFunctionLibrary::CreateCompushadyRTVTexture2D(TestName, 8, 8, EPixelFormat::PF_R8G8B8A8, FLinearColor::Black);
+	UCompushadyRTV* DrawRTV = UCompushadyFunctionLibrary::CreateCompushadyRTVTexture2D(TestName, 8, 8, EPixelFormat::PF_R8G8B8A8, FLinearColor::Black);
+	UCompushadyRTV* FallbackRTV = UCompushadyFunctionLibrary::CreateCompushadyRTVTexture2D(TestName, 8, 8, EPixelFormat::PF_R8G8B8A8, FLinearColor::Black);
+
+	// the arguments buffers go from UAVCompute to IndirectArgs between the dispatch and the draw
+	Compute->DispatchByMap({ {"Arguments", ArgumentsBuffer}, {"Count", CountBuffer}, {"DrawArguments", DrawArgumentsBuffer} }, FIntVector(1, 1, 1), FCompushadySignaled(), {});
+
+	FCompushadySignaled Signal;
+	Signal.BindUFunction(Rasterizer, TEXT("StoreLastSignal"));
+	Rasterizer->MultiDrawIndexedIndirect({}, {}, { RTV }, nullptr, IndexBuffer, ArgumentsBuffer, 0, CountBuffer, 0, 3, true, false, Signal, FCompushadyRasterizeConfig());
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitRasterizer(this, Rasterizer, [this, Rasterizer, RTV, DrawRTV, DrawArgumentsBuffer, Signal]()
+		{
+			TestTrue("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+			TArray<uint32> Output;
+			Output.AddZeroed(8 * 8);
+
+			RTV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+				{
+					CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R8G8B8A8, RowPitch, 8 * sizeof(uint32));
+				}, 0);
+
+			TestEqual(TEXT("Output[7 * 8]"), Output[7 * 8], 0xff0000ff);
+			TestEqual(TEXT("Output[3 * 8 + 4]"), Output[3 * 8 + 4], 0xff0000ff);
+			// without RHI support the count is ignored and the third draw is issued too
+			TestEqual(TEXT("Output[0]"), Output[0], GRHISupportsMultiDrawIndirect ? 0xff000000 : 0xff0000ff);
+
+			Rasterizer->DrawIndirect({}, {}, { DrawRTV }, nullptr, DrawArgumentsBuffer, 0, true, false, Signal, FCompushadyRasterizeConfig());
+		}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitRasterizer(this, Rasterizer, [this, Rasterizer, DrawRTV, FallbackRTV, IndexBuffer, ArgumentsBuffer, Signal]()
+		{
+			TestTrue("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+			TArray<uint32> Output;
+			Output.AddZeroed(8 * 8);
+
+			DrawRTV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+				{
+					CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R8G8B8A8, RowPitch, 8 * sizeof(uint32));
+				}, 0);
+
+			TestEqual(TEXT("Output[7 * 8]"), Output[7 * 8], 0xff0000ff);
+			TestEqual(TEXT("Output[3 * 8 + 4]"), Output[3 * 8 + 4], 0xff0000ff);
+			TestEqual(TEXT("Output[0]"), Output[0], 0xff000000);
+
+			// no count buffer, all of the draws are issued
+			Rasterizer->MultiDrawIndexedIndirect({}, {}, { FallbackRTV }, nullptr, IndexBuffer, ArgumentsBuffer, 0, nullptr, 0, 3, true, false, Signal, FCompushadyRasterizeConfig());
+		}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitRasterizer(this, Rasterizer, [this, Rasterizer, FallbackRTV]()
+		{
+			TestTrue("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+			TArray<uint32> Output;
+			Output.AddZeroed(8 * 8);
+
+			FallbackRTV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+				{
+					CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R8G8B8A8, RowPitch, 8 * sizeof(uint32));
+				}, 0);
+
+			TestEqual(TEXT("Output[7 * 8]"), Output[7 * 8], 0xff0000ff);
+			TestEqual(TEXT("Output[0]"), Output[0], 0xff0000ff);
+		}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyRasterizerTest_VertexBuffers, "Compushady.Rasterizer.VertexBuffers", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyRasterizerTest_VertexBuffers::RunTest(const FString& Parameters)
+{
+	FString ErrorMessages;
+	const FString VSCode = "struct Output { float4 pos : SV_Position; float4 color : COLOR; }; Output main(float2 pos : ATTRIBUTE0, float4 color : ATTRIBUTE1) { Output o; o.pos = float4(pos, 0, 1); o.color = color; return o; }";
+	const FString PSCode = "float4 main(float4 pos : SV_Position, float4 color : COLOR) : SV_Target0 { return color; }";
+	UCompushadyRasterizer* Rasterizer = UCompushadyFunctionLibrary::CreateCompushadyVSPSRasterizerFromHLSLString(VSCode, PSCode, FCompushadyRasterizerConfig(), ErrorMessages, "main", "main");
+	if (!TestNotNull(TEXT("Rasterizer"), Rasterizer))
+	{
+		return false;
+	}
+
+	UCompushadyRTV* RTV = UCompushadyFunctionLibrary::CreateCompushadyRTVTexture2D(TestName, 8, 8, EPixelFormat::PF_R8G8B8A8, FLinearColor::Black);
+
+	// a full screen quad with 4 shared vertices
+	UCompushadyUAV* Positions = UCompushadyFunctionLibrary::CreateCompushadyUAVBuffer(TestName, 4 * sizeof(FVector2f), EPixelFormat::PF_G32R32F);
+	Positions->MapWriteAndExecuteSync([](void* Data)
+		{
+			FVector2f* Vertices = reinterpret_cast<FVector2f*>(Data);
+			Vertices[0] = FVector2f(-1, -1);
+			Vertices[1] = FVector2f(-1, 1);
+			Vertices[2] = FVector2f(1, 1);
+			Vertices[3] = FVector2f(1, -1);
+		});
+
+	UCompushadyUAV* Colors = UCompushadyFunctionLibrary::CreateCompushadyUAVBuffer(TestName, 4 * sizeof(FVector4f), EPixelFormat::PF_A32B32G32R32F);
+	Colors->MapWriteAndExecuteSync([](void* Data)
+		{
+			FVector4f* Vertices = reinterpret_cast<FVector4f*>(Data);
+			for (int32 Index = 0; Index < 4; Index++)
+			{
+				Vertices[Index] = FVector4f(0, 1, 0, 1);
+			}
+		});
+
+	UCompushadyUAV* IndexBuffer = UCompushadyFunctionLibrary::CreateCompushadyUAVIndexBuffer(TestName, 6 * sizeof(uint16), EPixelFormat::PF_R16_UINT);
+	IndexBuffer->MapWriteAndExecuteSync([](void* Data)
+		{
+			const uint16 QuadIndices[] = { 0, 1, 2, 2, 3, 0 };
+			FMemory::Memcpy(Data, QuadIndices, sizeof(QuadIndices));
+		});
+
+	Rasterizer->SetVertexBuffers({ Positions, Colors });
+
+	FCompushadySignaled Signal;
+	Signal.BindUFunction(Rasterizer, TEXT("StoreLastSignal"));
+
+	// the streams have only 4 vertices
+	Rasterizer->Draw({}, {}, { RTV }, nullptr, 6, 1, true, false, Signal);
+	TestFalse(TEXT("Rasterizer->bLastSuccess"), Rasterizer->bLastSuccess);
+	TestFalse(TEXT("Rasterizer->LastErrorMessages.IsEmpty()"), Rasterizer->LastErrorMessages.IsEmpty());
+
+	Rasterizer->DrawIndexed({}, {}, { RTV }, nullptr, IndexBuffer, 6, 1, true, false, Signal, FCompushadyRasterizeConfig());
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitRasterizer(this, Rasterizer, [this, Rasterizer, RTV]()
+		{
+			TestTrue("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+			TArray<uint32> Output;
+			Output.AddZeroed(8 * 8);
+
+			RTV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+				{
+					CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R8G8B8A8, RowPitch, 8 * sizeof(uint32));
+				}, 0);
+
+			TestEqual(TEXT("Output[0]"), Output[0], 0xff00ff00);
+			TestEqual(TEXT("Output[7]"), Output[7], 0xff00ff00);
+			TestEqual(TEXT("Output[7 * 8]"), Output[7 * 8], 0xff00ff00);
+			TestEqual(TEXT("Output[7 * 8 + 7]"), Output[7 * 8 + 7], 0xff00ff00);
+		}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyRasterizerTest_DepthTest, "Compushady.Rasterizer.DepthTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyRasterizerTest_DepthTest::RunTest(const FString& Parameters)
+{
+	FString ErrorMessages;
+	// two full screen instances, the second (green) one is behind the first (red) one
+	const FString VSCode = "struct Output { float4 pos : SV_Position; float4 color : COLOR; }; Output main(uint vid : SV_VertexID, uint iid : SV_InstanceID) { Output o; o.pos = float4(vid == 1 ? 3 : -1, vid == 2 ? 3 : -1, iid == 0 ? 0.25 : 0.75, 1); o.color = iid == 0 ? float4(1, 0, 0, 1) : float4(0, 1, 0, 1); return o; }";
+	const FString PSCode = "float4 main(float4 pos : SV_Position, float4 color : COLOR) : SV_Target0 { return color; }";
+
+	FCompushadyRasterizerConfig RasterizerConfig;
+	RasterizerConfig.bDepthTest = true;
+	RasterizerConfig.bDepthWrite = true;
+	RasterizerConfig.DepthCompare = ECompushadyRasterizerDepthCompare::Less;
+
+	UCompushadyRasterizer* Rasterizer = UCompushadyFunctionLibrary::CreateCompushadyVSPSRasterizerFromHLSLString(VSCode, PSCode, RasterizerConfig, ErrorMessages, "main", "main");
+	if (!TestNotNull(TEXT("Rasterizer"), Rasterizer))
+	{
+		return false;
+	}
+
+	UCompushadyRTV* RTV = UCompushadyFunctionLibrary::CreateCompushadyRTVTexture2D(TestName, 8, 8, EPixelFormat::PF_R8G8B8A8, FLinearColor::Black);
+	UCompushadyDSV* DSV = UCompushadyFunctionLibrary::CreateCompushadyDSVTexture2D(TestName, 8, 8, EPixelFormat::PF_DepthStencil, 1.0f, 0);
+
+	FCompushadySignaled Signal;
+	Signal.BindUFunction(Rasterizer, TEXT("StoreLastSignal"));
+
+	// depth test requires a DSV
+	Rasterizer->Draw({}, {}, { RTV }, nullptr, 3, 2, true, true, Signal, FCompushadyRasterizeConfig());
+	TestFalse("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+	Rasterizer->Draw({}, {}, { RTV }, DSV, 3, 2, true, true, Signal, FCompushadyRasterizeConfig());
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitRasterizer(this, Rasterizer, [this, Rasterizer, RTV]()
+		{
+			TestTrue("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+			TArray<uint32> Output;
+			Output.AddZeroed(8 * 8);
+
+			RTV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+				{
+					CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R8G8B8A8, RowPitch, 8 * sizeof(uint32));
+				}, 0);
+
+			TestEqual(TEXT("Output[0]"), Output[0], 0xff0000ff);
+			TestEqual(TEXT("Output[3 * 8 + 4]"), Output[3 * 8 + 4], 0xff0000ff);
+			TestEqual(TEXT("Output[7 * 8 + 7]"), Output[7 * 8 + 7], 0xff0000ff);
+		}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyRasterizerTest_DepthPrepass, "Compushady.Rasterizer.DepthPrepass", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyRasterizerTest_DepthPrepass::RunTest(const FString& Parameters)
+{
+	FString ErrorMessages;
+	// instance 0 is a full screen green quad at depth 0.5, instance 1 covers the left half at depth 0.25
+	const FString VSCode = "float4 main(uint vid : SV_VertexID, uint iid : SV_InstanceID) : SV_Position { float2 uv = float2((vid == 1 || vid == 4 || vid == 5) ? 1 : 0, (vid == 2 || vid == 3 || vid == 5) ? 1 : 0); float right = iid == 0 ? 1 : 0; return float4(lerp(-1, right, uv.x), lerp(-1, 1, uv.y), iid == 0 ? 0.5 : 0.25, 1); }";
+	const FString PSCode = "float4 main(float4 pos : SV_Position) : SV_Target0 { return float4(0, 1, 0, 1); }";
+
+	FCompushadyRasterizerConfig RasterizerConfig;
+	RasterizerConfig.bDepthTest = true;
+	RasterizerConfig.bDepthWrite = true;
+	RasterizerConfig.DepthCompare = ECompushadyRasterizerDepthCompare::LessEqual;
+
+	UCompushadyRasterizer* Rasterizer = UCompushadyFunctionLibrary::CreateCompushadyVSPSRasterizerFromHLSLString(VSCode, PSCode, RasterizerConfig, ErrorMessages, "main", "main");
+	if (!TestNotNull(TEXT("Rasterizer"), Rasterizer))
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	UCompushadyRTV* RTV = UCompushadyFunctionLibrary::CreateCompushadyRTVTexture2D(TestName, 8, 8, EPixelFormat::PF_R8G8B8A8, FLinearColor::Black);
+	UCompushadyDSV* DSV = UCompushadyFunctionLibrary::CreateCompushadyDSVTexture2D(TestName, 8, 8, EPixelFormat::PF_DepthStencil, 1.0f, 0);
+
+	FCompushadySignaled Signal;
+	Signal.BindUFunction(Rasterizer, TEXT("StoreLastSignal"));
+
+	// depth only prepass (no RTVs) of both instances, clearing the DSV
+	Rasterizer->Draw({}, {}, {}, DSV, 6, 2, false, true, Signal, FCompushadyRasterizeConfig());
+
+	// the color pass loads the prepass depth: the full screen quad passes LessEqual only where nothing is in front of it
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitRasterizer(this, Rasterizer, [this, Rasterizer, RTV, DSV, Signal]()
+		{
+			TestTrue("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+			Rasterizer->Draw({}, {}, { RTV }, DSV, 6, 1, true, false, Signal, FCompushadyRasterizeConfig());
+		}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitRasterizer(this, Rasterizer, [this, Rasterizer, RTV]()
+		{
+			TestTrue("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+			TArray<uint32> Output;
+			Output.AddZeroed(8 * 8);
+
+			RTV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+				{
+					CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R8G8B8A8, RowPitch, 8 * sizeof(uint32));
+				}, 0);
+
+			TestEqual(TEXT("Output[0]"), Output[0], 0xff000000);
+			TestEqual(TEXT("Output[4 * 8 + 3]"), Output[4 * 8 + 3], 0xff000000);
+			TestEqual(TEXT("Output[4 * 8 + 4]"), Output[4 * 8 + 4], 0xff00ff00);
+			TestEqual(TEXT("Output[7 * 8 + 7]"), Output[7 * 8 + 7], 0xff00ff00);
+		}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyRasterizerTest_DrawBatch, "Compushady.Rasterizer.DrawBatch", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyRasterizerTest_DrawBatch::RunTest(const FString& Parameters)
+{
+	FString ErrorMessages;
+	// a quad covering Rect, filled with Color
+	const FString VSCode = "cbuffer Data : register(b0) { float4 Color; float4 Rect; }; float4 main(uint vid : SV_VertexID) : SV_Position { const float2 Corners[6] = { float2(0, 0), float2(0, 1), float2(1, 1), float2(1, 1), float2(1, 0), float2(0, 0) }; return float4(lerp(Rect.xy, Rect.zw, Corners[vid]), 0, 1); }";
+	const FString PSCode = "cbuffer Data : register(b0) { float4 Color; float4 Rect; }; float4 main(float4 pos : SV_Position) : SV_Target0 { return Color; }";
+	UCompushadyRasterizer* Rasterizer = UCompushadyFunctionLibrary::CreateCompushadyVSPSRasterizerFromHLSLString(VSCode, PSCode, FCompushadyRasterizerConfig(), ErrorMessages, "main", "main");
+	if (!TestNotNull(TEXT("Rasterizer"), Rasterizer))
+	{
+		return false;
+	}
+
+	UCompushadyRTV* RTV = UCompushadyFunctionLibrary::CreateCompushadyRTVTexture2D(TestName, 8, 8, EPixelFormat::PF_R8G8B8A8, FLinearColor::Black);
+	UCompushadyCBV* CBV = UCompushadyFunctionLibrary::CreateCompushadyCBV(TestName, 32);
+
+	// the same CBV, with different per-draw constants (left half red, right half green)
+	const FVector4f Constants[] = { FVector4f(1, 0, 0, 1), FVector4f(-1, -1, 0, 1), FVector4f(0, 1, 0, 1), FVector4f(0, -1, 1, 1) };
+
+	TArray<FCompushadyRasterizerDraw> Draws;
+	for (int32 DrawIndex = 0; DrawIndex < 2; DrawIndex++)
+	{
+		FCompushadyRasterizerDraw& Draw = Draws.AddDefaulted_GetRef();
+		Draw.VSResourceArray.CBVs.Add(CBV);
+		Draw.PSResourceArray.CBVs.Add(CBV);
+		Draw.NumVertices = 6;
+		Draw.VSConstants.Append(reinterpret_cast<const uint8*>(&Constants[DrawIndex * 2]), sizeof(FVector4f) * 2);
+		Draw.PSConstants.Append(reinterpret_cast<const uint8*>(&Constants[DrawIndex * 2]), sizeof(FVector4f));
+	}
+
+	FCompushadySignaled Signal;
+	Signal.BindUFunction(Rasterizer, TEXT("StoreLastSignal"));
+	Rasterizer->DrawBatch(Draws, { RTV }, nullptr, true, false, Signal, FCompushadyRasterizeConfig());
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitRasterizer(this, Rasterizer, [this, Rasterizer, RTV]()
+		{
+			TestTrue("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+			TArray<uint32> Output;
+			Output.AddZeroed(8 * 8);
+
+			RTV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+				{
+					CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R8G8B8A8, RowPitch, 8 * sizeof(uint32));
+				}, 0);
+
+			TestEqual(TEXT("Output[0]"), Output[0], 0xff0000ff);
+			TestEqual(TEXT("Output[7 * 8 + 3]"), Output[7 * 8 + 3], 0xff0000ff);
+			TestEqual(TEXT("Output[4]"), Output[4], 0xff00ff00);
+			TestEqual(TEXT("Output[7 * 8 + 7]"), Output[7 * 8 + 7], 0xff00ff00);
+		}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyRasterizerTest_DrawBatchIndexed, "Compushady.Rasterizer.DrawBatchIndexed", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyRasterizerTest_DrawBatchIndexed::RunTest(const FString& Parameters)
+{
+	FString ErrorMessages;
+	// two quads (left and right half of the render target), SV_VertexID includes the base vertex
+	const FString VSCode = "float4 main(uint vid : SV_VertexID) : SV_Position { const float2 Corners[8] = { float2(-1, -1), float2(-1, 1), float2(0, 1), float2(0, -1), float2(0, -1), float2(0, 1), float2(1, 1), float2(1, -1) }; return float4(Corners[vid], 0, 1); }";
+	const FString PSCode = "float4 main(float4 pos : SV_Position) : SV_Target0 { return float4(1, 0, 0, 1); }";
+	UCompushadyRasterizer* Rasterizer = UCompushadyFunctionLibrary::CreateCompushadyVSPSRasterizerFromHLSLString(VSCode, PSCode, FCompushadyRasterizerConfig(), ErrorMessages, "main", "main");
+	if (!TestNotNull(TEXT("Rasterizer"), Rasterizer))
+	{
+		return false;
+	}
+
+	UCompushadyRTV* RTV = UCompushadyFunctionLibrary::CreateCompushadyRTVTexture2D(TestName, 8, 8, EPixelFormat::PF_R8G8B8A8, FLinearColor::Black);
+
+	UCompushadyUAV* IndexBuffer = UCompushadyFunctionLibrary::CreateCompushadyUAVIndexBuffer(TestName, 6 * sizeof(uint16), EPixelFormat::PF_R16_UINT);
+	IndexBuffer->MapWriteAndExecuteSync([](void* Data)
+		{
+			const uint16 QuadIndices[] = { 0, 1, 2, 2, 3, 0 };
+			FMemory::Memcpy(Data, QuadIndices, sizeof(QuadIndices));
+		});
+
+	// the whole left quad, and only the second triangle (bottom right) of the right one
+	TArray<FCompushadyRasterizerDraw> Draws;
+	FCompushadyRasterizerDraw& LeftDraw = Draws.AddDefaulted_GetRef();
+	LeftDraw.IndexBuffer = IndexBuffer;
+	LeftDraw.NumIndices = 6;
+
+	FCompushadyRasterizerDraw& RightDraw = Draws.AddDefaulted_GetRef();
+	RightDraw.IndexBuffer = IndexBuffer;
+	RightDraw.NumIndices = 3;
+	RightDraw.FirstIndex = 3;
+	RightDraw.BaseVertex = 4;
+
+	FCompushadySignaled Signal;
+	Signal.BindUFunction(Rasterizer, TEXT("StoreLastSignal"));
+	Rasterizer->DrawBatch(Draws, { RTV }, nullptr, true, false, Signal);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitRasterizer(this, Rasterizer, [this, Rasterizer, RTV]()
+		{
+			TestTrue("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+			TArray<uint32> Output;
+			Output.AddZeroed(8 * 8);
+
+			RTV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+				{
+					CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R8G8B8A8, RowPitch, 8 * sizeof(uint32));
+				}, 0);
+
+			TestEqual(TEXT("Output[0]"), Output[0], 0xff0000ff);
+			TestEqual(TEXT("Output[7 * 8 + 3]"), Output[7 * 8 + 3], 0xff0000ff);
+			TestEqual(TEXT("Output[4]"), Output[4], 0xff000000);
+			TestEqual(TEXT("Output[7 * 8 + 7]"), Output[7 * 8 + 7], 0xff0000ff);
+		}));
+
+	return true;
+}
+
+// GRID_SIZE x GRID_SIZE meshlets covering the render target, each one is a TESS x TESS quads grid.
+// The amplification shader culls the meshlets outside of CullRect (in NDC) and launches a mesh shader group for each of the others.
+static const FString MeshletCullingASCode = "cbuffer Culling : register(b0) { float4 CullRect; }; struct Payload { uint MeshletIndices[32]; }; groupshared Payload payload; groupshared uint numMeshlets;"
+	"[numthreads(32, 1, 1)] void main(uint tid : SV_DispatchThreadID, uint gtid : SV_GroupThreadID) { if (gtid == 0) { numMeshlets = 0; } GroupMemoryBarrierWithGroupSync();"
+	"float2 meshletMin = float2(tid % GRID_SIZE, tid / GRID_SIZE) * (2.0 / GRID_SIZE) - 1; float2 meshletMax = meshletMin + 2.0 / GRID_SIZE;"
+	"if (tid < GRID_SIZE * GRID_SIZE && all(meshletMax > CullRect.xy) && all(meshletMin < CullRect.zw)) { uint slot; InterlockedAdd(numMeshlets, 1, slot); payload.MeshletIndices[slot] = tid; }"
+	"GroupMemoryBarrierWithGroupSync(); DispatchMesh(numMeshlets, 1, 1, payload); }";
+
+static const FString MeshletCullingMSCode = "struct Payload { uint MeshletIndices[32]; }; struct Vertex { float4 pos : SV_Position; };"
+	"[outputtopology(\"triangle\")] [numthreads(128, 1, 1)] void main(uint gid : SV_GroupID, uint gtid : SV_GroupThreadID, in payload Payload payload, out vertices Vertex verts[(TESS + 1) * (TESS + 1)], out indices uint3 tris[TESS * TESS * 2]) {"
+	"uint meshlet = payload.MeshletIndices[gid]; float2 meshletMin = float2(meshlet % GRID_SIZE, meshlet / GRID_SIZE) * (2.0 / GRID_SIZE) - 1; SetMeshOutputCounts((TESS + 1) * (TESS + 1), TESS * TESS * 2);"
+	"if (gtid < (TESS + 1) * (TESS + 1)) { verts[gtid].pos = float4(meshletMin + float2(gtid % (TESS + 1), gtid / (TESS + 1)) * (2.0 / GRID_SIZE / TESS), 0, 1); }"
+	"if (gtid < TESS * TESS * 2) { uint quad = gtid / 2; uint v = quad / TESS * (TESS + 1) + quad % TESS; tris[gtid] = gtid % 2 == 0 ? uint3(v, v + TESS + 1, v + TESS + 2) : uint3(v + TESS + 2, v + 1, v); } }";
+
+static const FString MeshletCullingPSCode = "float4 main(float4 pos : SV_Position) : SV_Target0 { return float4(1, 0, 0, 1); }";
+
+static UCompushadyRasterizer* CreateMeshletCullingRasterizer(const int32 GridSize, const int32 Tessellation, FString& ErrorMessages, const FCompushadyRasterizerConfig& RasterizerConfig = FCompushadyRasterizerConfig())
+{
+	const FString Defines = FString::Printf(TEXT("#define GRID_SIZE %d\n#define TESS %d\n"), GridSize, Tessellation);
+	return UCompushadyFunctionLibrary::CreateCompushadyASMSPSRasterizerFromHLSLString(Defines + MeshletCullingASCode, Defines + MeshletCullingMSCode, MeshletCullingPSCode, RasterizerConfig, ErrorMessages);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyRasterizerTest_AmplificationMeshletCulling, "Compushady.Rasterizer.AmplificationMeshletCulling", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyRasterizerTest_AmplificationMeshletCulling::RunTest(const FString& Parameters)
+{
+	if (!GRHISupportsMeshShadersTier0)
+	{
+		AddInfo(TEXT("Mesh Shaders are not supported by the RHI"));
+		return true;
+	}
+
+	FString ErrorMessages;
+	// a meshlet for each pixel
+	UCompushadyRasterizer* Rasterizer = CreateMeshletCullingRasterizer(8, 1, ErrorMessages);
+	if (!TestNotNull(TEXT("Rasterizer"), Rasterizer))
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	TestEqual(TEXT("Rasterizer->ASResourceBindings.NumCBVs"), Rasterizer->ASResourceBindings.NumCBVs, 1u);
+
+	// the mesh dispatches have no DSV
+	FCompushadyRasterizerConfig DepthRasterizerConfig;
+	DepthRasterizerConfig.bDepthTest = true;
+	TestNull(TEXT("Depth Rasterizer"), CreateMeshletCullingRasterizer(8, 1, ErrorMessages, DepthRasterizerConfig));
+
+	UCompushadyRTV* RTV = UCompushadyFunctionLibrary::CreateCompushadyRTVTexture2D(TestName, 8, 8, EPixelFormat::PF_R8G8B8A8, FLinearColor::Black);
+
+	// the left half survives the culling
+	UCompushadyCBV* CBV = UCompushadyFunctionLibrary::CreateCompushadyCBV(TestName, 16);
+	CBV->SetFloatArray(0, { -1, -1, 0, 1 });
+
+	FCompushadySignaled Signal;
+	Signal.BindUFunction(Rasterizer, TEXT("StoreLastSignal"));
+
+	// the amplification shader resources can only be bound by DispatchAmplification
+	Rasterizer->DispatchMesh({}, {}, { RTV }, FIntVector(2, 1, 1), Signal, FCompushadyRasterizeConfig());
+	TestFalse("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+	FCompushadyResourceArray ASResourceArray;
+	ASResourceArray.CBVs.Add(CBV);
+	Rasterizer->DispatchAmplification(ASResourceArray, {}, {}, { RTV }, FIntVector(2, 1, 1), Signal, FCompushadyRasterizeConfig());
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitRasterizer(this, Rasterizer, [this, Rasterizer, RTV]()
+		{
+			TestTrue("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+			TArray<uint32> Output;
+			Output.AddZeroed(8 * 8);
+
+			RTV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+				{
+					CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R8G8B8A8, RowPitch, 8 * sizeof(uint32));
+				}, 0);
+
+			TestEqual(TEXT("Output[0]"), Output[0], 0xff0000ff);
+			TestEqual(TEXT("Output[7 * 8 + 3]"), Output[7 * 8 + 3], 0xff0000ff);
+			TestEqual(TEXT("Output[4]"), Output[4], 0xff000000);
+			TestEqual(TEXT("Output[7 * 8 + 7]"), Output[7 * 8 + 7], 0xff000000);
+		}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyRasterizerTest_DispatchMeshIndirect, "Compushady.Rasterizer.DispatchMeshIndirect", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyRasterizerTest_DispatchMeshIndirect::RunTest(const FString& Parameters)
+{
+	if (!GRHISupportsMeshShadersTier0)
+	{
+		AddInfo(TEXT("Mesh Shaders are not supported by the RHI"));
+		return true;
+	}
+
+	FString ErrorMessages;
+	// each group emits a triangle on the bottom of its half of the render target
+	const FString MSCode = "struct Vertex { float4 pos : SV_Position; }; [outputtopology(\"triangle\")] [numthreads(1, 1, 1)] void main(uint gid : SV_GroupID, out vertices Vertex verts[3], out indices uint3 tris[1]) {"
+		"SetMeshOutputCounts(3, 1); float x = float(gid) - 1; verts[0].pos = float4(x, -1, 0, 1); verts[1].pos = float4(x, 1, 0, 1); verts[2].pos = float4(x + 1, -1, 0, 1); tris[0] = uint3(0, 1, 2); }";
+	const FString PSCode = "float4 main(float4 pos : SV_Position) : SV_Target0 { return float4(1, 0, 0, 1); }";
+	UCompushadyRasterizer* Rasterizer = UCompushadyFunctionLibrary::CreateCompushadyMSPSRasterizerFromHLSLString(MSCode, PSCode, FCompushadyRasterizerConfig(), ErrorMessages);
+	if (!TestNotNull(TEXT("Rasterizer"), Rasterizer))
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	const FString CSCode = "RWBuffer<uint> Arguments; [numthreads(1, 1, 1)] void main() { Arguments[0] = 2; Arguments[1] = 1; Arguments[2] = 1; }";
+	UCompushadyCompute* Compute = UCompushadyFunctionLibrary::CreateCompushadyComputeFromHLSLString(CSCode, ErrorMessages, "main");
+	if (!TestNotNull(TEXT("Compute"), Compute))
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	UCompushadyUAV* ArgumentsBuffer = UCompushadyFunctionLibrary::CreateCompushadyUAVIndirectArgumentsBuffer(TestName, 3 * sizeof(uint32));
+	UCompushadyRTV* RTV = UCompushadyFunctionLibrary::CreateCompushadyRTVTexture2D(TestName, 8, 8, EPixelFormat::PF_R8G8B8A8, FLinearColor::Black);
+
+	Compute->DispatchByMap({ {"Arguments", ArgumentsBuffer} }, FIntVector(1, 1, 1), FCompushadySignaled(), {});
+
+	FCompushadySignaled Signal;
+	Signal.BindUFunction(Rasterizer, TEXT("StoreLastSignal"));
+	Rasterizer->DispatchMeshIndirect({}, {}, { RTV }, ArgumentsBuffer, 0, Signal, FCompushadyRasterizeConfig());
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitRasterizer(this, Rasterizer, [this, Rasterizer, RTV]()
+		{
+			TestTrue("Rasterizer->bLastSuccess", Rasterizer->bLastSuccess);
+
+			TArray<uint32> Output;
+			Output.AddZeroed(8 * 8);
+
+			RTV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+				{
+					CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R8G8B8A8, RowPitch, 8 * sizeof(uint32));
+				}, 0);
+
+			TestEqual(TEXT("Output[7 * 8]"), Output[7 * 8], 0xff0000ff);
+			TestEqual(TEXT("Output[7 * 8 + 4]"), Output[7 * 8 + 4], 0xff0000ff);
+			TestEqual(TEXT("Output[0]"), Output[0], 0xff000000);
+			TestEqual(TEXT("Output[7]"), Output[7], 0xff000000);
+		}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyRasterizerTest_AmplificationMeshletCullingBenchmark, "Compushady.Rasterizer.AmplificationMeshletCullingBenchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FCompushadyRasterizerTest_AmplificationMeshletCullingBenchmark::RunTest(const FString& Parameters)
+{
+	if (!GRHISupportsMeshShadersTier0)
+	{
+		AddInfo(TEXT("Mesh Shaders are not supported by the RHI"));
+		return true;
+	}
+
+	constexpr int32 Iterations = 16;
+	// 16384 meshlets of 98 triangles
+	constexpr int32 GridSize = 128;
+
+	FString ErrorMessages;
+	UCompushadyRasterizer* Rasterizer = CreateMeshletCullingRasterizer(GridSize, 7, ErrorMessages);
+	if (!Rasterizer)
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	UCompushadyRTV* RTV = UCompushadyFunctionLibrary::CreateCompushadyRTVTexture2D(TestName, 1024, 1024, EPixelFormat::PF_R8G8B8A8, FLinearColor::Black);
+	UCompushadyCBV* CBV = UCompushadyFunctionLibrary::CreateCompushadyCBV(TestName, 16);
+
+	FCompushadyResourceArray ASResourceArray;
+	ASResourceArray.CBVs.Add(CBV);
+
+	FCompushadySignaled Signal;
+	Signal.BindUFunction(Rasterizer, TEXT("StoreLastSignal"));
+
+	// includes the submission and the GPU wait, so the numbers are only meaningful for comparison
+	auto Benchmark = [&](const TCHAR* Name, const TArray<float>& CullRect)
+		{
+			CBV->SetFloatArray(0, CullRect);
+
+			double ElapsedTime = 0;
+			// the first dispatch warms up the pipeline state
+			for (int32 Iteration = 0; Iteration <= Iterations; Iteration++)
+			{
+				const double StartTime = FPlatformTime::Seconds();
+				Rasterizer->DispatchAmplification(ASResourceArray, {}, {}, { RTV }, FIntVector(GridSize * GridSize / 32, 1, 1), Signal, FCompushadyRasterizeConfig());
+				// waits for the GPU and for the signal
+				FlushRenderingCommands();
+				FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+				if (Iteration > 0)
+				{
+					ElapsedTime += FPlatformTime::Seconds() - StartTime;
+				}
+			}
+
+			TestTrue(Name, Rasterizer->bLastSuccess);
+			AddInfo(FString::Printf(TEXT("%s: %.3f ms"), Name, ElapsedTime * 1000.0 / Iterations));
+		};
+
+	Benchmark(TEXT("16384 meshlets Unculled"), { -1, -1, 1, 1 });
+	Benchmark(TEXT("16384 meshlets Culled to a quarter"), { -1, -1, 0, 0 });
+	Benchmark(TEXT("16384 meshlets Culled to a sixteenth"), { -1, -1, -0.5f, -0.5f });
+
+	return true;
+}
+
 #endif
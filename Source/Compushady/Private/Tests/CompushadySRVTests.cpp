@@ -0,0 +1,344 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#if WITH_DEV_AUTOMATION_TESTS
+#include "CompushadyFunctionLibrary.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "TextureResource.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadySRVTest_Texture2DArrayFromImageDirectory, "Compushady.SRV.Texture2DArrayFromImageDirectory", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadySRVTest_Texture2DArrayFromImageDirectory::RunTest(const FString& Parameters)
+{
+	const FString Directory = FPaths::Combine(FPaths::ProjectIntermediateDir(), TEXT("CompushadyImageDirectory"));
+
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+
+	// 16 bit pngs must preserve their format
+	for (int32 Slice = 0; Slice < 4; Slice++)
+	{
+		TArray<uint16> Pixels;
+		for (int32 Index = 0; Index < 8 * 8 * 4; Index++)
+		{
+			Pixels.Add(Slice * 1000 + Index);
+		}
+
+		TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+		ImageWrapper->SetRaw(Pixels.GetData(), Pixels.Num() * sizeof(uint16), 8, 8, ERGBFormat::RGBA, 16);
+		FFileHelper::SaveArrayToFile(ImageWrapper->GetCompressed(), *FPaths::Combine(Directory, FString::Printf(TEXT("Slice%d.png"), Slice)));
+	}
+
+	FString ErrorMessages;
+	UCompushadySRV* SRV = UCompushadyFunctionLibrary::CreateCompushadySRVTexture2DArrayFromImageDirectory(TestName, Directory, TEXT("png"), ErrorMessages);
+
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+	if (!TestNotNull(TEXT("SRV"), SRV))
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	TestEqual(TEXT("GetTextureNumSlices()"), SRV->GetTextureNumSlices(), 4);
+	TestTrue(TEXT("GetTexturePixelFormat()"), SRV->GetTexturePixelFormat() == EPixelFormat::PF_R16G16B16A16_UNORM);
+
+	TArray<uint16> Output;
+	Output.AddZeroed(8 * 8 * 4);
+
+	const bool bSuccess = SRV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+		{
+			CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R16G16B16A16_UNORM, RowPitch, 8 * 4 * sizeof(uint16));
+		}, 3);
+
+	TestTrue(TEXT("bSuccess"), bSuccess);
+
+	TestEqual(TEXT("Output[0]"), Output[0], 3000);
+	TestEqual(TEXT("Output[255]"), Output[255], 3255);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadySRVTest_Texture2DFromImageFileMips, "Compushady.SRV.Texture2DFromImageFileMips", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadySRVTest_Texture2DFromImageFileMips::RunTest(const FString& Parameters)
+{
+	const FString Filename = FPaths::CreateTempFilename(*FPaths::ProjectIntermediateDir(), TEXT("Compushady"), TEXT(".png"));
+
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+
+	// left half black, right half 200
+	TArray<uint8> Pixels;
+	for (int32 Index = 0; Index < 4 * 4; Index++)
+	{
+		const uint8 Value = Index % 4 < 2 ? 0 : 200;
+		Pixels.Append({ Value, Value, Value, Value });
+	}
+
+	TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+	ImageWrapper->SetRaw(Pixels.GetData(), Pixels.Num(), 4, 4, ERGBFormat::RGBA, 8);
+	FFileHelper::SaveArrayToFile(ImageWrapper->GetCompressed(), *Filename);
+
+	UCompushadySRV* SRV = UCompushadyFunctionLibrary::CreateCompushadySRVTexture2DFromImageFile(TestName, Filename, 0);
+
+	IFileManager::Get().Delete(*Filename);
+
+	if (!TestNotNull(TEXT("SRV"), SRV))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("NumMips"), static_cast<int32>(SRV->GetTextureRHI()->GetNumMips()), 3);
+
+	TArray<uint8> Bytes;
+	TArray<FCompushadyTextureReadbackRegion> Regions;
+	TestTrue(TEXT("ReadbackTextureSlicesSync"), SRV->ReadbackTextureSlicesSync(0, 1, 1, 2, Bytes, Regions));
+
+	if (!TestEqual(TEXT("Regions.Num()"), Regions.Num(), 2))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Mip1[0]"), Bytes[Regions[0].Offset], 0);
+	TestEqual(TEXT("Mip1[1]"), Bytes[Regions[0].Offset + 4], 200);
+	TestEqual(TEXT("Mip2[0]"), Bytes[Regions[1].Offset], 100);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadySRVTest_BufferFromOwnedData, "Compushady.SRV.BufferFromOwnedData", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadySRVTest_BufferFromOwnedData::RunTest(const FString& Parameters)
+{
+	// the moved array goes through the float to half conversion
+	TArray<float> Floats = { 1, 2, 3, 4 };
+	UCompushadySRV* HalfSRV = UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromFloatArray(TestName, MoveTemp(Floats), EPixelFormat::PF_R16F);
+
+	TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Bytes = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(TArray<uint8>({ 1, 2, 3, 4, 5, 6, 7, 8 }));
+	UCompushadySRV* StructuredSRV = UCompushadyFunctionLibrary::CreateCompushadySRVStructuredBufferFromByteArray(TestName, Bytes, 4);
+	// the upload keeps its own reference
+	Bytes.Reset();
+
+	if (!TestNotNull(TEXT("HalfSRV"), HalfSRV) || !TestNotNull(TEXT("StructuredSRV"), StructuredSRV))
+	{
+		return false;
+	}
+
+	TArray<FFloat16> Halfs;
+	Halfs.AddZeroed(4);
+	TestTrue(TEXT("HalfSRV->MapReadAndExecuteSync"), HalfSRV->MapReadAndExecuteSync([&Halfs](const void* Data)
+		{
+			FMemory::Memcpy(Halfs.GetData(), Data, Halfs.Num() * sizeof(FFloat16));
+		}));
+
+	TestEqual(TEXT("Halfs[0]"), Halfs[0].GetFloat(), 1.0f);
+	TestEqual(TEXT("Halfs[3]"), Halfs[3].GetFloat(), 4.0f);
+
+	TArray<uint8> Output;
+	Output.AddZeroed(8);
+	TestTrue(TEXT("StructuredSRV->MapReadAndExecuteSync"), StructuredSRV->MapReadAndExecuteSync([&Output](const void* Data)
+		{
+			FMemory::Memcpy(Output.GetData(), Data, Output.Num());
+		}));
+
+	TestEqual(TEXT("GetBufferSize()"), StructuredSRV->GetBufferSize(), 8LL);
+	TestEqual(TEXT("Output[0]"), Output[0], 1);
+	TestEqual(TEXT("Output[7]"), Output[7], 8);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadySRVTest_BufferFromFileRange, "Compushady.SRV.BufferFromFileRange", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadySRVTest_BufferFromFileRange::RunTest(const FString& Parameters)
+{
+	const FString Filename = FPaths::CreateTempFilename(*FPaths::ProjectIntermediateDir(), TEXT("Compushady"), TEXT(".bin"));
+
+	TArray<uint32> Values;
+	for (int32 Index = 0; Index < 1024; Index++)
+	{
+		Values.Add(Index);
+	}
+	FFileHelper::SaveArrayToFile(TArrayView<const uint8>(reinterpret_cast<const uint8*>(Values.GetData()), Values.Num() * sizeof(uint32)), *Filename);
+
+	// skip the first 16 values
+	UCompushadySRV* SRV = UCompushadyFunctionLibrary::CreateCompushadySRVBufferFromFile(TestName, Filename, EPixelFormat::PF_R32_UINT, 16 * sizeof(uint32), 32 * sizeof(uint32));
+
+	IFileManager::Get().Delete(*Filename);
+
+	if (!TestNotNull(TEXT("SRV"), SRV))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("GetBufferSize()"), SRV->GetBufferSize(), static_cast<int64>(32 * sizeof(uint32)));
+
+	TArray<uint32> Output;
+	Output.AddZeroed(32);
+
+	SRV->MapReadAndExecuteSync([&Output](const void* Data)
+		{
+			FMemory::Memcpy(Output.GetData(), Data, Output.Num() * sizeof(uint32));
+		});
+
+	TestEqual(TEXT("Output[0]"), Output[0], 16);
+	TestEqual(TEXT("Output[31]"), Output[31], 47);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadySRVTest_CurveAtlas, "Compushady.SRV.CurveAtlas", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadySRVTest_CurveAtlas::RunTest(const FString& Parameters)
+{
+	UCurveFloat* CurveFloat = NewObject<UCurveFloat>();
+	CurveFloat->FloatCurve.AddKey(0, 0);
+	CurveFloat->FloatCurve.AddKey(1, 1);
+	CurveFloat->FloatCurve.Keys[0].InterpMode = ERichCurveInterpMode::RCIM_Linear;
+
+	UCurveFloat* CurveFloatConstant = NewObject<UCurveFloat>();
+	CurveFloatConstant->FloatCurve.AddKey(0, 5);
+
+	FString ErrorMessages;
+	UCompushadyCurveAtlas* CurveAtlas = UCompushadyFunctionLibrary::CreateCompushadyCurveAtlas(TestName, { CurveFloat, CurveFloatConstant }, 4, ErrorMessages);
+	if (!TestNotNull(TEXT("CurveAtlas"), CurveAtlas))
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	TestEqual(TEXT("GetCurveRow()"), CurveAtlas->GetCurveRow(CurveFloatConstant), 1);
+	TestEqual(TEXT("GetTextureSize()"), CurveAtlas->GetTextureSize(), FIntVector(4, 2, 1));
+	TestEqual(TEXT("Texels[0]"), CurveAtlas->GetTexels()[0].R, 0.125f);
+	TestEqual(TEXT("Texels[7]"), CurveAtlas->GetTexels()[7].R, 5.0f);
+
+	TestEqual(TEXT("Rebake()"), CurveAtlas->Rebake(), 0);
+
+	CurveFloatConstant->FloatCurve.Keys[0].Value = 6;
+	TestEqual(TEXT("Rebake()"), CurveAtlas->Rebake(), 1);
+	TestEqual(TEXT("Texels[7]"), CurveAtlas->GetTexels()[7].R, 6.0f);
+
+	TArray<FLinearColor> Output;
+	Output.AddZeroed(4 * 2);
+
+	const bool bSuccess = CurveAtlas->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+		{
+			CopyTextureData2D(Data, Output.GetData(), 2, EPixelFormat::PF_A32B32G32R32F, RowPitch, 4 * sizeof(FLinearColor));
+		}, 0);
+
+	TestTrue(TEXT("bSuccess"), bSuccess);
+	TestEqual(TEXT("Output[3]"), Output[3].R, 0.875f);
+	TestEqual(TEXT("Output[4]"), Output[4].R, 6.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadySRVTest_StaticMesh, "Compushady.SRV.StaticMesh", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadySRVTest_StaticMesh::RunTest(const FString& Parameters)
+{
+	UStaticMesh* StaticMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!TestNotNull(TEXT("StaticMesh"), StaticMesh))
+	{
+		return false;
+	}
+
+	FCompushadyStaticMeshStreamInfo StreamInfo;
+	FString ErrorMessages;
+
+	UCompushadySRV* Positions = UCompushadyFunctionLibrary::CreateCompushadySRVFromStaticMesh(StaticMesh, 0, ECompushadyStaticMeshStream::Positions, StreamInfo, ErrorMessages);
+	if (!TestNotNull(TEXT("Positions"), Positions))
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	TestEqual(TEXT("NumVertices"), StreamInfo.NumVertices, StaticMesh->GetNumVertices(0));
+	TestEqual(TEXT("Stride"), StreamInfo.Stride, 12);
+	TestEqual(TEXT("GetBufferSize()"), Positions->GetBufferSize(), static_cast<int64>(StreamInfo.NumVertices * StreamInfo.Stride));
+
+	UCompushadySRV* Indices = UCompushadyFunctionLibrary::CreateCompushadySRVFromStaticMesh(StaticMesh, 0, ECompushadyStaticMeshStream::Indices, StreamInfo, ErrorMessages);
+	if (!TestNotNull(TEXT("Indices"), Indices))
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	TestEqual(TEXT("NumIndices % 3"), StreamInfo.NumVertices % 3, 0);
+	TestEqual(TEXT("GetBufferSize()"), Indices->GetBufferSize(), static_cast<int64>(StreamInfo.NumVertices * StreamInfo.Stride));
+
+	TestNull(TEXT("Invalid LOD"), UCompushadyFunctionLibrary::CreateCompushadySRVFromStaticMesh(StaticMesh, 100, ECompushadyStaticMeshStream::Positions, StreamInfo, ErrorMessages));
+
+	// read the first indexed vertex through the views (the cube vertices are at +/- 50)
+	const FString Code = "Buffer<float> Positions; Buffer<uint> Indices; RWBuffer<float> Output; [numthreads(1,1,1)] void main() { uint Index = Indices[0]; Output[0] = Positions[Index * 3]; Output[1] = Positions[Index * 3 + 1]; Output[2] = Positions[Index * 3 + 2]; Output[3] = Index; }";
+	UCompushadyCompute* Compute = UCompushadyFunctionLibrary::CreateCompushadyComputeFromHLSLString(Code, ErrorMessages, "main");
+	if (!TestNotNull(TEXT("Compute"), Compute))
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVBuffer(TestName, 4 * sizeof(float), EPixelFormat::PF_R32_FLOAT);
+
+	Compute->DispatchByMap({ {"Positions", Positions}, {"Indices", Indices}, {"Output", UAV} }, FIntVector(1, 1, 1), FCompushadySignaled(), {});
+
+	// the readback is enqueued after the dispatch
+	TArray<float> Output;
+	Output.AddZeroed(4);
+
+	UAV->MapReadAndExecuteSync([&Output](const void* Data)
+		{
+			FMemory::Memcpy(Output.GetData(), Data, Output.Num() * sizeof(float));
+		});
+
+	TestEqual(TEXT("Output[0]"), FMath::Abs(Output[0]), 50.0f);
+	TestEqual(TEXT("Output[1]"), FMath::Abs(Output[1]), 50.0f);
+	TestEqual(TEXT("Output[2]"), FMath::Abs(Output[2]), 50.0f);
+	TestTrue(TEXT("Output[3]"), Output[3] < StaticMesh->GetNumVertices(0));
+
+	return true;
+}
+
+// a texture resource never initialized, its RHI texture is always null
+class FCompushadyTestUninitializedTextureResource : public FTextureResource
+{
+public:
+	uint32 GetSizeX() const override
+	{
+		return 1;
+	}
+
+	uint32 GetSizeY() const override
+	{
+		return 1;
+	}
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadySRVTest_FailedCreation, "Compushady.SRV.FailedCreation", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadySRVTest_FailedCreation::RunTest(const FString& Parameters)
+{
+	FCompushadyTestUninitializedTextureResource TextureResource;
+
+	AddExpectedError(TEXT("Texture Resource not available"));
+
+	UCompushadySRV* SRV = NewObject<UCompushadySRV>();
+	TestTrue(TEXT("InitializeFromTextureResource()"), SRV->InitializeFromTextureResource(&TextureResource));
+
+	// the failure is reported only after the creation in the render thread
+	TestTrue(TEXT("IsCreationFailed()"), SRV->IsCreationFailed());
+	TestFalse(TEXT("IsValidTexture()"), SRV->IsValidTexture());
+
+	FCompushadyResourceArray ResourceArray;
+	ResourceArray.SRVs.Add(SRV);
+	FCompushadyResourceBindings ResourceBindings;
+	ResourceBindings.SRVs.AddDefaulted();
+
+	FString ErrorMessages;
+	TestFalse(TEXT("ValidateResourceBindings()"), Compushady::Utils::ValidateResourceBindings(ResourceArray, ResourceBindings, ErrorMessages));
+	TestEqual(TEXT("ErrorMessages"), ErrorMessages, TEXT("SRV 0 creation failed"));
+
+	return true;
+}
+
+#endif
@@ -3,7 +3,30 @@
 #if WITH_DEV_AUTOMATION_TESTS
 #include "CompushadyFunctionLibrary.h"
 #include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
 
+class FCompushadyWaitResource : public IAutomationLatentCommand
+{
+public:
+	FCompushadyWaitResource(UCompushadyResource* InResource, TFunction<void()> InTestsFunction) : Resource(InResource), TestsFunction(InTestsFunction)
+	{
+
+	}
+
+	bool Update() override
+	{
+		if (!Resource->IsRunning())
+		{
+			TestsFunction();
+		}
+		return !Resource->IsRunning();
+	}
+
+private:
+	TStrongObjectPtr<UCompushadyResource> Resource;
+	TFunction<void()> TestsFunction;
+};
 
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_Buffer, "Compushady.UAV.Buffer", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
 
@@ -81,6 +104,218 @@ bool FCompushadyUAVTest_StructuredBuffer::RunTest(const FString& Parameters)
 	return true;
 }
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_PendingBuffer, "Compushady.UAV.PendingBuffer", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyUAVTest_PendingBuffer::RunTest(const FString& Parameters)
+{
+	// no render thread sync is required for creating them
+	TArray<UCompushadyUAV*> UAVs;
+	for (int32 Index = 0; Index < 200; Index++)
+	{
+		UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVStructuredBuffer(FString::Printf(TEXT("%s%d"), *TestName, Index), 32, 4);
+		if (!TestNotNull(TEXT("UAV"), UAV))
+		{
+			return false;
+		}
+		UAVs.Add(UAV);
+	}
+
+	// accessing the RHI resources from the game thread waits for their creation
+	TestEqual(TEXT("GetBufferSize()"), UAVs.Last()->GetBufferSize(), 32);
+	TestFalse(TEXT("IsPending()"), UAVs.Last()->IsPending());
+	TestFalse(TEXT("IsCreationFailed()"), UAVs.Last()->IsCreationFailed());
+
+	UAVs[0]->MapWriteAndExecuteSync([](void* Data)
+		{
+			reinterpret_cast<uint32*>(Data)[7] = 17;
+		});
+
+	uint32 Output = 0;
+	UAVs[0]->MapReadAndExecuteSync([&Output](const void* Data)
+		{
+			Output = reinterpret_cast<const uint32*>(Data)[7];
+		});
+
+	TestEqual(TEXT("Output"), Output, 17);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_Pool, "Compushady.UAV.Pool", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyUAVTest_Pool::RunTest(const FString& Parameters)
+{
+	UCompushadyUAVPool* Pool = UCompushadyFunctionLibrary::CreateCompushadyUAVPool(0);
+
+	UCompushadyUAV* UAV0 = Pool->AcquireUAVTexture2D(TestName, 64, 64, EPixelFormat::PF_R32_FLOAT);
+	UCompushadyUAV* UAV1 = Pool->AcquireUAVTexture2D(TestName, 64, 64, EPixelFormat::PF_R32_FLOAT);
+	UCompushadyUAV* UAV2 = Pool->AcquireUAVBuffer(TestName, 1024, EPixelFormat::PF_R32_UINT);
+
+	TestNotNull(TEXT("UAV0"), UAV0);
+	TestTrue(TEXT("UAV0 != UAV1"), UAV0 != UAV1);
+	TestEqual(TEXT("GetPooledBytes()"), Pool->GetPooledBytes(), static_cast<int64>(64 * 64 * 4 * 2 + 1024));
+
+	TestTrue(TEXT("Release(UAV0)"), Pool->Release(UAV0));
+	TestFalse(TEXT("Release(UAV0) again"), Pool->Release(UAV0));
+
+	// a different descriptor must not match
+	UCompushadyUAV* UAV3 = Pool->AcquireUAVTexture2D(TestName, 32, 64, EPixelFormat::PF_R32_FLOAT);
+	TestTrue(TEXT("UAV3 != UAV0"), UAV3 != UAV0);
+
+	// no frame has passed, so the released UAV is still in the pool
+	UCompushadyUAV* UAV4 = Pool->AcquireUAVTexture2D(TestName, 64, 64, EPixelFormat::PF_R32_FLOAT);
+	TestTrue(TEXT("UAV4 == UAV0"), UAV4 == UAV0);
+
+	TestEqual(TEXT("GetNumHits()"), Pool->GetNumHits(), 1);
+	TestEqual(TEXT("GetNumMisses()"), Pool->GetNumMisses(), 4);
+	TestEqual(TEXT("GetHitRate()"), Pool->GetHitRate(), 0.2f);
+
+	Pool->Release(UAV1);
+	Pool->Release(UAV2);
+	TestEqual(TEXT("GetNumFreeUAVs()"), Pool->GetNumFreeUAVs(), 2);
+
+	Pool->Trim();
+	TestEqual(TEXT("GetNumFreeUAVs()"), Pool->GetNumFreeUAVs(), 0);
+	TestEqual(TEXT("GetNumPooledUAVs()"), Pool->GetNumPooledUAVs(), 2);
+	TestEqual(TEXT("GetPooledBytes()"), Pool->GetPooledBytes(), static_cast<int64>(64 * 64 * 4 + 32 * 64 * 4));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_BufferArena, "Compushady.UAV.BufferArena", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyUAVTest_BufferArena::RunTest(const FString& Parameters)
+{
+	FString ErrorMessages;
+	UCompushadyBufferArena* Arena = UCompushadyFunctionLibrary::CreateCompushadyBufferArena(TestName, 64 * sizeof(uint32), sizeof(uint32), ErrorMessages);
+	if (!Arena)
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	UCompushadyUAV* UAV0 = Arena->AllocateUAV(16);
+	UCompushadySRV* SRV1 = Arena->AllocateSRV(16);
+	UCompushadyUAV* UAV2 = Arena->AllocateUAV(16);
+
+	TestNotNull(TEXT("UAV0"), UAV0);
+	TestEqual(TEXT("GetOffset(SRV1)"), Arena->GetOffset(SRV1), static_cast<int64>(16 * sizeof(uint32)));
+	TestNull(TEXT("AllocateUAV(32)"), Arena->AllocateUAV(32));
+
+	TestTrue(TEXT("Free(UAV0)"), Arena->Free(UAV0));
+	TestFalse(TEXT("Free(UAV0) again"), Arena->Free(UAV0));
+	TestEqual(TEXT("GetUsedBytes()"), Arena->GetUsedBytes(), static_cast<int64>(32 * sizeof(uint32)));
+	TestEqual(TEXT("GetFragmentation()"), Arena->GetFragmentation(), 0.5f);
+
+	// first fit, in the hole left by UAV0
+	UCompushadyUAV* UAV3 = Arena->AllocateUAV(8);
+	TestEqual(TEXT("GetOffset(UAV3)"), Arena->GetOffset(UAV3), static_cast<int64>(0));
+	TestTrue(TEXT("Free(UAV3)"), Arena->Free(UAV3));
+
+	TArray<uint32> Input;
+	for (uint32 Index = 0; Index < 64; Index++)
+	{
+		Input.Add(Index);
+	}
+
+	Arena->GetBackingUAV()->MapWriteAndExecuteSync([&Input](void* Data)
+		{
+			FMemory::Memcpy(Data, Input.GetData(), Input.Num() * sizeof(uint32));
+		});
+
+	TestTrue(TEXT("Compact"), Arena->Compact(128 * sizeof(uint32)));
+	TestEqual(TEXT("GetSize()"), Arena->GetSize(), static_cast<int64>(128 * sizeof(uint32)));
+	TestEqual(TEXT("GetOffset(SRV1)"), Arena->GetOffset(SRV1), static_cast<int64>(0));
+	TestEqual(TEXT("GetOffset(UAV2)"), Arena->GetOffset(UAV2), static_cast<int64>(16 * sizeof(uint32)));
+	TestEqual(TEXT("GetFragmentation()"), Arena->GetFragmentation(), 0.0f);
+
+	TArray<uint32> Output;
+	Output.AddZeroed(32);
+
+	Arena->GetBackingUAV()->MapReadAndExecuteSync([&Output](const void* Data)
+		{
+			FMemory::Memcpy(Output.GetData(), Data, Output.Num() * sizeof(uint32));
+		});
+
+	TestEqual(TEXT("Output[0]"), Output[0], 16U);
+	TestEqual(TEXT("Output[31]"), Output[31], 47U);
+
+	// the map functions of a view only access its range
+	TestEqual(TEXT("GetBufferSize(UAV2)"), UAV2->GetBufferSize(), static_cast<int64>(16 * sizeof(uint32)));
+
+	UAV2->MapWriteAndExecuteSync([](void* Data)
+		{
+			for (uint32 Index = 0; Index < 16; Index++)
+			{
+				reinterpret_cast<uint32*>(Data)[Index] = 1000 + Index;
+			}
+		});
+
+	TArray<uint32> RangeOutput;
+	RangeOutput.AddZeroed(16);
+
+	UAV2->MapReadAndExecuteSync([&RangeOutput](const void* Data)
+		{
+			FMemory::Memcpy(RangeOutput.GetData(), Data, RangeOutput.Num() * sizeof(uint32));
+		});
+
+	TestEqual(TEXT("RangeOutput[0]"), RangeOutput[0], 1000U);
+	TestEqual(TEXT("RangeOutput[15]"), RangeOutput[15], 1015U);
+
+	Arena->GetBackingUAV()->MapReadAndExecuteSync([&Output](const void* Data)
+		{
+			FMemory::Memcpy(Output.GetData(), Data, Output.Num() * sizeof(uint32));
+		});
+
+	TestEqual(TEXT("Output[15]"), Output[15], 31U);
+	TestEqual(TEXT("Output[16]"), Output[16], 1000U);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_StructuredBufferFromTransforms, "Compushady.UAV.StructuredBufferFromTransforms", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyUAVTest_StructuredBufferFromTransforms::RunTest(const FString& Parameters)
+{
+	// more than a single ParallelFor task
+	TArray<FTransform> Transforms;
+	for (int32 Index = 0; Index < 3000; Index++)
+	{
+		Transforms.Add(FTransform(FRotator(Index, 0, 0), FVector(Index, Index * 2, Index * 3), FVector(2)));
+	}
+
+	UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVStructuredBuffer(TestName, Transforms.Num() * 48, 48);
+
+	// the Matrix4x4 layout does not fit, so nothing is enqueued
+	FCompushadySignaled OnSignaled;
+	UAV->UpdateStructuredBufferFromTransforms(Transforms, ECompushadyTransformLayout::Matrix4x4, OnSignaled);
+	TestFalse(TEXT("IsRunning()"), UAV->IsRunning());
+
+	UAV->UpdateStructuredBufferFromTransforms(Transforms, ECompushadyTransformLayout::Matrix3x4, OnSignaled);
+
+	// the source transforms can go away, the converted floats are owned by the upload
+	const FMatrix44f Matrix = FMatrix44f(Transforms[2999].ToMatrixWithScale()).GetTransposed();
+	Transforms.Empty();
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitResource(UAV, [this, UAV, Matrix]()
+		{
+			TArray<float> Output;
+			Output.AddUninitialized(3000 * 12);
+
+			UAV->MapReadAndExecuteSync([&Output](const void* Data)
+				{
+					FMemory::Memcpy(Output.GetData(), Data, Output.Num() * sizeof(float));
+				});
+
+			TestEqual(TEXT("Output[2999 * 12]"), Output[2999 * 12], Matrix.M[0][0]);
+			TestEqual(TEXT("Output[2999 * 12 + 3]"), Output[2999 * 12 + 3], 2999.0f);
+			TestEqual(TEXT("Output[2999 * 12 + 7]"), Output[2999 * 12 + 7], 2999.0f * 2);
+			TestEqual(TEXT("Output[2999 * 12 + 11]"), Output[2999 * 12 + 11], 2999.0f * 3);
+		}));
+
+	return true;
+}
+
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_MapTextureRead, "Compushady.UAV.MapTextureRead", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
 
 bool FCompushadyUAVTest_MapTextureRead::RunTest(const FString& Parameters)
@@ -261,4 +496,368 @@ bool FCompushadyUAVTest_Texture3DSlice0::RunTest(const FString& Parameters)
 	return true;
 }
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_Texture2DArraySlices, "Compushady.UAV.Texture2DArraySlices", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyUAVTest_Texture2DArraySlices::RunTest(const FString& Parameters)
+{
+	UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVTexture2DArray(TestName, 8, 8, 64, EPixelFormat::PF_R32_UINT);
+
+	TArray<uint32> Slices;
+	for (int32 Index = 0; Index < 8 * 8 * 64; Index++)
+	{
+		Slices.Add(Index);
+	}
+
+	const int32 SliceSize = 8 * 8 * sizeof(uint32);
+
+	for (int32 Slice = 0; Slice < 64; Slice++)
+	{
+		UAV->UpdateTextureSliceSync(reinterpret_cast<uint8*>(Slices.GetData()) + (Slice * SliceSize), SliceSize, Slice);
+	}
+
+	TArray<uint32> Output;
+	Output.AddZeroed(8 * 8 * 64);
+
+	const bool bSuccess = UAV->MapTextureSlicesAndExecuteSync([&Output, SliceSize](const uint8* Data, const TArray<FCompushadyTextureReadbackRegion>& Regions)
+		{
+			for (const FCompushadyTextureReadbackRegion& Region : Regions)
+			{
+				CopyTextureData2D(Data + Region.Offset, reinterpret_cast<uint8*>(Output.GetData()) + Region.Slice * SliceSize, 8, EPixelFormat::PF_R32_UINT, Region.RowPitch, 8 * sizeof(uint32));
+			}
+		}, 0, 64);
+
+	TestTrue(TEXT("bSuccess"), bSuccess);
+
+	TestEqual(TEXT("Output[0]"), Output[0], 0);
+	TestEqual(TEXT("Output[64]"), Output[64], 64);
+	TestEqual(TEXT("Output[2047]"), Output[2047], 2047);
+	TestEqual(TEXT("Output[4095]"), Output[4095], 4095);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_Texture3DSlices, "Compushady.UAV.Texture3DSlices", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyUAVTest_Texture3DSlices::RunTest(const FString& Parameters)
+{
+	UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVTexture3D(TestName, 8, 8, 4, EPixelFormat::PF_R32G32_UINT);
+
+	TArray<uint64> Slices;
+	for (int32 Index = 0; Index < 8 * 8 * 4; Index++)
+	{
+		uint64 Value0 = Index;
+		uint64 Value1 = Index * 2;
+		Slices.Add(Value0 | Value1 << 32);
+	}
+
+	const int32 SliceSize = 8 * 8 * sizeof(uint64);
+
+	for (int32 Slice = 0; Slice < 4; Slice++)
+	{
+		UAV->UpdateTextureSliceSync(reinterpret_cast<uint8*>(Slices.GetData()) + (Slice * SliceSize), SliceSize, Slice);
+	}
+
+	TArray<uint8> Bytes;
+	TArray<FCompushadyTextureReadbackRegion> Regions;
+	const bool bSuccess = UAV->ReadbackTextureSlicesSync(1, 3, 0, 1, Bytes, Regions);
+
+	TestTrue(TEXT("bSuccess"), bSuccess);
+	TestEqual(TEXT("Regions.Num()"), Regions.Num(), 3);
+	TestEqual(TEXT("Regions[0].Slice"), Regions[0].Slice, 1);
+	TestTrue(TEXT("Regions[2].Size"), Regions[2].Size == FIntPoint(8, 8));
+
+	TArray<uint64> Output;
+	Output.AddZeroed(8 * 8);
+	CopyTextureData2D(Bytes.GetData() + Regions[2].Offset, Output.GetData(), 8, EPixelFormat::PF_R32G32_UINT, Regions[2].RowPitch, 8 * sizeof(uint64));
+
+	TestEqual(TEXT("Output[0]"), Output[0], 192ULL | (384ULL << 32));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_Texture3DUpdateAsync, "Compushady.UAV.Texture3DUpdateAsync", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyUAVTest_Texture3DUpdateAsync::RunTest(const FString& Parameters)
+{
+	UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVTexture3D(TestName, 8, 8, 4, EPixelFormat::PF_R32_UINT);
+
+	TArray64<uint8> Slices;
+	Slices.AddUninitialized(8 * 8 * 4 * sizeof(uint32));
+	for (int32 Index = 0; Index < 8 * 8 * 4; Index++)
+	{
+		reinterpret_cast<uint32*>(Slices.GetData())[Index] = Index;
+	}
+
+	FCompushadyTextureUploadRegion Region;
+	Region.NumSlices = 4;
+
+	FCompushadySignaled OnSignaled;
+	UAV->UpdateTextureAsync(MoveTemp(Slices), { Region }, OnSignaled);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitResource(UAV, [this, UAV]()
+		{
+			TArray<uint32> Output;
+			Output.AddZeroed(8 * 8);
+
+			const bool bSuccess = UAV->MapTextureSliceAndExecuteSync([&Output](const void* Data, const int32 RowPitch)
+				{
+					CopyTextureData2D(Data, Output.GetData(), 8, EPixelFormat::PF_R32_UINT, RowPitch, 8 * sizeof(uint32));
+				}, 3);
+
+			TestTrue(TEXT("bSuccess"), bSuccess);
+			TestEqual(TEXT("Output[0]"), Output[0], 192);
+			TestEqual(TEXT("Output[63]"), Output[63], 255);
+		}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_ReadbackAllToFileStreamed, "Compushady.UAV.ReadbackAllToFileStreamed", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyUAVTest_ReadbackAllToFileStreamed::RunTest(const FString& Parameters)
+{
+	// 1000 uint32 streamed in 64 bytes chunks (more than a single batch of staging buffers)
+	UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVBuffer(TestName, 4000, EPixelFormat::PF_R32_UINT);
+
+	UAV->MapWriteAndExecuteSync([](void* Data)
+		{
+			uint32* Ptr = reinterpret_cast<uint32*>(Data);
+			for (int32 Index = 0; Index < 1000; Index++)
+			{
+				Ptr[Index] = Index;
+			}
+		});
+
+	const FString Filename = FPaths::CreateTempFilename(*FPaths::ProjectIntermediateDir(), TEXT("Compushady"), TEXT(".bin"));
+
+	FCompushadyProgress OnProgress;
+	FCompushadySignaled OnSignaled;
+	UAV->ReadbackAllToFileStreamed(Filename, 64, OnProgress, OnSignaled);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitResource(UAV, [this, Filename]()
+		{
+			TArray<uint8> Content;
+			TestTrue(TEXT("Content"), FFileHelper::LoadFileToArray(Content, *Filename));
+			if (!TestEqual(TEXT("Content.Num()"), Content.Num(), 4000))
+			{
+				return;
+			}
+
+			const uint32* Ptr = reinterpret_cast<const uint32*>(Content.GetData());
+			TestEqual(TEXT("Content[0]"), Ptr[0], 0);
+			TestEqual(TEXT("Content[17]"), Ptr[17], 17);
+			TestEqual(TEXT("Content[999]"), Ptr[999], 999);
+
+			IFileManager::Get().Delete(*Filename);
+		}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_ReadbackTextureToFile, "Compushady.UAV.ReadbackTextureToFile", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyUAVTest_ReadbackTextureToFile::RunTest(const FString& Parameters)
+{
+	UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVTexture2D(TestName, 8, 8, EPixelFormat::PF_R32_UINT);
+
+	TArray<uint32> Slice;
+	for (int32 Index = 0; Index < 8 * 8; Index++)
+	{
+		Slice.Add(Index);
+	}
+
+	UAV->UpdateTextureSliceSync(reinterpret_cast<uint8*>(Slice.GetData()), Slice.Num() * sizeof(uint32), 0);
+
+	const FString Filename = FPaths::CreateTempFilename(*FPaths::ProjectIntermediateDir(), TEXT("Compushady"), TEXT(".bin"));
+
+	FCompushadySignaled OnSignaled;
+	UAV->ReadbackAllToFile(Filename, OnSignaled);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FCompushadyWaitResource(UAV, [this, Filename]()
+		{
+			TArray<uint8> Content;
+			TestTrue(TEXT("Content"), FFileHelper::LoadFileToArray(Content, *Filename));
+			if (!TestEqual(TEXT("Content.Num()"), Content.Num(), 8 * 8 * 4))
+			{
+				return;
+			}
+
+			const uint32* Ptr = reinterpret_cast<const uint32*>(Content.GetData());
+			TestEqual(TEXT("Content[0]"), Ptr[0], 0);
+			TestEqual(TEXT("Content[9]"), Ptr[9], 9);
+			TestEqual(TEXT("Content[63]"), Ptr[63], 63);
+
+			IFileManager::Get().Delete(*Filename);
+		}));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_MipGenerator, "Compushady.UAV.MipGenerator", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyUAVTest_MipGenerator::RunTest(const FString& Parameters)
+{
+	UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVTexture2D(TestName, 64, 64, EPixelFormat::PF_R32_FLOAT, 0);
+
+	TestEqual(TEXT("NumMips"), static_cast<int32>(UAV->GetTextureRHI()->GetNumMips()), 7);
+
+	TArray<float> Slice;
+	for (int32 Index = 0; Index < 64 * 64; Index++)
+	{
+		Slice.Add(Index);
+	}
+
+	UAV->UpdateTextureSliceSync(reinterpret_cast<uint8*>(Slice.GetData()), Slice.Num() * sizeof(float), 0);
+
+	auto ReadLastMip = [UAV]()
+		{
+			TArray<uint8> Bytes;
+			TArray<FCompushadyTextureReadbackRegion> Regions;
+			if (!UAV->ReadbackTextureSlicesSync(0, 1, 6, 1, Bytes, Regions))
+			{
+				return -1.0f;
+			}
+			return *reinterpret_cast<const float*>(Bytes.GetData() + Regions[0].Offset);
+		};
+
+	FString ErrorMessages;
+	UCompushadyMipGenerator* AverageMipGenerator = UCompushadyFunctionLibrary::CreateCompushadyMipGenerator(ECompushadyMipReduction::Average, ErrorMessages);
+	TestNotNull(TEXT("AverageMipGenerator"), AverageMipGenerator);
+
+	TestTrue(TEXT("GenerateMipsSync"), AverageMipGenerator->GenerateMipsSync(UAV));
+	TestEqual(TEXT("Average"), ReadLastMip(), 2047.5f);
+
+	UCompushadyMipGenerator* MaxMipGenerator = UCompushadyFunctionLibrary::CreateCompushadyMipGenerator(ECompushadyMipReduction::Max, ErrorMessages);
+	TestNotNull(TEXT("MaxMipGenerator"), MaxMipGenerator);
+
+	TestTrue(TEXT("GenerateMipsSync"), MaxMipGenerator->GenerateMipsSync(UAV));
+	TestEqual(TEXT("Max"), ReadLastMip(), 4095.0f);
+
+	TestTrue(TEXT("GenerateMipsSync PerMip"), AverageMipGenerator->GenerateMipsSync(UAV, true));
+	TestEqual(TEXT("Average PerMip"), ReadLastMip(), 2047.5f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_MipGeneratorSinglePass, "Compushady.UAV.MipGeneratorSinglePass", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FCompushadyUAVTest_MipGeneratorSinglePass::RunTest(const FString& Parameters)
+{
+	// more than 7 mips, so the last group reduces the remaining ones
+	constexpr int32 Size = 256;
+	constexpr int32 NumMips = 9;
+
+	UCompushadyUAV* SinglePassUAV = UCompushadyFunctionLibrary::CreateCompushadyUAVTexture2D(TestName + "SinglePass", Size, Size, EPixelFormat::PF_R32_FLOAT, 0);
+	UCompushadyUAV* PerMipUAV = UCompushadyFunctionLibrary::CreateCompushadyUAVTexture2D(TestName + "PerMip", Size, Size, EPixelFormat::PF_R32_FLOAT, 0);
+
+	TestEqual(TEXT("NumMips"), static_cast<int32>(SinglePassUAV->GetTextureRHI()->GetNumMips()), NumMips);
+
+	auto Upload = [](UCompushadyUAV* UAV, const int32 Seed)
+		{
+			TArray<float> Slice;
+			for (int32 Index = 0; Index < Size * Size; Index++)
+			{
+				Slice.Add((Index * 7919 + Seed) % 65536);
+			}
+			UAV->UpdateTextureSliceSync(reinterpret_cast<uint8*>(Slice.GetData()), Slice.Num() * sizeof(float), 0);
+		};
+
+	auto Compare = [this](UCompushadyUAV* UAV, UCompushadyUAV* ExpectedUAV, const TCHAR* What)
+		{
+			TArray<uint8> Bytes;
+			TArray<FCompushadyTextureReadbackRegion> Regions;
+			TArray<uint8> ExpectedBytes;
+			TArray<FCompushadyTextureReadbackRegion> ExpectedRegions;
+			if (!TestTrue(TEXT("ReadbackTextureSlicesSync"), UAV->ReadbackTextureSlicesSync(0, 1, 0, NumMips, Bytes, Regions)) ||
+				!TestTrue(TEXT("ReadbackTextureSlicesSync"), ExpectedUAV->ReadbackTextureSlicesSync(0, 1, 0, NumMips, ExpectedBytes, ExpectedRegions)) ||
+				!TestEqual(TEXT("Regions.Num()"), Regions.Num(), NumMips))
+			{
+				return;
+			}
+
+			for (int32 Mip = 0; Mip < NumMips; Mip++)
+			{
+				const FCompushadyTextureReadbackRegion& Region = Regions[Mip];
+				const FCompushadyTextureReadbackRegion& ExpectedRegion = ExpectedRegions[Mip];
+				int32 NumMismatches = 0;
+				for (int32 Y = 0; Y < Region.Size.Y; Y++)
+				{
+					const float* Row = reinterpret_cast<const float*>(Bytes.GetData() + Region.Offset + Y * Region.RowPitch);
+					const float* ExpectedRow = reinterpret_cast<const float*>(ExpectedBytes.GetData() + ExpectedRegion.Offset + Y * ExpectedRegion.RowPitch);
+					for (int32 X = 0; X < Region.Size.X; X++)
+					{
+						// the reductions can be summed in a different order
+						if (!FMath::IsNearlyEqual(Row[X], ExpectedRow[X], FMath::Max(1.0f, FMath::Abs(ExpectedRow[X])) * 1e-5f))
+						{
+							NumMismatches++;
+						}
+					}
+				}
+				TestEqual(FString::Printf(TEXT("%s Mip %d mismatches"), What, Mip), NumMismatches, 0);
+			}
+		};
+
+	FString ErrorMessages;
+	for (const ECompushadyMipReduction Reduction : { ECompushadyMipReduction::Average, ECompushadyMipReduction::Max })
+	{
+		UCompushadyMipGenerator* MipGenerator = UCompushadyFunctionLibrary::CreateCompushadyMipGenerator(Reduction, ErrorMessages);
+		if (!TestNotNull(TEXT("MipGenerator"), MipGenerator))
+		{
+			AddError(ErrorMessages);
+			return false;
+		}
+
+		const TCHAR* What = Reduction == ECompushadyMipReduction::Average ? TEXT("Average") : TEXT("Max");
+
+		// the second dispatch (with different content) fails to reach the last mips if the group counter is not reset
+		for (int32 Seed = 0; Seed < 2; Seed++)
+		{
+			Upload(SinglePassUAV, Seed * 101);
+			Upload(PerMipUAV, Seed * 101);
+
+			TestTrue(TEXT("GenerateMipsSync"), MipGenerator->GenerateMipsSync(SinglePassUAV));
+			TestTrue(TEXT("GenerateMipsSync PerMip"), MipGenerator->GenerateMipsSync(PerMipUAV, true));
+
+			Compare(SinglePassUAV, PerMipUAV, What);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompushadyUAVTest_MipGeneratorBenchmark, "Compushady.UAV.MipGeneratorBenchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FCompushadyUAVTest_MipGeneratorBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 Iterations = 16;
+
+	UCompushadyUAV* UAV = UCompushadyFunctionLibrary::CreateCompushadyUAVTexture2D(TestName, 4096, 4096, EPixelFormat::PF_R32_FLOAT, 0);
+
+	FString ErrorMessages;
+	UCompushadyMipGenerator* MipGenerator = UCompushadyFunctionLibrary::CreateCompushadyMipGenerator(ECompushadyMipReduction::Max, ErrorMessages);
+	if (!MipGenerator)
+	{
+		AddError(ErrorMessages);
+		return false;
+	}
+
+	// includes the submission and the GPU wait, so the numbers are only meaningful for comparison
+	auto Benchmark = [&](const TCHAR* Name, const bool bPerMip)
+		{
+			MipGenerator->GenerateMipsSync(UAV, bPerMip);
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+			{
+				MipGenerator->GenerateMipsSync(UAV, bPerMip);
+			}
+			const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+			AddInfo(FString::Printf(TEXT("%s: %.3f ms"), Name, ElapsedTime * 1000.0 / Iterations));
+		};
+
+	Benchmark(TEXT("4096x4096 R32F SinglePass"), false);
+	Benchmark(TEXT("4096x4096 R32F PerMip"), true);
+
+	return true;
+}
+
 #endif
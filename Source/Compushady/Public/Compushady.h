@@ -5,8 +5,10 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 #include "Runtime/Launch/Resources/Version.h"
+#include "Stats/Stats.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogCompushady, Log, All);
+DECLARE_STATS_GROUP(TEXT("Compushady"), STATGROUP_Compushady, STATCAT_Advanced);
 
 #if ENGINE_MAJOR_VERSION == 5
 #if ENGINE_MINOR_VERSION == 2
@@ -38,12 +40,21 @@ namespace Compushady
 		Sampler
 	};
 
+	struct FCompushadyShaderConstant
+	{
+		FString Name;
+		uint32 Offset;
+		uint32 Size;
+	};
+
 	struct FCompushadyShaderResourceBinding
 	{
 		uint32 BindingIndex;
 		uint32 SlotIndex;
 		FString Name;
 		ECompushadySharedResourceType Type;
+		// members layout (only for UniformBuffers)
+		TArray<FCompushadyShaderConstant> Constants;
 	};
 
 	struct FCompushadyShaderSemantic
@@ -52,18 +63,21 @@ namespace Compushady
 		uint32 Index;
 		uint32 Register;
 		uint32 Mask;
+		// int/uint components (float otherwise)
+		bool bInteger;
 
 		bool operator==(const FCompushadyShaderSemantic& Other) const
 		{
-			return Name == Other.Name && Index == Other.Index && Register == Other.Register && Mask == Other.Mask;
+			return Name == Other.Name && Index == Other.Index && Register == Other.Register && Mask == Other.Mask && bInteger == Other.bInteger;
 		}
 
-		FCompushadyShaderSemantic(const FString& InName, const uint32 InIndex, const uint32 InRegister, const uint32 InMask)
+		FCompushadyShaderSemantic(const FString& InName, const uint32 InIndex, const uint32 InRegister, const uint32 InMask, const bool bInInteger = false)
 		{
 			Name = InName;
 			Index = InIndex;
 			Register = InRegister;
 			Mask = InMask;
+			bInteger = bInInteger;
 		}
 	};
 
@@ -0,0 +1,93 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CompushadySRV.h"
+#include "CompushadyUAV.h"
+#include "CompushadyBufferArena.generated.h"
+
+/**
+ * Sub-allocates element ranges of a single structured buffer (requires Unreal Engine 5.3).
+ * Each range is handed out as a regular SRV or UAV (a view with its own offset and number of elements),
+ * so thousands of small buffers cost a single allocation. Ranges are placed first-fit and merged back on Free.
+ * Compact moves the live ranges to the start of a new backing buffer (optionally bigger) and recreates their views,
+ * the handed out objects stay the same.
+ * The views share the transitions of the backing buffer: SRVs and UAVs of the same arena cannot be bound to the same dispatch.
+ * The map/readback/upload functions of a view (and GetBufferSize) only access its own range.
+ */
+UCLASS(BlueprintType)
+class COMPUSHADY_API UCompushadyBufferArena : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	bool InitializeArena(const FString& InName, const int64 Size, const int32 InStride, FString& ErrorMessages);
+
+	// returns nullptr if there is no free range big enough (Compact could make room)
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	UCompushadySRV* AllocateSRV(const int32 NumElements);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	UCompushadyUAV* AllocateUAV(const int32 NumElements);
+
+	// the view must not be used anymore, as its range can be immediately reallocated
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool Free(UCompushadyResource* Resource);
+
+	// NewSize = 0 keeps the current size, the render thread is flushed before moving the ranges
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool Compact(const int64 NewSize = 0);
+
+	// in bytes, -1 if the resource has not been allocated by this arena
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int64 GetOffset(UCompushadyResource* Resource) const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int64 GetSize() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int64 GetUsedBytes() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int64 GetLargestFreeBytes() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int32 GetNumAllocations() const;
+
+	// between 0 (all of the free space is contiguous) and 1
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	float GetFragmentation() const;
+
+	// the whole backing buffer, for binding all of the ranges at once (it changes after Compact)
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	UCompushadyUAV* GetBackingUAV() const;
+
+protected:
+	// in elements
+	struct FRange
+	{
+		int64 FirstElement = 0;
+		int64 NumElements = 0;
+	};
+
+	bool AllocateRange(const int64 NumElements, int64& FirstElement);
+	void FreeRange(const FRange& Range);
+	bool InitializeView(UCompushadyResource* Resource, const FRange& Range);
+
+	FString Name;
+	int32 Stride = 0;
+	int64 Capacity = 0;
+	int64 UsedElements = 0;
+
+	UPROPERTY()
+	UCompushadyUAV* BackingUAV = nullptr;
+
+	// this keeps the views alive until Free
+	UPROPERTY()
+	TArray<UCompushadyResource*> Views;
+
+	TMap<UCompushadyResource*, FRange> Allocations;
+	// sorted by FirstElement, adjacent ranges are always merged
+	TArray<FRange> FreeRanges;
+};
@@ -6,8 +6,18 @@
 #include "UObject/NoExportTypes.h"
 #include "Camera/CameraComponent.h"
 #include "Components/SceneCaptureComponent2D.h"
+#include "CompushadyTypes.h"
 #include "CompushadyCBV.generated.h"
 
+struct FCompushadyCBVStructCopy
+{
+	int32 SourceOffset;
+	int32 DestinationOffset;
+	// in bytes of the source
+	int32 Size;
+	bool bDoubleToFloat;
+};
+
 /**
  *
  */
@@ -27,6 +37,20 @@ public:
 
 	FUniformBufferRHIRef GetRHI();
 
+	// in snapshot mode every dispatch/draw gets its own copy of the constants (taken when the work is enqueued)
+	// so they can be changed while the previous work is still in flight
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	void SetSnapshotMode(const bool bEnabled);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	bool IsSnapshotMode() const;
+
+	// game thread only, the data is copied only if it has been changed since the previous snapshot
+	TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Snapshot();
+
+	// render thread only, returns a transient (single frame) uniform buffer
+	FUniformBufferRHIRef CreateSnapshotRHI(const TArray<uint8>& SnapshotData) const;
+
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	bool SetFloat(const int64 Offset, const float Value);
 
@@ -59,6 +83,51 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	bool SetRotationFloat2(const int64 Offset, const float Radians);
 
+	// resolves the constants names to offsets, the layout is generally taken from the shader resource bindings
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool SetLayout(const FCompushadyResourceBinding& ResourceBinding);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int64 GetConstantOffset(const FString& Name) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool SetFloatByName(const FString& Name, const float Value);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool SetDoubleByName(const FString& Name, const double Value);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool SetIntByName(const FString& Name, const int32 Value);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool SetUIntByName(const FString& Name, const int64 Value);
+
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "Values"), Category = "Compushady")
+	bool SetFloatArrayByName(const FString& Name, const TArray<float>& Values);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool SetVectorFloatByName(const FString& Name, const FVector Value);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool SetLinearColorByName(const FString& Name, const FLinearColor Value);
+
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "Transform"), Category = "Compushady")
+	bool SetTransformFloatByName(const FString& Name, const FTransform& Transform, const bool bTranspose = true);
+
+	// copies every struct property matching (by name) a constant of the layout, doubles are converted to floats when the constant is half the size
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (CustomStructureParam = "Struct"), Category = "Compushady")
+	bool SetFromStruct(const int32& Struct);
+
+	DECLARE_FUNCTION(execSetFromStruct);
+
+	bool SetFromStruct(const UScriptStruct* ScriptStruct, const void* StructData);
+
+	template<typename T>
+	bool SetFromStruct(const T& Struct)
+	{
+		return SetFromStruct(TBaseStructure<T>::Get(), &Struct);
+	}
+
 	const TArray<uint8>& GetBufferData() const { return BufferData; }
 
 	int64 GetBufferSize() const;
@@ -112,6 +181,17 @@ public:
 		return false;
 	}
 
+	template<typename T>
+	bool SetValueByName(const FString& Name, const T Value)
+	{
+		const FCompushadyResourceConstant* Constant = Constants.Find(Name);
+		if (!Constant || Constant->Size < static_cast<int32>(sizeof(T)))
+		{
+			return false;
+		}
+		return SetValue(Constant->Offset, Value);
+	}
+
 	template<typename T>
 	bool GetValue(const int64 Offset, T& OutValue) const
 	{
@@ -130,4 +210,12 @@ protected:
 
 	FUniformBufferLayoutRHIRef UniformBufferLayoutRHIRef;
 	FUniformBufferRHIRef UniformBufferRHIRef;
+
+	// built on every call, as the property offsets change when a user defined struct is recompiled
+	bool BuildStructCopyPlan(const UScriptStruct* ScriptStruct, TArray<FCompushadyCBVStructCopy>& Plan) const;
+
+	bool bSnapshotMode = false;
+	TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> LastSnapshot;
+
+	TMap<FString, FCompushadyResourceConstant> Constants;
 };
@@ -0,0 +1,98 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CompushadySRV.h"
+#include "CompushadyCBVPool.generated.h"
+
+/**
+ * Packs many small constant blocks in 256 bytes aligned slots of a single Structured Buffer.
+ * The whole pool can be bound as a StructuredBuffer (indexing it by slot) or a single slot can be bound with GetSlotSRV.
+ * Dirty slots are uploaded with a single buffer copy when the pool (or one of its slots) is used by a pipeline.
+ */
+UCLASS(BlueprintType)
+class COMPUSHADY_API UCompushadyCBVPool : public UCompushadySRV
+{
+	GENERATED_BODY()
+
+public:
+	// slots are exposed as the elements of a structured buffer, so they cannot be bigger than its maximum stride
+	bool InitializePool(const FString& Name, const int32 InSlotSize, const int32 InNumSlots);
+
+	static constexpr int32 MaxSlotSize = 2048;
+
+	// returns -1 when the pool is full
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	int32 AllocateSlot();
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool FreeSlot(const int32 Slot);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int32 GetSlotSize() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int32 GetNumSlots() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int32 GetNumAllocatedSlots() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int32 GetNumDirtySlots() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int64 GetSlotOffset(const int32 Slot) const;
+
+	// the returned SRV exposes only the specified slot (as a StructuredBuffer with a single element), requires UE >= 5.3
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	UCompushadySRV* GetSlotSRV(const int32 Slot);
+
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "Data"), Category = "Compushady")
+	bool SetSlotData(const int32 Slot, const int64 Offset, const TArray<uint8>& Data);
+
+	bool SetSlotData(const int32 Slot, const int64 Offset, const void* Data, const int64 Size);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool SetFloat(const int32 Slot, const int64 Offset, const float Value);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool SetInt(const int32 Slot, const int64 Offset, const int32 Value);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool SetUInt(const int32 Slot, const int64 Offset, const int64 Value);
+
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "Values"), Category = "Compushady")
+	bool SetFloatArray(const int32 Slot, const int64 Offset, const TArray<float>& Values);
+
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "Transform"), Category = "Compushady")
+	bool SetTransformFloat(const int32 Slot, const int64 Offset, const FTransform& Transform, const bool bTranspose = true);
+
+	// enqueue the upload of all of the dirty slots (automatically called when the pool is used by a pipeline)
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	void Upload();
+
+	bool IsValidSlot(const int32 Slot, const int64 Offset, const int64 Size) const;
+
+	template<typename T>
+	bool SetSlotValue(const int32 Slot, const int64 Offset, const T Value)
+	{
+		return SetSlotData(Slot, Offset, &Value, sizeof(T));
+	}
+
+protected:
+	int32 SlotSize = 0;
+	int32 NumSlots = 0;
+
+	TArray<uint8> SlotsData;
+	TBitArray<> AllocatedSlots;
+	TArray<int32> FreeSlots;
+
+	TBitArray<> DirtySlots;
+	int32 NumDirtySlots = 0;
+	int32 FirstDirtySlot = MAX_int32;
+	int32 LastDirtySlot = -1;
+
+	UPROPERTY()
+	TMap<int32, UCompushadySRV*> SlotSRVs;
+};
@@ -0,0 +1,40 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace Compushady
+{
+	namespace Conversion
+	{
+		COMPUSHADY_API void HalfToFloat(const uint16* Source, float* Destination, const int64 Elements);
+		COMPUSHADY_API void FloatToHalf(const float* Source, uint16* Destination, const int64 Elements);
+
+		COMPUSHADY_API void Unorm8ToFloat(const uint8* Source, float* Destination, const int64 Elements);
+		COMPUSHADY_API void FloatToUnorm8(const float* Source, uint8* Destination, const int64 Elements);
+
+		COMPUSHADY_API void Unorm16ToFloat(const uint16* Source, float* Destination, const int64 Elements);
+		COMPUSHADY_API void FloatToUnorm16(const float* Source, uint16* Destination, const int64 Elements);
+
+		// 4 floats per pixel
+		COMPUSHADY_API void RGB10A2ToFloat(const uint32* Source, float* Destination, const int64 Pixels);
+		COMPUSHADY_API void FloatToRGB10A2(const float* Source, uint32* Destination, const int64 Pixels);
+
+		// RGBA8 <-> BGRA8 (the same operation in both directions), Source and Destination can be the same
+		COMPUSHADY_API void SwapRedBlue8(const uint8* Source, uint8* Destination, const int64 Pixels);
+
+		// 16 floats per transform (transposed by default, as expected by hlsl float4x4)
+		COMPUSHADY_API void TransformsToMatrix44f(const FTransform* Source, float* Destination, const int64 Transforms, const bool bTranspose = true);
+		// 12 floats per transform (hlsl float3x4, the translation is in the last column)
+		COMPUSHADY_API void TransformsToMatrix34f(const FTransform* Source, float* Destination, const int64 Transforms);
+		// 10 floats per transform: rotation quaternion (xyzw), translation (xyz) and scale (xyz)
+		COMPUSHADY_API void TransformsToQuatTranslationScale(const FTransform* Source, float* Destination, const int64 Transforms);
+
+		COMPUSHADY_API bool SupportsPixelFormat(const EPixelFormat PixelFormat);
+
+		// converts from the component type of the PixelFormat (half, unorm, packed, float), components are returned in RGBA order
+		COMPUSHADY_API bool PixelFormatToFloat(const EPixelFormat PixelFormat, const uint8* Source, const int64 Size, TArray<float>& Destination);
+		COMPUSHADY_API bool FloatToPixelFormat(const EPixelFormat PixelFormat, const float* Source, const int64 Elements, TArray64<uint8>& Destination);
+	}
+}
@@ -0,0 +1,61 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CompushadySRV.h"
+#include "Curves/CurveBase.h"
+#include "CompushadyCurveAtlas.generated.h"
+
+/**
+ * Bakes many curves (one per row, over their own time range) in a single float4 2D texture.
+ * Float curves are stored in the red channel, vector curves in rgb and color curves in rgba.
+ * The index table (a StructuredBuffer<float4>) maps each curve to (MinTime, 1 / (MaxTime - MinTime), V, Row),
+ * so that a kernel can sample Atlas.SampleLevel(Sampler, float2((Time - Index.x) * Index.y, Index.z), 0).
+ * Rebake only evaluates (and uploads) the curves whose keys changed since the last bake.
+ */
+UCLASS(BlueprintType)
+class COMPUSHADY_API UCompushadyCurveAtlas : public UCompushadySRV
+{
+	GENERATED_BODY()
+
+public:
+	bool InitializeAtlas(const FString& Name, const TArray<UCurveBase*>& InCurves, const int32 InResolution, FString& ErrorMessages);
+
+	// returns the number of rebaked curves
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	int32 Rebake();
+
+	// returns -1 if the curve is not in the atlas
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int32 GetCurveRow(UCurveBase* Curve) const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	UCompushadySRV* GetIndexTableSRV() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int32 GetResolution() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int32 GetNumCurves() const;
+
+	// the baked texels (Resolution * NumCurves float4)
+	const TArray<FLinearColor>& GetTexels() const;
+
+	static uint32 GetCurveHash(const UCurveBase* Curve);
+
+protected:
+	void BakeCurve(const int32 Row);
+
+	UPROPERTY()
+	TArray<UCurveBase*> Curves;
+
+	UPROPERTY()
+	UCompushadySRV* IndexTableSRV = nullptr;
+
+	int32 Resolution = 0;
+
+	TArray<uint32> CurveHashes;
+	TArray<FLinearColor> Texels;
+	TArray<FVector4f> IndexTable;
+};
@@ -0,0 +1,67 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CompushadyTypes.h"
+
+namespace Compushady
+{
+	namespace DataTable
+	{
+		enum class ECopyKind : uint8
+		{
+			// float, int32, uint32 (and double/int64/uint64 when not demoted)
+			Copy,
+			DoubleToFloat,
+			// int8 and int16 are widened to int
+			SignedInt,
+			// uint8, uint16 and enums are widened to uint
+			UnsignedInt,
+			// bools (including bitfields) are stored as uint (0 or 1)
+			Bool
+		};
+
+		struct FCopy
+		{
+			ECopyKind Kind = ECopyKind::Copy;
+			int32 SourceOffset = 0;
+			// relative to the beginning of the column element
+			int32 DestinationOffset = 0;
+			// in the source
+			int32 Size = 0;
+			// required for the non-plain kinds
+			const FProperty* Property = nullptr;
+		};
+
+		// a column maps to a single hlsl member (a scalar or a vector, like float3 for an FVector)
+		struct FColumn
+		{
+			FString Name;
+			FString HLSLType;
+			// offset in the interleaved row
+			int32 RowOffset = 0;
+			int32 Size = 0;
+			TArray<FCopy> Copies;
+		};
+
+		struct FLayoutPlan
+		{
+			FString StructName;
+			TArray<FColumn> Columns;
+			// the stride of the interleaved layout (8 bytes aligned when 64 bit members are present)
+			int32 RowSize = 0;
+			int32 Alignment = 4;
+		};
+
+		// the plan is rebuilt on every Pack (it holds raw properties and offsets that would be stale after a struct recompile), game thread only
+		COMPUSHADY_API bool BuildLayoutPlan(const UScriptStruct* RowStruct, const bool bDemoteDoubles, FLayoutPlan& Plan);
+
+		// rows are packed in parallel, Stride is the row size for the interleaved layout and 4 for the columnar one
+		COMPUSHADY_API bool Pack(const UScriptStruct* RowStruct, TArrayView<const uint8* const> Rows, const ECompushadyDataTableLayout Layout, const bool bDemoteDoubles, TArray<uint8>& Data, int32& Stride, FString& HLSL, FString& ErrorMessages);
+		COMPUSHADY_API bool PackDataTable(const UDataTable* DataTable, const ECompushadyDataTableLayout Layout, const bool bDemoteDoubles, TArray<uint8>& Data, int32& Stride, FString& HLSL, FString& ErrorMessages);
+
+		// the interleaved layout maps to a struct, the columnar one to a set of per-column offsets (in uints)
+		COMPUSHADY_API FString GenerateHLSL(const FLayoutPlan& Plan, const ECompushadyDataTableLayout Layout, const int32 NumRows);
+	}
+}
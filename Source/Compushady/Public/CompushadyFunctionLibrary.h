@@ -4,9 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "CompushadyBlendable.h"
+#include "CompushadyBufferArena.h"
 #include "CompushadyCBV.h"
+#include "CompushadyCBVPool.h"
 #include "CompushadyCompute.h"
+#include "CompushadyCurveAtlas.h"
 #include "CompushadyDSV.h"
+#include "CompushadyImageSequenceExporter.h"
+#include "CompushadyMipGenerator.h"
 #include "CompushadyShader.h"
 #include "CompushadySoundWave.h"
 #include "CompushadySRV.h"
@@ -14,9 +19,11 @@
 #include "CompushadyRTV.h"
 #include "CompushadySampler.h"
 #include "CompushadyUAV.h"
+#include "CompushadyUAVPool.h"
 #include "CompushadyVideoEncoder.h"
 #include "Curves/CurveFloat.h"
 #include "Engine/DataTable.h"
+#include "Engine/StaticMesh.h"
 #include "Engine/Texture2DArray.h"
 #include "Engine/TextureCube.h"
 #include "Engine/TextureRenderTarget2D.h"
@@ -46,26 +53,78 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadyCBV* CreateCompushadyCBVFromFloatArray(const FString& Name, const TArray<float>& Data);
 
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	static UCompushadyCBV* CreateCompushadyCBVFromResourceBinding(const FString& Name, const FCompushadyResourceBinding& ResourceBinding);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	static UCompushadyCBVPool* CreateCompushadyCBVPool(const FString& Name, const int32 SlotSize, const int32 NumSlots);
+
+	// the UAV buffer creators (and the owned SRV buffer variants below) return a pending resource: a non-null result only means the arguments are valid,
+	// the RHI buffer is created later in the render thread and can still fail. Check IsCreationFailed() (or IsValidBuffer()) after WaitForCreation().
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadyUAV* CreateCompushadyUAVBuffer(const FString& Name, const int64 Size, const EPixelFormat PixelFormat);
 
+	// R32_UINT buffer usable as indirect arguments (and count) buffer by the Rasterizer
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	static UCompushadyUAV* CreateCompushadyUAVIndirectArgumentsBuffer(const FString& Name, const int64 Size);
+
+	// PixelFormat must be R16_UINT or R32_UINT
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	static UCompushadyUAV* CreateCompushadyUAVIndexBuffer(const FString& Name, const int64 Size, const EPixelFormat PixelFormat);
+
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadySRV* CreateCompushadySRVBufferFromFloatArray(const FString& Name, const TArray<float>& Data, const EPixelFormat PixelFormat);
 
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadySRV* CreateCompushadySRVBufferFromByteArray(const FString& Name, const TArray<uint8>& Data, const EPixelFormat PixelFormat);
 
+	UFUNCTION(BlueprintCallable, meta = (AdvancedDisplay = "Offset,Size"), Category = "Compushady")
+	static UCompushadySRV* CreateCompushadySRVBufferFromFile(const FString& Name, const FString& Filename, const EPixelFormat PixelFormat, const int64 Offset = 0, const int64 Size = 0);
+
+	UFUNCTION(BlueprintCallable, meta = (AdvancedDisplay = "Offset,Size"), Category = "Compushady")
+	static UCompushadyUAV* CreateCompushadyUAVBufferFromFile(const FString& Name, const FString& Filename, const EPixelFormat PixelFormat, const int64 Offset = 0, const int64 Size = 0);
+
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadySRV* CreateCompushadySRVStructuredBufferFromFloatArray(const FString& Name, const TArray<float>& Data, const int32 Stride);
 
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadySRV* CreateCompushadySRVStructuredBufferFromByteArray(const FString& Name, const TArray<uint8>& Data, const int32 Stride);
 
+	// the following variants copy the data only once, directly into the locked buffer (no intermediate array, but it is not zero-copy:
+	// formats requiring a conversion from float still convert into a temporary array).
+	// views must be valid until the function returns, moved and shared arrays are owned by the upload
+	// (in this case the SRV is returned immediately and the buffer is created later in the render thread, see IsCreationFailed()).
+	static UCompushadySRV* CreateCompushadySRVBufferFromFloatArray(const FString& Name, TArrayView<const float> Data, const EPixelFormat PixelFormat);
+	static UCompushadySRV* CreateCompushadySRVBufferFromFloatArray(const FString& Name, TArray<float>&& Data, const EPixelFormat PixelFormat);
+	static UCompushadySRV* CreateCompushadySRVBufferFromFloatArray(const FString& Name, TSharedPtr<const TArray<float>, ESPMode::ThreadSafe> Data, const EPixelFormat PixelFormat);
+
+	static UCompushadySRV* CreateCompushadySRVBufferFromByteArray(const FString& Name, TArrayView<const uint8> Data, const EPixelFormat PixelFormat);
+	static UCompushadySRV* CreateCompushadySRVBufferFromByteArray(const FString& Name, TArray<uint8>&& Data, const EPixelFormat PixelFormat);
+	static UCompushadySRV* CreateCompushadySRVBufferFromByteArray(const FString& Name, TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Data, const EPixelFormat PixelFormat);
+
+	static UCompushadySRV* CreateCompushadySRVStructuredBufferFromFloatArray(const FString& Name, TArrayView<const float> Data, const int32 Stride);
+	static UCompushadySRV* CreateCompushadySRVStructuredBufferFromFloatArray(const FString& Name, TArray<float>&& Data, const int32 Stride);
+	static UCompushadySRV* CreateCompushadySRVStructuredBufferFromFloatArray(const FString& Name, TSharedPtr<const TArray<float>, ESPMode::ThreadSafe> Data, const int32 Stride);
+
+	static UCompushadySRV* CreateCompushadySRVStructuredBufferFromByteArray(const FString& Name, TArrayView<const uint8> Data, const int32 Stride);
+	static UCompushadySRV* CreateCompushadySRVStructuredBufferFromByteArray(const FString& Name, TArray<uint8>&& Data, const int32 Stride);
+	static UCompushadySRV* CreateCompushadySRVStructuredBufferFromByteArray(const FString& Name, TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> Data, const int32 Stride);
+
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadyUAV* CreateCompushadyUAVStructuredBuffer(const FString& Name, const int64 Size, const int32 Stride);
 
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
-	static UCompushadyUAV* CreateCompushadyUAVTexture2D(const FString& Name, const int32 Width, const int32 Height, const EPixelFormat Format);
+	static UCompushadyUAVPool* CreateCompushadyUAVPool(const int32 EvictionFrames = 30);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	static UCompushadyBufferArena* CreateCompushadyBufferArena(const FString& Name, const int64 Size, const int32 Stride, FString& ErrorMessages);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	static UCompushadyMipGenerator* CreateCompushadyMipGenerator(const ECompushadyMipReduction Reduction, FString& ErrorMessages);
+
+	// NumMips = 0 creates the full mip chain
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	static UCompushadyUAV* CreateCompushadyUAVTexture2D(const FString& Name, const int32 Width, const int32 Height, const EPixelFormat Format, const int32 NumMips = 1);
 
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadyUAV* CreateCompushadyUAVSharedTexture2D(const FString& Name, const int32 Width, const int32 Height, const EPixelFormat Format);
@@ -79,8 +138,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadySRV* CreateCompushadySRVTexture3D(const FString& Name, const int32 Width, const int32 Height, const int32 Depth, const EPixelFormat Format);
 
+	// NumMips = 0 creates the full mip chain, the mips are box filtered on the CPU from the decoded image
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
-	static UCompushadySRV* CreateCompushadySRVTexture2DFromImageFile(const FString& Name, const FString& Filename);
+	static UCompushadySRV* CreateCompushadySRVTexture2DFromImageFile(const FString& Name, const FString& Filename, const int32 NumMips = 1);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	static TArray<UCompushadySRV*> CreateCompushadySRVTexture2DsFromImageFiles(const TArray<FString>& Filenames, FString& ErrorMessages);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	static UCompushadySRV* CreateCompushadySRVTexture2DArrayFromImageFiles(const FString& Name, const TArray<FString>& Filenames, FString& ErrorMessages);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	static UCompushadySRV* CreateCompushadySRVTexture2DArrayFromImageDirectory(const FString& Name, const FString& Directory, const FString& Extension, FString& ErrorMessages);
 
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadySRV* CreateCompushadySRVFromTexture2D(UTexture2D* Texture2D);
@@ -97,6 +166,8 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadySampler* CreateCompushadySampler(TextureFilter Filter);
 
+	// RTVs have a single mip, as draws can only target the first one: for a mip chain copy the RTV into a CreateCompushadyUAVTexture2D texture
+	// with mips and fill them with a UCompushadyMipGenerator (that requires UAV textures)
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadyRTV* CreateCompushadyRTVTexture2D(const FString& Name, const int32 Width, const int32 Height, const EPixelFormat Format, const FLinearColor ClearColor);
 
@@ -106,12 +177,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadySRV* CreateCompushadySRVFromTextureCube(UTextureCube* TextureCube);
 
+	// the SRV aliases the GPU buffer of the StaticMesh (no copies), StreamInfo describes how to read it in hlsl
+	// (waits for the view creation, returns nullptr when the engine buffer does not support Shader Resource Views)
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	static UCompushadySRV* CreateCompushadySRVFromStaticMesh(UStaticMesh* StaticMesh, const int32 LOD, const ECompushadyStaticMeshStream Stream, FCompushadyStaticMeshStreamInfo& StreamInfo, FString& ErrorMessages);
+
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadySRV* CreateCompushadySRVBufferFromCurveFloat(const FString& Name, UCurveFloat* CurveFloat, const float StartTime, const float EndTime, const int32 Steps);
 
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	static UCompushadyCurveAtlas* CreateCompushadyCurveAtlas(const FString& Name, const TArray<UCurveBase*>& Curves, const int32 Resolution, FString& ErrorMessages);
+
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadySRV* CreateCompushadySRVBufferFromDataTable(const FString& Name, UDataTable* DataTable, const EPixelFormat PixelFormat);
 
+	// supports numeric, bool, enum and struct (FVector and similar become hlsl vectors) columns, HLSL gets the matching declaration
+	UFUNCTION(BlueprintCallable, meta = (AdvancedDisplay = "bDemoteDoubles"), Category = "Compushady")
+	static UCompushadySRV* CreateCompushadySRVStructuredBufferFromDataTable(const FString& Name, UDataTable* DataTable, const ECompushadyDataTableLayout Layout, FString& HLSL, FString& ErrorMessages, const bool bDemoteDoubles = true);
+
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadyUAV* CreateCompushadyUAVFromRenderTarget2D(UTextureRenderTarget2D* RenderTarget);
 
@@ -136,6 +219,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadyVideoEncoder* CreateCompushadyVideoEncoder(const ECompushadyVideoEncoderCodec Codec, const ECompushadyVideoEncoderQuality Quality, const ECompushadyVideoEncoderLatency Latency);
 
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	static UCompushadyImageSequenceExporter* CreateCompushadyImageSequenceExporter(const FString& FilenamePrefix, const ECompushadyImageSequenceFormat Format, const ECompushadyImageSequencePolicy Policy, const int32 NumWorkers = 4, const int32 MaxQueuedFrames = 8);
+
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static bool DisassembleSPIRVFile(const FString& Filename, FString& Disassembled, FString& ErrorMessages);
 
@@ -163,6 +249,9 @@ public:
 	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "RasterizerConfig"), Category = "Compushady")
 	static UCompushadyRasterizer* CreateCompushadyMSPSRasterizerFromHLSLString(const FString& MeshShaderSource, const FString& PixelShaderSource, const FCompushadyRasterizerConfig& RasterizerConfig, FString& ErrorMessages, const FString& MeshShaderEntryPoint = "main", const FString& PixelShaderEntryPoint = "main");
 
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "RasterizerConfig"), Category = "Compushady")
+	static UCompushadyRasterizer* CreateCompushadyASMSPSRasterizerFromHLSLString(const FString& AmplificationShaderSource, const FString& MeshShaderSource, const FString& PixelShaderSource, const FCompushadyRasterizerConfig& RasterizerConfig, FString& ErrorMessages, const FString& AmplificationShaderEntryPoint = "main", const FString& MeshShaderEntryPoint = "main", const FString& PixelShaderEntryPoint = "main");
+
 	UFUNCTION(BlueprintCallable, Category = "Compushady")
 	static UCompushadyCompute* CreateCompushadyComputeFromHLSLShaderAsset(UCompushadyShader* ShaderAsset, FString& ErrorMessages, const FString& EntryPoint = "main");
 
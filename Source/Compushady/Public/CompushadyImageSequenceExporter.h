@@ -0,0 +1,70 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "UObject/NoExportTypes.h"
+#include "CompushadyTypes.h"
+#include "CompushadyImageSequenceExporter.generated.h"
+
+struct FCompushadyImageSequenceExporterState;
+
+UENUM(BlueprintType)
+enum class ECompushadyImageSequenceFormat : uint8
+{
+	PNG,
+	EXR,
+	Raw
+};
+
+UENUM(BlueprintType)
+enum class ECompushadyImageSequencePolicy : uint8
+{
+	// discard the frame when the queue is full
+	Drop,
+	// wait (in the calling thread) for a free slot in the queue
+	Block
+};
+
+/**
+ *
+ */
+UCLASS(BlueprintType)
+class COMPUSHADY_API UCompushadyImageSequenceExporter : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	bool Initialize(const FString& InFilenamePrefix, const ECompushadyImageSequenceFormat InFormat, const ECompushadyImageSequencePolicy InPolicy, const int32 NumWorkers, const int32 MaxQueuedFrames);
+
+	// only 2D textures are supported, the frame is copied by the GPU and mapped when the copy is completed (without stalling the render thread)
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool ExportFrame(UCompushadyResource* FrameResource);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	void Flush();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int64 GetNumExportedFrames() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int64 GetNumDroppedFrames() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int64 GetNumFailedFrames() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int32 GetNumQueuedFrames() const;
+
+	void BeginDestroy() override;
+
+protected:
+
+	TSharedPtr<FCompushadyImageSequenceExporterState, ESPMode::ThreadSafe> State;
+
+	int64 NextFrameNumber = 0;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+};
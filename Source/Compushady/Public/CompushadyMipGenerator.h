@@ -0,0 +1,80 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CompushadyCompute.h"
+#include "UObject/StrongObjectPtr.h"
+#include "CompushadyMipGenerator.generated.h"
+
+UENUM(BlueprintType)
+enum class ECompushadyMipReduction : uint8
+{
+	Average,
+	// Min and Max generate Hi-Z pyramids
+	Min,
+	Max
+};
+
+/**
+ * Fills the mip chain of 2D UAV textures (float or unorm formats) from their first mip.
+ * GenerateMips uses a single dispatch (up to 13 mips, so 4096x4096 textures): each group reduces a 64x64 tile
+ * to a single texel in groupshared memory, and the last group to finish reduces the remaining mips.
+ * Bigger textures automatically fall back to a dispatch per mip.
+ */
+UCLASS(BlueprintType)
+class COMPUSHADY_API UCompushadyMipGenerator : public UObject, public ICompushadyPipeline
+{
+	GENERATED_BODY()
+
+public:
+	bool InitMipGenerator(const ECompushadyMipReduction InReduction, FString& ErrorMessages);
+
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnSignaled"), Category = "Compushady")
+	void GenerateMips(UCompushadyUAV* UAV, const FCompushadySignaled& OnSignaled);
+
+	// a dispatch per mip (mainly for benchmarking the single pass version)
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnSignaled"), Category = "Compushady")
+	void GenerateMipsPerMip(UCompushadyUAV* UAV, const FCompushadySignaled& OnSignaled);
+
+	bool GenerateMipsSync(UCompushadyUAV* UAV, const bool bPerMip = false);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	bool IsRunning() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	ECompushadyMipReduction GetReduction() const;
+
+	static constexpr int32 MaxSinglePassMips = 13;
+
+	void BeginDestroy() override;
+
+protected:
+	struct FMipChain
+	{
+		TArray<TStrongObjectPtr<UCompushadyUAV>> Mips;
+		TStrongObjectPtr<UCompushadyCBV> Constants;
+	};
+
+	const FMipChain* GetMipChain(UCompushadyUAV* UAV, FString& ErrorMessages);
+	// the per-mip views keep the texture alive, so they are released as soon as the source UAV is collected
+	void PurgeMipChains();
+	bool CanUseSinglePass(const FMipChain& MipChain) const;
+	TFunction<void(FRHICommandListImmediate&)> GetGenerateFunction(UCompushadyUAV* UAV, const bool bPerMip, FString& ErrorMessages);
+
+	ECompushadyMipReduction Reduction = ECompushadyMipReduction::Average;
+
+	UPROPERTY()
+	UCompushadyCompute* SinglePassCompute = nullptr;
+
+	UPROPERTY()
+	UCompushadyCompute* PerMipCompute = nullptr;
+
+	// used by the single pass version for finding the last group
+	UPROPERTY()
+	UCompushadyUAV* Counter = nullptr;
+
+	TMap<TWeakObjectPtr<UCompushadyUAV>, FMipChain> MipChains;
+
+	FDelegateHandle PostGarbageCollectHandle;
+};
@@ -17,6 +17,8 @@ class COMPUSHADY_API UCompushadyRTV : public UCompushadyResource
 
 public:
 	bool InitializeFromTexture(FTextureRHIRef InTextureRHIRef);
+	// the RTV is pending until the render thread reads the RHI texture of the resource
+	bool InitializeFromTextureResource(FTextureResource* InTextureResource);
 
 	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnSignaled"), Category="Compushady")
 	void Clear(FLinearColor Color, const FCompushadySignaled& OnSignaled);
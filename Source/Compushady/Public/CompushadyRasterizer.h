@@ -25,6 +25,19 @@ enum class ECompushadyRasterizerCullMode : uint8
 	CounterClockWise
 };
 
+UENUM(BlueprintType)
+enum class ECompushadyRasterizerDepthCompare : uint8
+{
+	Never,
+	Less,
+	LessEqual,
+	Greater,
+	GreaterEqual,
+	Equal,
+	NotEqual,
+	Always
+};
+
 USTRUCT(BlueprintType)
 struct COMPUSHADY_API FCompushadyRasterizerConfig
 {
@@ -36,6 +49,18 @@ struct COMPUSHADY_API FCompushadyRasterizerConfig
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
 	ECompushadyRasterizerCullMode CullMode = ECompushadyRasterizerCullMode::None;
 
+	// depth test and write require a DSV in the draws, the occluded pixels are rejected before running the pixel shader
+	// (unless it writes depth, discards or writes to UAVs). Mesh shader Rasterizers do not support them.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	bool bDepthTest = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	bool bDepthWrite = false;
+
+	// LessEqual (GreaterEqual with reversed Z) allows a depth only prepass followed by the color draws with the same Rasterizer
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	ECompushadyRasterizerDepthCompare DepthCompare = ECompushadyRasterizerDepthCompare::LessEqual;
+
 };
 
 USTRUCT(BlueprintType)
@@ -43,14 +68,59 @@ struct COMPUSHADY_API FCompushadyRasterizeConfig
 {
 	GENERATED_BODY()
 
+	// in pixels (Z is the depth range), an invalid Viewport covers the whole first render target
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
-	FBox Viewport;
+	FBox Viewport = FBox(ForceInit);
 
+	// in pixels, an invalid Scissor disables the scissor test
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
-	FBox2D Scissor;
+	FBox2D Scissor = FBox2D(ForceInit);
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
-	int32 StencilValue;
+	int32 StencilValue = 0;
+
+};
+
+USTRUCT(BlueprintType)
+struct COMPUSHADY_API FCompushadyRasterizerDraw
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	FCompushadyResourceArray VSResourceArray;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	FCompushadyResourceArray PSResourceArray;
+
+	// ignored when IndexBuffer is set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	int32 NumVertices = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	int32 NumInstances = 1;
+
+	// optional, created with CreateCompushadyUAVIndexBuffer
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	UCompushadyResource* IndexBuffer = nullptr;
+
+	// the following three are used only when IndexBuffer is set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	int32 NumIndices = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	int32 FirstIndex = 0;
+
+	// added to each index before fetching the vertex
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	int32 BaseVertex = 0;
+
+	// optional, replaces the first bytes of the first CBV of VSResourceArray for this draw only
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	TArray<uint8> VSConstants;
+
+	// optional, replaces the first bytes of the first CBV of PSResourceArray for this draw only
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	TArray<uint8> PSConstants;
 
 };
 
@@ -65,12 +135,58 @@ class COMPUSHADY_API UCompushadyRasterizer : public UObject, public ICompushadyP
 public:
 	bool InitVSPSFromHLSL(const TArray<uint8>& VertexShaderCode, const FString& VertexShaderEntryPoint, const TArray<uint8>& PixelShaderCode, const FString& PixelShaderEntryPoint, const FCompushadyRasterizerConfig& RasterizerConfig, FString& ErrorMessages);
 	bool InitMSPSFromHLSL(const TArray<uint8>& MeshShaderCode, const FString& MeshShaderEntryPoint, const TArray<uint8>& PixelShaderCode, const FString& PixelShaderEntryPoint, const FCompushadyRasterizerConfig& RasterizerConfig, FString& ErrorMessages);
+	bool InitASMSPSFromHLSL(const TArray<uint8>& AmplificationShaderCode, const FString& AmplificationShaderEntryPoint, const TArray<uint8>& MeshShaderCode, const FString& MeshShaderEntryPoint, const TArray<uint8>& PixelShaderCode, const FString& PixelShaderEntryPoint, const FCompushadyRasterizerConfig& RasterizerConfig, FString& ErrorMessages);
+
+	// draws without RTVs (but with a DSV) are depth only passes: the pixel shader is not bound, so it cannot discard.
+	// The DSV is cleared (to its clear value) when bClearDepthStencil is true.
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "VSResourceArray,PSResourceArray,OnSignaled,RasterizeConfig"), Category = "Compushady")
+	void Draw(const FCompushadyResourceArray& VSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, const int32 NumVertices, const int32 NumInstances, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig = FCompushadyRasterizeConfig());
+
+	// all of the draws in a single render pass (and with a single GPU signal), sharing targets, clears, pipeline state and vertex buffers
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnSignaled,RasterizeConfig"), Category = "Compushady")
+	void DrawBatch(const TArray<FCompushadyRasterizerDraw>& Draws, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig = FCompushadyRasterizeConfig());
+
+	// the index buffer must be created with CreateCompushadyUAVIndexBuffer
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "VSResourceArray,PSResourceArray,OnSignaled,RasterizeConfig"), Category = "Compushady")
+	void DrawIndexed(const FCompushadyResourceArray& VSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, UCompushadyResource* IndexBuffer, const int32 NumIndices, const int32 NumInstances, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig = FCompushadyRasterizeConfig());
+
+	// with an amplification shader XYZ is the number of amplification shader groups and the amplification shader must have no resources
+	// (use DispatchAmplification for binding them). The same applies to DispatchMeshIndirect.
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "MSResourceArray,PSResourceArray,OnSignaled,RasterizeConfig"), Category = "Compushady")
+	void DispatchMesh(const FCompushadyResourceArray& MSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, const FIntVector XYZ, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig = FCompushadyRasterizeConfig());
+
+	// XYZ is the number of amplification shader groups, each one launches (with DispatchMesh in HLSL) the mesh shader groups
+	// of the meshlets it did not cull, passing them its payload
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "ASResourceArray,MSResourceArray,PSResourceArray,OnSignaled,RasterizeConfig"), Category = "Compushady")
+	void DispatchAmplification(const FCompushadyResourceArray& ASResourceArray, const FCompushadyResourceArray& MSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, const FIntVector XYZ, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig = FCompushadyRasterizeConfig());
+
+	// the arguments buffers must be created with CreateCompushadyUAVIndirectArgumentsBuffer (so that a compute shader can fill them)
+	// DrawIndirect arguments are 4 uints: VertexCountPerInstance, InstanceCount, StartVertexLocation, StartInstanceLocation
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "VSResourceArray,PSResourceArray,OnSignaled,RasterizeConfig"), Category = "Compushady")
+	void DrawIndirect(const FCompushadyResourceArray& VSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, UCompushadyResource* ArgumentsBuffer, const int64 ArgumentsOffset, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig = FCompushadyRasterizeConfig());
+
+	// DrawIndexedIndirect arguments are 5 uints: IndexCountPerInstance, InstanceCount, StartIndexLocation, BaseVertexLocation, StartInstanceLocation
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "VSResourceArray,PSResourceArray,OnSignaled,RasterizeConfig"), Category = "Compushady")
+	void DrawIndexedIndirect(const FCompushadyResourceArray& VSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, UCompushadyResource* IndexBuffer, UCompushadyResource* ArgumentsBuffer, const int64 ArgumentsOffset, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig = FCompushadyRasterizeConfig());
 
-	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "VSResourceArray,PSResourceArray,OnSignaled"), Category = "Compushady")
-	void Draw(const FCompushadyResourceArray& VSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, const int32 NumVertices, const int32 NumInstances, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled);
+	// up to MaxDrawArguments consecutive DrawIndexedIndirect arguments, the actual number is read (in the GPU) from the first uint at CountBufferOffset of CountBuffer.
+	// Without multi draw support in the RHI (GRHISupportsMultiDrawIndirect) or without a CountBuffer, the count is ignored and always MaxDrawArguments draws
+	// are issued, so the unused arguments must have a zero InstanceCount.
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "VSResourceArray,PSResourceArray,OnSignaled,RasterizeConfig"), Category = "Compushady")
+	void MultiDrawIndexedIndirect(const FCompushadyResourceArray& VSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyDSV* DSV, UCompushadyResource* IndexBuffer, UCompushadyResource* ArgumentsBuffer, const int64 ArgumentsOffset, UCompushadyResource* CountBuffer, const int64 CountBufferOffset, const int32 MaxDrawArguments, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig = FCompushadyRasterizeConfig());
 
-	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "MSResourceArray,PSResourceArray,OnSignaled"), Category = "Compushady")
-	void DispatchMesh(const FCompushadyResourceArray& MSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, const FIntVector XYZ, const FCompushadySignaled& OnSignaled);
+	// DispatchMeshIndirect arguments are 3 uints: ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "MSResourceArray,PSResourceArray,OnSignaled,RasterizeConfig"), Category = "Compushady")
+	void DispatchMeshIndirect(const FCompushadyResourceArray& MSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*> RTVs, UCompushadyResource* ArgumentsBuffer, const int64 ArgumentsOffset, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig = FCompushadyRasterizeConfig());
+
+	// the vertex shader inputs must use the ATTRIBUTE<N> semantics (float1-4 or uint), VertexBuffers[N] feeds ATTRIBUTE<N> (non interleaved, one element per vertex).
+	// The buffers (created with CreateCompushadyUAVBuffer, so that a compute shader can fill them) are used by all of the following VS draws.
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	void SetVertexBuffers(const TArray<UCompushadyResource*>& InVertexBuffers);
+
+	// creates (and starts compiling) the pipeline state for the given targets, so that the first draw does not stall on it
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool PrecachePipelineState(const TArray<UCompushadyRTV*>& RTVs, UCompushadyDSV* DSV);
 
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
 	bool IsRunning() const;
@@ -78,6 +194,9 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Compushady")
 	FCompushadyResourceBindings VSResourceBindings;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Compushady")
+	FCompushadyResourceBindings ASResourceBindings;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Compushady")
 	FCompushadyResourceBindings MSResourceBindings;
 
@@ -95,14 +214,79 @@ public:
 
 protected:
 	bool CreateVSPSRasterizerPipeline(TArray<uint8>& VertexShaderByteCode, TArray<uint8>& PixelShaderByteCode, Compushady::FCompushadyShaderResourceBindings VertexShaderResourceBindings, Compushady::FCompushadyShaderResourceBindings PixelShaderResourceBindings, const FCompushadyRasterizerConfig& RasterizerConfig, FString& ErrorMessages);
+	bool CreateAmplificationShader(TArray<uint8>& AmplificationShaderByteCode, Compushady::FCompushadyShaderResourceBindings AmplificationShaderResourceBindings, FString& ErrorMessages);
 	bool CreateMSPSRasterizerPipeline(TArray<uint8>& MeshShaderByteCode, TArray<uint8>& PixelShaderByteCode, Compushady::FCompushadyShaderResourceBindings MeshShaderResourceBindings, Compushady::FCompushadyShaderResourceBindings PixelShaderResourceBindings, const FCompushadyRasterizerConfig& RasterizerConfig, FString& ErrorMessages);
 
 	void FillPipelineStateInitializer(const FCompushadyRasterizerConfig& RasterizerConfig);
 
+	// a draw of a render pass, DrawFunction is called after setting its parameters
+	struct FRenderPassDraw
+	{
+		// only for pipelines with an amplification shader
+		FCompushadyResourceArray ASResourceArray;
+		FCompushadyResourceArray VSOrMSResourceArray;
+		FCompushadyResourceArray PSResourceArray;
+		TArray<uint8> VSOrMSConstants;
+		TArray<uint8> PSConstants;
+		TFunction<void(FRHICommandListImmediate& RHICmdList)> DrawFunction;
+		// the vertices fetched by non indexed draws, 0 when unknown (indexed and indirect draws)
+		int32 NumVertices = 0;
+	};
+
+	// common path of the draws: the Buffers (vertex, index and arguments buffers) are tracked and transitioned to their access before the render pass,
+	// DrawFunction is called in the render pass after setting the pipeline state and the parameters
+	void EnqueueDraw(const FCompushadyResourceArray& VSOrMSResourceArray, const FCompushadyResourceArray& PSResourceArray, const TArray<UCompushadyRTV*>& RTVs, UCompushadyDSV* DSV, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig, const TArray<TPair<UCompushadyResource*, ERHIAccess>>& Buffers, TFunction<void(FRHICommandListImmediate& RHICmdList)> DrawFunction, const int32 NumVertices = 0);
+
+	void EnqueueRenderPass(const TArray<FRenderPassDraw>& Draws, const TArray<UCompushadyRTV*>& RTVs, UCompushadyDSV* DSV, const bool bClearColor, const bool bClearDepthStencil, const FCompushadySignaled& OnSignaled, const FCompushadyRasterizeConfig& RasterizeConfig, const TArray<TPair<UCompushadyResource*, ERHIAccess>>& Buffers);
+
+	bool CheckBuffer(const TCHAR* Name, UCompushadyResource* Buffer, const EBufferUsageFlags Usage, const int64 Offset, const int64 Size, const FCompushadySignaled& OnSignaled);
+
+	struct FPipelineStateKey
+	{
+		uint32 RenderTargetsEnabled = 0;
+		TStaticArray<EPixelFormat, MaxSimultaneousRenderTargets> RenderTargetFormats = TStaticArray<EPixelFormat, MaxSimultaneousRenderTargets>(InPlace, EPixelFormat::PF_Unknown);
+		// the creation flags end in the initializer too (some RHIs derive the PSO from them, like sRGB)
+		TStaticArray<ETextureCreateFlags, MaxSimultaneousRenderTargets> RenderTargetFlags = TStaticArray<ETextureCreateFlags, MaxSimultaneousRenderTargets>(InPlace, ETextureCreateFlags::None);
+		EPixelFormat DepthStencilTargetFormat = EPixelFormat::PF_Unknown;
+		ETextureCreateFlags DepthStencilTargetFlag = ETextureCreateFlags::None;
+		uint16 NumSamples = 1;
+
+		bool operator==(const FPipelineStateKey& Other) const
+		{
+			return RenderTargetsEnabled == Other.RenderTargetsEnabled && RenderTargetFormats == Other.RenderTargetFormats && RenderTargetFlags == Other.RenderTargetFlags &&
+				DepthStencilTargetFormat == Other.DepthStencilTargetFormat && DepthStencilTargetFlag == Other.DepthStencilTargetFlag && NumSamples == Other.NumSamples;
+		}
+
+		friend uint32 GetTypeHash(const FPipelineStateKey& Key)
+		{
+			uint32 Hash = HashCombine(GetTypeHash(Key.RenderTargetsEnabled), HashCombine(GetTypeHash(static_cast<uint8>(Key.DepthStencilTargetFormat)), GetTypeHash(Key.NumSamples)));
+			Hash = HashCombine(Hash, GetTypeHash(static_cast<uint64>(Key.DepthStencilTargetFlag)));
+			for (int32 Index = 0; Index < MaxSimultaneousRenderTargets; Index++)
+			{
+				Hash = HashCombine(Hash, HashCombine(GetTypeHash(static_cast<uint8>(Key.RenderTargetFormats[Index])), GetTypeHash(static_cast<uint64>(Key.RenderTargetFlags[Index]))));
+			}
+			return Hash;
+		}
+	};
+
+	using FPipelineStateInitializerPtr = TSharedPtr<const FGraphicsPipelineStateInitializer, ESPMode::ThreadSafe>;
+
+	// must be called in the game thread, the returned initializer is immutable and can be captured by the render commands
+	FPipelineStateInitializerPtr GetPipelineStateInitializer(const TArray<UCompushadyRTV*>& RTVs, UCompushadyDSV* DSV, FString& ErrorMessages);
+
 	ERHIInterfaceType RHIInterfaceType;
 	FVertexShaderRHIRef VertexShaderRef;
 	FPixelShaderRHIRef PixelShaderRef;
 	FMeshShaderRHIRef MeshShaderRef;
+	FAmplificationShaderRHIRef AmplificationShaderRef;
+	// shaders and fixed function state, the render target formats are filled by GetPipelineStateInitializer
 	FGraphicsPipelineStateInitializer PipelineStateInitializer;
-	FGraphicsPipelineStateRHIRef PipelineStateRHIRef;
+	// one for each combination of render target formats and flags
+	TMap<FPipelineStateKey, FPipelineStateInitializerPtr> PipelineStateInitializers;
+	bool bDepthEnabled = false;
+	// empty if the vertex shader has no input (StreamIndex and AttributeIndex are the ATTRIBUTE index)
+	FVertexDeclarationElementList VertexDeclarationElements;
+
+	UPROPERTY()
+	TArray<UCompushadyResource*> VertexBuffers;
 };
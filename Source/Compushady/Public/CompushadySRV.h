@@ -24,6 +24,40 @@ enum class ECompushadySceneTexture : uint8
 	CustomDepth
 };
 
+UENUM(BlueprintType)
+enum class ECompushadyStaticMeshStream : uint8
+{
+	Positions,
+	Tangents,
+	TexCoords,
+	Colors,
+	Indices
+};
+
+// describes how to read a StaticMesh stream in hlsl (vertex Index, element N is Buffer[Index * ElementsPerVertex + N])
+USTRUCT(BlueprintType)
+struct COMPUSHADY_API FCompushadyStaticMeshStreamInfo
+{
+	GENERATED_BODY()
+
+	// the number of indices for the Indices stream
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compushady")
+	int32 NumVertices = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compushady")
+	int32 ElementsPerVertex = 0;
+
+	// in bytes, for each vertex (or index)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compushady")
+	int32 Stride = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compushady")
+	TEnumAsByte<EPixelFormat> PixelFormat = EPixelFormat::PF_Unknown;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compushady")
+	FString HLSLType;
+};
+
 /**
  * 
  */
@@ -33,10 +67,20 @@ class COMPUSHADY_API UCompushadySRV : public UCompushadyResource
 	GENERATED_BODY()
 
 public:
+	// views are created in the render thread, the SRV is pending until then
 	bool InitializeFromTexture(FTextureRHIRef InTextureRHIRef);
+	bool InitializeFromTextureResource(FTextureResource* InTextureResource);
 	bool InitializeFromBuffer(FBufferRHIRef InBufferRHIRef, const EPixelFormat PixelFormat);
 	bool InitializeFromStructuredBuffer(FBufferRHIRef InBufferRHIRef);
+	// view of a range of elements (UE >= 5.3)
+	bool InitializeFromStructuredBuffer(FBufferRHIRef InBufferRHIRef, const uint32 FirstElement, const uint32 NumElements);
 	bool InitializeFromSceneTexture(const ECompushadySceneTexture InSceneTexture);
+	// view of a buffer owned by the engine (like the StaticMesh ones), BufferFunction is called in the render thread
+	bool InitializeFromRenderBuffer(TFunction<FRHIBuffer*()> BufferFunction, const EPixelFormat PixelFormat);
+
+	// the buffer is created (and filled by FillFunction, if any) in the render thread
+	void InitializeFromPendingBuffer(const FString& Name, const int64 Size, const EPixelFormat PixelFormat, TFunction<void(void*)> FillFunction = nullptr);
+	void InitializeFromPendingStructuredBuffer(const FString& Name, const int64 Size, const int32 Stride, TFunction<void(void*)> FillFunction = nullptr);
 	
 	FShaderResourceViewRHIRef GetRHI() const;
 	FTextureRHIRef GetRHI(const FPostProcessMaterialInputs& PPInputs) const;
@@ -44,6 +88,10 @@ public:
 	bool IsSceneTexture() const;
 
 protected:
+	// PF_Unknown for Structured Buffers
+	void CreateBufferView(FRHICommandListImmediate& RHICmdList, const EPixelFormat PixelFormat);
+	void CreateTextureView(FRHICommandListImmediate& RHICmdList);
+
 	FShaderResourceViewRHIRef SRVRHIRef;
 
 	ECompushadySceneTexture SceneTexture = ECompushadySceneTexture::None;
@@ -86,6 +86,73 @@ struct COMPUSHADY_API FCompushadyTextureCopyInfo
 	int32 NumSlices = 1;
 };
 
+USTRUCT(BlueprintType)
+struct COMPUSHADY_API FCompushadyTextureUploadRegion
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	int32 Slice = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	int32 NumSlices = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	int32 Mip = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	FIntPoint Offset = FIntPoint::ZeroValue;
+
+	// zero means the whole mip
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	FIntPoint Size = FIntPoint::ZeroValue;
+
+	// byte offset of the region in the uploaded data
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	int64 DataOffset = 0;
+
+	// zero means tightly packed rows
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
+	int64 RowPitch = 0;
+};
+
+USTRUCT(BlueprintType)
+struct COMPUSHADY_API FCompushadyTextureReadbackRegion
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compushady")
+	int32 Slice = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compushady")
+	int32 Mip = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compushady")
+	FIntPoint Size = FIntPoint::ZeroValue;
+
+	// byte offset of the first row in the readback data
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compushady")
+	int64 Offset = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compushady")
+	int64 RowPitch = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FCompushadyResourceConstant
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Compushady")
+	FString Name;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Compushady")
+	int32 Offset = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Compushady")
+	int32 Size = 0;
+};
+
 USTRUCT(BlueprintType)
 struct FCompushadyResourceBinding
 {
@@ -99,6 +166,10 @@ struct FCompushadyResourceBinding
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Compushady")
 	FString Name;
+
+	// members layout (only for CBVs)
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Compushady")
+	TArray<FCompushadyResourceConstant> Constants;
 };
 
 USTRUCT(BlueprintType)
@@ -167,6 +238,9 @@ struct FCompushadyResourceArray
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compushady")
 	TArray<class UCompushadySampler*> Samplers;
+
+	// contents of the CBVs in snapshot mode, taken when the work is enqueued (see Compushady::Utils::SnapshotResourceArray)
+	TArray<TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe>> CBVSnapshots;
 };
 
 DECLARE_DYNAMIC_DELEGATE_TwoParams(FCompushadySignaled, bool, bSuccess, const FString&, ErrorMessage);
@@ -174,6 +248,8 @@ DECLARE_DYNAMIC_DELEGATE_TwoParams(FCompushadySignaled, bool, bSuccess, const FS
 DECLARE_DYNAMIC_DELEGATE_ThreeParams(FCompushadySignaledWithFloatPayload, bool, bSuccess, float&, Payload, const FString&, ErrorMessage);
 DECLARE_DYNAMIC_DELEGATE_ThreeParams(FCompushadySignaledWithFloatArrayPayload, bool, bSuccess, const TArray<float>&, Payload, const FString&, ErrorMessage);
 
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FCompushadyProgress, int64, ProcessedBytes, int64, TotalBytes);
+
 class COMPUSHADY_API ICompushadySignalable
 {
 public:
@@ -206,13 +282,27 @@ public:
 		RenderThreadCompletionEvent = FFunctionGraphTask::CreateAndDispatchWhenReady([] {}, TStatId(), nullptr, ENamedThreads::GetRenderThread());
 		FGraphEventArray Prerequisites;
 		Prerequisites.Add(RenderThreadCompletionEvent);
-		GameThreadCompletionEvent = FFunctionGraphTask::CreateAndDispatchWhenReady([this, OnSignaled, ReadbackCacheFloats]
+		// ReadbackCacheFloats is filled by the render thread, so it must be captured by reference
+		GameThreadCompletionEvent = FFunctionGraphTask::CreateAndDispatchWhenReady([this, OnSignaled, &ReadbackCacheFloats]
 			{
 				OnSignaled.ExecuteIfBound(true, ReadbackCacheFloats, "");
 				OnSignalReceived();
 			}, TStatId(), &Prerequisites, ENamedThreads::GameThread);
 	}
 
+	// used when the work is driven by a background task (instead of the render thread)
+	void BeginFence(const FCompushadySignaled& OnSignaled, FGraphEventRef WorkerCompletionEvent, TSharedRef<FString, ESPMode::ThreadSafe> WorkerErrorMessages)
+	{
+		RenderThreadCompletionEvent = WorkerCompletionEvent;
+		FGraphEventArray Prerequisites;
+		Prerequisites.Add(RenderThreadCompletionEvent);
+		GameThreadCompletionEvent = FFunctionGraphTask::CreateAndDispatchWhenReady([this, OnSignaled, WorkerErrorMessages]
+			{
+				OnSignaled.ExecuteIfBound(WorkerErrorMessages->IsEmpty(), *WorkerErrorMessages);
+				OnSignalReceived();
+			}, TStatId(), &Prerequisites, ENamedThreads::GameThread);
+	}
+
 	void WaitForGPU(FRHICommandListImmediate& RHICmdList)
 	{
 		RHICmdList.SubmitCommandsAndFlushGPU();
@@ -271,6 +361,26 @@ protected:
 	TArray<TStrongObjectPtr<UObject>> CurrentTrackedResources;
 };
 
+UENUM(BlueprintType)
+enum class ECompushadyTransformLayout : uint8
+{
+	// float4x4 (64 bytes)
+	Matrix4x4,
+	// float3x4 with the translation in the last column (48 bytes)
+	Matrix3x4,
+	// float4 rotation, float3 translation, float3 scale (40 bytes)
+	QuatTranslationScale
+};
+
+UENUM(BlueprintType)
+enum class ECompushadyDataTableLayout : uint8
+{
+	// a struct per row (AoS)
+	Interleaved,
+	// each column is stored contiguously for all of the rows (SoA)
+	Columnar
+};
+
 UCLASS(Abstract)
 class COMPUSHADY_API UCompushadyResource : public UObject, public ICompushadySignalable
 {
@@ -283,9 +393,18 @@ public:
 	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnSignaled"), Category = "Compushady")
 	void ReadbackAllToFloatArray(const FCompushadySignaledWithFloatArrayPayload& OnSignaled);
 
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnSignaled"), Category = "Compushady")
+	void ReadbackToHalfAsFloatArray(const int32 Offset, const int32 Elements, const FCompushadySignaledWithFloatArrayPayload& OnSignaled);
+
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnSignaled"), Category = "Compushady")
+	void ReadbackTextureSliceToFloatArray(const int32 Slice, const FCompushadySignaledWithFloatArrayPayload& OnSignaled);
+
 	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnSignaled"), Category = "Compushady")
 	void ReadbackAllToFile(const FString& Filename, const FCompushadySignaled& OnSignaled);
 
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnProgress,OnSignaled"), Category = "Compushady")
+	void ReadbackAllToFileStreamed(const FString& Filename, const int64 ChunkSize, const FCompushadyProgress& OnProgress, const FCompushadySignaled& OnSignaled);
+
 	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnSignaled"), Category = "Compushady")
 	void ReadbackTextureToPngFile(const FString& Filename, const FCompushadySignaled& OnSignaled);
 
@@ -304,6 +423,7 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
 	FIntVector GetTextureSize() const;
 
+	// for views of a range of elements this is the size of the range
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
 	int64 GetBufferSize() const;
 
@@ -325,8 +445,21 @@ public:
 	bool IsValidTexture() const;
 	bool IsValidBuffer() const;
 
+	// true while the RHI resources are still being created in the render thread
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	bool IsPending() const;
+
+	// true if the deferred creation of the RHI resources failed in the render thread (waits for the creation)
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	bool IsCreationFailed() const;
+
+	// blocks the game thread until the RHI resources are available (does nothing in the other threads)
+	void WaitForCreation() const;
+
 	void OnSignalReceived() override;
 
+	bool IsReadyForFinishDestroy() override;
+
 	void MapReadAndExecute(TFunction<void(const void*)> InFunction, const FCompushadySignaled& OnSignaled);
 	void MapReadAndExecuteInGameThread(TFunction<void(const void*)> InFunction, const FCompushadySignaled& OnSignaled);
 	bool MapReadAndExecuteSync(TFunction<void(const void*)> InFunction);
@@ -335,20 +468,58 @@ public:
 	void MapWriteAndExecuteInGameThread(TFunction<void(void*)> InFunction, const FCompushadySignaled& OnSignaled);
 	bool MapWriteAndExecuteSync(TFunction<void(void*)> InFunction);
 
+	// the transforms are converted in parallel by the render thread directly into the upload buffer (no flushing), Offset is in bytes
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	void UpdateStructuredBufferFromTransforms(const TArray<FTransform>& Transforms, const ECompushadyTransformLayout Layout, const FCompushadySignaled& OnSignaled, const int64 Offset = 0);
+
+	void UpdateStructuredBufferFromTransforms(TArrayView<const FTransform> Transforms, const ECompushadyTransformLayout Layout, const FCompushadySignaled& OnSignaled, const int64 Offset = 0);
+
+	static int32 GetTransformLayoutSize(const ECompushadyTransformLayout Layout);
+
 	UFUNCTION(BlueprintCallable, meta = (AdvancedDisplay = "UpdateInfo", AutoCreateRefTerm = "UpdateInfo"), Category = "Compushady")
 	bool UpdateTextureSliceSync(const TArray<uint8>& Pixels, const int32 Slice);
 
 	bool UpdateTextureSliceSync(const uint8* Ptr, const int64 Size, const int32 Slice);
 
+	// the pixel data is kept alive until the upload is completed, multiple regions are uploaded in a single render command
+	void UpdateTextureAsync(TSharedRef<TArray64<uint8>, ESPMode::ThreadSafe> Pixels, const TArray<FCompushadyTextureUploadRegion>& Regions, const FCompushadySignaled& OnSignaled);
+	void UpdateTextureAsync(TArray64<uint8>&& Pixels, const TArray<FCompushadyTextureUploadRegion>& Regions, const FCompushadySignaled& OnSignaled);
+
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnSignaled"), Category = "Compushady")
+	void UpdateTextureSlicesAsync(const TArray<uint8>& Pixels, const int32 FirstSlice, const int32 NumSlices, const FCompushadySignaled& OnSignaled);
+
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "OnSignaled"), Category = "Compushady")
+	void UpdateTextureRegionsAsync(const TArray<uint8>& Pixels, const TArray<FCompushadyTextureUploadRegion>& Regions, const FCompushadySignaled& OnSignaled);
+
 	bool MapTextureSliceAndExecuteSync(TFunction<void(const void*, const int32)> InFunction, const int32 Slice);
 
+	// slices and mips are copied in a single staging texture and mapped with a single GPU wait
+	void MapTextureSlicesAndExecute(TFunction<void(const uint8*, const TArray<FCompushadyTextureReadbackRegion>&)> InFunction, const FCompushadySignaled& OnSignaled, const int32 FirstSlice, const int32 NumSlices, const int32 FirstMip = 0, const int32 NumMips = 1);
+	bool MapTextureSlicesAndExecuteSync(TFunction<void(const uint8*, const TArray<FCompushadyTextureReadbackRegion>&)> InFunction, const int32 FirstSlice, const int32 NumSlices, const int32 FirstMip = 0, const int32 NumMips = 1);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool ReadbackTextureSlicesSync(const int32 FirstSlice, const int32 NumSlices, const int32 FirstMip, const int32 NumMips, TArray<uint8>& Bytes, TArray<FCompushadyTextureReadbackRegion>& Regions);
+
 protected:
+	// the RHI resources are created in the render thread, render commands enqueued later are always executed after it
+	void EnqueueCreation(TFunction<void(FRHICommandListImmediate& RHICmdList)> InFunction);
+	void EnqueueBufferCreation(const FString& Name, const int64 Size, const EBufferUsageFlags Usage, const uint32 Stride, const ERHIAccess InitialState, TFunction<void(void*)> FillFunction, TFunction<void(FRHICommandListImmediate& RHICmdList)> OnCreated);
+
+	FGraphEventRef CreationCompletionEvent;
+	// written by the render thread before CreationCompletionEvent is completed
+	bool bCreationFailed = false;
+
 	FTextureRHIRef TextureRHIRef;
 	FBufferRHIRef BufferRHIRef;
+	// byte range of BufferRHIRef accessed by the buffer map/readback/upload functions (0 size means the whole buffer),
+	// views of a range of elements only see their own range
+	int64 BufferViewOffset = 0;
+	int64 BufferViewSize = 0;
 	FStagingBufferRHIRef StagingBufferRHIRef;
 	FBufferRHIRef UploadBufferRHIRef;
 	FRHITransitionInfo RHITransitionInfo;
 	FTextureRHIRef ReadbackTextureRHIRef;
+	FTextureRHIRef ReadbackAtlasTextureRHIRef;
 	TArray<uint8> ReadbackCacheBytes;
 	TArray<float> ReadbackCacheFloats;
 };
@@ -361,9 +532,13 @@ namespace Compushady
 		COMPUSHADY_API bool ValidateResourceBindings(const FCompushadyResourceArray& ResourceArray, const FCompushadyResourceBindings& ResourceBindings, FString& ErrorMessages);
 		COMPUSHADY_API FPixelShaderRHIRef CreatePixelShaderFromHLSL(const TArray<uint8>& ShaderCode, const FString& EntryPoint, FCompushadyResourceBindings& ResourceBindings, FString& ErrorMessages);
 
+		// must be called in the game thread when enqueuing the work (it snapshots CBVs and uploads CBV pools), the returned array is the one to pass to SetupPipelineParameters
+		COMPUSHADY_API FCompushadyResourceArray SnapshotResourceArray(const FCompushadyResourceArray& ResourceArray);
+
 		COMPUSHADY_API void SetupPipelineParameters(FRHICommandList& RHICmdList, FComputeShaderRHIRef Shader, const FCompushadyResourceArray& ResourceArray, const FCompushadyResourceBindings& ResourceBindings);
 		COMPUSHADY_API void SetupPipelineParameters(FRHICommandList& RHICmdList, FVertexShaderRHIRef Shader, const FCompushadyResourceArray& ResourceArray, const FCompushadyResourceBindings& ResourceBindings);
 		COMPUSHADY_API void SetupPipelineParameters(FRHICommandList& RHICmdList, FMeshShaderRHIRef Shader, const FCompushadyResourceArray& ResourceArray, const FCompushadyResourceBindings& ResourceBindings);
+		COMPUSHADY_API void SetupPipelineParameters(FRHICommandList& RHICmdList, FAmplificationShaderRHIRef Shader, const FCompushadyResourceArray& ResourceArray, const FCompushadyResourceBindings& ResourceBindings);
 		COMPUSHADY_API void SetupPipelineParameters(FRHICommandList& RHICmdList, FPixelShaderRHIRef Shader, const FCompushadyResourceArray& ResourceArray, const FCompushadyResourceBindings& ResourceBindings, const FPostProcessMaterialInputs& PPInputs);
 		COMPUSHADY_API void SetupPipelineParameters(FRHICommandList& RHICmdList, FRayTracingShaderBindingsWriter& ShaderBindingsWriter, const FCompushadyResourceArray& ResourceArray, const FCompushadyResourceBindings& ResourceBindings);
 	}
@@ -16,12 +16,26 @@ class COMPUSHADY_API UCompushadyUAV : public UCompushadyResource
 	GENERATED_BODY()
 
 public:
+	// views are created in the render thread, the UAV is pending until then
 	bool InitializeFromTexture(FTextureRHIRef InTextureRHIRef);
+	// view of a single mip (the texture size and the transitions still refer to the whole texture)
+	bool InitializeFromTextureMip(FTextureRHIRef InTextureRHIRef, const int32 MipLevel);
+	bool InitializeFromTextureResource(FTextureResource* InTextureResource);
 	bool InitializeFromBuffer(FBufferRHIRef InBufferRHIRef, const EPixelFormat PixelFormat);
 	bool InitializeFromStructuredBuffer(FBufferRHIRef InBufferRHIRef);
+	// view of a range of elements (UE >= 5.3)
+	bool InitializeFromStructuredBuffer(FBufferRHIRef InBufferRHIRef, const uint32 FirstElement, const uint32 NumElements);
+
+	// the buffer is created (and filled by FillFunction, if any) in the render thread too
+	void InitializeFromPendingBuffer(const FString& Name, const int64 Size, const EPixelFormat PixelFormat, const EBufferUsageFlags AdditionalUsage = EBufferUsageFlags::None);
+	void InitializeFromPendingStructuredBuffer(const FString& Name, const int64 Size, const int32 Stride, TFunction<void(void*)> FillFunction = nullptr);
 
 	FUnorderedAccessViewRHIRef GetRHI() const;
 
 protected:
+	// PF_Unknown for Structured Buffers
+	void CreateBufferView(FRHICommandListImmediate& RHICmdList, const EPixelFormat PixelFormat);
+	void CreateTextureView(FRHICommandListImmediate& RHICmdList, const int32 MipLevel = 0);
+
 	FUnorderedAccessViewRHIRef UAVRHIRef;
 };
@@ -0,0 +1,124 @@
+// Copyright 2023 - Roberto De Ioris.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CompushadyUAV.h"
+#include "CompushadyUAVPool.generated.h"
+
+struct FCompushadyUAVPoolKey
+{
+	enum class EKind : uint8
+	{
+		Buffer,
+		StructuredBuffer,
+		Texture2D,
+		Texture2DArray,
+		Texture3D
+	};
+
+	EKind Kind = EKind::Buffer;
+	// buffers use only X (the size in bytes is always stored in Size)
+	FIntVector Extent = FIntVector::ZeroValue;
+	int64 Size = 0;
+	EPixelFormat PixelFormat = EPixelFormat::PF_Unknown;
+	int32 Stride = 0;
+
+	bool operator==(const FCompushadyUAVPoolKey& Other) const
+	{
+		return Kind == Other.Kind && Extent == Other.Extent && Size == Other.Size && PixelFormat == Other.PixelFormat && Stride == Other.Stride;
+	}
+
+	friend uint32 GetTypeHash(const FCompushadyUAVPoolKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(static_cast<uint8>(Key.Kind)), GetTypeHash(Key.Extent)), HashCombine(GetTypeHash(Key.Size), HashCombine(GetTypeHash(static_cast<uint8>(Key.PixelFormat)), GetTypeHash(Key.Stride))));
+	}
+};
+
+/**
+ * Recycles scratch UAVs: a released UAV is handed out again by the next Acquire with the same descriptor.
+ * The content of a recycled UAV is undefined, the Name is used only when a new UAV is created.
+ * Free UAVs not acquired for more than EvictionFrames frames are destroyed by Evict (called by each Acquire).
+ */
+UCLASS(BlueprintType)
+class COMPUSHADY_API UCompushadyUAVPool : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	void InitializePool(const int32 InEvictionFrames);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	UCompushadyUAV* AcquireUAVBuffer(const FString& Name, const int64 Size, const EPixelFormat PixelFormat);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	UCompushadyUAV* AcquireUAVStructuredBuffer(const FString& Name, const int64 Size, const int32 Stride);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	UCompushadyUAV* AcquireUAVTexture2D(const FString& Name, const int32 Width, const int32 Height, const EPixelFormat Format);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	UCompushadyUAV* AcquireUAVTexture2DArray(const FString& Name, const int32 Width, const int32 Height, const int32 Slices, const EPixelFormat Format);
+
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	UCompushadyUAV* AcquireUAVTexture3D(const FString& Name, const int32 Width, const int32 Height, const int32 Depth, const EPixelFormat Format);
+
+	// the UAV must have been acquired from this pool
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	bool Release(UCompushadyUAV* UAV);
+
+	// returns the number of destroyed UAVs
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	int32 Evict();
+
+	// destroys all of the free UAVs
+	UFUNCTION(BlueprintCallable, Category = "Compushady")
+	void Trim();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int64 GetPooledBytes() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int32 GetNumPooledUAVs() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int32 GetNumFreeUAVs() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int64 GetNumHits() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	int64 GetNumMisses() const;
+
+	// between 0 and 1
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Compushady")
+	float GetHitRate() const;
+
+	void BeginDestroy() override;
+
+protected:
+	struct FPooledUAV
+	{
+		FCompushadyUAVPoolKey Key;
+		int64 Bytes = 0;
+		uint64 LastReleasedFrame = 0;
+		bool bAcquired = false;
+	};
+
+	UCompushadyUAV* Acquire(const FCompushadyUAVPoolKey& Key, TFunction<UCompushadyUAV*()> CreateFunction);
+	void RemoveUAV(UCompushadyUAV* UAV);
+	void UpdateStats(const int64 BytesDelta);
+
+	int32 EvictionFrames = 30;
+
+	// this keeps the pooled UAVs alive
+	UPROPERTY()
+	TArray<UCompushadyUAV*> UAVs;
+
+	TMap<UCompushadyUAV*, FPooledUAV> PooledUAVs;
+	TMultiMap<FCompushadyUAVPoolKey, UCompushadyUAV*> FreeUAVs;
+
+	int64 PooledBytes = 0;
+	int64 NumHits = 0;
+	int64 NumMisses = 0;
+};